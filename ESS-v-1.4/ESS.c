@@ -26,1048 +26,377 @@
 #endif
 
 #include <stdio.h>
+#include <errno.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <fcntl.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+#include <linux/if_alg.h>
 
 #include "lib/bluetooth.h"
 #include "lib/l2cap.h"
 #include "lib/uuid.h"
 #include "src/shared/mainloop.h"
+#include "src/shared/timeout.h"
 #include "src/shared/util.h"
 #include "src/shared/queue.h"
-#include "src/shared/timeout.h"
 #include "src/shared/att.h"
 #include "src/shared/gatt-db.h"
 #include "src/shared/gatt-server.h"
 #include "src/shared/gatt-client.h"
 #include "peripheral/ESS/ess_uuid.h"
 #include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/profile.h"
+#include "peripheral/ESS/metrics.h"
+#include "peripheral/ESS/log.h"
+#include "peripheral/ESS/trace.h"
+#include "peripheral/ESS/sim.h"
+#include "peripheral/ESS/trigger.h"
+#include "peripheral/ESS/state.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/sched.h"
 
 
 static int att_fd = -1;
 static struct queue *conn_list = NULL;
 static struct gatt_db *gatt_db = NULL;
 static struct gatt_db *gatt_cache = NULL;
-static struct ess_temp *temp_db = NULL;
-static struct ess_apparent_speed *apparent_speed_db = NULL;
-static struct ess_apparent_direction *apparent_direction_db=NULL;
-static struct ess_dew_point *dew_point_db=NULL;
-static struct ess_elevation *elevation_db=NULL;
-static struct ess_gust_factor *gust_factor_db=NULL;
-static struct ess_heat_index *heat_index_db=NULL;
-static struct ess_humidity *humidity_db=NULL;
-static struct ess_irradiance *irradiance_db=NULL;
-static struct ess_pollen_concentration *pollen_concentration_db=NULL;
-static struct ess_rainfall *rainfall_db=NULL;
-static struct ess_pressure *pressure_db=NULL;
-static struct ess_true_direction *true_direction_db=NULL;
-static struct ess_true_speed *true_speed_db=NULL;
-static struct ess_uv_index *uv_index_db=NULL;
-static struct ess_wind_chill *wind_chill_db=NULL;
-static struct ess_barometric_pressure *barometric_pressure_db=NULL;
-static struct ess_magnetic_declination *magnetic_declination_db=NULL;
-static struct ess_magnetic_flux_2D *magnetic_flux_2D_db=NULL;
-static struct ess_magnetic_flux_3D *magnetic_flux_3D_db=NULL;
-static struct gatt_conn *conn = NULL;
+/* src/shared objects behind gatt_db and gatt_cache, measured */
+static int64_t gatt_db_mem = 0;
+static struct queue *ess_chars = NULL;
+static struct gatt_db_attribute *ess_service = NULL;
+static uint16_t svc_chngd_handle = 0;
+static const char *profile_path = NULL;
+static unsigned int tick_id = 0;
+static uint32_t tick_count = 0;
+static uint64_t tick_time = 0;
+/* the same instant on CLOCK_MONOTONIC, tick_time is virtual when simulated */
+static uint64_t tick_mono = 0;
+static uint64_t tick_due = 0;
+static bool tx_timestamps = false;
+static uint32_t notify_rate = 0;
+static uint32_t notify_burst = 0;
+static uint8_t db_hash[16];
+static bool db_hash_valid = false;
+static struct metrics_hist conn_accept;
+static struct metrics_hist conn_setup;
 
 static uint8_t public_addr[6] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
 static uint8_t dev_name[20];
 static uint8_t dev_name_len = 0;
 
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for temperature characteristic and its descriptors like                                   ***
-***  Temperature = 0x0A8C (27 degC)							       ***
-***  User Descriptor = "Temperature charact "                                                  ***
-***  range = 0 to 100 (degC) 			  					       ***
-***  flags = 0 ,sampling = instantaneous, measurement_period= 20 sec, update=29sec,	       ***	
-***  application = left, uncertainity = 10.5%                                                  ***
-
-*/
-
-
-static void es_temp_init(void)
+void gatt_set_public_address(uint8_t addr[6])
 {
-
-	temp_db = new0(struct ess_temp, 1);
-	temp_db->temp_ms = new0(struct ess_measurement, 1);
-	temp_db->temp_tr = new0(struct trigger_setting, 1);
-	temp_db->user_desc = new0(wchar_t, 21);
-
-	memcpy(temp_db->user_desc, "Temperature Charact", 19);
-	temp_db->lower_temp = 0x0000;
-	temp_db->upper_temp = 0x2710;
-	temp_db->temp_data = 0x0A8C;
-	temp_db->temp_ms->flags = 0;
-	temp_db->temp_ms->sample = 0x01;
-	temp_db->temp_ms->applicatn = 0x1D;
-	temp_db->temp_ms->m_uncertainity = 0x15;
-	temp_db->temp_ms->m_period[0] = 0x14;
-	temp_db->temp_ms->m_period[1] = 0;
-	temp_db->temp_ms->m_period[2] = 0;
-	temp_db->temp_ms->u_interval[0] = 0x1D;
-	temp_db->temp_ms->u_interval[1] = 0;
-	temp_db->temp_ms->u_interval[2] = 0;
-	temp_db->indication = 0x0000;
-	temp_db->temp_tr->condition = 0x01;
-	temp_db->temp_tr->data[0] = 0x3C;
-	temp_db->temp_tr->data[1] = 0x00;
-	temp_db->temp_tr->data[2] = 0x00;
-
-	if( temp_db->temp_tr->condition==0x01 || temp_db->temp_tr->condition==0x02)
-		temp_db->temp_tr->time_enable=true;
-	else if( temp_db->temp_tr->condition>=0x03 && temp_db->temp_tr->condition<= 0x09)
-		temp_db->temp_tr->value_enable=true;
-	else	
-		temp_db->temp_tr->trigger_inactive=true;
-
-	temp_db->g_update_timer=(temp_db->temp_tr->data[0])|(temp_db->temp_tr->data[1]<<8)| (temp_db->temp_tr->data[2]<<16);
-
+	memcpy(public_addr, addr, sizeof(public_addr));
 }
 
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Apparent wind Speed characteristic and its descriptors like                                ***
-***  Wind Speed = 0x0100 (2.56 m/sec)						               ***
-***  User Descriptor = "Apparent Wind speed"                                                  ***
-***  range = 0 to 100 (m/sec) 			  					       ***
-***  flags = 0 ,sampling = instantaneous, measurement_period= 10 sec, update=15sec,	       ***	
-***  application = Air, uncertainity = 10.5%                                                   ***
-
-*/
-
-static void es_speed_init(void)
+void gatt_set_device_name(uint8_t name[20], uint8_t len)
 {
-
-	apparent_speed_db = new0(struct ess_apparent_speed, 1);
-	apparent_speed_db->apparent_speed_ms = new0(struct ess_measurement, 1);
-	apparent_speed_db->apparent_speed_tr = new0(struct trigger_setting, 1);
-	apparent_speed_db->user_desc = new0(wchar_t, 21);
-
-	memcpy(apparent_speed_db->user_desc, "Apparent wind Speed", 20);
-	apparent_speed_db->lower_speed = 0x0000;
-	apparent_speed_db->upper_speed = 0x2710;
-	apparent_speed_db->apparent_speed_data = 0x0100;
-	apparent_speed_db->apparent_speed_ms->flags = 0;
-	apparent_speed_db->apparent_speed_ms->sample = 0x01;
-	apparent_speed_db->apparent_speed_ms->applicatn = 0x01;
-	apparent_speed_db->apparent_speed_ms->m_uncertainity = 0x15;
-	apparent_speed_db->apparent_speed_ms->m_period[0] = 0x0A;
-	apparent_speed_db->apparent_speed_ms->m_period[1] = 0;
-	apparent_speed_db->apparent_speed_ms->m_period[2] = 0;
-	apparent_speed_db->apparent_speed_ms->u_interval[0] = 0x0F;
-	apparent_speed_db->apparent_speed_ms->u_interval[1] = 0;
-	apparent_speed_db->apparent_speed_ms->u_interval[2] = 0;
-	apparent_speed_db->indication = 0x0000;
-	apparent_speed_db->apparent_speed_tr->condition = 0x01;
-	apparent_speed_db->apparent_speed_tr->data[0] = 0x3C;
-	apparent_speed_db->apparent_speed_tr->data[1] = 0x00;
-	apparent_speed_db->apparent_speed_tr->data[2] = 0x00;
-        	 
-	if( apparent_speed_db->apparent_speed_tr->condition==0x01 || apparent_speed_db->apparent_speed_tr->condition==0x02)
-		apparent_speed_db->apparent_speed_tr->time_enable=true;
-	else if( apparent_speed_db->apparent_speed_tr->condition>=0x03 && apparent_speed_db->apparent_speed_tr->condition<= 0x09)
-		apparent_speed_db->apparent_speed_tr->value_enable=true;
-	else	
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=true;
-
-	apparent_speed_db->g_update_timer=(apparent_speed_db->apparent_speed_tr->data[0])|(apparent_speed_db->apparent_speed_tr->data[1]<<8)| (apparent_speed_db->apparent_speed_tr->data[2]<<16);
+	memcpy(dev_name, name, sizeof(dev_name));
+	dev_name_len = len;
 }
 
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Apparent Wind direction characteristic and its descriptors like                       ***
-***  Wind Direction = 0x0123 (2.91 deg)						               ***
-***  User Descriptor = "Apparent Direction"                                                    ***
-***  range = 0 to 436.9 (deg) 			  					       ***
-***  flags = 0 ,sampling = RMS, measurement_period= 60 sec, update=316sec,	               ***	
-***  application = Air, uncertainity = 10.5%                                                   ***
-
-*/
-
-static void es_apparent_direction_init(void)
+void gatt_set_profile(const char *path)
 {
-
-	apparent_direction_db = new0(struct ess_apparent_direction, 1);
-	apparent_direction_db->apparent_direction_ms = new0(struct ess_measurement, 1);
-	apparent_direction_db->apparent_direction_tr = new0(struct trigger_setting, 1);
-	apparent_direction_db->user_desc = new0(wchar_t, 21);
-	
-	apparent_direction_db->apparent_direction_data = 0x0123;
-	memcpy(apparent_direction_db->user_desc, "Apparent Direction", 18);
-	apparent_direction_db->lower_direction = 0x0000;
-	apparent_direction_db->upper_direction = 0xAAAA;
-	apparent_direction_db->apparent_direction_ms->flags = 0;
-	apparent_direction_db->apparent_direction_ms->sample = 0x03;
-	apparent_direction_db->apparent_direction_ms->applicatn = 0x01;
-	apparent_direction_db->apparent_direction_ms->m_uncertainity = 0x15;
-	apparent_direction_db->apparent_direction_ms->m_period[0] = 0x3C;
-	apparent_direction_db->apparent_direction_ms->m_period[1] = 0;
-	apparent_direction_db->apparent_direction_ms->m_period[2] = 0;
-	apparent_direction_db->apparent_direction_ms->u_interval[0] = 0x3C;
-	apparent_direction_db->apparent_direction_ms->u_interval[1] = 0x01;
-	apparent_direction_db->apparent_direction_ms->u_interval[2] = 0;
-	apparent_direction_db->indication = 0x0000;
-	apparent_direction_db->apparent_direction_tr->condition = 0x01;
-	apparent_direction_db->apparent_direction_tr->data[0] = 0x3C;
-	apparent_direction_db->apparent_direction_tr->data[1] = 0x00;
-	apparent_direction_db->apparent_direction_tr->data[2] = 0x00;
-
-	if( apparent_direction_db->apparent_direction_tr->condition==0x01 || apparent_direction_db->apparent_direction_tr->condition==0x02)
-		apparent_direction_db->apparent_direction_tr->time_enable=true;
-	else if( apparent_direction_db->apparent_direction_tr->condition>=0x03 && apparent_direction_db->apparent_direction_tr->condition<= 0x09)
-		apparent_direction_db->apparent_direction_tr->value_enable=true;
-	else	
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=true;
-
-	apparent_direction_db->g_update_timer=(apparent_direction_db->apparent_direction_tr->data[0])|(apparent_direction_db->apparent_direction_tr->data[1]<<8)| (apparent_direction_db->apparent_direction_tr->data[2]<<16);
-
+	profile_path = path;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Dew Point characteristic and its descriptors like                                     ***
-***  User Descriptor = "Dew Point"                                                             ***
-
-*/
-
-
-static void es_dew_point_init(void)
+void gatt_set_tx_timestamps(bool enable)
 {
-
-	dew_point_db = new0(struct ess_dew_point, 1);
-	dew_point_db->dew_point_ms = new0(struct ess_measurement, 1);
-	dew_point_db->dew_point_tr = new0(struct trigger_setting, 1);
-	dew_point_db->user_desc = new0(wchar_t, 21);
-	
-	dew_point_db->dew_point_data = 0x23;
-	memcpy(dew_point_db->user_desc, "Dew Point", 10);
-	dew_point_db->lower_dew_point = 10;
-	dew_point_db->upper_dew_point = 45;
-	dew_point_db->dew_point_ms->flags = 0;
-	dew_point_db->dew_point_ms->sample = 0x02;
-	dew_point_db->dew_point_ms->applicatn = 0x15;
-	dew_point_db->dew_point_ms->m_uncertainity = 0x15;
-	dew_point_db->dew_point_ms->m_period[0] = 0x3C;
-	dew_point_db->dew_point_ms->m_period[1] = 0x10;
-	dew_point_db->dew_point_ms->m_period[2] = 0;
-	dew_point_db->dew_point_ms->u_interval[0] = 0x3C;
-	dew_point_db->dew_point_ms->u_interval[1] = 0x1F;
-	dew_point_db->dew_point_ms->u_interval[2] = 0;
-	dew_point_db->indication = 0x0000;
-	dew_point_db->dew_point_tr->condition = 0x01;
-	dew_point_db->dew_point_tr->data[0] = 0x3C;
-	dew_point_db->dew_point_tr->data[1] = 0x00;
-	dew_point_db->dew_point_tr->data[2] = 0x00;
-
-	if( dew_point_db->dew_point_tr->condition==0x01 || dew_point_db->dew_point_tr->condition==0x02)
-		dew_point_db->dew_point_tr->time_enable=true;
-	else if( dew_point_db->dew_point_tr->condition>=0x03 && dew_point_db->dew_point_tr->condition<= 0x09)
-		dew_point_db->dew_point_tr->value_enable=true;
-	else	
-		dew_point_db->dew_point_tr->trigger_inactive=true;
-
-	dew_point_db->g_update_timer=(dew_point_db->dew_point_tr->data[0])|(dew_point_db->dew_point_tr->data[1]<<8)| (dew_point_db->dew_point_tr->data[2]<<16);
-
+	tx_timestamps = enable;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Elevation characteristic and its descriptors like                                     ***
-***  User Descriptor = "Elevation"                                                             ***
-
-*/
+/* Octets of notifications per second and connection, 0 for no limit */
 
-static void es_elevation_init(void)
+void gatt_set_notify_budget(uint32_t rate, uint32_t burst)
 {
-
-	elevation_db = new0(struct ess_elevation, 1);
-	elevation_db->elevation_ms = new0(struct ess_measurement, 1);
-	elevation_db->elevation_tr = new0(struct trigger_setting, 1);
-	elevation_db->user_desc = new0(wchar_t, 21);
-	
-	elevation_db->elevation_data = rand();
-	memcpy(elevation_db->user_desc, "Elevation", 10);
-	elevation_db->lower_elevation[0] = 0x15;
-	elevation_db->lower_elevation[1] = 0x25;
-	elevation_db->lower_elevation[2] = 0x00;
-	elevation_db->upper_elevation[0] = 0x55;
-	elevation_db->upper_elevation[1] = 0x25;
-	elevation_db->upper_elevation[2] = 0x00;
-	elevation_db->elevation_ms->flags = 0;
-	elevation_db->elevation_ms->sample = 0x07;
-	elevation_db->elevation_ms->applicatn = 0x15;
-	elevation_db->elevation_ms->m_uncertainity = 0x15;
-	elevation_db->elevation_ms->m_period[0] = 0x3C;
-	elevation_db->elevation_ms->m_period[1] = 0x01;
-	elevation_db->elevation_ms->m_period[2] = 0;
-	elevation_db->elevation_ms->u_interval[0] = 0x3C;
-	elevation_db->elevation_ms->u_interval[1] = 0x1F;
-	elevation_db->elevation_ms->u_interval[2] = 0;
-	elevation_db->indication = 0x0000;
-	elevation_db->elevation_tr->condition = 0x01;
-	elevation_db->elevation_tr->data[0] = 0x3C;
-	elevation_db->elevation_tr->data[1] = 0x00;
-	elevation_db->elevation_tr->data[2] = 0x00;
-
-	elevation_db->tr_value = 0;
-
-	if( elevation_db->elevation_tr->condition==0x01 || elevation_db->elevation_tr->condition==0x02)
-		elevation_db->elevation_tr->time_enable=true;
-	else if( elevation_db->elevation_tr->condition>=0x03 && elevation_db->elevation_tr->condition<= 0x09)
-		elevation_db->elevation_tr->value_enable=true;
-	else	
-		elevation_db->elevation_tr->trigger_inactive=true;
-
-	elevation_db->g_update_timer=(elevation_db->elevation_tr->data[0])|(elevation_db->elevation_tr->data[1]<<8)| (elevation_db->elevation_tr->data[2]<<16);
-
+	notify_rate = rate;
+	notify_burst = burst > rate ? burst : rate;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Gust Factor characteristic and its descriptors like                                   ***
-***  User Descriptor = "Gust Factor"                                                           ***
-
-*/
+/* Record how far along the pipeline a sample of the characteristic got */
 
-static void es_gust_factor_init(void)
+static void ess_char_observe(struct ess_char *chr, enum ess_stage stage,
+							uint64_t elapsed)
 {
+	if (!chr->age && !ess_char_age_new(chr))
+		return;
 
-	gust_factor_db = new0(struct ess_gust_factor, 1);
-	gust_factor_db->gust_factor_ms = new0(struct ess_measurement, 1);
-	gust_factor_db->gust_factor_tr = new0(struct trigger_setting, 1);
-	gust_factor_db->user_desc = new0(wchar_t, 21);
-	
-	gust_factor_db->gust_factor_data = rand();
-	memcpy(gust_factor_db->user_desc, "Gust Factor", 10);
-	gust_factor_db->lower_gust_factor = 10;
-	gust_factor_db->upper_gust_factor = 45;
-	gust_factor_db->gust_factor_ms->flags = 0;
-	gust_factor_db->gust_factor_ms->sample = 0x05;
-	gust_factor_db->gust_factor_ms->applicatn = 0x09;
-	gust_factor_db->gust_factor_ms->m_uncertainity = 0x08;
-	gust_factor_db->gust_factor_ms->m_period[0] = 0x3C;
-	gust_factor_db->gust_factor_ms->m_period[1] = 0x10;
-	gust_factor_db->gust_factor_ms->m_period[2] = 0;
-	gust_factor_db->gust_factor_ms->u_interval[0] = 0x3C;
-	gust_factor_db->gust_factor_ms->u_interval[1] = 0x1F;
-	gust_factor_db->gust_factor_ms->u_interval[2] = 0;
-	gust_factor_db->indication = 0x0000;
-	gust_factor_db->gust_factor_tr->condition = 0x01;
-	gust_factor_db->gust_factor_tr->data[0] = 0x3C;
-	gust_factor_db->gust_factor_tr->data[1] = 0x00;
-	gust_factor_db->gust_factor_tr->data[2] = 0x00;
-
-	if( gust_factor_db->gust_factor_tr->condition==0x01 || gust_factor_db->gust_factor_tr->condition==0x02)
-		gust_factor_db->gust_factor_tr->time_enable=true;
-	else if( gust_factor_db->gust_factor_tr->condition>=0x03 && gust_factor_db->gust_factor_tr->condition<= 0x09)
-		gust_factor_db->gust_factor_tr->value_enable=true;
-	else	
-		gust_factor_db->gust_factor_tr->trigger_inactive=true;
-
-	gust_factor_db->g_update_timer=(gust_factor_db->gust_factor_tr->data[0])|(gust_factor_db->gust_factor_tr->data[1]<<8)| (gust_factor_db->gust_factor_tr->data[2]<<16);
-
+	metrics_observe(&chr->age[stage], elapsed);
 }
 
-
 /*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Heat index characteristic and its descriptors like                                    ***
-***  User Descriptor = "Heat index"                                                            ***
-
+*** Kernel transmit timestamps (SO_TIMESTAMPING). The kernel loops every   ***
+*** PDU back on the error queue of the socket with the time it went to the ***
+*** driver and, where Bluetooth supports it, the time the controller sent  ***
+*** it. They are matched against the notifications queued on the           ***
+*** connection by opcode and handle, anything else is not ours.            ***
+***                                                                        ***
+*** A pending error queue raises EPOLLERR on the socket, which an ATT      ***
+*** transport may take for a hangup, so this is only enabled on request.   ***
 */
 
-static void es_heat_index_init(void)
-{
-
-	heat_index_db = new0(struct ess_heat_index, 1);
-	heat_index_db->heat_index_ms = new0(struct ess_measurement, 1);
-	heat_index_db->heat_index_tr = new0(struct trigger_setting, 1);
-	heat_index_db->user_desc = new0(wchar_t, 21);
-	
-	heat_index_db->heat_index_data = 0x23;
-	memcpy(heat_index_db->user_desc, "Heat index", 10);
-	heat_index_db->lower_heat_index = 10;
-	heat_index_db->upper_heat_index = 45;
-	heat_index_db->heat_index_ms->flags = 0;
-	heat_index_db->heat_index_ms->sample = 0x02;
-	heat_index_db->heat_index_ms->applicatn = 0x15;
-	heat_index_db->heat_index_ms->m_uncertainity = 0x15;
-	heat_index_db->heat_index_ms->m_period[0] = 0x3C;
-	heat_index_db->heat_index_ms->m_period[1] = 0x10;
-	heat_index_db->heat_index_ms->m_period[2] = 0;
-	heat_index_db->heat_index_ms->u_interval[0] = 0x3C;
-	heat_index_db->heat_index_ms->u_interval[1] = 0x1F;
-	heat_index_db->heat_index_ms->u_interval[2] = 0;
-	heat_index_db->indication = 0x0000;
-	heat_index_db->heat_index_tr->condition = 0x01;
-	heat_index_db->heat_index_tr->data[0] = 0x3C;
-	heat_index_db->heat_index_tr->data[1] = 0x00;
-	heat_index_db->heat_index_tr->data[2] = 0x00;
-
-	if( heat_index_db->heat_index_tr->condition==0x01 || heat_index_db->heat_index_tr->condition==0x02)
-		heat_index_db->heat_index_tr->time_enable=true;
-	else if( heat_index_db->heat_index_tr->condition>=0x03 && heat_index_db->heat_index_tr->condition<= 0x09)
-		heat_index_db->heat_index_tr->value_enable=true;
-	else	
-		heat_index_db->heat_index_tr->trigger_inactive=true;
-
-	heat_index_db->g_update_timer=(heat_index_db->heat_index_tr->data[0])|(heat_index_db->heat_index_tr->data[1]<<8)| (heat_index_db->heat_index_tr->data[2]<<16);
+/* not known to older headers */
+#define ESS_TSTAMP_TX_COMPLETION	(1 << 18)
+#define ESS_TSTAMP_COMPLETION		3
 
-}
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Humidity characteristic and its descriptors like                                      ***
-***  User Descriptor = "Humidity"                                                              ***
-
-*/
-
-static void es_humidity_init(void)
+static void tx_push(struct gatt_conn *conn, uint16_t handle, uint8_t len,
+							uint64_t sampled)
 {
+	struct ess_tx *tx;
 
-	humidity_db = new0(struct ess_humidity, 1);
-	humidity_db->humidity_ms = new0(struct ess_measurement, 1);
-	humidity_db->humidity_tr = new0(struct trigger_setting, 1);
-	humidity_db->user_desc = new0(wchar_t, 21);
-	
-	humidity_db->humidity_data = rand();
-	memcpy(humidity_db->user_desc, "Humidity", 8);
-	humidity_db->lower_humidity = 10;
-	humidity_db->upper_humidity = 45;
-	humidity_db->humidity_ms->flags = 0;
-	humidity_db->humidity_ms->sample = 0x02;
-	humidity_db->humidity_ms->applicatn = 0x15;
-	humidity_db->humidity_ms->m_uncertainity = 0x15;
-	humidity_db->humidity_ms->m_period[0] = 0x3C;
-	humidity_db->humidity_ms->m_period[1] = 0x10;
-	humidity_db->humidity_ms->m_period[2] = 0;
-	humidity_db->humidity_ms->u_interval[0] = 0x3C;
-	humidity_db->humidity_ms->u_interval[1] = 0x1F;
-	humidity_db->humidity_ms->u_interval[2] = 0;
-	humidity_db->indication = 0x0000;
-	humidity_db->humidity_tr->condition = 0x01;
-	humidity_db->humidity_tr->data[0] = 0x3C;
-	humidity_db->humidity_tr->data[1] = 0x00;
-	humidity_db->humidity_tr->data[2] = 0x00;
-
-	if( humidity_db->humidity_tr->condition==0x01 || humidity_db->humidity_tr->condition==0x02)
-		humidity_db->humidity_tr->time_enable=true;
-	else if( humidity_db->humidity_tr->condition>=0x03 && humidity_db->humidity_tr->condition<= 0x09)
-		humidity_db->humidity_tr->value_enable=true;
-	else	
-		humidity_db->humidity_tr->trigger_inactive=true;
-
-	humidity_db->g_update_timer=(humidity_db->humidity_tr->data[0])|(humidity_db->humidity_tr->data[1]<<8)| (humidity_db->humidity_tr->data[2]<<16);
-
-}
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Irradiance characteristic and its descriptors like                                    ***
-***  User Descriptor = "Irradiance"                                                            ***
+	/* stamps that never came, forget the oldest */
+	if (conn->tx_len == ESS_TX_PENDING) {
+		conn->tx_head = (conn->tx_head + 1) % ESS_TX_PENDING;
+		conn->tx_len--;
 
-*/
-
-static void es_irradiance_init(void)
-{
+		if (conn->tx_sent)
+			conn->tx_sent--;
+	}
 
-	irradiance_db = new0(struct ess_irradiance, 1);
-	irradiance_db->irradiance_ms = new0(struct ess_measurement, 1);
-	irradiance_db->irradiance_tr = new0(struct trigger_setting, 1);
-	irradiance_db->user_desc = new0(wchar_t, 21);
-	
-	irradiance_db->irradiance_data = rand();
-	memcpy(irradiance_db->user_desc, "Irradiance", 10);
-	irradiance_db->lower_irradiance = 10;
-	irradiance_db->upper_irradiance = 45;
-	irradiance_db->irradiance_ms->flags = 0;
-	irradiance_db->irradiance_ms->sample = 0x02;
-	irradiance_db->irradiance_ms->applicatn = 0x15;
-	irradiance_db->irradiance_ms->m_uncertainity = 0x15;
-	irradiance_db->irradiance_ms->m_period[0] = 0x3C;
-	irradiance_db->irradiance_ms->m_period[1] = 0x10;
-	irradiance_db->irradiance_ms->m_period[2] = 0;
-	irradiance_db->irradiance_ms->u_interval[0] = 0x3C;
-	irradiance_db->irradiance_ms->u_interval[1] = 0x1F;
-	irradiance_db->irradiance_ms->u_interval[2] = 0;
-	irradiance_db->indication = 0x0000;
-	irradiance_db->irradiance_tr->condition = 0x01;
-	irradiance_db->irradiance_tr->data[0] = 0x3C;
-	irradiance_db->irradiance_tr->data[1] = 0x00;
-	irradiance_db->irradiance_tr->data[2] = 0x00;
-
-	if( irradiance_db->irradiance_tr->condition==0x01 || irradiance_db->irradiance_tr->condition==0x02)
-		irradiance_db->irradiance_tr->time_enable=true;
-	else if( irradiance_db->irradiance_tr->condition>=0x03 && irradiance_db->irradiance_tr->condition<= 0x09)
-		irradiance_db->irradiance_tr->value_enable=true;
-	else	
-		irradiance_db->irradiance_tr->trigger_inactive=true;
-
-	irradiance_db->g_update_timer=(irradiance_db->irradiance_tr->data[0])|(irradiance_db->irradiance_tr->data[1]<<8)| (irradiance_db->irradiance_tr->data[2]<<16);
+	tx = &conn->tx[(conn->tx_head + conn->tx_len) % ESS_TX_PENDING];
+	tx->handle = handle;
+	tx->len = len;
+	tx->sampled = sampled;
 
+	conn->tx_len++;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Pollen Concentration characteristic and its descriptors like                          ***
-***  User Descriptor = "Pollen Concentration"                                                  ***
-
-*/
-
-static void es_pollen_concentration_init(void)
+static bool tx_match(const struct ess_tx *tx, const uint8_t *data, size_t len)
 {
+	/* lower layers prepend their headers, the ATT PDU is at the end */
+	if (len < tx->len)
+		return false;
 
-	pollen_concentration_db = new0(struct ess_pollen_concentration, 1);
-	pollen_concentration_db->pollen_concentration_ms = new0(struct ess_measurement, 1);
-	pollen_concentration_db->pollen_concentration_tr = new0(struct trigger_setting, 1);
-	pollen_concentration_db->user_desc = new0(wchar_t, 21);
-	
-	pollen_concentration_db->pollen_concentration_data = rand();
-	memcpy(pollen_concentration_db->user_desc, "Pollen Concentration", 20);
-	pollen_concentration_db->lower_pollen_concentration[0] = 0x15;
-	pollen_concentration_db->lower_pollen_concentration[1] = 0x25;
-	pollen_concentration_db->lower_pollen_concentration[2] = 0x00;
-	pollen_concentration_db->upper_pollen_concentration[0] = 0x55;
-	pollen_concentration_db->upper_pollen_concentration[1] = 0x25;
-	pollen_concentration_db->upper_pollen_concentration[2] = 0x00;
-	pollen_concentration_db->pollen_concentration_ms->flags = 0;
-	pollen_concentration_db->pollen_concentration_ms->sample = 0x07;
-	pollen_concentration_db->pollen_concentration_ms->applicatn = 0x15;
-	pollen_concentration_db->pollen_concentration_ms->m_uncertainity = 0x15;
-	pollen_concentration_db->pollen_concentration_ms->m_period[0] = 0x3C;
-	pollen_concentration_db->pollen_concentration_ms->m_period[1] = 0x01;
-	pollen_concentration_db->pollen_concentration_ms->m_period[2] = 0;
-	pollen_concentration_db->pollen_concentration_ms->u_interval[0] = 0x3C;
-	pollen_concentration_db->pollen_concentration_ms->u_interval[1] = 0x1F;
-	pollen_concentration_db->pollen_concentration_ms->u_interval[2] = 0;
-	pollen_concentration_db->indication = 0x0000;
-	pollen_concentration_db->pollen_concentration_tr->condition = 0x01;
-	pollen_concentration_db->pollen_concentration_tr->data[0] = 0x3C;
-	pollen_concentration_db->pollen_concentration_tr->data[1] = 0x00;
-	pollen_concentration_db->pollen_concentration_tr->data[2] = 0x00;
-
-	pollen_concentration_db->tr_value = 0;
-
-	if( pollen_concentration_db->pollen_concentration_tr->condition==0x01 || pollen_concentration_db->pollen_concentration_tr->condition==0x02)
-		pollen_concentration_db->pollen_concentration_tr->time_enable=true;
-	else if( pollen_concentration_db->pollen_concentration_tr->condition>=0x03 && pollen_concentration_db->pollen_concentration_tr->condition<= 0x09)
-		pollen_concentration_db->pollen_concentration_tr->value_enable=true;
-	else	
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=true;
-
-	pollen_concentration_db->g_update_timer=(pollen_concentration_db->pollen_concentration_tr->data[0])|(pollen_concentration_db->pollen_concentration_tr->data[1]<<8)| (pollen_concentration_db->pollen_concentration_tr->data[2]<<16);
+	data += len - tx->len;
 
+	return data[0] == BT_ATT_OP_HANDLE_VAL_NOT &&
+					get_le16(data + 1) == tx->handle;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Rainfall characteristic and its descriptors like                                      ***
-***  User Descriptor = "Rainfall"                                                              ***
-
-*/
-
-static void es_rainfall_init(void)
+static void tx_stamp(struct gatt_conn *conn, const uint8_t *data, size_t len,
+						uint32_t type, uint64_t when)
 {
+	bool complete = type == ESS_TSTAMP_COMPLETION;
+	unsigned int i = complete || !conn->tx_complete ? 0 : conn->tx_sent;
+	struct ess_tx *tx = NULL;
+	const struct ess_attr *attr;
+	struct ess_char *chr;
 
-	rainfall_db = new0(struct ess_rainfall, 1);
-	rainfall_db->rainfall_ms = new0(struct ess_measurement, 1);
-	rainfall_db->rainfall_tr = new0(struct trigger_setting, 1);
-	rainfall_db->user_desc = new0(wchar_t, 21);
-	
-	rainfall_db->rainfall_data = rand();
-	memcpy(rainfall_db->user_desc, "Rain Fall", 9);
-	rainfall_db->lower_rainfall = 10;
-	rainfall_db->upper_rainfall = 45;
-	rainfall_db->rainfall_ms->flags = 0;
-	rainfall_db->rainfall_ms->sample = 0x02;
-	rainfall_db->rainfall_ms->applicatn = 0x15;
-	rainfall_db->rainfall_ms->m_uncertainity = 0x15;
-	rainfall_db->rainfall_ms->m_period[0] = 0x3C;
-	rainfall_db->rainfall_ms->m_period[1] = 0x10;
-	rainfall_db->rainfall_ms->m_period[2] = 0;
-	rainfall_db->rainfall_ms->u_interval[0] = 0x3C;
-	rainfall_db->rainfall_ms->u_interval[1] = 0x1F;
-	rainfall_db->rainfall_ms->u_interval[2] = 0;
-	rainfall_db->indication = 0x0000;
-	rainfall_db->rainfall_tr->condition = 0x01;
-	rainfall_db->rainfall_tr->data[0] = 0x3C;
-	rainfall_db->rainfall_tr->data[1] = 0x00;
-	rainfall_db->rainfall_tr->data[2] = 0x00;
-
-	if( rainfall_db->rainfall_tr->condition==0x01 || rainfall_db->rainfall_tr->condition==0x02)
-		rainfall_db->rainfall_tr->time_enable=true;
-	else if( rainfall_db->rainfall_tr->condition>=0x03 && rainfall_db->rainfall_tr->condition<= 0x09)
-		rainfall_db->rainfall_tr->value_enable=true;
-	else	
-		rainfall_db->rainfall_tr->trigger_inactive=true;
-
-	rainfall_db->g_update_timer=(rainfall_db->rainfall_tr->data[0])|(rainfall_db->rainfall_tr->data[1]<<8)| (rainfall_db->rainfall_tr->data[2]<<16);
-
-}
+	if (type != SCM_TSTAMP_SND && !complete)
+		return;
 
-/*
+	for (; i < conn->tx_len; i++) {
+		tx = &conn->tx[(conn->tx_head + i) % ESS_TX_PENDING];
 
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Pressure characteristic and its descriptors like                                      ***
-***  User Descriptor = "Pressure"                                                              ***
+		if (tx_match(tx, data, len))
+			break;
+	}
 
-*/
+	if (i == conn->tx_len)
+		return;
 
-static void es_pressure_init(void)
-{
+	attr = gatt_server_attr(tx->handle);
+	chr = attr ? attr->chr : NULL;
+	if (chr && when > tx->sampled)
+		ess_char_observe(chr, complete ? ESS_STAGE_COMPLETE :
+						ESS_STAGE_SEND,
+						when - tx->sampled);
 
-	pressure_db = new0(struct ess_pressure, 1);
-	pressure_db->pressure_ms = new0(struct ess_measurement, 1);
-	pressure_db->pressure_tr = new0(struct trigger_setting, 1);
-	pressure_db->user_desc = new0(wchar_t, 21);
-	
-	pressure_db->pressure_data = rand();
-	memcpy(pressure_db->user_desc, "Pressure", 8);
-	pressure_db->lower_pressure = 10;
-	pressure_db->upper_pressure = 45;
-	pressure_db->pressure_ms->flags = 0;
-	pressure_db->pressure_ms->sample = 0x02;
-	pressure_db->pressure_ms->applicatn = 0x15;
-	pressure_db->pressure_ms->m_uncertainity = 0x15;
-	pressure_db->pressure_ms->m_period[0] = 0x3C;
-	pressure_db->pressure_ms->m_period[1] = 0x10;
-	pressure_db->pressure_ms->m_period[2] = 0;
-	pressure_db->pressure_ms->u_interval[0] = 0x3C;
-	pressure_db->pressure_ms->u_interval[1] = 0x1F;
-	pressure_db->pressure_ms->u_interval[2] = 0;
-	pressure_db->indication = 0x0000;
-	pressure_db->pressure_tr->condition = 0x01;
-	pressure_db->pressure_tr->data[0] = 0x3C;
-	pressure_db->pressure_tr->data[1] = 0x00;
-	pressure_db->pressure_tr->data[2] = 0x00;
-
-	if( pressure_db->pressure_tr->condition==0x01 || pressure_db->pressure_tr->condition==0x02)
-		pressure_db->pressure_tr->time_enable=true;
-	else if( pressure_db->pressure_tr->condition>=0x03 && pressure_db->pressure_tr->condition<= 0x09)
-		pressure_db->pressure_tr->value_enable=true;
-	else	
-		pressure_db->pressure_tr->trigger_inactive=true;
-
-	pressure_db->g_update_timer=(pressure_db->pressure_tr->data[0])|(pressure_db->pressure_tr->data[1]<<8)| (pressure_db->pressure_tr->data[2]<<16);
+	if (!complete && conn->tx_complete) {
+		conn->tx_sent = i + 1;
+		return;
+	}
 
+	/* the entries before this one will not be stamped any more */
+	conn->tx_head = (conn->tx_head + i + 1) % ESS_TX_PENDING;
+	conn->tx_len -= i + 1;
+	conn->tx_sent = conn->tx_sent > i + 1 ? conn->tx_sent - i - 1 : 0;
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for True Wind Direction characteristic and its descriptors like                           ***
-***  User Descriptor = "True Wind Direction"                                                   ***
-
-*/
-
-static void es_true_direction_init(void)
+static void tstamp_callback(int fd, uint32_t events, void *user_data)
 {
+	struct gatt_conn *conn = user_data;
+	struct timespec real, mono;
+	int64_t offset;
 
-	true_direction_db = new0(struct ess_true_direction, 1);
-	true_direction_db->true_direction_ms = new0(struct ess_measurement, 1);
-	true_direction_db->true_direction_tr = new0(struct trigger_setting, 1);
-	true_direction_db->user_desc = new0(wchar_t, 21);
-	
-	true_direction_db->true_direction_data = rand();
-	memcpy(true_direction_db->user_desc, "True Wind Direction", 19);
-	true_direction_db->lower_true_direction = 10;
-	true_direction_db->upper_true_direction = 45;
-	true_direction_db->true_direction_ms->flags = 0;
-	true_direction_db->true_direction_ms->sample = 0x02;
-	true_direction_db->true_direction_ms->applicatn = 0x15;
-	true_direction_db->true_direction_ms->m_uncertainity = 0x15;
-	true_direction_db->true_direction_ms->m_period[0] = 0x3C;
-	true_direction_db->true_direction_ms->m_period[1] = 0x10;
-	true_direction_db->true_direction_ms->m_period[2] = 0;
-	true_direction_db->true_direction_ms->u_interval[0] = 0x3C;
-	true_direction_db->true_direction_ms->u_interval[1] = 0x1F;
-	true_direction_db->true_direction_ms->u_interval[2] = 0;
-	true_direction_db->indication = 0x0000;
-	true_direction_db->true_direction_tr->condition = 0x01;
-	true_direction_db->true_direction_tr->data[0] = 0x3C;
-	true_direction_db->true_direction_tr->data[1] = 0x00;
-	true_direction_db->true_direction_tr->data[2] = 0x00;
-
-	if( true_direction_db->true_direction_tr->condition==0x01 || true_direction_db->true_direction_tr->condition==0x02)
-		true_direction_db->true_direction_tr->time_enable=true;
-	else if( true_direction_db->true_direction_tr->condition>=0x03 && true_direction_db->true_direction_tr->condition<= 0x09)
-		true_direction_db->true_direction_tr->value_enable=true;
-	else	
-		true_direction_db->true_direction_tr->trigger_inactive=true;
-
-	true_direction_db->g_update_timer=(true_direction_db->true_direction_tr->data[0])|(true_direction_db->true_direction_tr->data[1]<<8)| (true_direction_db->true_direction_tr->data[2]<<16);
-
-}
-
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for True Wind Speed characteristic and its descriptors like                               ***
-***  User Descriptor = "True Wind Speed"                                                       ***
-
-*/
-
-static void es_true_speed_init(void)
-{
+	/* software stamps are CLOCK_REALTIME, samples CLOCK_MONOTONIC */
+	clock_gettime(CLOCK_REALTIME, &real);
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	offset = (real.tv_sec - mono.tv_sec) * 1000000000ll +
+						real.tv_nsec - mono.tv_nsec;
 
-	true_speed_db = new0(struct ess_true_speed, 1);
-	true_speed_db->true_speed_ms = new0(struct ess_measurement, 1);
-	true_speed_db->true_speed_tr = new0(struct trigger_setting, 1);
-	true_speed_db->user_desc = new0(wchar_t, 21);
-	
-	true_speed_db->true_speed_data = rand();
-	memcpy(true_speed_db->user_desc, "True Wind Speed", 15);
-	true_speed_db->lower_true_speed = 10;
-	true_speed_db->upper_true_speed = 45;
-	true_speed_db->true_speed_ms->flags = 0;
-	true_speed_db->true_speed_ms->sample = 0x02;
-	true_speed_db->true_speed_ms->applicatn = 0x15;
-	true_speed_db->true_speed_ms->m_uncertainity = 0x15;
-	true_speed_db->true_speed_ms->m_period[0] = 0x3C;
-	true_speed_db->true_speed_ms->m_period[1] = 0x10;
-	true_speed_db->true_speed_ms->m_period[2] = 0;
-	true_speed_db->true_speed_ms->u_interval[0] = 0x3C;
-	true_speed_db->true_speed_ms->u_interval[1] = 0x1F;
-	true_speed_db->true_speed_ms->u_interval[2] = 0;
-	true_speed_db->indication = 0x0000;
-	true_speed_db->true_speed_tr->condition = 0x01;
-	true_speed_db->true_speed_tr->data[0] = 0x3C;
-	true_speed_db->true_speed_tr->data[1] = 0x00;
-	true_speed_db->true_speed_tr->data[2] = 0x00;
-
-	if( true_speed_db->true_speed_tr->condition==0x01 || true_speed_db->true_speed_tr->condition==0x02)
-		true_speed_db->true_speed_tr->time_enable=true;
-	else if( true_speed_db->true_speed_tr->condition>=0x03 && true_speed_db->true_speed_tr->condition<= 0x09)
-		true_speed_db->true_speed_tr->value_enable=true;
-	else	
-		true_speed_db->true_speed_tr->trigger_inactive=true;
-
-	true_speed_db->g_update_timer=(true_speed_db->true_speed_tr->data[0])|(true_speed_db->true_speed_tr->data[1]<<8)| (true_speed_db->true_speed_tr->data[2]<<16);
+	while (1) {
+		union {
+			char buf[256];
+			struct cmsghdr align;
+		} control;
+		struct scm_timestamping *ts = NULL;
+		struct sock_extended_err *serr = NULL;
+		struct cmsghdr *cmsg;
+		struct msghdr msg;
+		struct iovec iov;
+		uint8_t data[64];
+		ssize_t len;
 
-}
+		iov.iov_base = data;
+		iov.iov_len = sizeof(data);
 
-/*
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control.buf;
+		msg.msg_controllen = sizeof(control.buf);
 
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for UV Index characteristic and its descriptors like                                      ***
-***  User Descriptor = "UV INdex"                                                              ***
+		len = recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+		if (len < 0)
+			break;
 
-*/
+		/* too long for a notification of ours */
+		if (msg.msg_flags & MSG_TRUNC)
+			continue;
 
-static void es_uv_index_init(void)
-{
+		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+					cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if (cmsg->cmsg_level == SOL_SOCKET &&
+				cmsg->cmsg_type == SO_TIMESTAMPING)
+				ts = (void *) CMSG_DATA(cmsg);
+			else if (cmsg->cmsg_len >= CMSG_LEN(sizeof(*serr)))
+				serr = (void *) CMSG_DATA(cmsg);
+		}
 
-	uv_index_db = new0(struct ess_uv_index, 1);
-	uv_index_db->uv_index_ms = new0(struct ess_measurement, 1);
-	uv_index_db->uv_index_tr = new0(struct trigger_setting, 1);
-	uv_index_db->user_desc = new0(wchar_t, 21);
-	
-	uv_index_db->uv_index_data = rand();
-	memcpy(uv_index_db->user_desc, "UV Index", 8);
-	uv_index_db->lower_uv_index = 10;
-	uv_index_db->upper_uv_index = 45;
-	uv_index_db->uv_index_ms->flags = 0;
-	uv_index_db->uv_index_ms->sample = 0x02;
-	uv_index_db->uv_index_ms->applicatn = 0x15;
-	uv_index_db->uv_index_ms->m_uncertainity = 0x15;
-	uv_index_db->uv_index_ms->m_period[0] = 0x3C;
-	uv_index_db->uv_index_ms->m_period[1] = 0x10;
-	uv_index_db->uv_index_ms->m_period[2] = 0;
-	uv_index_db->uv_index_ms->u_interval[0] = 0x3C;
-	uv_index_db->uv_index_ms->u_interval[1] = 0x1F;
-	uv_index_db->uv_index_ms->u_interval[2] = 0;
-	uv_index_db->indication = 0x0000;
-	uv_index_db->uv_index_tr->condition = 0x01;
-	uv_index_db->uv_index_tr->data[0] = 0x3C;
-	uv_index_db->uv_index_tr->data[1] = 0x00;
-	uv_index_db->uv_index_tr->data[2] = 0x00;
-
-	if( uv_index_db->uv_index_tr->condition==0x01 || uv_index_db->uv_index_tr->condition==0x02)
-		uv_index_db->uv_index_tr->time_enable=true;
-	else if( uv_index_db->uv_index_tr->condition>=0x03 && uv_index_db->uv_index_tr->condition<= 0x09)
-		uv_index_db->uv_index_tr->value_enable=true;
-	else	
-		uv_index_db->uv_index_tr->trigger_inactive=true;
-
-	uv_index_db->g_update_timer=(uv_index_db->uv_index_tr->data[0])|(uv_index_db->uv_index_tr->data[1]<<8)| (uv_index_db->uv_index_tr->data[2]<<16);
+		if (!ts || !serr || serr->ee_errno != ENOMSG ||
+			serr->ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+			continue;
 
+		tx_stamp(conn, data, len, serr->ee_info,
+				ts->ts[0].tv_sec * 1000000000ll +
+				ts->ts[0].tv_nsec - offset);
+	}
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Wind Chill characteristic and its descriptors like                                    ***
-***  User Descriptor = "Wind Chill"                                                            ***
-
-*/
-
-static void es_wind_chill_init(void)
+static void gatt_conn_tstamp_start(struct gatt_conn *conn, int fd)
 {
+	int flags = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	int val = flags | ESS_TSTAMP_TX_COMPLETION;
 
-	wind_chill_db = new0(struct ess_wind_chill, 1);
-	wind_chill_db->wind_chill_ms = new0(struct ess_measurement, 1);
-	wind_chill_db->wind_chill_tr = new0(struct trigger_setting, 1);
-	wind_chill_db->user_desc = new0(wchar_t, 21);
-	
-	wind_chill_db->wind_chill_data = rand();
-	memcpy(wind_chill_db->user_desc, "Wind Chill", 9);
-	wind_chill_db->lower_wind_chill = 10;
-	wind_chill_db->upper_wind_chill = 45;
-	wind_chill_db->wind_chill_ms->flags = 0;
-	wind_chill_db->wind_chill_ms->sample = 0x02;
-	wind_chill_db->wind_chill_ms->applicatn = 0x15;
-	wind_chill_db->wind_chill_ms->m_uncertainity = 0x15;
-	wind_chill_db->wind_chill_ms->m_period[0] = 0x3C;
-	wind_chill_db->wind_chill_ms->m_period[1] = 0x10;
-	wind_chill_db->wind_chill_ms->m_period[2] = 0;
-	wind_chill_db->wind_chill_ms->u_interval[0] = 0x3C;
-	wind_chill_db->wind_chill_ms->u_interval[1] = 0x1F;
-	wind_chill_db->wind_chill_ms->u_interval[2] = 0;
-	wind_chill_db->indication = 0x0000;
-	wind_chill_db->wind_chill_tr->condition = 0x01;
-	wind_chill_db->wind_chill_tr->data[0] = 0x3C;
-	wind_chill_db->wind_chill_tr->data[1] = 0x00;
-	wind_chill_db->wind_chill_tr->data[2] = 0x00;
-
-	if( wind_chill_db->wind_chill_tr->condition==0x01 || wind_chill_db->wind_chill_tr->condition==0x02)
-		wind_chill_db->wind_chill_tr->time_enable=true;
-	else if( wind_chill_db->wind_chill_tr->condition>=0x03 && wind_chill_db->wind_chill_tr->condition<= 0x09)
-		wind_chill_db->wind_chill_tr->value_enable=true;
-	else	
-		wind_chill_db->wind_chill_tr->trigger_inactive=true;
-
-	wind_chill_db->g_update_timer=(wind_chill_db->wind_chill_tr->data[0])|(wind_chill_db->wind_chill_tr->data[1]<<8)| (wind_chill_db->wind_chill_tr->data[2]<<16);
+	conn->tx_complete = true;
 
-}
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &val,
+							sizeof(val)) < 0) {
+		conn->tx_complete = false;
 
-/*
+		if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+							sizeof(flags)) < 0) {
+			ess_warn("No transmit timestamps: %m\n");
+			return;
+		}
+	}
 
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Barometric Pressure Trend characteristic and its descriptors lik                      ***
-***  User Descriptor = "Barometric Pressure"                                                   ***
+	/* a watch of our own, the ATT layer owns the registration of fd */
+	conn->tstamp_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (conn->tstamp_fd < 0)
+		return;
 
-*/
+	if (mainloop_add_fd(conn->tstamp_fd, EPOLLERR, tstamp_callback,
+							conn, NULL) < 0) {
+		close(conn->tstamp_fd);
+		conn->tstamp_fd = -1;
+	}
+}
 
-static void es_barometric_pressure_init(void)
+static void gatt_conn_tstamp_stop(struct gatt_conn *conn)
 {
+	if (conn->tstamp_fd < 0)
+		return;
 
-	barometric_pressure_db = new0(struct ess_barometric_pressure, 1);
-	barometric_pressure_db->barometric_pressure_ms = new0(struct ess_measurement, 1);
-	barometric_pressure_db->user_desc = new0(wchar_t, 21);
-	
-	barometric_pressure_db->barometric_pressure_data = rand();
-	memcpy(barometric_pressure_db->user_desc, "Barometric pressure", 19);
-	barometric_pressure_db->lower_barometric_pressure = 10;
-	barometric_pressure_db->upper_barometric_pressure = 45;
-	barometric_pressure_db->barometric_pressure_ms->flags = 0;
-	barometric_pressure_db->barometric_pressure_ms->sample = 0x02;
-	barometric_pressure_db->barometric_pressure_ms->applicatn = 0x15;
-	barometric_pressure_db->barometric_pressure_ms->m_uncertainity = 0x15;
-	barometric_pressure_db->barometric_pressure_ms->m_period[0] = 0x3C;
-	barometric_pressure_db->barometric_pressure_ms->m_period[1] = 0x10;
-	barometric_pressure_db->barometric_pressure_ms->m_period[2] = 0;
-	barometric_pressure_db->barometric_pressure_ms->u_interval[0] = 0x3C;
-	barometric_pressure_db->barometric_pressure_ms->u_interval[1] = 0x1F;
-	barometric_pressure_db->barometric_pressure_ms->u_interval[2] = 0;
-
+	mainloop_remove_fd(conn->tstamp_fd);
+	close(conn->tstamp_fd);
+	conn->tstamp_fd = -1;
 }
 
-/*
+ESS_ARENA(conn_arena, struct gatt_conn, ESS_STATIC_CONNS, ESS_MEM_CONNS);
+
+#if defined(ESS_STATIC) && ESS_STATIC_CONNS > ESS_MAX_CONNS
+#error "ESS_STATIC_CONNS must not exceed ESS_MAX_CONNS"
+#endif
 
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Magnetic Declination characteristic and its descriptors like                          ***
-***  User Descriptor = "Magnetic Declination"                                                  ***
+/* Slots taken by connections, see ESS_MAX_CONNS */
+static uint64_t conn_slots = 0;
 
-*/
+/* Hand the subscriptions of a slot to another one */
 
-static void es_magnetic_declination_init(void)
+static void conn_ccc_move(unsigned int from, unsigned int to)
 {
+	unsigned int id;
 
-	magnetic_declination_db = new0(struct ess_magnetic_declination, 1);
-	magnetic_declination_db->magnetic_declination_ms = new0(struct ess_measurement, 1);
-	magnetic_declination_db->magnetic_declination_tr = new0(struct trigger_setting, 1);
-	magnetic_declination_db->user_desc = new0(wchar_t, 21);
-	
-	magnetic_declination_db->magnetic_declination_data = rand();
-	memcpy(magnetic_declination_db->user_desc, "Magnetic Declination", 20);
-	magnetic_declination_db->lower_magnetic_declination = 10;
-	magnetic_declination_db->upper_magnetic_declination = 45;
-	magnetic_declination_db->magnetic_declination_ms->flags = 0;
-	magnetic_declination_db->magnetic_declination_ms->sample = 0x02;
-	magnetic_declination_db->magnetic_declination_ms->applicatn = 0x15;
-	magnetic_declination_db->magnetic_declination_ms->m_uncertainity = 0x15;
-	magnetic_declination_db->magnetic_declination_ms->m_period[0] = 0x3C;
-	magnetic_declination_db->magnetic_declination_ms->m_period[1] = 0x10;
-	magnetic_declination_db->magnetic_declination_ms->m_period[2] = 0;
-	magnetic_declination_db->magnetic_declination_ms->u_interval[0] = 0x3C;
-	magnetic_declination_db->magnetic_declination_ms->u_interval[1] = 0x1F;
-	magnetic_declination_db->magnetic_declination_ms->u_interval[2] = 0;
-	magnetic_declination_db->indication = 0x0000;
-	magnetic_declination_db->magnetic_declination_tr->condition = 0x01;
-	magnetic_declination_db->magnetic_declination_tr->data[0] = 0x3C;
-	magnetic_declination_db->magnetic_declination_tr->data[1] = 0x00;
-	magnetic_declination_db->magnetic_declination_tr->data[2] = 0x00;
-
-	if( magnetic_declination_db->magnetic_declination_tr->condition==0x01 || magnetic_declination_db->magnetic_declination_tr->condition==0x02)
-		magnetic_declination_db->magnetic_declination_tr->time_enable=true;
-	else if( magnetic_declination_db->magnetic_declination_tr->condition>=0x03 && magnetic_declination_db->magnetic_declination_tr->condition<= 0x09)
-		magnetic_declination_db->magnetic_declination_tr->value_enable=true;
-	else	
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=true;
-
-	magnetic_declination_db->g_update_timer=(magnetic_declination_db->magnetic_declination_tr->data[0])|(magnetic_declination_db->magnetic_declination_tr->data[1]<<8)| (magnetic_declination_db->magnetic_declination_tr->data[2]<<16);
+	for (id = 0; id < ess_state.len; id++) {
+		if (!(ess_state.ccc[id] & (1ull << from)))
+			continue;
 
+		ess_state.ccc[id] &= ~(1ull << from);
+		ess_state.ccc[id] |= 1ull << to;
+	}
 }
 
-/*
-
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Magnetic Flux 2D characteristic and its descriptors like                              ***
-***  User Descriptor = "Magnetic Flux 2D"                                                      ***
-
-*/
+/* Drop the subscriptions of a slot and give it back */
 
-static void es_magnetic_flux_2D_init(void)
+static void conn_slot_release(unsigned int slot)
 {
+	unsigned int id;
 
-	magnetic_flux_2D_db = new0(struct ess_magnetic_flux_2D, 1);
-	magnetic_flux_2D_db->magnetic_flux_2D_ms = new0(struct ess_measurement, 1);
-	magnetic_flux_2D_db->magnetic_flux_2D_tr = new0(struct trigger_setting, 1);
-	magnetic_flux_2D_db->user_desc = new0(wchar_t, 21);
-	
-	magnetic_flux_2D_db->magnetic_flux_2D_xdata = rand();
-	magnetic_flux_2D_db->magnetic_flux_2D_ydata = rand();
-	memcpy(magnetic_flux_2D_db->user_desc, "Magnetic Flux 2D", 16);
-	magnetic_flux_2D_db->xlower_magnetic_flux_2D = rand();
-	magnetic_flux_2D_db->xupper_magnetic_flux_2D = rand();
-	magnetic_flux_2D_db->ylower_magnetic_flux_2D = rand();
-	magnetic_flux_2D_db->yupper_magnetic_flux_2D = rand();
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->flags = 0;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->sample = 0x02;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->applicatn = 0x15;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->m_uncertainity = 0x15;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[0] = 0x3C;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[1] = 0x10;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[2] = 0;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[0] = 0x3C;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[1] = 0x1F;
-	magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[2] = 0;
-	magnetic_flux_2D_db->indication = 0x0000;
-	magnetic_flux_2D_db->magnetic_flux_2D_tr->condition = 0x01;
-	magnetic_flux_2D_db->magnetic_flux_2D_tr->data[0] = 0x3C;
-	magnetic_flux_2D_db->magnetic_flux_2D_tr->data[1] = 0x00;
-	magnetic_flux_2D_db->magnetic_flux_2D_tr->data[2] = 0x00;
-
-	if( magnetic_flux_2D_db->magnetic_flux_2D_tr->condition==0x01 || magnetic_flux_2D_db->magnetic_flux_2D_tr->condition==0x02)
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable=true;
-	else if( magnetic_flux_2D_db->magnetic_flux_2D_tr->condition>=0x03 && magnetic_flux_2D_db->magnetic_flux_2D_tr->condition<= 0x09)
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->value_enable=true;
-	else	
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=true;
-
-	magnetic_flux_2D_db->g_update_timer=(magnetic_flux_2D_db->magnetic_flux_2D_tr->data[0])|(magnetic_flux_2D_db->magnetic_flux_2D_tr->data[1]<<8)| (magnetic_flux_2D_db->magnetic_flux_2D_tr->data[2]<<16);
-
-}
+	for (id = 0; id < ess_state.len; id++) {
+		if (!(ess_state.ccc[id] & (1ull << slot)))
+			continue;
 
-/*
+		ess_state.ccc[id] &= ~(1ull << slot);
+		if (!ess_state.ccc[id])
+			ess_state.flags[id] &= ~ESS_STATE_ENABLE;
+	}
 
-***  This function will allocate the memory and initialize all the initials values requiered   ***
-***  for Magentic Flux 3D characteristic and its descriptors like                              ***
-***  User Descriptor = "Magnetic Flux 3D"                                                      ***
+	conn_slots &= ~(1ull << slot);
+}
 
-*/
+/* Free a connection, its slot stays taken along with the subscriptions */
 
-static void es_magnetic_flux_3D_init(void)
+static void gatt_conn_close(void *data)
 {
+	struct gatt_conn *conn = data;
 
-	magnetic_flux_3D_db = new0(struct ess_magnetic_flux_3D, 1);
-	magnetic_flux_3D_db->magnetic_flux_3D_ms = new0(struct ess_measurement, 1);
-	magnetic_flux_3D_db->magnetic_flux_3D_tr = new0(struct trigger_setting, 1);
-	magnetic_flux_3D_db->user_desc = new0(wchar_t, 21);
-	
-	magnetic_flux_3D_db->magnetic_flux_3D_xdata = rand();
-	magnetic_flux_3D_db->magnetic_flux_3D_ydata = rand();
-	magnetic_flux_3D_db->magnetic_flux_3D_zdata = rand();
-	memcpy(magnetic_flux_3D_db->user_desc, "Magnetic Flux 3D", 16);
-	magnetic_flux_3D_db->xlower_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->xupper_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->ylower_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->yupper_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->zlower_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->zupper_magnetic_flux_3D = rand();
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->flags = 0;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->sample = 0x02;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->applicatn = 0x15;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->m_uncertainity = 0x15;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[0] = 0x3C;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[1] = 0x10;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[2] = 0;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[0] = 0x3C;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[1] = 0x1F;
-	magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[2] = 0;
-	magnetic_flux_3D_db->indication = 0x0000;
-	magnetic_flux_3D_db->magnetic_flux_3D_tr->condition = 0x01;
-	magnetic_flux_3D_db->magnetic_flux_3D_tr->data[0] = 0x3C;
-	magnetic_flux_3D_db->magnetic_flux_3D_tr->data[1] = 0x00;
-	magnetic_flux_3D_db->magnetic_flux_3D_tr->data[2] = 0x00;
-
-	if( magnetic_flux_3D_db->magnetic_flux_3D_tr->condition==0x01 || magnetic_flux_3D_db->magnetic_flux_3D_tr->condition==0x02)
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable=true;
-	else if( magnetic_flux_3D_db->magnetic_flux_3D_tr->condition>=0x03 && magnetic_flux_3D_db->magnetic_flux_3D_tr->condition<= 0x09)
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->value_enable=true;
-	else	
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=true;
-
-	magnetic_flux_3D_db->g_update_timer=(magnetic_flux_3D_db->magnetic_flux_3D_tr->data[0])|(magnetic_flux_3D_db->magnetic_flux_3D_tr->data[1]<<8)| (magnetic_flux_3D_db->magnetic_flux_3D_tr->data[2]<<16);
+	ess_trace(conn_teardown, 0, conn->att, metrics_now());
 
-}
+	gatt_conn_tstamp_stop(conn);
 
-void gatt_set_public_address(uint8_t addr[6])
-{
-	memcpy(public_addr, addr, sizeof(public_addr));
-}
+	bt_gatt_client_unref(conn->client);
+	bt_gatt_server_unref(conn->gatt);
+	bt_att_unref(conn->att);
 
-void gatt_set_device_name(uint8_t name[20], uint8_t len)
-{
-	memcpy(dev_name, name, sizeof(dev_name));
-	dev_name_len = len;
+	ess_mem_charge(ESS_MEM_SHARED, -conn->mem);
+	ess_arena_free(&conn_arena, conn);
 }
 
 static void gatt_conn_destroy(void *data)
 {
 	struct gatt_conn *conn = data;
 
-	bt_gatt_client_unref(conn->client);
-	bt_gatt_server_unref(conn->gatt);
-	bt_att_unref(conn->att);
-
-	free(conn);
+	conn_slot_release(conn->slot);
+	gatt_conn_close(conn);
 }
 
 static void gatt_conn_disconnect(int err, void *user_data)
 {
 	struct gatt_conn *conn = user_data;
 
-	printf("Device disconnected: %s\n", strerror(err));
+	ess_info("Device disconnected: %s\n", strerror(err));
 
 	queue_remove(conn_list, conn);
 	gatt_conn_destroy(conn);
@@ -1076,60 +405,88 @@ static void gatt_conn_disconnect(int err, void *user_data)
 static void client_ready_callback(bool success, uint8_t att_ecode,
 				  void *user_data)
 {
-	printf("GATT client discovery complete\n");
+	ess_info("GATT client discovery complete\n");
 }
 
 static void client_service_changed_callback(uint16_t start_handle,
 					    uint16_t end_handle,
 					    void *user_data)
 {
-	printf("GATT client service changed notification\n");
+	ess_info("GATT client service changed notification\n");
 }
 
-static struct gatt_conn *gatt_conn_new(int fd)
+static struct gatt_conn *gatt_conn_new(int fd, uint16_t mtu)
 {
 	struct gatt_conn *conn;
-	uint16_t mtu = 0;
+	struct ess_mem_probe probe;
 
-	conn = new0(struct gatt_conn, 1);
+	if (conn_slots == UINT64_MAX) {
+		ess_error("Too many connections\n");
+		return NULL;
+	}
+
+	conn = ess_arena_new(&conn_arena);
 	if (!conn)
 		return NULL;
 
+	conn->tstamp_fd = -1;
+	ess_sched_init(&conn->sched);
+
+	ess_mem_probe_start(&probe);
+
 	conn->att = bt_att_new(fd, false);
 	if (!conn->att) {
-		fprintf(stderr, "Failed to initialze ATT transport layer\n");
-		free(conn);
+		ess_error("Failed to initialze ATT transport layer\n");
+		ess_arena_free(&conn_arena, conn);
 		return NULL;
 	}
 
-	bt_att_set_close_on_unref(conn->att, true);
 	bt_att_register_disconnect(conn->att, gatt_conn_disconnect, conn, NULL);
 
 	bt_att_set_security(conn->att, BT_SECURITY_SDP);
 
+	/* a connection taken over from another process keeps its MTU */
+	if (mtu)
+		bt_att_set_mtu(conn->att, mtu);
+
 	conn->gatt = bt_gatt_server_new(gatt_db, conn->att, mtu);
 	if (!conn->gatt) {
-		fprintf(stderr, "Failed to create GATT server\n");
+		ess_error("Failed to create GATT server\n");
 		bt_att_unref(conn->att);
-		free(conn);
+		ess_arena_free(&conn_arena, conn);
 		return NULL;
 	}
 
-	conn->client = bt_gatt_client_new(gatt_cache, conn->att, mtu);
-	if (!conn->gatt) {
-		fprintf(stderr, "Failed to create GATT client\n");
+	conn->client = bt_gatt_client_new(gatt_cache, conn->att, 0);
+	if (!conn->client) {
+		ess_error("Failed to create GATT client\n");
 		bt_gatt_server_unref(conn->gatt);
 		bt_att_unref(conn->att);
-		free(conn);
+		ess_arena_free(&conn_arena, conn);
 		return NULL;
 	}
 
+	/* what the client discovers later is not counted */
+	conn->mem = ess_mem_probe_end(&probe);
+	ess_mem_charge(ESS_MEM_SHARED, conn->mem);
+
+	/* on failure the socket stays with the caller */
+	bt_att_set_close_on_unref(conn->att, true);
+
 	bt_gatt_client_set_ready_handler(conn->client,
 					 client_ready_callback, conn, NULL);
 	bt_gatt_client_set_service_changed(conn->client,
 					   client_service_changed_callback,
 					   conn, NULL);
 
+	if (tx_timestamps)
+		gatt_conn_tstamp_start(conn, fd);
+
+	conn->slot = __builtin_ctzll(~conn_slots);
+	conn_slots |= 1ull << conn->slot;
+
+	ess_trace(conn_accept, 0, conn->att, metrics_now());
+
 	return conn;
 }
 
@@ -1137,6 +494,7 @@ static void att_conn_callback(int fd, uint32_t events, void *user_data)
 {
 	struct sockaddr_l2 addr;
 	socklen_t addrlen;
+	uint64_t start, accepted;
 	int new_fd;
 
 	if (events & (EPOLLERR | EPOLLHUP)) {
@@ -1147,9255 +505,2620 @@ static void att_conn_callback(int fd, uint32_t events, void *user_data)
 	memset(&addr, 0, sizeof(addr));
 	addrlen = sizeof(addr);
 
-	new_fd = accept(att_fd, (struct sockaddr *)&addr, &addrlen);
+	start = metrics_now();
+
+	new_fd = accept4(att_fd, (struct sockaddr *)&addr, &addrlen,
+							SOCK_CLOEXEC);
 	if (new_fd < 0) {
-		fprintf(stderr, "Failed to accept new ATT connection: %m\n");
+		ess_error("Failed to accept new ATT connection: %m\n");
 		return;
 	}
 
-	conn = gatt_conn_new(new_fd);
-	if (!conn) {
-		fprintf(stderr, "Failed to create GATT connection\n");
+	accepted = metrics_now();
+	metrics_observe(&conn_accept, accepted - start);
+
+	if (!gatt_server_attach(new_fd)) {
+		ess_error("Failed to create GATT connection\n");
 		close(new_fd);
 		return;
 	}
 
-	if (!queue_push_tail(conn_list, conn)) {
-		fprintf(stderr, "Failed to add GATT connection\n");
-		gatt_conn_destroy(conn);
-		close(new_fd);
-	}
+	metrics_observe(&conn_setup, metrics_now() - accepted);
 
-	printf("New device connected\n");
+	ess_info("New device connected\n");
 }
 
+/*
+*** This section consist of the call backs shared by every characteristic ***
+*** instance, the instance itself is passed as the attribute user data    ***
+*/
 
-/*Apparent wind speed client characteristic configuration read call back */
+/* Read helper honouring the offset of read blob requests */
 
-static void apparent_speed_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
+static void ess_read_result(struct gatt_db_attribute *attrib, unsigned int id,
+				uint16_t offset, const uint8_t *value,
+				size_t len)
 {
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=apparent_speed_db->indication;
+	if (offset > len) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_INVALID_OFFSET, NULL, 0);
+		return;
 	}
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
+	gatt_db_attribute_read_result(attrib, id, 0, value + offset,
+								len - offset);
 }
 
-/* This function will be called on regular interval to send the notification */
+/*
+ * Read a new sample of the characteristic from its sensor source, returns
+ * the time it was taken
+ */
 
-static bool apparent_speed_time_calculation(void *user_data)
-{
+/*
+ * A file source stays open and is read from its start on every sample,
+ * opening it again each tick costs a path lookup the mainloop pays for
+ * every instance. A file replaced by rename, the usual way to update it
+ * atomically, has no links left and is opened again.
+ */
 
-	struct gatt_conn *server=user_data;
-	int16_t pdu;
+static int ess_source_read(struct ess_source *src, int32_t *raw, int axes)
+{
+	char buf[128];
+	struct stat st;
+	char *str, *end;
+	ssize_t len;
+	int n;
 
-	
+	if (src->fd >= 0 && (fstat(src->fd, &st) < 0 || !st.st_nlink)) {
+		close(src->fd);
+		src->fd = -1;
+	}
 
-		
-	pdu=rand();
+	if (src->fd < 0) {
+		src->fd = open(src->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (src->fd < 0)
+			return 0;
+	}
 
-	bt_gatt_server_send_notification(server->gatt,apparent_speed_db->apparent_speed_handle,
-						(uint8_t *)&pdu, 2);
+	len = pread(src->fd, buf, sizeof(buf) - 1, 0);
+	if (len < 0) {
+		close(src->fd);
+		src->fd = -1;
+		return 0;
+	}
 
-	return true;
-}
+	buf[len] = '\0';
 
-/* This function will be called on every second and based on the trigger condition value will be notified */
-static bool apparent_speed_value_calculation(void *user_data)
-{
+	for (n = 0, str = buf; n < axes; n++, str = end) {
+		long val;
 
-	struct gatt_conn *server=user_data;
-	int16_t pdu;
-	uint8_t notify=true;
+		errno = 0;
+		val = strtol(str, &end, 10);
+		if (errno || end == str || val < INT32_MIN || val > INT32_MAX)
+			break;
 
-	
+		raw[n] = val;
+	}
 
-		
-	pdu=rand();
+	return n;
+}
 
+static uint64_t ess_char_sample(struct ess_char *chr, int32_t *value)
+{
+	struct ess_source *src = &chr->source;
+	struct ess_rng *rng = &src->rng;
+	int32_t raw[ESS_MAX_AXES];
+	uint32_t daytime;
+	int i, n;
 
+	/* an all zero state is not valid, seed the stream on first use */
+	if (!(rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]))
+		ess_rng_init(rng, chr->type->uuid, chr->instance);
 
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(apparent_speed_db->apparent_speed_tr->condition){
+	switch (src->type) {
+	case ESS_SOURCE_RANDOM:
+		for (i = 0; i < chr->type->axes; i++)
+			value[i] = ess_rng_range(rng, chr->lower, chr->upper);
+		return ess_clock_now();
+	case ESS_SOURCE_WALK:
+		for (i = 0; i < chr->type->axes; i++)
+			value[i] = ess_sim_walk(rng, ess_state.value[i][chr->id],
+					src->step, chr->lower, chr->upper);
+		return ess_clock_now();
+	case ESS_SOURCE_DIURNAL:
+		daytime = ess_clock_daytime();
 
-		case 0x03 : if( pdu == apparent_speed_db->apparent_speed_data) 
-				notify=false;
-			    else
-			    	apparent_speed_db->apparent_speed_data= pdu;
-			    break;
+		for (i = 0; i < chr->type->axes; i++)
+			value[i] = ess_sim_diurnal(rng, daytime, src->step,
+						chr->lower, chr->upper);
+		return ess_clock_now();
+	case ESS_SOURCE_PUBLISH:
+		if (!src->published)
+			break;
 
-		case 0x04 : if( pdu >= apparent_speed_db->tr_value)
-				notify=false;
-			    break;
+		for (i = 0; i < chr->type->axes; i++)
+			value[i] = src->value[i];
+		return src->published;
+	case ESS_SOURCE_CONSTANT:
+		break;
+	case ESS_SOURCE_FILE:
+		n = ess_source_read(src, raw, chr->type->axes);
+		if (n != chr->type->axes)
+			break;
 
-		case 0x05 : if( pdu > apparent_speed_db->tr_value)
-				notify=false;
-			    break;
+		for (i = 0; i < n; i++)
+			value[i] = (int64_t) raw[i] * src->mul / src->div;
+		return ess_clock_now();
+	}
 
-		case 0x06 : if( pdu <= apparent_speed_db->tr_value)
-				notify=false;
-			    break;
+	/*
+	 * keep the last known value if the source could not be read, and
+	 * with it the time it was taken
+	 */
+	ess_state_get(ess_state.value, chr->id, value);
 
-		case 0x07 : if( pdu < apparent_speed_db->tr_value)
-				notify=false;
-			    break;
+	return chr->sampled;
+}
 
-		case 0x08 : if( pdu != apparent_speed_db->tr_value)
-				notify=false;
-			    break;
+struct ess_notify {
+	struct ess_char *chr;
+	uint8_t pdu[4 * ESS_MAX_AXES];
+	uint16_t len;
+};
 
-		default   : if( pdu == apparent_speed_db->tr_value)
-				notify=false;
+static void notify_conn(void *data, void *user_data)
+{
+	struct gatt_conn *conn = data;
+	struct ess_notify *notify = user_data;
+	struct ess_char *lost;
 
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,apparent_speed_db->apparent_speed_handle,
-						(uint8_t *)&pdu, 2);
-	}
+	if (!(ess_state.ccc[notify->chr->id] & (1ull << conn->slot)))
+		return;
 
-	return true;
+	lost = ess_sched_push(&conn->sched, notify->chr, notify->pdu,
+					notify->len, notify->chr->sampled);
+	if (lost)
+		metrics_inc(&lost->stats.replaced);
 }
 
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
+/*
+ * Hand what the tick queued for a connection to the ATT layer, by priority
+ * and within the budget of the connection
+ */
 
-static void update_apparent_speed_timer(struct gatt_conn *server)
+static void drain_conn(void *data, void *user_data)
 {
-	
-	unsigned int timer;
+	struct gatt_conn *conn = data;
+	struct ess_sched_entry entry;
 
-	apparent_speed_db->g_current_timer=((apparent_speed_db->apparent_speed_tr->data[0]) | (apparent_speed_db->apparent_speed_tr->data[1]<<8) | (apparent_speed_db->apparent_speed_tr->data[2]<<16));
+	ess_sched_refill(&conn->sched, notify_rate, notify_burst);
 
+	while (ess_sched_pop(&conn->sched, &entry)) {
+		struct ess_char *chr = entry.chr;
 
-	if(!apparent_speed_db->apparent_speed_enable || apparent_speed_db->apparent_speed_tr->trigger_inactive){
-	timeout_remove(apparent_speed_db->timeout_id);
-	return;
-	}
-	
-	timer=apparent_speed_db->g_current_timer*1000;
-	
+		if (!bt_gatt_server_send_notification(conn->gatt, chr->handle,
+						entry.pdu, entry.len)) {
+			metrics_inc(&chr->stats.send_failures);
+			ess_trace1(notify, chr->handle, conn->att, tick_mono, 0);
+			continue;
+		}
 
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
+		metrics_inc(&chr->stats.notifications);
+		ess_trace1(notify, chr->handle, conn->att, tick_mono, 1);
 
- 
-	if(apparent_speed_db->apparent_speed_tr->time_enable)   
-	apparent_speed_db->timeout_id=timeout_add(timer,apparent_speed_time_calculation,server,NULL);
-	else
-	apparent_speed_db->timeout_id=timeout_add(1000,apparent_speed_value_calculation,server,NULL);
-	
-}
+		ess_char_observe(chr, ESS_STAGE_QUEUE,
+					ess_clock_now() - entry.sampled);
 
-/* Apparent wind speed client characteristic configuration write call back */
+		/* opcode and handle in front of the value */
+		if (conn->tstamp_fd >= 0)
+			tx_push(conn, chr->handle, entry.len + 3,
+							entry.sampled);
+	}
+}
 
-static void apparent_speed_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static void flush_conn(void *data, void *user_data)
 {
+	struct gatt_conn *conn = data;
 
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+	ess_sched_init(&conn->sched);
+}
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
+/* This function will queue the current value to all the connected clients */
 
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || apparent_speed_db->apparent_speed_tr->trigger_inactive)
-		apparent_speed_db->apparent_speed_enable = false;
-	else if (value[0] == 0x01) {
-		apparent_speed_db->apparent_speed_enable = true;
-		apparent_speed_db->indication = 0x0001;
-	} else
-		error = 0x80;
+static void ess_char_notify(struct ess_char *chr)
+{
+	struct ess_notify notify;
+	int32_t value[ESS_MAX_AXES];
 
-	/* updating a timer function to call notification on a periodic interval */
+	if (queue_isempty(conn_list))
+		return;
 
-	update_apparent_speed_timer(server);
+	/* the value is the same for every client, encode it once */
+	ess_state_get(ess_state.value, chr->id, value);
 
- done:
+	notify.chr = chr;
+	notify.len = ess_value_encode(chr->type, value, notify.pdu);
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	ess_char_observe(chr, ESS_STAGE_ENCODE, ess_clock_now() - chr->sampled);
 
+	queue_foreach(conn_list, notify_conn, &notify);
 }
 
-/*Apparent Wind Speed trigger read call back */ 
+/* This function will be called on regular interval to send the notification */
 
-static void apparent_speed_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
+static void ess_time_calculation(struct ess_char *chr)
 {
-	uint8_t error,len;
-	uint8_t val[4];
+	int32_t value[ESS_MAX_AXES];
 
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=apparent_speed_db->apparent_speed_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = apparent_speed_db->apparent_speed_tr->data[0];
-		val[2] = apparent_speed_db->apparent_speed_tr->data[1];
-		val[3] = apparent_speed_db->apparent_speed_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)apparent_speed_db->tr_value;
-		val[2]=(uint8_t)(apparent_speed_db->tr_value>>8);
-		len=3;
-	}
-	
+	chr->sampled = ess_char_sample(chr, value);
+	ess_state_set(ess_state.value, chr->id, value);
 
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
+	if (chr->sampled >= tick_due)
+		ess_char_observe(chr, ESS_STAGE_SCHED,
+						chr->sampled - tick_due);
 
+	ess_char_notify(chr);
 }
 
-/*Apparent Wind Speed trigger write call back */
- 
-static void apparent_speed_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+/*
+ * Value triggers are checked on every tick. The samples of all the due
+ * instances are taken first, then evaluated in one batch against the
+ * stored values, which are only updated afterwards.
+ */
+
+static void ess_value_sample(struct ess_char *chr)
 {
+	int32_t pdu[ESS_MAX_AXES];
 
-	uint8_t error;
+	chr->sampled = ess_char_sample(chr, pdu);
+	ess_state_set(ess_state.sample, chr->id, pdu);
 
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=false;
-		apparent_speed_db->apparent_speed_tr->data[0] = value[1];		/* if trigger is time based  */
-		apparent_speed_db->apparent_speed_tr->data[1] = value[2];
-		apparent_speed_db->apparent_speed_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		apparent_speed_db->apparent_speed_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=true;
-		if(apparent_speed_db->timeout_id!=0){
-			timeout_remove(apparent_speed_db->timeout_id);
-			apparent_speed_db->apparent_speed_enable = false;
-			apparent_speed_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {	
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}	
-		error=0;
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=false;		/* if trigger is value based */
-		apparent_speed_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
+	if (chr->sampled >= tick_due)
+		ess_char_observe(chr, ESS_STAGE_SCHED,
+						chr->sampled - tick_due);
+}
 
-	apparent_speed_db->apparent_speed_tr->condition=value[0] ;
-	
+static void ess_value_calculation(struct ess_char *chr, bool notify)
+{
+	int32_t pdu[ESS_MAX_AXES];
 
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
+	ess_trace1(trigger, chr->handle, 0, tick_mono, notify);
 
-	if( apparent_speed_db->apparent_speed_tr->condition==0x01 || apparent_speed_db->apparent_speed_tr->condition==0x02){
-		apparent_speed_db->apparent_speed_tr->value_enable=false;
-		apparent_speed_db->apparent_speed_tr->time_enable=true;
-	} else if( apparent_speed_db->apparent_speed_tr->condition>=0x03 && apparent_speed_db->apparent_speed_tr->condition<= 0x09){
-		apparent_speed_db->apparent_speed_tr->time_enable=false;
-		apparent_speed_db->apparent_speed_tr->value_enable=true;
-		if(apparent_speed_db->apparent_speed_enable && !apparent_speed_db->apparent_speed_tr->trigger_inactive){
-			timeout_remove(apparent_speed_db->timeout_id);
-			update_apparent_speed_timer(conn);
-		}	
-	} else{	
-
-		apparent_speed_db->apparent_speed_tr->trigger_inactive=true;
-		apparent_speed_db->apparent_speed_tr->time_enable=false;
-		apparent_speed_db->apparent_speed_tr->value_enable=false;
-		if(apparent_speed_db->apparent_speed_enable && !apparent_speed_db->apparent_speed_tr->trigger_inactive){
-			timeout_remove(apparent_speed_db->timeout_id);
-			update_apparent_speed_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(apparent_speed_db->apparent_speed_tr->time_enable)
-	apparent_speed_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
+	ess_char_observe(chr, ESS_STAGE_TRIGGER,
+					ess_clock_now() - chr->sampled);
 
+	ess_state_get(ess_state.sample, chr->id, pdu);
+	ess_state_set(ess_state.value, chr->id, pdu);
 
-	if(apparent_speed_db->g_update_timer!=apparent_speed_db->g_current_timer && apparent_speed_db->apparent_speed_tr->time_enable){
-		timeout_remove(apparent_speed_db->timeout_id);
-		update_apparent_speed_timer(conn);
+	/* notify only if its satisfying the trigger condition */
+	if (!notify) {
+		metrics_inc(&chr->stats.suppressed);
+		return;
 	}
-	
 
-done :
+	ess_char_notify(chr);
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	/*
+	 * the next sample is the latest value once the interval is over, a
+	 * change in between that has been undone is not notified
+	 */
+	if (ess_state.flags[chr->id] & ESS_STATE_SPACED)
+		ess_state.deadline[chr->id] = tick_count +
+						ess_state.interval[chr->id];
 
+	/* intervals and changes of combined settings start over */
+	if (ess_state.flags[chr->id] & ESS_STATE_MULTI)
+		ess_trigger_arm(&chr->combo, pdu, tick_count);
 }
 
-/*Apparent User Descriptor write call back */ 
+/*
+ * Whether the sample of instance id is notified, from its batch word or
+ * its combined settings and then through the damping
+ */
 
-static void apparent_speed_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static bool ess_value_fire(unsigned int id, uint64_t fire)
 {
+	uint8_t flags = ess_state.flags[id];
+	struct ess_char *chr;
+	int32_t sample[ESS_MAX_AXES];
+	bool notify;
 
-	uint8_t error=0;
-	
-
-	/* checking if string is empty or length is more than the pdu length */
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+	if (!(flags & (ESS_STATE_MULTI | ESS_STATE_DAMPED)))
+		return fire >> (id % 64) & 1;
 
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+	chr = ess_state.chr[id];
+	ess_state_get(ess_state.sample, id, sample);
 
-	/* initializing the string with zero's and then copying the new string to the data base */
-	memset(apparent_speed_db->user_desc,0,21);
-	memcpy(apparent_speed_db->user_desc,value,len+1);
+	if (flags & ESS_STATE_MULTI)
+		notify = ess_trigger_eval(&chr->combo, sample,
+					chr->type->axes, tick_count);
+	else
+		notify = fire >> (id % 64) & 1;
 
-done :
+	if (!(flags & ESS_STATE_DAMPED) ||
+				ess_trigger_damp(chr, sample, notify))
+		return notify;
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	if (notify)
+		metrics_inc(&chr->stats.damped);
 
+	return false;
 }
-	
 
-/* Speed characteristic user descriptor read call back */
+/*
+*** A single one second tick drives every characteristic instance. Trigger ***
+*** intervals are whole seconds, so each instance only keeps the tick at   ***
+*** which it is due next instead of owning a timer of its own. The pass    ***
+*** reads the flags and deadlines of struct ess_state and only touches an  ***
+*** instance itself when it is due. The notifications of the tick go out  ***
+*** together at its end, so each connection can order them by priority.  ***
+*/
+
+/* Evaluate the value triggers of the instances sampled this tick */
 
-static void apparent_speed_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-				       unsigned int id, uint16_t offset,
-				       uint8_t opcode, struct bt_att *att,
-				       void *user_data)
+static void ess_value_batch(unsigned int words)
 {
+	unsigned int id, w;
 
-	uint8_t error;
-	static char *str;
-	if (offset >= 22) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-	} else {
-		error = 0;
-		str = (char *)apparent_speed_db->user_desc;
-	}
+	ess_trigger_batch(ess_state.len, ess_state.fire);
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *) str, 21);
+	for (w = 0; w < words; w++) {
+		uint64_t due = ess_state.due[w];
 
-}
+		while (due) {
+			id = w * 64 + __builtin_ctzll(due);
+			due &= due - 1;
 
-/* speed charcteristic valid range descriptor read call back */
+			ess_value_calculation(ess_state.chr[id],
+					ess_value_fire(id, ess_state.fire[w]));
+		}
+	}
+}
 
-static void apparent_speed_valid_range_read_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static bool ess_tick(void *user_data)
 {
+	unsigned int id, words = (ess_state.len + 63) / 64;
+	bool pending = false;
 
-	uint8_t error;
-	static uint16_t value[2];
+	tick_count++;
+	tick_time = ess_clock_now();
+	tick_mono = metrics_now();
 
-	if (offset > 4) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-	} else {
-		error = 0;
-		value[0] = apparent_speed_db->lower_speed;
-		value[1] = apparent_speed_db->upper_speed;
-	}
+	/* expirations the timer coalesced are not counted as delay */
+	tick_due += ESS_NSEC_PER_SEC;
+	if (tick_time > tick_due + ESS_NSEC_PER_SEC)
+		tick_due = tick_time;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *) value, 4);
+	ess_trace1(tick, 0, 0, tick_mono, tick_count);
 
-}
+	memset(ess_state.due, 0, words * sizeof(uint64_t));
 
+	for (id = 0; id < ess_state.len; id++) {
+		uint8_t flags = ess_state.flags[id];
 
+		if ((flags & (ESS_STATE_ENABLE | ESS_STATE_INACTIVE)) !=
+							ESS_STATE_ENABLE)
+			continue;
 
-/* speed characteristic measurement descriptor read call back */
+		if ((int32_t) (tick_count - ess_state.deadline[id]) < 0)
+			continue;
 
-static void apparent_speed_measurement_read_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
+		if (flags & ESS_STATE_TIME) {
+			ess_time_calculation(ess_state.chr[id]);
+			ess_state.deadline[id] = tick_count +
+							ess_state.interval[id];
+		} else {
+			ess_value_sample(ess_state.chr[id]);
+			ess_state.due[id / 64] |= 1ull << (id % 64);
+			ess_state.deadline[id] = tick_count + 1;
+			pending = true;
+		}
+	}
 
-	uint8_t error;
-	uint8_t value[11];
+	if (pending)
+		ess_value_batch(words);
 
-	error = 0;
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = apparent_speed_db->apparent_speed_ms->sample;
-	value[3] = apparent_speed_db->apparent_speed_ms->m_period[0];
-	value[4] = apparent_speed_db->apparent_speed_ms->m_period[1];
-	value[5] = apparent_speed_db->apparent_speed_ms->m_period[2];
-	value[6] = apparent_speed_db->apparent_speed_ms->u_interval[0];
-	value[7] = apparent_speed_db->apparent_speed_ms->u_interval[1];
-	value[8] = apparent_speed_db->apparent_speed_ms->u_interval[2];
-	value[9] = apparent_speed_db->apparent_speed_ms->applicatn;
-	value[10] = apparent_speed_db->apparent_speed_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+	queue_foreach(conn_list, drain_conn, NULL);
 
+	return true;
 }
 
-/* speed characteristic read call back */
+/* Timer function will read the trigger setting and schedule the next notification based on value or time */
 
-static void apparent_speed_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void update_char_timer(struct ess_char *chr)
 {
+	uint8_t flags = ess_state.flags[chr->id];
 
-	uint8_t error;
-	uint16_t value;
-
-	if (offset > 3) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-	} else {
-		error = 0;
-		value = apparent_speed_db->apparent_speed_data;
-	}
+	if ((flags & (ESS_STATE_ENABLE | ESS_STATE_INACTIVE)) !=
+							ESS_STATE_ENABLE)
+		return;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *) & value,
-				      2);
-}
+	/*
+	** if trigger is based on time notify after the trigger interval **
+	** if trigger is based on value check the trigger condition on every one sec and notify **
+	*/
 
+	if (flags & ESS_STATE_TIME)
+		ess_state.deadline[chr->id] = tick_count +
+						ess_state.interval[chr->id];
+	else
+		ess_state.deadline[chr->id] = tick_count + 1;
 
-/* Tempertaure client characteristic configuration read call back */
+	if (flags & (ESS_STATE_MULTI | ESS_STATE_DAMPED)) {
+		int32_t value[ESS_MAX_AXES];
 
-static void temp_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
+		ess_state_get(ess_state.value, chr->id, value);
 
-	uint8_t error;
-	static uint16_t value;
+		if (flags & ESS_STATE_MULTI)
+			ess_trigger_arm(&chr->combo, value, tick_count);
 
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=temp_db->indication;
+		if (flags & ESS_STATE_DAMPED)
+			ess_trigger_damp_arm(chr, value);
 	}
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
+	if (!tick_id) {
+		tick_due = ess_clock_now();
+		tick_id = ess_clock_tick_add(ess_tick, NULL);
+	}
 }
 
-/* This function will notify the temperature data to client if trigger is based on time */
+/* Count an ATT request on a characteristic and how long handling it took */
 
-static bool temp_time_calculation(void *user_data)
+static uint64_t ess_char_begin(struct ess_char *chr, struct bt_att *att,
+								bool write)
 {
+	uint64_t now = metrics_now();
 
-	struct gatt_conn *server=user_data;
-	int16_t pdu;
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,temp_db->temp_handle,
-						(uint8_t *)&pdu, 2);
+	if (write)
+		ess_trace(write_entry, chr->handle, att, now);
+	else
+		ess_trace(read_entry, chr->handle, att, now);
 
-	return true;
+	return now;
 }
 
-
-/* This function will notify the temperature data to client if trigger is tempertaure value and this function will be called on every one sec */
-
-static bool temp_value_calculation(void *user_data)
+static void ess_char_account(struct ess_char *chr, struct bt_att *att,
+				uint8_t opcode, uint64_t start, bool write)
 {
+	uint64_t now = metrics_now();
 
-	struct gatt_conn *server=user_data;
-	int16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(temp_db->temp_tr->condition){
-
-		case 0x03 : if( pdu == temp_db->temp_data)
-				notify=false;
-			    else
-			    	temp_db->temp_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= temp_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > temp_db->tr_value)
-				notify=false;
-			    break;
+	if (write) {
+		metrics_inc(&chr->stats.writes);
+		ess_trace1(write_exit, chr->handle, att, now, opcode);
+	} else {
+		metrics_inc(&chr->stats.reads);
+		ess_trace1(read_exit, chr->handle, att, now, opcode);
+	}
 
-		case 0x06 : if( pdu <= temp_db->tr_value)
-				notify=false;
-			    break;
+	metrics_att_observe(opcode, now - start);
+}
 
-		case 0x07 : if( pdu < temp_db->tr_value)
-				notify=false;
-			    break;
+/* characteristic value read call back */
 
-		case 0x08 : if( pdu != temp_db->tr_value)
-				notify=false;
-			    break;
+static void ess_char_read(struct gatt_db_attribute *attrib,
+		      unsigned int id, uint16_t offset,
+		      uint8_t opcode, struct bt_att *att, void *user_data)
+{
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
+	int32_t current[ESS_MAX_AXES];
+	uint8_t value[4 * ESS_MAX_AXES];
+	uint16_t len;
 
-		default   : if( pdu == temp_db->tr_value)
-				notify=false;
+	ess_state_get(ess_state.value, chr->id, current);
+	len = ess_value_encode(chr->type, current, value);
 
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,temp_db->temp_handle,
-						(uint8_t *)&pdu, 2);
-	}
+	ess_read_result(attrib, id, offset, value, len);
 
-	return true;
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
+/* measurement descriptor read call back */
 
-static void update_temp_timer(struct gatt_conn *server)
+static void ess_measurement_read_cb(struct gatt_db_attribute *attrib,
+				    unsigned int id, uint16_t offset,
+				    uint8_t opcode, struct bt_att *att,
+				    void *user_data)
 {
-	
-	unsigned int timer;
-
-	temp_db->g_current_timer=((temp_db->temp_tr->data[0]) | (temp_db->temp_tr->data[1]<<8) | (temp_db->temp_tr->data[2]<<16));
-
-
-	if(!temp_db->temp_enable || temp_db->temp_tr->trigger_inactive){
-	timeout_remove(temp_db->timeout_id);
-	return;
-	}
-	
-	timer=temp_db->g_current_timer*1000;
-	
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
+	uint8_t value[11];
 
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
+	value[0] = chr->ms.flags;
+	value[1] = chr->ms.flags >> 8;
+	value[2] = chr->ms.sample;
+	memcpy(&value[3], chr->ms.m_period, 3);
+	memcpy(&value[6], chr->ms.u_interval, 3);
+	value[9] = chr->ms.applicatn;
+	value[10] = chr->ms.m_uncertainity;
 
- 
-	if(temp_db->temp_tr->time_enable)
-	temp_db->timeout_id=timeout_add(timer,temp_time_calculation,server,NULL);
-	else
-	temp_db->timeout_id=timeout_add(1000,temp_value_calculation,server,NULL);
+	ess_read_result(attrib, id, offset, value, sizeof(value));
 
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* client characteristic configuration descriptor write call back */
+/* valid range descriptor read call back, lower and upper bound of every axis */
 
-static void temp_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
+static void ess_valid_range_read_cb(struct gatt_db_attribute *attrib,
 				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
 				    uint8_t opcode, struct bt_att *att,
 				    void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
+	const struct ess_char_type *type = chr->type;
+	uint8_t value[8 * ESS_MAX_AXES];
+	uint16_t len = 0;
+	int i, j;
 
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
+	for (i = 0; i < type->axes; i++) {
+		for (j = 0; j < type->len; j++)
+			value[len++] = (uint32_t) chr->lower >> (8 * j);
 
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+		for (j = 0; j < type->len; j++)
+			value[len++] = (uint32_t) chr->upper >> (8 * j);
 	}
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
+	ess_read_result(attrib, id, offset, value, len);
 
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || temp_db->temp_tr->trigger_inactive)
-		temp_db->temp_enable = false;
-	else if (value[0] == 0x01) {
-		temp_db->temp_enable = true;
-		temp_db->indication = 0x0001;
-	} else
-		error = 0x80;
+	ess_char_account(chr, att, opcode, start, false);
+}
 
-	/* updating a timer function to call notification on a periodic interval */
+/* damping descriptor read call back, hysteresis and dead band le32 */
 
-	update_temp_timer(server);
+static void ess_damping_read_cb(struct gatt_db_attribute *attrib,
+				unsigned int id, uint16_t offset,
+				uint8_t opcode, struct bt_att *att,
+				void *user_data)
+{
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
+	uint8_t value[8];
 
- done:
+	put_le32(chr->damping.hysteresis, &value[0]);
+	put_le32(chr->damping.deadband, &value[4]);
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	ess_read_result(attrib, id, offset, value, sizeof(value));
 
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Temperature characteristic user descriptor write call back */
-
+/* damping descriptor write call back, both at most INT32_MAX */
 
-static void temp_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static void ess_damping_write_cb(struct gatt_db_attribute *attrib,
+				unsigned int id, uint16_t offset,
+				const uint8_t *value, size_t len,
+				uint8_t opcode, struct bt_att *att,
+				void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, true);
+	uint32_t hysteresis, deadband;
+	uint8_t error = 0;
 
-	uint8_t error=0;
-	
-	
-	/* checking if string is empty or length is more than the pdu length */
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
+	if (offset) {
+		error = BT_ATT_ERROR_INVALID_OFFSET;
 		goto done;
 	}
 
-	if(offset){
+	if (!value || len != 8) {
 		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
 		goto done;
 	}
 
-	/* initializing the string with zero's and then copying the new string to the data base */
+	hysteresis = get_le32(&value[0]);
+	deadband = get_le32(&value[4]);
+
+	if (hysteresis > INT32_MAX || deadband > INT32_MAX) {
+		error = BT_ERROR_OUT_OF_RANGE;
+		goto done;
+	}
 
-	memset(temp_db->user_desc,0,21);
-	memcpy(temp_db->user_desc,value,len+1);
+	chr->damping.hysteresis = hysteresis;
+	chr->damping.deadband = deadband;
 
-done :
+	ess_trigger_setup(chr);
+	update_char_timer(chr);
 
+done:
 	gatt_db_attribute_write_result(attrib, id, error);
 
+	ess_char_account(chr, att, opcode, start, true);
 }
-	
-	
 
-/* Temperature characteristic user descriptor read call back */
+/* characteristic user descriptor read call back */
 
-static void temp_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
+static void ess_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
 				       unsigned int id, uint16_t offset,
 				       uint8_t opcode, struct bt_att *att,
 				       void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
 
-	uint8_t error;
-	if (offset >= 22) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	} else {
-		error = 0;
-	}
-
-done:
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)temp_db->user_desc, 21);
+	ess_read_result(attrib, id, offset, (uint8_t *) chr->user_desc,
+						strlen(chr->user_desc));
 
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Temperature valid range descriptor read call back */
+/* characteristic user descriptor write call back */
 
-static void temp_valid_range_read_cb(struct gatt_db_attribute *attrib,
+static void ess_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
 				    unsigned int id, uint16_t offset,
+				    const uint8_t * value, size_t len,
 				    uint8_t opcode, struct bt_att *att,
 				    void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, true);
+	uint8_t error = 0;
 
-	uint8_t error;
-	static uint16_t value[2];
+	/* checking if string is empty or length is more than the pdu length */
+	if (!value || len > ESS_USER_DESC_LEN) {
+		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
+		goto done;
+	}
 
-	if (offset > 4) {
+	if (offset) {
 		error = BT_ATT_ERROR_INVALID_OFFSET;
-	} else {
-		error = 0;
-		value[0] = temp_db->lower_temp;
-		value[1] = temp_db->upper_temp;
+		goto done;
 	}
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *) value, 4);
+	/* initializing the string with zero's and then copying the new string to the data base */
+	memset(chr->user_desc, 0, sizeof(chr->user_desc));
+	memcpy(chr->user_desc, value, len);
+
+done:
+	gatt_db_attribute_write_result(attrib, id, error);
+
+	ess_char_account(chr, att, opcode, start, true);
+}
+
+/* Which of the trigger settings of its instance a descriptor is */
 
+static unsigned int trigger_index(struct gatt_db_attribute *attrib)
+{
+	const struct ess_attr *attr;
+
+	attr = gatt_server_attr(gatt_db_attribute_get_handle(attrib));
+
+	return attr ? attr->index : 0;
 }
 
-/* Temperature trigger descriptor read call back */
+/* trigger setting descriptor read call back */
 
-static void temp_triger_read_cb(struct gatt_db_attribute *attrib,
+static void ess_triger_read_cb(struct gatt_db_attribute *attrib,
 			       unsigned int id, uint16_t offset,
 			       uint8_t opcode, struct bt_att *att,
 			       void *user_data)
 {
-	uint8_t error,len;
-	uint8_t val[4];
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
+	struct ess_trigger_setting setting;
+	uint8_t val[1 + 4 * ESS_MAX_AXES];
+	uint16_t len = 1;
+
+	ess_trigger_get(chr, trigger_index(attrib), &setting);
 
 	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=temp_db->temp_tr->condition;
+	val[0] = setting.condition;
 
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = temp_db->temp_tr->data[0];
-		val[2] = temp_db->temp_tr->data[1];
-		val[3] = temp_db->temp_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)temp_db->tr_value;
-		val[2]=(uint8_t)(temp_db->tr_value>>8);
-		len=3;
+	if (val[0] == 0x01 || val[0] == 0x02) {
+		val[1] = setting.interval;
+		val[2] = setting.interval >> 8;
+		val[3] = setting.interval >> 16;
+		len += 3;
+	} else if (val[0] >= 0x04 && val[0] <= 0x09) {
+		len += ess_value_encode(chr->type, setting.threshold, &val[1]);
 	}
-	
 
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
+	ess_read_result(attrib, id, offset, val, len);
 
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Temperature trigger descriptor write call back */
+/* trigger setting descriptor write call back */
 
-static void temp_triger_write_cb(struct gatt_db_attribute *attrib,
+static void ess_triger_write_cb(struct gatt_db_attribute *attrib,
 				unsigned int id, uint16_t offset,
 				const uint8_t * value, size_t len,
 				uint8_t opcode, struct bt_att *att,
 				void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, true);
+	size_t value_len = chr->type->len * chr->type->axes;
+	unsigned int index = trigger_index(attrib);
+	struct ess_trigger_setting setting;
+	uint8_t error = 0;
 
-	uint8_t error;
+	if (offset) {
+		error = BT_ATT_ERROR_INVALID_OFFSET;
+		goto done;
+	}
 
-	if (len<1 || len>4) {
+	if (!value || len < 1 || len > 1 + value_len) {
 		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		temp_db->temp_tr->trigger_inactive=false;
-		temp_db->temp_tr->data[0] = value[1];		/* if trigger is time based  */
-		temp_db->temp_tr->data[1] = value[2];
-		temp_db->temp_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
+		goto done;
+	}
+
+	/* checking if the value is RFU */
+	if (value[0] > 0x09) {
+		error = BT_ERROR_OUT_OF_RANGE;
+		goto done;
+	}
+
+	ess_trigger_get(chr, index, &setting);
+
+	switch (value[0]) {
+	case 0x00:
+	case 0x03:
+		if (len != 1) {
+			error = BT_ATT_ERROR_INVALID_PDU;
 			goto done;
 		}
-		error=0;
-		temp_db->temp_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		temp_db->temp_tr->trigger_inactive=true;
-		if(temp_db->timeout_id!=0){
-			timeout_remove(temp_db->timeout_id);
-			temp_db->temp_enable = false;
-			temp_db->indication = 0x0000;
+		break;
+	case 0x01:
+	case 0x02:
+		/* if trigger is time based, a zero interval is not allowed */
+		if (len != 4) {
+			error = BT_ATT_ERROR_INVALID_PDU;
 			goto done;
 		}
-	}else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
+
+		if (!value[1] && !value[2] && !value[3]) {
+			error = BT_ERROR_OUT_OF_RANGE;
 			goto done;
 		}
-		error=0;
-		temp_db->temp_tr->trigger_inactive=false;		/* if trigger is value based */
-	}else {
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
+
+		setting.interval = value[1] | (value[2] << 8) |
+							(value[3] << 16);
+		break;
+	default:
+		/* if trigger is value based */
+		if (len != 1 + value_len) {
+			error = BT_ATT_ERROR_INVALID_PDU;
 			goto done;
 		}
-		error=0;
-		temp_db->temp_tr->trigger_inactive=false;		/* if trigger is value based */
-		temp_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	temp_db->temp_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
 
-	if( temp_db->temp_tr->condition==0x01 || temp_db->temp_tr->condition==0x02){
-		temp_db->temp_tr->value_enable=false;
-		temp_db->temp_tr->time_enable=true;
-	} else if( temp_db->temp_tr->condition>=0x03 && temp_db->temp_tr->condition<= 0x09){
-		temp_db->temp_tr->time_enable=false;
-		temp_db->temp_tr->value_enable=true;
-		if(temp_db->temp_enable && !temp_db->temp_tr->trigger_inactive){
-			timeout_remove(temp_db->timeout_id);
-			update_temp_timer(conn);
-		}	
-	} else{	
-
-		temp_db->temp_tr->trigger_inactive=true;
-		temp_db->temp_tr->time_enable=false;
-		temp_db->temp_tr->value_enable=false;
-		if(temp_db->temp_enable && !temp_db->temp_tr->trigger_inactive){
-			timeout_remove(temp_db->timeout_id);
-			update_temp_timer(conn);
-		}	
-		
+		ess_value_decode(chr->type, &value[1], setting.threshold);
+		break;
 	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(temp_db->temp_tr->time_enable)
-	temp_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
 
+	setting.condition = value[0];
+	ess_trigger_set(chr, index, &setting);
 
-	if(temp_db->g_update_timer!=temp_db->g_current_timer && temp_db->temp_tr->time_enable){
-		timeout_remove(temp_db->timeout_id);
-		update_temp_timer(conn);
+	/* if trigger is inactive the notification is disabled as well */
+	if (ess_state.flags[chr->id] & ESS_STATE_INACTIVE) {
+		ess_state.flags[chr->id] &= ~ESS_STATE_ENABLE;
+		ess_state.ccc[chr->id] = 0;
 	}
-	
 
-done :
+	/* if notification is already enabled update the timer with new values */
+	update_char_timer(chr);
 
+done:
 	gatt_db_attribute_write_result(attrib, id, error);
 
+	ess_char_account(chr, att, opcode, start, true);
 }
 
-/* Temperature measurement descriptor read Call back */ 
+/* ES configuration descriptor read call back */
 
-static void temp_measurement_read_cb(struct gatt_db_attribute *attrib,
+static void ess_es_config_read_cb(struct gatt_db_attribute *attrib,
 				    unsigned int id, uint16_t offset,
 				    uint8_t opcode, struct bt_att *att,
 				    void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, false);
 
-	uint8_t error;
-	uint8_t value[11];
-
-	error = 0;
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = temp_db->temp_ms->sample;
-	value[3] = temp_db->temp_ms->m_period[0];
-	value[4] = temp_db->temp_ms->m_period[1];
-	value[5] = temp_db->temp_ms->m_period[2];
-	value[6] = temp_db->temp_ms->u_interval[0];
-	value[7] = temp_db->temp_ms->u_interval[1];
-	value[8] = temp_db->temp_ms->u_interval[2];
-	value[9] = temp_db->temp_ms->applicatn;
-	value[10] = temp_db->temp_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+	ess_read_result(attrib, id, offset, &chr->es_config, 1);
 
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Temperature characteristic read call back */
+/* ES configuration descriptor write call back, 0x00 is AND and 0x01 OR */
 
-static void temp_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void ess_es_config_write_cb(struct gatt_db_attribute *attrib,
+				    unsigned int id, uint16_t offset,
+				    const uint8_t * value, size_t len,
+				    uint8_t opcode, struct bt_att *att,
+				    void *user_data)
 {
+	struct ess_char *chr = user_data;
+	uint64_t start = ess_char_begin(chr, att, true);
+	uint8_t error = 0;
 
-	uint8_t error;
-	static uint16_t value;
-
-	if (offset > 3) {
+	if (offset) {
 		error = BT_ATT_ERROR_INVALID_OFFSET;
-	} else {
-		error = 0;
-		value = temp_db->temp_data;
+		goto done;
 	}
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *) & value,
-				      2);
-}
+	if (!value || len != 1) {
+		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
+		goto done;
+	}
 
+	if (value[0] > ESS_CONFIG_OR) {
+		error = BT_ERROR_OUT_OF_RANGE;
+		goto done;
+	}
 
-/*
-*** This section cocnsist of all the call backs ***
-*** of apparent wind speed characteristics      ***
-*/
+	chr->es_config = value[0];
 
+	/* recompiles the combination of the trigger settings */
+	ess_trigger_setup(chr);
+	update_char_timer(chr);
 
+done:
+	gatt_db_attribute_write_result(attrib, id, error);
 
-/* apparent wind speed value read call back */
+	ess_char_account(chr, att, opcode, start, true);
+}
 
-static void apparent_direction_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static bool match_conn_att(const void *data, const void *match_data)
 {
+	const struct gatt_conn *conn = data;
 
-	uint8_t error=0;
-	uint16_t value;
+	return conn->att == match_data;
+}
+
+/* client characteristic configuration read call back */
+
+static void ess_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
+{
+	struct ess_char *chr = user_data;
+	struct gatt_conn *conn = queue_find(conn_list, match_conn_att, att);
+	uint64_t start = ess_char_begin(chr, att, false);
+	uint8_t value[2];
 
-	value=apparent_direction_db->apparent_direction_data;
+	value[0] = conn && ess_state.ccc[chr->id] & (1ull << conn->slot) ?
+								0x01 : 0x00;
+	value[1] = 0x00;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
+	ess_read_result(attrib, id, offset, value, sizeof(value));
+
+	ess_char_account(chr, att, opcode, start, false);
 }
 
-/* Apparent wind Direction measurement descriptor read call back */
+/* client characteristic configuration write call back */
 
-static void apparent_direction_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void ess_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
+				    unsigned int id, uint16_t offset,
+				    const uint8_t * value, size_t len,
+				    uint8_t opcode, struct bt_att *att,
+				    void *user_data)
 {
+	struct ess_char *chr = user_data;
+	struct gatt_conn *conn = queue_find(conn_list, match_conn_att, att);
+	uint64_t start = ess_char_begin(chr, att, true);
+	uint8_t error = 0;
+	bool enabled;
 
-	uint8_t error=0,value[11];
+	if (!value || len != 2) {
+		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
+		goto done;
+	}
 
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = apparent_direction_db->apparent_direction_ms->sample;
-	value[3] = apparent_direction_db->apparent_direction_ms->m_period[0];
-	value[4] = apparent_direction_db->apparent_direction_ms->m_period[1];
-	value[5] = apparent_direction_db->apparent_direction_ms->m_period[2];
-	value[6] = apparent_direction_db->apparent_direction_ms->u_interval[0];
-	value[7] = apparent_direction_db->apparent_direction_ms->u_interval[1];
-	value[8] = apparent_direction_db->apparent_direction_ms->u_interval[2];
-	value[9] = apparent_direction_db->apparent_direction_ms->applicatn;
-	value[10] = apparent_direction_db->apparent_direction_ms->m_uncertainity;
+	if (offset) {
+		error = BT_ATT_ERROR_INVALID_OFFSET;
+		goto done;
+	}
 
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+	if (!conn) {
+		error = BT_ATT_ERROR_UNLIKELY;
+		goto done;
+	}
 
-}	
+	enabled = !!(ess_state.flags[chr->id] & ESS_STATE_ENABLE);
 
-/* Apparent wind Direction valid range read call back */
+	/* every connection subscribes on its own, see ESS_MAX_CONNS */
 
-static void apparent_direction_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
+	if (value[0] == 0x00 ||
+			ess_state.flags[chr->id] & ESS_STATE_INACTIVE)
+		ess_state.ccc[chr->id] &= ~(1ull << conn->slot);
+	else if (value[0] == 0x01)
+		ess_state.ccc[chr->id] |= 1ull << conn->slot;
+	else {
+		error = 0x80;
+		goto done;
+	}
 
-	uint8_t error=0;
-	uint16_t value[2];
-	
-	value[0]=apparent_direction_db->lower_direction;
-	value[1]=apparent_direction_db->upper_direction;
+	if (ess_state.ccc[chr->id])
+		ess_state.flags[chr->id] |= ESS_STATE_ENABLE;
+	else
+		ess_state.flags[chr->id] &= ~ESS_STATE_ENABLE;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
+	/* the first subscriber starts the timer, the others join it */
 
-}
+	if (!enabled)
+		update_char_timer(chr);
 
-/* Apparent Wind Direction user descriptor read call back */
+done:
+	gatt_db_attribute_write_result(attrib, id, error);
 
-static void apparent_direction_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+	ess_char_account(chr, att, opcode, start, true);
+}
+static void gap_device_name_read(struct gatt_db_attribute *attrib,
+				 unsigned int id, uint16_t offset,
+				 uint8_t opcode, struct bt_att *att,
+				 void *user_data)
 {
+	uint8_t error;
+	const uint8_t *value;
+	size_t len;
 
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=apparent_direction_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
+	if (offset > dev_name_len) {
+		error = BT_ATT_ERROR_INVALID_OFFSET;
+		value = NULL;
+		len = dev_name_len;
+	} else {
+		error = 0;
+		len = dev_name_len - offset;
+		value = len ? &dev_name[offset] : NULL;
+	}
 
+	gatt_db_attribute_read_result(attrib, id, error, value, len);
 }
 
-/* Apparent Wind Direction user descriptor write call back */
+/* Service Changed indications are enabled per connection */
 
-static void apparent_direction_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+static void svc_chngd_ccc_read_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
 {
+	struct gatt_conn *conn = queue_find(conn_list, match_conn_att, att);
+	uint8_t value[2];
 
-	uint8_t error;
+	value[0] = conn && conn->svc_chngd_enabled ? 0x02 : 0x00;
+	value[1] = 0x00;
+
+	ess_read_result(attrib, id, offset, value, sizeof(value));
+}
+
+static void svc_chngd_ccc_write_cb(struct gatt_db_attribute *attrib,
+				    unsigned int id, uint16_t offset,
+				    const uint8_t * value, size_t len,
+				    uint8_t opcode, struct bt_att *att,
+				    void *user_data)
+{
+	struct gatt_conn *conn = queue_find(conn_list, match_conn_att, att);
+	uint8_t error = 0;
 
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
+	if (!value || len != 2) {
 		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
 		goto done;
 	}
 
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
+	if (offset) {
+		error = BT_ATT_ERROR_INVALID_OFFSET;
 		goto done;
 	}
 
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(apparent_direction_db->user_desc,0,21);
-	memcpy(apparent_direction_db->user_desc,value,len+1);
+	if (!conn) {
+		error = BT_ATT_ERROR_UNLIKELY;
+		goto done;
+	}
 
-done :
+	if (value[0] == 0x00)
+		conn->svc_chngd_enabled = false;
+	else if (value[0] == 0x02)
+		conn->svc_chngd_enabled = true;
+	else
+		error = 0x80;
 
+done:
 	gatt_db_attribute_write_result(attrib, id, error);
-
 }
 
+/*
+*   Database Hash, the AES-CMAC with a zero key of the handle, type and    *
+*   (for declarations) value of every attribute a client caches. A        *
+*   reconnecting client compares it against the one it cached with the    *
+*   database and skips discovery when they match. It is computed through  *
+*   the kernel crypto API on the first read after the database changed.   *
+*/
 
-static void apparent_direction_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
+#ifndef SOL_ALG
+#define SOL_ALG 279
+#endif
+
+struct db_hash_buf {
+	uint8_t *data;
+	size_t len;
+	size_t size;
+};
+
+#ifdef ESS_STATIC
+/* an attribute adds at most 24 octets, the other services have 32 */
+static uint8_t db_hash_mem[(ESS_STATIC_HANDLES + 32) * 24];
+#endif
+
+static void db_hash_append(struct db_hash_buf *buf, const void *data,
+								size_t len)
 {
+	if (!buf->data)
+		return;
 
-	uint8_t error;
-	static uint16_t value;
+	if (buf->len + len > buf->size) {
+#ifdef ESS_STATIC
+		buf->data = NULL;
+		return;
+#else
+		uint8_t *tmp = realloc(buf->data, (buf->size + len) * 2);
 
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=apparent_direction_db->indication;
-	}
+		if (!tmp) {
+			free(buf->data);
+			buf->data = NULL;
+			return;
+		}
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
+		buf->data = tmp;
+		buf->size = (buf->size + len) * 2;
+#endif
+	}
 
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
 }
 
-
-static bool apparent_direction_time_calculation(void *user_data)
+static void db_hash_value_cb(struct gatt_db_attribute *attrib, int err,
+					const uint8_t *value, size_t length,
+					void *user_data)
 {
+	if (!err)
+		db_hash_append(user_data, value, length);
+}
 
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
+static void db_hash_attrib(struct db_hash_buf *buf,
+					struct gatt_db_attribute *attrib)
+{
+	const bt_uuid_t *type = gatt_db_attribute_get_type(attrib);
+	uint8_t hdr[4];
 
-	
+	if (type->type != BT_UUID16)
+		return;
 
-		
-	pdu=rand();
+	put_le16(gatt_db_attribute_get_handle(attrib), &hdr[0]);
+	put_le16(type->value.u16, &hdr[2]);
 
-	bt_gatt_server_send_notification(server->gatt,apparent_direction_db->apparent_direction_handle,
-						(uint8_t *)&pdu, 2);
+	switch (type->value.u16) {
+	case GATT_PRIM_SVC_UUID:
+	case GATT_SND_SVC_UUID:
+	case GATT_INCLUDE_UUID:
+	case GATT_CHARAC_UUID:
+	case GATT_CHARAC_EXT_PROPER_UUID:
+		db_hash_append(buf, hdr, sizeof(hdr));
 
-	return true;
+		/* declarations hold their value, the read completes here */
+		gatt_db_attribute_read(attrib, 0, 0, NULL, db_hash_value_cb,
+									buf);
+		break;
+	case GATT_CHARAC_USER_DESC_UUID:
+	case GATT_CLIENT_CHARAC_CFG_UUID:
+	case GATT_SERVER_CHARAC_CFG_UUID:
+	case GATT_CHARAC_FMT_UUID:
+	case GATT_CHARAC_AGREG_FMT_UUID:
+		db_hash_append(buf, hdr, sizeof(hdr));
+		break;
+	}
 }
 
-
-static bool apparent_direction_value_calculation(void *user_data)
+static void db_hash_service(struct gatt_db_attribute *service,
+							void *user_data)
 {
+	struct gatt_db_attribute *attrib;
+	uint16_t start, end;
+	unsigned int handle;
 
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
+	if (!gatt_db_attribute_get_service_handles(service, &start, &end))
+		return;
 
-		
-	pdu=rand();
+	for (handle = start; handle <= end; handle++) {
+		attrib = gatt_db_get_attribute(gatt_db, handle);
+		if (attrib)
+			db_hash_attrib(user_data, attrib);
+	}
+}
 
+/* The crypto API takes the message most significant octet first */
 
+static void db_hash_swap(uint8_t *data, size_t len)
+{
+	size_t i;
+	uint8_t tmp;
 
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(apparent_direction_db->apparent_direction_tr->condition){
+	for (i = 0; i < len / 2; i++) {
+		tmp = data[i];
+		data[i] = data[len - 1 - i];
+		data[len - 1 - i] = tmp;
+	}
+}
 
-		case 0x03 : if( pdu == apparent_direction_db->apparent_direction_data)
-				notify=false;
-			    else
-			    	apparent_direction_db->apparent_direction_data= pdu;
-			    break;
+static bool db_hash_update(void)
+{
+	struct sockaddr_alg salg;
+	struct db_hash_buf buf;
+	uint8_t key[16];
+	int fd, op = -1;
+	bool result = false;
 
-		case 0x04 : if( pdu >= apparent_direction_db->tr_value)
-				notify=false;
-			    break;
+	buf.len = 0;
+#ifdef ESS_STATIC
+	buf.size = sizeof(db_hash_mem);
+	buf.data = db_hash_mem;
+#else
+	buf.size = 256;
+	buf.data = malloc(buf.size);
+#endif
 
-		case 0x05 : if( pdu > apparent_direction_db->tr_value)
-				notify=false;
-			    break;
+	gatt_db_foreach_service(gatt_db, NULL, db_hash_service, &buf);
+	if (!buf.data)
+		return false;
 
-		case 0x06 : if( pdu <= apparent_direction_db->tr_value)
-				notify=false;
-			    break;
+	db_hash_swap(buf.data, buf.len);
 
-		case 0x07 : if( pdu < apparent_direction_db->tr_value)
-				notify=false;
-			    break;
+	fd = socket(AF_ALG, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		goto done;
 
-		case 0x08 : if( pdu != apparent_direction_db->tr_value)
-				notify=false;
-			    break;
+	memset(&salg, 0, sizeof(salg));
+	salg.salg_family = AF_ALG;
+	strcpy((char *) salg.salg_type, "hash");
+	strcpy((char *) salg.salg_name, "cmac(aes)");
 
-		default   : if( pdu == apparent_direction_db->tr_value)
-				notify=false;
+	memset(key, 0, sizeof(key));
 
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,apparent_direction_db->apparent_direction_handle,
-						(uint8_t *)&pdu, 2);
-	}
+	if (bind(fd, (struct sockaddr *) &salg, sizeof(salg)) < 0 ||
+			setsockopt(fd, SOL_ALG, ALG_SET_KEY, key,
+							sizeof(key)) < 0)
+		goto done;
 
-	return true;
-}
+	op = accept4(fd, NULL, 0, SOCK_CLOEXEC);
+	if (op < 0)
+		goto done;
 
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
+	if (write(op, buf.data, buf.len) != (ssize_t) buf.len ||
+			read(op, db_hash, sizeof(db_hash)) != sizeof(db_hash))
+		goto done;
 
-static void update_apparent_direction_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
+	db_hash_swap(db_hash, sizeof(db_hash));
+	db_hash_valid = true;
+	result = true;
 
-	apparent_direction_db->g_current_timer=((apparent_direction_db->apparent_direction_tr->data[0]) | (apparent_direction_db->apparent_direction_tr->data[1]<<8) | (apparent_direction_db->apparent_direction_tr->data[2]<<16));
+done:
+	if (!result)
+		ess_error("Failed to compute database hash: %m\n");
 
+	if (op >= 0)
+		close(op);
 
-	if(!apparent_direction_db->apparent_direction_enable || apparent_direction_db->apparent_direction_tr->trigger_inactive){
-	timeout_remove(apparent_direction_db->timeout_id);
-	return;
-	}
-	
-	timer=apparent_direction_db->g_current_timer*1000;
-	
+	if (fd >= 0)
+		close(fd);
 
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
+#ifndef ESS_STATIC
+	free(buf.data);
+#endif
 
- 
-	if(apparent_direction_db->apparent_direction_tr->time_enable)   
-	apparent_direction_db->timeout_id=timeout_add(timer,apparent_direction_time_calculation,server,NULL);
-	else
-	apparent_direction_db->timeout_id=timeout_add(1000,apparent_direction_value_calculation,server,NULL);
-	
+	return result;
 }
 
-
-static void apparent_direction_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static void db_hash_read_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
 {
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+	if (!db_hash_valid && !db_hash_update()) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_UNLIKELY, NULL, 0);
+		return;
 	}
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
+	ess_read_result(attrib, id, offset, db_hash, sizeof(db_hash));
+}
 
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || apparent_direction_db->apparent_direction_tr->trigger_inactive)
-		apparent_direction_db->apparent_direction_enable = false;
-	else if (value[0] == 0x01) {
-		apparent_direction_db->apparent_direction_enable = true;
-		apparent_direction_db->indication = 0x0001;
-	} else
-		error = 0x80;
+static void populate_gatt_service(struct gatt_db *db)
+{
+	struct gatt_db_attribute *service, *attr;
+	bt_uuid_t uuid;
 
-	/* updating a timer function to call notification on a periodic interval */
+	bt_uuid16_create(&uuid, UUID_GATT);
+	service = gatt_db_add_service(db, &uuid, true, 6);
 
-	update_apparent_direction_timer(server);
+	bt_uuid16_create(&uuid, GATT_CHARAC_SERVICE_CHANGED);
+	attr = gatt_db_service_add_characteristic(service, &uuid,
+					   0,
+					   BT_GATT_CHRC_PROP_INDICATE,
+					   NULL, NULL, NULL);
 
- done:
+	svc_chngd_handle = gatt_db_attribute_get_handle(attr);
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
+	gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       svc_chngd_ccc_read_cb,
+				       svc_chngd_ccc_write_cb, NULL);
+
+	bt_uuid16_create(&uuid, UUID_DATABASE_HASH);
+	gatt_db_service_add_characteristic(service, &uuid, BT_ATT_PERM_READ,
+					   BT_GATT_CHRC_PROP_READ,
+					   db_hash_read_cb, NULL, NULL);
 
+	gatt_db_service_set_active(service, true);
 }
 
-static void apparent_direction_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
+static void populate_gap_service(struct gatt_db *db)
 {
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=apparent_direction_db->apparent_direction_tr->condition;
+	struct gatt_db_attribute *service;
+	bt_uuid_t uuid;
 
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = apparent_direction_db->apparent_direction_tr->data[0];
-		val[2] = apparent_direction_db->apparent_direction_tr->data[1];
-		val[3] = apparent_direction_db->apparent_direction_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)apparent_direction_db->tr_value;
-		val[2]=(uint8_t)(apparent_direction_db->tr_value>>8);
-		len=3;
-	}
-	
+	bt_uuid16_create(&uuid, UUID_GAP);
+	service = gatt_db_add_service(db, &uuid, true, 6);
 
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
+	bt_uuid16_create(&uuid, GATT_CHARAC_DEVICE_NAME);
+	gatt_db_service_add_characteristic(service, &uuid,
+					   BT_ATT_PERM_READ,
+					   BT_GATT_CHRC_PROP_READ,
+					   gap_device_name_read, NULL, NULL);
 
+	gatt_db_service_set_active(service, true);
 }
 
-
-static void apparent_direction_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+static void populate_devinfo_service(struct gatt_db *db)
 {
+	struct gatt_db_attribute *service;
+	bt_uuid_t uuid;
 
-	uint8_t error;
+	bt_uuid16_create(&uuid, 0x180a);
+	service = gatt_db_add_service(db, &uuid, true, 9);
 
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=false;
-		apparent_direction_db->apparent_direction_tr->data[0] = value[1];		/* if trigger is time based  */
-		apparent_direction_db->apparent_direction_tr->data[1] = value[2];
-		apparent_direction_db->apparent_direction_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		apparent_direction_db->apparent_direction_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=true;
-		if(apparent_direction_db->timeout_id!=0){
-			timeout_remove(apparent_direction_db->timeout_id);
-			apparent_direction_db->apparent_direction_enable = false;
-			apparent_direction_db->indication = 0x0000;
-			goto done;
-		}
-	}else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=false;		/* if trigger is value based */
-	}else {
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=false;		/* if trigger is value based */
-		apparent_direction_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
+	gatt_db_service_set_active(service, true);
+}
 
-	apparent_direction_db->apparent_direction_tr->condition=value[0] ;
-	
+/* This function will initialize the fields of all the characteristic and descriptor with server designed initial values */
 
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
+/* Number of attribute handles used by one characteristic and its descriptors */
 
-	if( apparent_direction_db->apparent_direction_tr->condition==0x01 || apparent_direction_db->apparent_direction_tr->condition==0x02){
-		apparent_direction_db->apparent_direction_tr->value_enable=false;
-		apparent_direction_db->apparent_direction_tr->time_enable=true;
-	} else if( apparent_direction_db->apparent_direction_tr->condition>=0x03 && apparent_direction_db->apparent_direction_tr->condition<= 0x09){
-		apparent_direction_db->apparent_direction_tr->time_enable=false;
-		apparent_direction_db->apparent_direction_tr->value_enable=true;
-		if(apparent_direction_db->apparent_direction_enable && !apparent_direction_db->apparent_direction_tr->trigger_inactive){
-			timeout_remove(apparent_direction_db->timeout_id);
-			update_apparent_direction_timer(conn);
-		}	
-	} else{	
-
-		apparent_direction_db->apparent_direction_tr->trigger_inactive=true;
-		apparent_direction_db->apparent_direction_tr->time_enable=false;
-		apparent_direction_db->apparent_direction_tr->value_enable=false;
-		if(apparent_direction_db->apparent_direction_enable && !apparent_direction_db->apparent_direction_tr->trigger_inactive){
-			timeout_remove(apparent_direction_db->timeout_id);
-			update_apparent_direction_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(apparent_direction_db->apparent_direction_tr->time_enable)
-	apparent_direction_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
+static uint16_t ess_char_num_handles(const struct ess_char *chr)
+{
+	/* declaration, value, measurement, valid range and user description */
+	uint16_t num = 5;
 
+	/* trigger settings, damping and client characteristic configuration */
+	if (chr->type->notify)
+		num += chr->num_triggers + 2;
 
-	if(apparent_direction_db->g_update_timer!=apparent_direction_db->g_current_timer && apparent_direction_db->apparent_direction_tr->time_enable){
-		timeout_remove(apparent_direction_db->timeout_id);
-		update_apparent_direction_timer(conn);
-	}
-	
+	if (chr->es_config_enable)
+		num++;
 
-done :
+	return num;
+}
 
-	gatt_db_attribute_write_result(attrib, id, error);
+static void count_handles(void *data, void *user_data)
+{
+	unsigned int *num = user_data;
 
+	*num += ess_char_num_handles(data);
 }
 
 /*
-*** This section cocnsist of all the call backs of ***
-*** Dew Point characteristics                      ***
+*   Attribute handles of the ESS service, from the service declaration    *
+*   on, mapped to the instance they belong to and the kind of attribute.  *
+*   Built with the service, it resolves a handle without walking the      *
+*   instances.                                                            *
 */
 
+#ifdef ESS_STATIC
+static struct ess_attr ess_attr_mem[ESS_STATIC_HANDLES];
+#endif
+
+static struct ess_attr *ess_attrs = NULL;
+static uint16_t ess_attrs_start = 0;
+static unsigned int ess_attrs_len = 0;
 
-static void dew_point_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static bool ess_attrs_reset(uint16_t start, unsigned int len)
 {
+#ifdef ESS_STATIC
+	if (len > ESS_STATIC_HANDLES) {
+		ess_error("Profile needs more than %u handles\n",
+							ESS_STATIC_HANDLES);
+		return false;
+	}
 
-	uint8_t error=0;
-	int8_t  value;
+	ess_mem_charge_static(ESS_MEM_DB, ((int64_t) len - ess_attrs_len) *
+					(int64_t) sizeof(struct ess_attr));
+	ess_attrs = ess_attr_mem;
+#else
+	struct ess_attr *attrs;
 
-	value=dew_point_db->dew_point_data;
+	attrs = realloc(ess_attrs, len * sizeof(*attrs));
+	if (!attrs)
+		return false;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 1);
+	ess_mem_charge(ESS_MEM_DB, ((int64_t) len - ess_attrs_len) *
+					(int64_t) sizeof(struct ess_attr));
+	ess_attrs = attrs;
+#endif
+	memset(ess_attrs, 0, len * sizeof(*ess_attrs));
+	ess_attrs_start = start;
+	ess_attrs_len = len;
 
+	return true;
 }
 
-
-/* Dew Point measurement descriptor read call back */
-
-static void dew_point_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void ess_attrs_free(void)
 {
+#ifdef ESS_STATIC
+	ess_mem_charge_static(ESS_MEM_DB,
+			-(int64_t) (ess_attrs_len * sizeof(*ess_attrs)));
+#else
+	ess_mem_charge(ESS_MEM_DB,
+			-(int64_t) (ess_attrs_len * sizeof(*ess_attrs)));
+	free(ess_attrs);
+#endif
+	ess_attrs = NULL;
+	ess_attrs_start = 0;
+	ess_attrs_len = 0;
+}
 
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = dew_point_db->dew_point_ms->sample;
-	value[3] = dew_point_db->dew_point_ms->m_period[0];
-	value[4] = dew_point_db->dew_point_ms->m_period[1];
-	value[5] = dew_point_db->dew_point_ms->m_period[2];
-	value[6] = dew_point_db->dew_point_ms->u_interval[0];
-	value[7] = dew_point_db->dew_point_ms->u_interval[1];
-	value[8] = dew_point_db->dew_point_ms->u_interval[2];
-	value[9] = dew_point_db->dew_point_ms->applicatn;
-	value[10] = dew_point_db->dew_point_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+static void ess_attr_set(uint16_t handle, struct ess_char *chr,
+				enum ess_attr_kind kind, uint8_t setting)
+{
+	uint16_t index = handle - ess_attrs_start;
 
-}	
+	if (index >= ess_attrs_len)
+		return;
 
-/* Dew Point valid range read call back */
+	ess_attrs[index].chr = chr;
+	ess_attrs[index].kind = kind;
+	ess_attrs[index].index = setting;
+}
 
-static void dew_point_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+const struct ess_attr *gatt_server_attr(uint16_t handle)
 {
+	uint16_t index = handle - ess_attrs_start;
 
-	uint8_t error=0;
-	int8_t value[2];
-
-	value[0]=-40;
-	value[1]=+80;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
+	if (handle < ess_attrs_start || index >= ess_attrs_len ||
+						!ess_attrs[index].chr)
+		return NULL;
 
+	return &ess_attrs[index];
 }
 
-/* Dew Point user descriptor read call back */
+/* Adding one characteristic instance and it's descriptors */
 
-static void dew_point_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void populate_char(void *data, void *user_data)
 {
+	struct ess_char *chr = data;
+	struct gatt_db_attribute *service = user_data, *attr;
+	uint8_t props = BT_GATT_CHRC_PROP_READ;
+	bt_uuid_t uuid;
+	unsigned int i;
 
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=dew_point_db->user_desc;
+	if (chr->type->notify)
+		props |= BT_GATT_CHRC_PROP_NOTIFY;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
+	bt_uuid16_create(&uuid, chr->type->uuid);
+	attr = gatt_db_service_add_characteristic(service, &uuid,
+						  BT_ATT_PERM_READ, props,
+						  ess_char_read, NULL, chr);
 
-}
+	chr->handle = gatt_db_attribute_get_handle(attr);
 
-/* Dew Point user descriptor write call back */
+	/* the declaration is the handle before the value */
+	ess_attr_set(chr->handle - 1, chr, ESS_ATTR_DECL, 0);
+	ess_attr_set(chr->handle, chr, ESS_ATTR_VALUE, 0);
 
-static void dew_point_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
+	attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ,
+				       ess_measurement_read_cb, NULL, chr);
+	ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_MEASUREMENT, 0);
+
+	/* the callbacks find the setting through gatt_server_attr() */
+	for (i = 0; i < chr->num_triggers; i++) {
+		bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
+		attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       ess_triger_read_cb, ess_triger_write_cb,
+				       chr);
+		ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_TRIGGER, i);
 	}
 
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+	if (chr->es_config_enable) {
+		bt_uuid16_create(&uuid, ESS_CONFIGURATION_DESC);
+		attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       ess_es_config_read_cb,
+				       ess_es_config_write_cb, chr);
+		ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_CONFIG, 0);
 	}
 
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(dew_point_db->user_desc,0,21);
-	memcpy(dew_point_db->user_desc,value,len+1);
-
-done :
+	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
+	attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ,
+				       ess_valid_range_read_cb, NULL, chr);
+	ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_RANGE, 0);
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
+	attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       ess_char_user_desc_read_cb,
+				       ess_char_user_desc_write_cb, chr);
+	ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_USER_DESC, 0);
+
+	if (chr->type->notify) {
+		bt_string_to_uuid(&uuid, ESS_DAMPING_DESC);
+		attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       ess_damping_read_cb,
+				       ess_damping_write_cb, chr);
+		ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_DAMPING, 0);
 
+		bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
+		attr = gatt_db_service_add_descriptor(service, &uuid,
+				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				       ess_msrmt_ccc_read_cb,
+				       ess_msrmt_ccc_write_cb, chr);
+		ess_attr_set(gatt_db_attribute_get_handle(attr), chr,
+							ESS_ATTR_CCC, 0);
+	}
 }
 
-static void dew_point_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
+static unsigned int ess_service_num_handles(struct queue *chars)
 {
+	unsigned int num_handles = 1;
 
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=dew_point_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
+	queue_foreach(chars, count_handles, &num_handles);
 
+	return num_handles;
 }
 
+/*
+*   This Functions populate the gatt data base with the ESS service and   *
+*   only the characteristics listed in the profile, the service reserves  *
+*   exactly the number of handles those characteristics need. A non zero  *
+*   handle places the service there, which is how a reload keeps the      *
+*   handles of the characteristics it did not change                      *
+*/
 
-static bool dew_point_time_calculation(void *user_data)
+static struct gatt_db_attribute *add_environmental_service(
+						struct gatt_db *db,
+						struct queue *chars,
+						uint16_t handle)
 {
+	struct gatt_db_attribute *service;
+	unsigned int num_handles = ess_service_num_handles(chars);
+	uint16_t start;
+	bt_uuid_t uuid;
 
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-
-	
+	if (num_handles > UINT16_MAX - 32) {
+		ess_error("Profile needs too many handles: %u\n",
+								num_handles);
+		return NULL;
+	}
 
-		
-	pdu=rand();
+	/*  Adding ESS service as primary service  */
 
-	bt_gatt_server_send_notification(server->gatt,dew_point_db->dew_point_handle,
-						(uint8_t *)&pdu, 1);
+	bt_uuid16_create(&uuid, UUID_ESS_SERVICE);
+	if (handle)
+		service = gatt_db_insert_service(db, handle, &uuid, true,
+								num_handles);
+	else
+		service = gatt_db_add_service(db, &uuid, true, num_handles);
+	if (!service)
+		return NULL;
 
-	return true;
-}
+	gatt_db_attribute_get_service_handles(service, &start, NULL);
 
+	if (!ess_attrs_reset(start, num_handles)) {
+		gatt_db_remove_service(db, service);
+		return NULL;
+	}
 
-static bool dew_point_value_calculation(void *user_data)
-{
+	queue_foreach(chars, populate_char, service);
 
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-	uint8_t notify=true;
+	/* activating the ESS service all the characteristic and descriptor */
 
-	
+	gatt_db_service_set_active(service, true);
 
-		
-	pdu=rand();
+	return service;
+}
 
+/* Build the attribute database from the profile, shared by every connection */
 
+static bool gatt_db_setup(void)
+{
+	struct ess_mem_probe probe;
 
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(dew_point_db->dew_point_tr->condition){
+	ess_heap_check();
+	ess_mem_probe_start(&probe);
 
-		case 0x03 : if( pdu == dew_point_db->dew_point_data)
-				notify=false;
-			    else
-			    	dew_point_db->dew_point_data= pdu;
-			    break;
+	gatt_db = gatt_db_new();
+	if (!gatt_db)
+		return false;
 
-		case 0x04 : if( pdu >= dew_point_db->tr_value)
-				notify=false;
-			    break;
+	if (profile_path)
+		ess_chars = ess_profile_load(profile_path);
+	else
+		ess_chars = ess_profile_default();
 
-		case 0x05 : if( pdu > dew_point_db->tr_value)
-				notify=false;
-			    break;
+	populate_gatt_service(gatt_db);
+	populate_gap_service(gatt_db);
+	populate_devinfo_service(gatt_db);
 
-		case 0x06 : if( pdu <= dew_point_db->tr_value)
-				notify=false;
-			    break;
+	/* ESS goes last so a reload can grow it without moving anything */
 
-		case 0x07 : if( pdu < dew_point_db->tr_value)
-				notify=false;
-			    break;
+	if (ess_chars)
+		ess_service = add_environmental_service(gatt_db, ess_chars, 0);
 
-		case 0x08 : if( pdu != dew_point_db->tr_value)
-				notify=false;
-			    break;
+	if (!ess_service) {
+		ess_error("Failed to populate ESS service\n");
+		ess_profile_free(ess_chars);
+		ess_chars = NULL;
+		gatt_db_unref(gatt_db);
+		gatt_db = NULL;
+		return false;
+	}
 
-		default   : if( pdu == dew_point_db->tr_value)
-				notify=false;
+	gatt_cache = gatt_db_new();
 
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,dew_point_db->dew_point_handle,
-						(uint8_t *)&pdu, 1);
+	conn_list = queue_new();
+	if (!conn_list) {
+		ess_profile_free(ess_chars);
+		ess_chars = NULL;
+		ess_service = NULL;
+		gatt_db_unref(gatt_db);
+		gatt_db = NULL;
+		return false;
 	}
 
+	gatt_db_mem = ess_mem_probe_end(&probe);
+	ess_mem_charge(ESS_MEM_SHARED, gatt_db_mem);
+
 	return true;
 }
 
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_dew_point_timer(struct gatt_conn *server)
+static void gatt_db_cleanup(void)
 {
-	
-	unsigned int timer;
+	queue_destroy(conn_list, gatt_conn_destroy);
+	conn_list = NULL;
 
-	dew_point_db->g_current_timer=((dew_point_db->dew_point_tr->data[0]) | (dew_point_db->dew_point_tr->data[1]<<8) | (dew_point_db->dew_point_tr->data[2]<<16));
+	if (tick_id) {
+		ess_clock_tick_remove(tick_id);
+		tick_id = 0;
+	}
 
+	ess_profile_free(ess_chars);
+	ess_chars = NULL;
+	ess_service = NULL;
+	ess_attrs_free();
 
-	if(!dew_point_db->dew_point_enable || dew_point_db->dew_point_tr->trigger_inactive){
-	timeout_remove(dew_point_db->timeout_id);
-	return;
-	}
-	
-	timer=dew_point_db->g_current_timer*1000;
-	
+	gatt_db_unref(gatt_cache);
+	gatt_cache = NULL;
 
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
+	gatt_db_unref(gatt_db);
+	gatt_db = NULL;
 
- 
-	if(dew_point_db->dew_point_tr->time_enable)   
-	dew_point_db->timeout_id=timeout_add(timer,dew_point_time_calculation,server,NULL);
-	else
-	dew_point_db->timeout_id=timeout_add(1000,dew_point_value_calculation,server,NULL);
-	
+	ess_mem_charge(ESS_MEM_SHARED, -gatt_db_mem);
+	gatt_db_mem = 0;
 }
 
+/* An instance is kept across a reload when it sits on the same handles */
 
-static void dew_point_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static bool ess_char_same_layout(const struct ess_char *old,
+					const struct ess_char *chr)
 {
+	return old->type == chr->type && old->instance == chr->instance &&
+			old->es_config_enable == chr->es_config_enable &&
+			old->num_triggers == chr->num_triggers;
+}
 
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
+/* The new instance takes over the value and subscription of the old one */
 
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+static void ess_char_keep(struct ess_char *chr, struct ess_char *old)
+{
+	int32_t value[ESS_MAX_AXES];
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
+	ess_state_get(ess_state.value, old->id, value);
+	ess_state_set(ess_state.value, chr->id, value);
+	chr->sampled = old->sampled;
+	chr->source.rng = old->source.rng;
+	chr->stats = old->stats;
+	chr->age = old->age;
+	old->age = NULL;
+
+	/* the subscriptions of every connection */
+	if (!(ess_state.flags[chr->id] & ESS_STATE_INACTIVE)) {
+		ess_state.flags[chr->id] |= ess_state.flags[old->id] &
+							ESS_STATE_ENABLE;
+		ess_state.ccc[chr->id] = ess_state.ccc[old->id];
 	}
 
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || dew_point_db->dew_point_tr->trigger_inactive)
-		dew_point_db->dew_point_enable = false;
-	else if (value[0] == 0x01) {
-		dew_point_db->dew_point_enable = true;
-		dew_point_db->indication = 0x0001;
-	} else
-		error = 0x80;
+	update_char_timer(chr);
+}
 
-	/* updating a timer function to call notification on a periodic interval */
+static void send_service_changed(void *data, void *user_data)
+{
+	struct gatt_conn *conn = data;
 
-	update_dew_point_timer(server);
+	if (!conn->svc_chngd_enabled)
+		return;
 
- done:
+	bt_gatt_server_send_indication(conn->gatt, svc_chngd_handle,
+					user_data, 4, NULL, NULL, NULL);
+}
 
-	gatt_db_attribute_write_result(attrib, id, error);
+/* The run of changed handles being collected, and how many were reported */
 
-}
+struct reload_range {
+	uint16_t start;
+	uint16_t end;
+	unsigned int runs;
+};
 
-static void dew_point_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
+static void reload_range_flush(struct reload_range *range)
 {
-	uint8_t error,len;
-	uint8_t val[4];
+	uint8_t value[4];
 
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=dew_point_db->dew_point_tr->condition;
+	if (!range->start)
+		return;
 
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = dew_point_db->dew_point_tr->data[0];
-		val[2] = dew_point_db->dew_point_tr->data[1];
-		val[3] = dew_point_db->dew_point_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else{
-		error=0;
-		val[1]=(uint8_t)dew_point_db->tr_value;
-		len=2;
-	}
-	
+	ess_info("Handles 0x%04x-0x%04x changed\n", range->start, range->end);
+
+	put_le16(range->start, &value[0]);
+	put_le16(range->end, &value[2]);
 
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
+	queue_foreach(conn_list, send_service_changed, value);
 
+	range->start = 0;
+	range->end = 0;
+	range->runs++;
 }
 
+/* Ranges come in order of their start, touching ones make a single run */
 
-static void dew_point_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+static void reload_range_add(struct reload_range *range, uint16_t start,
+								uint16_t end)
 {
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		dew_point_db->dew_point_tr->trigger_inactive=false;
-		dew_point_db->dew_point_tr->data[0] = value[1];		/* if trigger is time based  */
-		dew_point_db->dew_point_tr->data[1] = value[2];
-		dew_point_db->dew_point_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		dew_point_db->dew_point_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		dew_point_db->dew_point_tr->trigger_inactive=true;
-		if(dew_point_db->timeout_id!=0){
-			timeout_remove(dew_point_db->timeout_id);
-			dew_point_db->dew_point_enable = false;
-			dew_point_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		dew_point_db->dew_point_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else{
-		if(len!=2){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		dew_point_db->dew_point_tr->trigger_inactive=false;		/* if trigger is value based */
-		dew_point_db->tr_value=value[1];
-		
+	if (range->start && start <= range->end + 1) {
+		if (end > range->end)
+			range->end = end;
+		return;
 	}
 
-	dew_point_db->dew_point_tr->condition=value[0] ;
-	
+	reload_range_flush(range);
 
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( dew_point_db->dew_point_tr->condition==0x01 || dew_point_db->dew_point_tr->condition==0x02){
-		dew_point_db->dew_point_tr->value_enable=false;
-		dew_point_db->dew_point_tr->time_enable=true;
-	} else if( dew_point_db->dew_point_tr->condition>=0x03 && dew_point_db->dew_point_tr->condition<= 0x09){
-		dew_point_db->dew_point_tr->time_enable=false;
-		dew_point_db->dew_point_tr->value_enable=true;
-		if(dew_point_db->dew_point_enable && !dew_point_db->dew_point_tr->trigger_inactive){
-			timeout_remove(dew_point_db->timeout_id);
-			update_dew_point_timer(conn);
-		}	
-	} else{	
-
-		dew_point_db->dew_point_tr->trigger_inactive=true;
-		dew_point_db->dew_point_tr->time_enable=false;
-		dew_point_db->dew_point_tr->value_enable=false;
-		if(dew_point_db->dew_point_enable && !dew_point_db->dew_point_tr->trigger_inactive){
-			timeout_remove(dew_point_db->timeout_id);
-			update_dew_point_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(dew_point_db->dew_point_tr->time_enable)
-	dew_point_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
+	range->start = start;
+	range->end = end;
+}
 
+/*
+*** Walk the old and the new instances in handle order. Instances starting  ***
+*** on the same handle with the same layout are kept, every other run of    ***
+*** handles they cover is reported by a Service Changed of its own          ***
+*/
 
-	if(dew_point_db->g_update_timer!=dew_point_db->g_current_timer && dew_point_db->dew_point_tr->time_enable){
-		timeout_remove(dew_point_db->timeout_id);
-		update_dew_point_timer(conn);
-	}
-	
+static void ess_reload_diff(struct queue *chars, uint16_t start,
+						struct reload_range *range)
+{
+	const struct queue_entry *old = queue_get_entries(ess_chars);
+	const struct queue_entry *new = queue_get_entries(chars);
+	unsigned int old_handle = start + 1, new_handle = start + 1;
 
-done :
+	while (old || new) {
+		unsigned int old_num = old ? ess_char_num_handles(old->data) : 0;
+		unsigned int new_num = new ? ess_char_num_handles(new->data) : 0;
 
-	gatt_db_attribute_write_result(attrib, id, error);
+		if (old && new && old_handle == new_handle) {
+			if (ess_char_same_layout(old->data, new->data))
+				ess_char_keep(new->data, old->data);
+			else
+				reload_range_add(range, old_handle,
+					old_handle + (old_num > new_num ?
+						old_num : new_num) - 1);
 
+			old_handle += old_num;
+			new_handle += new_num;
+			old = old->next;
+			new = new->next;
+		} else if (old && (!new || old_handle < new_handle)) {
+			reload_range_add(range, old_handle,
+						old_handle + old_num - 1);
+			old_handle += old_num;
+			old = old->next;
+		} else {
+			reload_range_add(range, new_handle,
+						new_handle + new_num - 1);
+			new_handle += new_num;
+			new = new->next;
+		}
+	}
 }
 
 /*
-*** This section cocnsist of all the call backs of ***
-*** Elevation characteristics                      ***
+*   Reload the profile of a running server. The ESS service is rebuilt on  *
+*   its old start handle, instances which did not change keep their        *
+*   handles, values and subscriptions, and connected clients are told to   *
+*   rediscover only the handles that did change                            *
 */
 
-static void elevation_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void server_reload(void)
 {
+	struct gatt_db_attribute *service;
+	struct reload_range range = { 0, 0, 0 };
+	struct queue *chars;
+	unsigned int num_handles;
+	uint16_t start, old_end, new_end;
 
-	uint8_t error=0;
-	int32_t value;
+	if (!ess_service)
+		return;
 
-	value=elevation_db->elevation_data;
+	if (profile_path)
+		chars = ess_profile_load(profile_path);
+	else
+		chars = ess_profile_default();
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 3);
+	if (!chars) {
+		ess_error("Reload failed, keeping current profile\n");
+		return;
+	}
 
-}
+	gatt_db_attribute_get_service_handles(ess_service, &start, &old_end);
 
+	num_handles = ess_service_num_handles(chars);
+	if (start + num_handles - 1 > UINT16_MAX) {
+		ess_error("Reload failed, too many handles\n");
+		ess_profile_free(chars);
+		return;
+	}
 
-static void elevation_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
+	new_end = start + num_handles - 1;
 
-	uint8_t error=0,value[11];
+	gatt_db_remove_service(gatt_db, ess_service);
 
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = elevation_db->elevation_ms->sample;
-	value[3] = elevation_db->elevation_ms->m_period[0];
-	value[4] = elevation_db->elevation_ms->m_period[1];
-	value[5] = elevation_db->elevation_ms->m_period[2];
-	value[6] = elevation_db->elevation_ms->u_interval[0];
-	value[7] = elevation_db->elevation_ms->u_interval[1];
-	value[8] = elevation_db->elevation_ms->u_interval[2];
-	value[9] = elevation_db->elevation_ms->applicatn;
-	value[10] = elevation_db->elevation_ms->m_uncertainity;
+	service = add_environmental_service(gatt_db, chars, start);
+	if (!service) {
+		ess_error("Reload failed, restoring current profile\n");
+		ess_profile_free(chars);
+		ess_service = add_environmental_service(gatt_db, ess_chars,
+									start);
+		if (!ess_service) {
+			ess_error("Failed to restore ESS service, exiting\n");
+			mainloop_quit();
+		}
+		return;
+	}
 
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+	/* the service declaration covers a different group now */
+	if (new_end != old_end)
+		reload_range_add(&range, start, start);
 
-}	
+	/* state moves only now, the old instances are kept on failure */
+	ess_reload_diff(chars, start, &range);
+	reload_range_flush(&range);
 
+	/* queued notifications point at the instances going away */
+	queue_foreach(conn_list, flush_conn, NULL);
 
-static void elevation_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
+	ess_profile_free(ess_chars);
+	ess_chars = chars;
+	ess_service = service;
 
-	uint8_t error=0;
-	int8_t value[2][3];
+	if (!range.runs) {
+		ess_info("Profile reloaded, no attribute changed\n");
+		return;
+	}
 
-	value[0][0]=elevation_db->lower_elevation[0];
-	value[0][1]=elevation_db->upper_elevation[1];
-	value[0][2]=elevation_db->upper_elevation[2];
-	value[1][0]=elevation_db->lower_elevation[0];
-	value[1][1]=elevation_db->upper_elevation[1];
-	value[1][2]=elevation_db->upper_elevation[2];
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 6);
+	ess_info("Profile reloaded, %u handle ranges changed\n", range.runs);
 
+	db_hash_valid = false;
 }
 
+/* A reload allocates the way startup does */
 
-static void elevation_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+void gatt_server_reload(void)
 {
+	bool sealed = ess_arena_sealed();
+	struct ess_mem_probe probe;
+	int64_t delta;
+
+	ess_mem_probe_start(&probe);
+	ess_arena_seal(false);
+	server_reload();
+	ess_arena_seal(sealed);
+
+	/* indications of Service Changed still queued are counted too */
+	delta = ess_mem_probe_end(&probe);
+	gatt_db_mem += delta;
+	ess_mem_charge(ESS_MEM_SHARED, delta);
+}
 
-	uint8_t error=0;
-	wchar_t *value;
+/*
+*   A value handed over by the application (see publish.h), on the        *
+*   mainloop. It becomes the source of the instance and is what the next  *
+*   tick samples, so triggers and notifications work as for any other     *
+*   source. An instance nobody is subscribed to is not sampled at all,     *
+*   its value is updated right away for reads.                             *
+*/
 
-	value=elevation_db->user_desc;
+struct publish_match {
+	uint16_t uuid;
+	uint16_t instance;
+};
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
+static bool match_char_instance(const void *data, const void *match_data)
+{
+	const struct ess_char *chr = data;
+	const struct publish_match *match = match_data;
 
+	return chr->type->uuid == match->uuid &&
+					chr->instance == match->instance;
 }
 
-
-static void elevation_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+bool gatt_server_publish(uint16_t uuid, uint16_t instance,
+				const int32_t *value, uint64_t timestamp)
 {
+	struct publish_match match = { uuid, instance };
+	struct ess_source *src;
+	struct ess_char *chr;
+	int i;
 
-	uint8_t error;
+	chr = queue_find(ess_chars, match_char_instance, &match);
+	if (!chr)
+		return false;
 
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+	/* instances with a source of their own are not fed */
+	src = &chr->source;
+	if (src->type != ESS_SOURCE_PUBLISH)
+		return false;
 
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+	src->published = timestamp ? timestamp : ess_clock_now();
+
+	for (i = 0; i < chr->type->axes; i++)
+		src->value[i] = value[i];
+
+	if (!(ess_state.flags[chr->id] & ESS_STATE_ENABLE)) {
+		ess_state_set(ess_state.value, chr->id, src->value);
+		chr->sampled = src->published;
 	}
 
-	/* initializing the string with zero's and then copying the new string to the data base */
+	return true;
+}
 
-	memset(elevation_db->user_desc,0,21);
-	memcpy(elevation_db->user_desc,value,len+1);
+/*
+*   Serve an already connected ATT socket, e.g. one end of a socketpair   *
+*   used by the benchmark. On failure the caller still owns the socket.   *
+*/
 
-done :
+/* The database served to every connection, set up on first use */
 
-	gatt_db_attribute_write_result(attrib, id, error);
+struct gatt_db *gatt_server_get_db(void)
+{
+	if (!gatt_db && !gatt_db_setup())
+		return NULL;
 
+	return gatt_db;
 }
 
-static void elevation_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
+bool gatt_server_attach(int fd)
 {
+	struct gatt_conn *conn;
 
-	uint8_t error;
-	static uint16_t value;
+	if (!gatt_db && !gatt_db_setup())
+		return false;
 
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=elevation_db->indication;
-	}
+	conn = gatt_conn_new(fd, 0);
+	if (!conn)
+		return false;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
+	if (!queue_push_tail(conn_list, conn)) {
+		ess_error("Failed to add GATT connection\n");
+		bt_att_set_close_on_unref(conn->att, false);
+		gatt_conn_destroy(conn);
+		return false;
+	}
 
+	return true;
 }
 
-
-static bool elevation_time_calculation(void *user_data)
+void gatt_server_start(void)
 {
+	struct sockaddr_l2 addr;
 
-	struct gatt_conn *server=user_data;
-	int32_t pdu;
-
-	
-
-		
-	pdu=rand();
+	if (att_fd >= 0)
+		return;
 
-	bt_gatt_server_send_notification(server->gatt,elevation_db->elevation_handle,
-						(uint8_t *)&pdu, 3);
+	att_fd = socket(PF_BLUETOOTH, SOCK_SEQPACKET | SOCK_CLOEXEC,
+			BTPROTO_L2CAP);
+	if (att_fd < 0) {
+		ess_error("Failed to create ATT server socket: %m\n");
+		return;
+	}
 
-	return true;
-}
+	memset(&addr, 0, sizeof(addr));
+	addr.l2_family = AF_BLUETOOTH;
+	addr.l2_cid = htobs(ATT_CID);
+	memcpy(&addr.l2_bdaddr, public_addr, 6);
+	addr.l2_bdaddr_type = BDADDR_LE_PUBLIC;
 
+	if (bind(att_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		ess_error("Failed to bind ATT server socket: %m\n");
+		close(att_fd);
+		att_fd = -1;
+		return;
+	}
 
-static bool elevation_value_calculation(void *user_data)
-{
+	if (listen(att_fd, 1) < 0) {
+		ess_error("Failed to listen on ATT server socket: %m\n");
+		close(att_fd);
+		att_fd = -1;
+		return;
+	}
 
-	struct gatt_conn *server=user_data;
-	int32_t pdu;
-	uint8_t notify=true;
+	if (!gatt_db && !gatt_db_setup()) {
+		close(att_fd);
+		att_fd = -1;
+		return;
+	}
 
-	
+	mainloop_add_fd(att_fd, EPOLLIN, att_conn_callback, NULL, NULL);
 
-		
-	pdu=rand();
+	/* from here on the sample runs on what it has */
+	ess_arena_seal(true);
+}
 
+void gatt_server_stop(void)
+{
+	if (att_fd < 0 && !gatt_db)
+		return;
 
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(elevation_db->elevation_tr->condition){
+	if (att_fd >= 0) {
+		mainloop_remove_fd(att_fd);
+		close(att_fd);
+		att_fd = -1;
+	}
 
-		case 0x03 : if( pdu == elevation_db->elevation_data)
-				notify=false;
-			    else
-			    	elevation_db->elevation_data= pdu;
-			    break;
+	gatt_db_cleanup();
+}
 
-		case 0x04 : if( pdu >= elevation_db->tr_value)
-				notify=false;
-			    break;
+static void collect_char(void *data, void *user_data)
+{
+	struct ess_char *chr = data;
+	struct metrics_buf *buf = user_data;
+	char labels[96];
+	unsigned int stage;
 
-		case 0x05 : if( pdu > elevation_db->tr_value)
-				notify=false;
-			    break;
+	snprintf(labels, sizeof(labels),
+			"handle=\"0x%04x\",type=\"%s\",instance=\"%u\"",
+			chr->handle, chr->type->name, chr->instance);
 
-		case 0x06 : if( pdu <= elevation_db->tr_value)
-				notify=false;
-			    break;
+	metrics_put(buf, METRIC_READS, chr->handle, labels, chr->stats.reads);
+	metrics_put(buf, METRIC_WRITES, chr->handle, labels,
+							chr->stats.writes);
+	metrics_put(buf, METRIC_NOTIFICATIONS, chr->handle, labels,
+						chr->stats.notifications);
+	metrics_put(buf, METRIC_SUPPRESSED, chr->handle, labels,
+						chr->stats.suppressed);
+	metrics_put(buf, METRIC_SEND_FAILURES, chr->handle, labels,
+						chr->stats.send_failures);
+	metrics_put(buf, METRIC_DAMPED, chr->handle, labels,
+						chr->stats.damped);
+	metrics_put(buf, METRIC_REPLACED, chr->handle, labels,
+						chr->stats.replaced);
 
-		case 0x07 : if( pdu < elevation_db->tr_value)
-				notify=false;
-			    break;
+	if (ess_mem_enabled)
+		metrics_put(buf, METRIC_CHAR_MEMORY, chr->handle, labels,
+							ess_char_mem(chr));
 
-		case 0x08 : if( pdu != elevation_db->tr_value)
-				notify=false;
-			    break;
+	if (!chr->age)
+		return;
 
-		default   : if( pdu == elevation_db->tr_value)
-				notify=false;
+	for (stage = 0; stage < ESS_STAGE_MAX; stage++) {
+		if (!chr->age[stage].count)
+			continue;
 
+		metrics_put_hist(buf, METRIC_AGE_SCHED + stage, chr->handle,
+						labels, &chr->age[stage]);
 	}
-	
-	/* notify only if its satisfying the trigger condition 	*/		
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,elevation_db->elevation_handle,
-						(uint8_t *)&pdu, 3);
-	}
-
-	return true;
 }
 
- /*Timer function will read the trigger setting and call a function to send notification based on value or time */
+/*
+*   Metrics collector. Everything is read at scrape time, the queue depth  *
+*   of a connection is what the kernel still holds in its send queue.      *
+*/
 
-static void update_elevation_timer(struct gatt_conn *server)
+void gatt_server_collect(struct metrics_buf *buf)
 {
-	
-	unsigned int timer;
+	const struct queue_entry *entry;
+	uint16_t index = 0;
 
-	elevation_db->g_current_timer=((elevation_db->elevation_tr->data[0]) | (elevation_db->elevation_tr->data[1]<<8) | (elevation_db->elevation_tr->data[2]<<16));
+	queue_foreach(ess_chars, collect_char, buf);
 
+	metrics_put(buf, METRIC_CONNECTIONS, 0, NULL, queue_length(conn_list));
+	metrics_put_hist(buf, METRIC_CONN_ACCEPT, 0, NULL, &conn_accept);
+	metrics_put_hist(buf, METRIC_CONN_SETUP, 0, NULL, &conn_setup);
 
-	if(!elevation_db->elevation_enable || elevation_db->elevation_tr->trigger_inactive){
-	timeout_remove(elevation_db->timeout_id);
-	return;
-	}
-	
-	timer=elevation_db->g_current_timer*1000;
-	
-
-	/*
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(elevation_db->elevation_tr->time_enable)   
-	elevation_db->timeout_id=timeout_add(timer,elevation_time_calculation,server,NULL);
-	else
-	elevation_db->timeout_id=timeout_add(1000,elevation_value_calculation,server,NULL);
-	
-}
+	for (entry = queue_get_entries(conn_list); entry;
+					entry = entry->next, index++) {
+		struct gatt_conn *conn = entry->data;
+		char labels[32];
+		int pending = 0;
 
+		snprintf(labels, sizeof(labels), "conn=\"%u\"", index);
 
-static void elevation_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
+		/* a measured figure may come out slightly below zero */
+		if (ess_mem_enabled)
+			metrics_put(buf, METRIC_CONN_MEMORY, index, labels,
+					conn_arena.size + (conn->mem > 0 ?
+							conn->mem : 0));
 
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
+		metrics_put(buf, METRIC_CONN_PENDING, index, labels,
+							conn->sched.len);
 
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+		if (ioctl(bt_att_get_fd(conn->att), TIOCOUTQ, &pending) < 0)
+			continue;
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
+		metrics_put(buf, METRIC_CONN_QUEUE, index, labels, pending);
 	}
-
-	/*enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || elevation_db->elevation_tr->trigger_inactive)
-		elevation_db->elevation_enable = false;
-	else if (value[0] == 0x01) {
-		elevation_db->elevation_enable = true;
-		elevation_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/*updating a timer function to call notification on a periodic interval */
-
-	update_elevation_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
 }
 
-static void elevation_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=elevation_db->elevation_tr->condition;
+/*
+*** Live upgrade. The running process sends its listening socket, every    ***
+*** connected ATT socket and the runtime state of every instance over a    ***
+*** unix socket (SCM_RIGHTS), the new process rebuilds its connections     ***
+*** around the inherited sockets and acknowledges. Until the ack arrives   ***
+*** the old process keeps every socket, so a failed upgrade changes nothing ***
+*/
 
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = elevation_db->elevation_tr->data[0];
-		val[2] = elevation_db->elevation_tr->data[1];
-		val[3] = elevation_db->elevation_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else {
-		error=0;
-		val[1]=(uint8_t)elevation_db->tr_value;
-		val[2]=(uint8_t)(elevation_db->tr_value>>8);
-		val[3]=(uint8_t)(elevation_db->tr_value>>16);
-		len=4;
+#define HANDOVER_MAGIC		0x45535348
+#define HANDOVER_VERSION	4
+#define HANDOVER_TIMEOUT	5
+
+struct handover_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t num_chars;
+	uint16_t num_conns;
+	uint32_t tick_count;
+} __attribute__ ((packed));
+
+/* a trigger setting after the first one */
+
+struct handover_trigger {
+	uint8_t condition;
+	uint8_t data[3];
+	int32_t threshold[ESS_MAX_AXES];
+} __attribute__ ((packed));
+
+struct handover_char {
+	uint16_t uuid;
+	uint16_t instance;
+	uint8_t es_config_enable;
+	uint8_t es_config;
+	int32_t value[ESS_MAX_AXES];
+	int32_t tr_value[ESS_MAX_AXES];
+	uint8_t condition;
+	uint8_t data[3];
+	int32_t remaining;
+	/* bit n for the n-th connection handed over */
+	uint64_t ccc;
+	char user_desc[ESS_USER_DESC_LEN + 1];
+	uint8_t num_triggers;
+	struct handover_trigger triggers[ESS_MAX_TRIGGERS - 1];
+	uint32_t hysteresis;
+	uint32_t deadband;
+} __attribute__ ((packed));
+
+struct handover_conn {
+	uint16_t mtu;
+	uint8_t svc_chngd_enabled;
+} __attribute__ ((packed));
+
+static bool handover_send(int sk, const void *data, size_t len, int fd)
+{
+	union {
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} ctrl;
+	struct msghdr msg;
+	struct iovec iov;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = (void *) data;
+	iov.iov_len = len;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+
+	if (fd >= 0) {
+		struct cmsghdr *cmsg;
+
+		memset(&ctrl, 0, sizeof(ctrl));
+		msg.msg_control = ctrl.buf;
+		msg.msg_controllen = sizeof(ctrl.buf);
+
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	}
+
+	return sendmsg(sk, &msg, MSG_NOSIGNAL) == (ssize_t) len;
+}
+
+static bool handover_recv(int sk, void *data, size_t len, int *fd)
+{
+	union {
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} ctrl;
+	struct cmsghdr *cmsg;
+	struct msghdr msg;
+	struct iovec iov;
+	ssize_t n;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = data;
+	iov.iov_len = len;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctrl.buf;
+	msg.msg_controllen = sizeof(ctrl.buf);
+
+	n = recvmsg(sk, &msg, MSG_CMSG_CLOEXEC);
+
+	if (fd)
+		*fd = -1;
+
+	for (cmsg = CMSG_FIRSTHDR(&msg); n >= 0 && cmsg;
+					cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		int rfd;
+
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+					cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		memcpy(&rfd, CMSG_DATA(cmsg), sizeof(int));
+
+		if (fd && *fd < 0)
+			*fd = rfd;
+		else
+			close(rfd);
+	}
+
+	if (n != (ssize_t) len || (msg.msg_flags & MSG_CTRUNC)) {
+		if (fd && *fd >= 0) {
+			close(*fd);
+			*fd = -1;
+		}
+		return false;
 	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
 
+	return true;
 }
 
-
-static void elevation_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+static void handover_set_timeout(int sk)
 {
+	struct timeval tv = { HANDOVER_TIMEOUT, 0 };
 
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	 /*checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		elevation_db->elevation_tr->trigger_inactive=false;
-		elevation_db->elevation_tr->data[0] = value[1];		 /*if trigger is time based  */
-		elevation_db->elevation_tr->data[1] = value[2];
-		elevation_db->elevation_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		elevation_db->elevation_tr->condition = value[0] ;	 /*if trigger is inactive check notification is enable if yes disable the 												notification */
-		elevation_db->elevation_tr->trigger_inactive=true;
-		if(elevation_db->timeout_id!=0){
-			timeout_remove(elevation_db->timeout_id);
-			elevation_db->elevation_enable = false;
-			elevation_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03) {
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		elevation_db->elevation_tr->trigger_inactive=false;		 /*if trigger is value based */
-	} else {
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		elevation_db->elevation_tr->trigger_inactive=false;		 /*if trigger is value based */
-		elevation_db->tr_value=value[1] | value[2]<<8 | value[3]<<16 | 0<<24;
-		
-	}
-
-	elevation_db->elevation_tr->condition=value[0] ;
-	
+	setsockopt(sk, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(sk, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
 
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
+/* The subscribers of an instance by their position in the handover */
 
-	if( elevation_db->elevation_tr->condition==0x01 || elevation_db->elevation_tr->condition==0x02){
-		elevation_db->elevation_tr->value_enable=false;
-		elevation_db->elevation_tr->time_enable=true;
-	} else if( elevation_db->elevation_tr->condition>=0x03 && elevation_db->elevation_tr->condition<= 0x09){
-		elevation_db->elevation_tr->time_enable=false;
-		elevation_db->elevation_tr->value_enable=true;
-		if(elevation_db->elevation_enable && !elevation_db->elevation_tr->trigger_inactive){
-			timeout_remove(elevation_db->timeout_id);
-			update_elevation_timer(conn);
-		}	
-	} else{	
-
-		elevation_db->elevation_tr->trigger_inactive=true;
-		elevation_db->elevation_tr->time_enable=false;
-		elevation_db->elevation_tr->value_enable=false;
-		if(elevation_db->elevation_enable && !elevation_db->elevation_tr->trigger_inactive){
-			timeout_remove(elevation_db->timeout_id);
-			update_elevation_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(elevation_db->elevation_tr->time_enable)
-	elevation_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
+static uint64_t handover_ccc(const struct ess_char *chr)
+{
+	const struct queue_entry *entry;
+	uint64_t ccc = 0;
+	unsigned int n = 0;
 
+	for (entry = queue_get_entries(conn_list); entry;
+						entry = entry->next, n++) {
+		const struct gatt_conn *conn = entry->data;
 
-	if(elevation_db->g_update_timer!=elevation_db->g_current_timer && elevation_db->elevation_tr->time_enable){
-		timeout_remove(elevation_db->timeout_id);
-		update_elevation_timer(conn);
+		if (ess_state.ccc[chr->id] & (1ull << conn->slot))
+			ccc |= 1ull << n;
 	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
 
+	return ccc;
 }
 
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Gust Factor characteristics                    ***
-*/
-
-
-static void gust_factor_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void handover_trigger_set(struct handover_trigger *tr,
+				const struct ess_trigger_setting *setting)
 {
+	int i;
 
-	uint8_t error=0,value;
-
-	value=heat_index_db->heat_index_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, &value, 1);
-
+	tr->condition = setting->condition;
+	tr->data[0] = setting->interval;
+	tr->data[1] = setting->interval >> 8;
+	tr->data[2] = setting->interval >> 16;
+	for (i = 0; i < ESS_MAX_AXES; i++)
+		tr->threshold[i] = setting->threshold[i];
 }
 
+/*
+ * The new process acknowledges once it runs on the inherited sockets. The
+ * wait is a watch on the mainloop, but nothing is read from the sockets
+ * after the state went out: a write accepted meanwhile would be lost and
+ * both processes would answer the same PDUs. The connections are closed
+ * down to their sockets and set up again from what was sent if the new
+ * process rejects the upgrade.
+ */
 
-static void gust_factor_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
+struct handover_held {
+	int fd;
+	unsigned int slot;
+	struct handover_conn rec;
+};
 
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = gust_factor_db->gust_factor_ms->sample;
-	value[3] = gust_factor_db->gust_factor_ms->m_period[0];
-	value[4] = gust_factor_db->gust_factor_ms->m_period[1];
-	value[5] = gust_factor_db->gust_factor_ms->m_period[2];
-	value[6] = gust_factor_db->gust_factor_ms->u_interval[0];
-	value[7] = gust_factor_db->gust_factor_ms->u_interval[1];
-	value[8] = gust_factor_db->gust_factor_ms->u_interval[2];
-	value[9] = gust_factor_db->gust_factor_ms->applicatn;
-	value[10] = gust_factor_db->gust_factor_ms->m_uncertainity;
+ESS_ARENA(held_arena, struct handover_held, ESS_STATIC_CONNS, ESS_MEM_CONNS);
 
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
+static int handover_sk = -1;
+static unsigned int handover_timeout_id = 0;
+static struct queue *handover_conns = NULL;
+static gatt_handover_func_t handover_func = NULL;
+static void *handover_data = NULL;
 
+static void handover_held_free(void *data)
+{
+	ess_arena_free(&held_arena, data);
 }
 
-
-
-static void gust_factor_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void handover_resume(void *data)
 {
+	struct handover_held *held = data;
+	struct gatt_conn *conn;
 
-	uint8_t error=0;
-	uint8_t value[2];
-
-	value[0]=gust_factor_db->lower_gust_factor;
-	value[1]=gust_factor_db->upper_gust_factor;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
+	/* the subscriptions follow if it gets another slot */
+	conn_slots &= ~(1ull << held->slot);
+
+	conn = gatt_conn_new(held->fd, held->rec.mtu);
+	if (!conn || !queue_push_tail(conn_list, conn)) {
+		ess_error("Failed to resume GATT connection\n");
+		if (conn)
+			gatt_conn_destroy(conn);
+		else
+			close(held->fd);
+		conn_slot_release(held->slot);
+	} else {
+		conn->svc_chngd_enabled = held->rec.svc_chngd_enabled;
+		if (conn->slot != held->slot)
+			conn_ccc_move(held->slot, conn->slot);
+	}
 
+	handover_held_free(held);
 }
-	
 
-
-static void gust_factor_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
+static void handover_release(void *data)
 {
+	struct handover_held *held = data;
 
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=gust_factor_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
+	close(held->fd);
+	conn_slot_release(held->slot);
+	handover_held_free(held);
 }
 
-
-static void gust_factor_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
+static void handover_done(bool success)
 {
+	gatt_handover_func_t func = handover_func;
 
-	uint8_t error;
+	mainloop_remove_fd(handover_sk);
+	timeout_remove(handover_timeout_id);
+	handover_sk = -1;
+	handover_timeout_id = 0;
+	handover_func = NULL;
 
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+	if (!success) {
+		ess_error("Upgrade rejected, keeping connections\n");
 
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
+		queue_remove_all(handover_conns, NULL, NULL, handover_resume);
 
-	/* initializing the string with zero's and then copying the new string to the data base */
+		if (att_fd >= 0)
+			mainloop_add_fd(att_fd, EPOLLIN, att_conn_callback,
+								NULL, NULL);
+	} else {
+		/* the new process owns every socket now, stop touching them */
 
-	memset(gust_factor_db->user_desc,0,21);
-	memcpy(gust_factor_db->user_desc,value,len+1);
+		if (att_fd >= 0) {
+			close(att_fd);
+			att_fd = -1;
+		}
 
-done :
+		ess_info("Handed over %u connections\n",
+					queue_length(handover_conns));
 
-	gatt_db_attribute_write_result(attrib, id, error);
+		queue_remove_all(handover_conns, NULL, NULL, handover_release);
+	}
 
+	func(success, handover_data);
 }
 
-static void gust_factor_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
+static void handover_ack(int fd, uint32_t events, void *user_data)
 {
+	uint8_t status;
 
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=gust_factor_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
+	if (!(events & EPOLLIN) || recv(fd, &status, 1, MSG_DONTWAIT) != 1)
+		status = 0x01;
 
+	handover_done(status == 0x00);
 }
 
-
-static bool gust_factor_time_calculation(void *user_data)
+static bool handover_timeout(void *user_data)
 {
+	ess_error("No answer from the new process\n");
 
-	struct gatt_conn *server=user_data;
-	uint8_t pdu;
-
-	
+	handover_timeout_id = 0;
+	handover_done(false);
 
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,gust_factor_db->gust_factor_handle,
-						(uint8_t *)&pdu, 1);
-
-	return true;
+	return false;
 }
 
-
-static bool gust_factor_value_calculation(void *user_data)
+bool gatt_server_handover(int sk, gatt_handover_func_t func,
+							void *user_data)
 {
+	const struct queue_entry *entry;
+	struct handover_hdr hdr;
+	unsigned int k;
+	int i;
 
-	struct gatt_conn *server=user_data;
-	uint8_t pdu;
-	uint8_t notify=true;
+	if (!ess_service || handover_sk >= 0)
+		return false;
 
-	
+	if (!handover_conns) {
+		handover_conns = queue_new();
+		if (!handover_conns)
+			return false;
+	}
 
-		
-	pdu=rand();
+	handover_set_timeout(sk);
 
+	hdr.magic = HANDOVER_MAGIC;
+	hdr.version = HANDOVER_VERSION;
+	hdr.num_chars = queue_length(ess_chars);
+	hdr.num_conns = queue_length(conn_list);
+	hdr.tick_count = tick_count;
 
+	if (!handover_send(sk, &hdr, sizeof(hdr), att_fd))
+		goto fail;
 
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(gust_factor_db->gust_factor_tr->condition){
+	for (entry = queue_get_entries(ess_chars); entry;
+						entry = entry->next) {
+		const struct ess_char *chr = entry->data;
+		struct handover_char rec;
 
-		case 0x03 : if( pdu == gust_factor_db->gust_factor_data)
-				notify=false;
-			    else
-			    	gust_factor_db->gust_factor_data= pdu;
-			    break;
+		memset(&rec, 0, sizeof(rec));
+		rec.uuid = chr->type->uuid;
+		rec.instance = chr->instance;
+		rec.es_config_enable = chr->es_config_enable;
+		rec.es_config = chr->es_config;
+		for (i = 0; i < ESS_MAX_AXES; i++) {
+			rec.value[i] = ess_state.value[i][chr->id];
+			rec.tr_value[i] = ess_state.threshold[i][chr->id];
+		}
+		rec.condition = ess_state.condition[chr->id];
+		rec.data[0] = ess_state.interval[chr->id];
+		rec.data[1] = ess_state.interval[chr->id] >> 8;
+		rec.data[2] = ess_state.interval[chr->id] >> 16;
+		rec.remaining = ess_state.deadline[chr->id] - tick_count;
+		rec.ccc = handover_ccc(chr);
+		memcpy(rec.user_desc, chr->user_desc, sizeof(rec.user_desc));
+		rec.num_triggers = chr->num_triggers;
+		for (k = 1; k < chr->num_triggers; k++)
+			handover_trigger_set(&rec.triggers[k - 1],
+							&chr->triggers[k - 1]);
+		rec.hysteresis = chr->damping.hysteresis;
+		rec.deadband = chr->damping.deadband;
 
-		case 0x04 : if( pdu >= gust_factor_db->tr_value)
-				notify=false;
-			    break;
+		if (!handover_send(sk, &rec, sizeof(rec), -1))
+			goto fail;
+	}
 
-		case 0x05 : if( pdu > gust_factor_db->tr_value)
-				notify=false;
-			    break;
+	for (entry = queue_get_entries(conn_list); entry;
+						entry = entry->next) {
+		struct gatt_conn *conn = entry->data;
+		struct handover_held *held;
 
-		case 0x06 : if( pdu <= gust_factor_db->tr_value)
-				notify=false;
-			    break;
+		held = ess_arena_new(&held_arena);
+		if (!held || !queue_push_tail(handover_conns, held)) {
+			if (held)
+				handover_held_free(held);
+			goto fail;
+		}
 
-		case 0x07 : if( pdu < gust_factor_db->tr_value)
-				notify=false;
-			    break;
+		held->fd = bt_att_get_fd(conn->att);
+		held->slot = conn->slot;
+		held->rec.mtu = bt_att_get_mtu(conn->att);
+		held->rec.svc_chngd_enabled = conn->svc_chngd_enabled;
 
-		case 0x08 : if( pdu != gust_factor_db->tr_value)
-				notify=false;
-			    break;
+		if (!handover_send(sk, &held->rec, sizeof(held->rec),
+								held->fd))
+			goto fail;
+	}
 
-		default   : if( pdu == gust_factor_db->tr_value)
-				notify=false;
+	if (mainloop_add_fd(sk, EPOLLIN, handover_ack, NULL, NULL) < 0)
+		goto fail;
 
+	handover_timeout_id = timeout_add(HANDOVER_TIMEOUT * 1000,
+					handover_timeout, NULL, NULL);
+	if (!handover_timeout_id) {
+		mainloop_remove_fd(sk);
+		goto fail;
 	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,gust_factor_db->gust_factor_handle,
-						(uint8_t *)&pdu, 1);
-	}
-
-	return true;
-}
 
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
+	if (att_fd >= 0)
+		mainloop_remove_fd(att_fd);
 
-static void update_gust_factor_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
+	/* down to the sockets, they stay open for either process */
+	for (entry = queue_get_entries(conn_list); entry;
+						entry = entry->next) {
+		struct gatt_conn *conn = entry->data;
 
-	gust_factor_db->g_current_timer=((gust_factor_db->gust_factor_tr->data[0]) | (gust_factor_db->gust_factor_tr->data[1]<<8) | (gust_factor_db->gust_factor_tr->data[2]<<16));
+		bt_att_set_close_on_unref(conn->att, false);
+	}
 
+	queue_remove_all(conn_list, NULL, NULL, gatt_conn_close);
 
-	if(!gust_factor_db->gust_factor_enable || gust_factor_db->gust_factor_tr->trigger_inactive){
-	timeout_remove(gust_factor_db->timeout_id);
-	return;
-	}
-	
-	timer=gust_factor_db->g_current_timer*1000;
-	
+	handover_sk = sk;
+	handover_func = func;
+	handover_data = user_data;
 
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
+	return true;
 
- 
-	if(gust_factor_db->gust_factor_tr->time_enable)   
-	gust_factor_db->timeout_id=timeout_add(timer,gust_factor_time_calculation,server,NULL);
-	else
-	gust_factor_db->timeout_id=timeout_add(1000,gust_factor_value_calculation,server,NULL);
-	
+fail:
+	ess_error("Failed to send upgrade state: %m\n");
+	queue_remove_all(handover_conns, NULL, NULL, handover_held_free);
+	return false;
 }
 
-
-static void gust_factor_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
+static bool handover_restore_char(struct ess_char *chr,
+					const struct handover_char *rec)
 {
+	struct ess_trigger_setting setting;
+	unsigned int k;
+	int i;
 
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
+	if (rec->uuid != chr->type->uuid || rec->instance != chr->instance ||
+			rec->es_config_enable != chr->es_config_enable ||
+			rec->num_triggers != chr->num_triggers)
+		return false;
 
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		ess_state.value[i][chr->id] = rec->value[i];
+		ess_state.threshold[i][chr->id] = rec->tr_value[i];
 	}
+	memcpy(chr->user_desc, rec->user_desc, ESS_USER_DESC_LEN);
+	chr->es_config = rec->es_config;
 
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
+	ess_state.condition[chr->id] = rec->condition;
+	ess_state.interval[chr->id] = rec->data[0] | (rec->data[1] << 8) |
+						(rec->data[2] << 16);
 
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || gust_factor_db->gust_factor_tr->trigger_inactive)
-		gust_factor_db->gust_factor_enable = false;
-	else if (value[0] == 0x01) {
-		gust_factor_db->gust_factor_enable = true;
-		gust_factor_db->indication = 0x0001;
-	} else
-		error = 0x80;
+	for (k = 1; k < chr->num_triggers; k++) {
+		const struct handover_trigger *tr = &rec->triggers[k - 1];
 
-	/* updating a timer function to call notification on a periodic interval */
+		setting.condition = tr->condition;
+		setting.interval = tr->data[0] | (tr->data[1] << 8) |
+							(tr->data[2] << 16);
+		for (i = 0; i < ESS_MAX_AXES; i++)
+			setting.threshold[i] = tr->threshold[i];
+		chr->triggers[k - 1] = setting;
+	}
 
-	update_gust_factor_timer(server);
+	chr->damping.hysteresis = rec->hysteresis;
+	chr->damping.deadband = rec->deadband;
+	ess_trigger_setup(chr);
 
- done:
+	/* a new process hands out slot n to the n-th connection taken over */
+	ess_state.ccc[chr->id] = rec->ccc;
+	if (rec->ccc)
+		ess_state.flags[chr->id] |= ESS_STATE_ENABLE;
+	else
+		ess_state.flags[chr->id] &= ~ESS_STATE_ENABLE;
 
-	gatt_db_attribute_write_result(attrib, id, error);
+	update_char_timer(chr);
+	ess_state.deadline[chr->id] = tick_count + rec->remaining;
 
+	return true;
 }
 
-static void gust_factor_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
+bool gatt_server_takeover(int sk)
 {
-	uint8_t error,len;
-	uint8_t val[4];
+	const struct queue_entry *entry;
+	struct handover_hdr hdr;
+	uint8_t status = 0x01;
+	unsigned int i;
+	int fd;
 
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=gust_factor_db->gust_factor_tr->condition;
+	handover_set_timeout(sk);
 
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = gust_factor_db->gust_factor_tr->data[0];
-		val[2] = gust_factor_db->gust_factor_tr->data[1];
-		val[3] = gust_factor_db->gust_factor_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else{
-		error=0;
-		val[1]=(uint8_t)gust_factor_db->tr_value;
-		len=2;
+	if (!handover_recv(sk, &hdr, sizeof(hdr), &fd) ||
+					hdr.magic != HANDOVER_MAGIC ||
+					hdr.version != HANDOVER_VERSION) {
+		ess_error("Invalid upgrade state\n");
+		goto fail;
 	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
 
-}
+	if (!gatt_db && !gatt_db_setup())
+		goto fail;
 
+	/* handles must not move under the connected clients */
+	if (hdr.num_chars != queue_length(ess_chars)) {
+		ess_error("Profile differs from the running one\n");
+		goto fail;
+	}
 
-static void gust_factor_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
+	tick_count = hdr.tick_count;
 
-	uint8_t error;
+	for (entry = queue_get_entries(ess_chars); entry;
+						entry = entry->next) {
+		struct handover_char rec;
 
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		gust_factor_db->gust_factor_tr->trigger_inactive=false;
-		gust_factor_db->gust_factor_tr->data[0] = value[1];		/* if trigger is time based  */
-		gust_factor_db->gust_factor_tr->data[1] = value[2];
-		gust_factor_db->gust_factor_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		gust_factor_db->gust_factor_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		gust_factor_db->gust_factor_tr->trigger_inactive=true;
-		if(gust_factor_db->timeout_id!=0){
-			timeout_remove(gust_factor_db->timeout_id);
-			gust_factor_db->gust_factor_enable = false;
-			gust_factor_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		gust_factor_db->gust_factor_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else{
-		if(len!=2){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
+		if (!handover_recv(sk, &rec, sizeof(rec), NULL) ||
+				!handover_restore_char(entry->data, &rec)) {
+			ess_error("Profile differs from the running one\n");
+			goto fail;
 		}
-		error=0;
-		gust_factor_db->gust_factor_tr->trigger_inactive=false;		/* if trigger is value based */
-		gust_factor_db->tr_value=value[1];
-		
 	}
 
-	gust_factor_db->gust_factor_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
+	for (i = 0; i < hdr.num_conns; i++) {
+		struct handover_conn rec;
+		struct gatt_conn *conn;
+		int conn_fd;
 
-	if( gust_factor_db->gust_factor_tr->condition==0x01 || gust_factor_db->gust_factor_tr->condition==0x02){
-		gust_factor_db->gust_factor_tr->value_enable=false;
-		gust_factor_db->gust_factor_tr->time_enable=true;
-	} else if( gust_factor_db->gust_factor_tr->condition>=0x03 && gust_factor_db->gust_factor_tr->condition<= 0x09){
-		gust_factor_db->gust_factor_tr->time_enable=false;
-		gust_factor_db->gust_factor_tr->value_enable=true;
-		if(gust_factor_db->gust_factor_enable && !gust_factor_db->gust_factor_tr->trigger_inactive){
-			timeout_remove(gust_factor_db->timeout_id);
-			update_gust_factor_timer(conn);
-		}	
-	} else{	
-
-		gust_factor_db->gust_factor_tr->trigger_inactive=true;
-		gust_factor_db->gust_factor_tr->time_enable=false;
-		gust_factor_db->gust_factor_tr->value_enable=false;
-		if(gust_factor_db->gust_factor_enable && !gust_factor_db->gust_factor_tr->trigger_inactive){
-			timeout_remove(gust_factor_db->timeout_id);
-			update_gust_factor_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(gust_factor_db->gust_factor_tr->time_enable)
-	gust_factor_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
+		if (!handover_recv(sk, &rec, sizeof(rec), &conn_fd) ||
+								conn_fd < 0)
+			goto fail;
 
+		conn = gatt_conn_new(conn_fd, rec.mtu);
+		if (!conn) {
+			close(conn_fd);
+			goto fail;
+		}
 
-	if(gust_factor_db->g_update_timer!=gust_factor_db->g_current_timer && gust_factor_db->gust_factor_tr->time_enable){
-		timeout_remove(gust_factor_db->timeout_id);
-		update_gust_factor_timer(conn);
+		conn->svc_chngd_enabled = rec.svc_chngd_enabled;
+		queue_push_tail(conn_list, conn);
 	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Heat Index characteristics                     ***
-*/
-
-
-static void heat_index_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int8_t value;
-
-	value=heat_index_db->heat_index_data;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 1);
-
-
-}
-
-/* Heat Index measurement descriptor read call back */
-
-static void heat_index_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = heat_index_db->heat_index_ms->sample;
-	value[3] = heat_index_db->heat_index_ms->m_period[0];
-	value[4] = heat_index_db->heat_index_ms->m_period[1];
-	value[5] = heat_index_db->heat_index_ms->m_period[2];
-	value[6] = heat_index_db->heat_index_ms->u_interval[0];
-	value[7] = heat_index_db->heat_index_ms->u_interval[1];
-	value[8] = heat_index_db->heat_index_ms->u_interval[2];
-	value[9] = heat_index_db->heat_index_ms->applicatn;
-	value[10] = heat_index_db->heat_index_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void heat_index_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int8_t value[2];
-
-	value[0]=heat_index_db->lower_heat_index;
-	value[1]=heat_index_db->upper_heat_index;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
 
-}
-	
-
-/* Heat Index user descriptor read call back */
-
-static void heat_index_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
+	if (fd >= 0) {
+		att_fd = fd;
+		fd = -1;
+		mainloop_add_fd(att_fd, EPOLLIN, att_conn_callback, NULL, NULL);
+	}
 
-	value=heat_index_db->user_desc;
+	status = 0x00;
+	if (send(sk, &status, 1, MSG_NOSIGNAL) != 1)
+		goto fail;
 
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
+	ess_info("Took over %u connections\n", hdr.num_conns);
 
-}
+	/* gatt_server_start() returns early on the inherited socket */
+	ess_arena_seal(true);
 
-/* Heat Index user descriptor write call back */
+	return true;
 
-static void heat_index_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
+fail:
+	if (fd >= 0)
+		close(fd);
 
-	uint8_t error;
+	status = 0x01;
+	send(sk, &status, 1, MSG_NOSIGNAL);
 
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(heat_index_db->user_desc,0,21);
-	memcpy(heat_index_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void heat_index_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=heat_index_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool heat_index_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,heat_index_db->heat_index_handle,
-						(uint8_t *)&pdu, 1);
-
-	return true;
-}
-
-
-static bool heat_index_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(heat_index_db->heat_index_tr->condition){
-
-		case 0x03 : if( pdu == heat_index_db->heat_index_data)
-				notify=false;
-			    else
-			    	heat_index_db->heat_index_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= heat_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > heat_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= heat_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < heat_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != heat_index_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == heat_index_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,heat_index_db->heat_index_handle,
-						(uint8_t *)&pdu, 1);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_heat_index_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	heat_index_db->g_current_timer=((heat_index_db->heat_index_tr->data[0]) | (heat_index_db->heat_index_tr->data[1]<<8) | (heat_index_db->heat_index_tr->data[2]<<16));
-
-
-	if(!heat_index_db->heat_index_enable || heat_index_db->heat_index_tr->trigger_inactive){
-	timeout_remove(heat_index_db->timeout_id);
-	return;
-	}
-	
-	timer=heat_index_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(heat_index_db->heat_index_tr->time_enable)   
-	heat_index_db->timeout_id=timeout_add(timer,heat_index_time_calculation,server,NULL);
-	else
-	heat_index_db->timeout_id=timeout_add(1000,heat_index_value_calculation,server,NULL);
-	
-}
-
-
-static void heat_index_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || heat_index_db->heat_index_tr->trigger_inactive)
-		heat_index_db->heat_index_enable = false;
-	else if (value[0] == 0x01) {
-		heat_index_db->heat_index_enable = true;
-		heat_index_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_heat_index_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void heat_index_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=heat_index_db->heat_index_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = heat_index_db->heat_index_tr->data[0];
-		val[2] = heat_index_db->heat_index_tr->data[1];
-		val[3] = heat_index_db->heat_index_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else{
-		error=0;
-		val[1]=(uint8_t)heat_index_db->tr_value;
-		len=2;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void heat_index_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		heat_index_db->heat_index_tr->trigger_inactive=false;
-		heat_index_db->heat_index_tr->data[0] = value[1];		/* if trigger is time based  */
-		heat_index_db->heat_index_tr->data[1] = value[2];
-		heat_index_db->heat_index_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		heat_index_db->heat_index_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		heat_index_db->heat_index_tr->trigger_inactive=true;
-		if(heat_index_db->timeout_id!=0){
-			timeout_remove(heat_index_db->timeout_id);
-			heat_index_db->heat_index_enable = false;
-			heat_index_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		heat_index_db->heat_index_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else{
-		if(len!=2){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		heat_index_db->heat_index_tr->trigger_inactive=false;		/* if trigger is value based */
-		heat_index_db->tr_value=value[1];
-		
-	}
-
-	heat_index_db->heat_index_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( heat_index_db->heat_index_tr->condition==0x01 || heat_index_db->heat_index_tr->condition==0x02){
-		heat_index_db->heat_index_tr->value_enable=false;
-		heat_index_db->heat_index_tr->time_enable=true;
-	} else if( heat_index_db->heat_index_tr->condition>=0x03 && heat_index_db->heat_index_tr->condition<= 0x09){
-		heat_index_db->heat_index_tr->time_enable=false;
-		heat_index_db->heat_index_tr->value_enable=true;
-		if(heat_index_db->heat_index_enable && !heat_index_db->heat_index_tr->trigger_inactive){
-			timeout_remove(heat_index_db->timeout_id);
-			update_heat_index_timer(conn);
-		}	
-	} else{	
-
-		heat_index_db->heat_index_tr->trigger_inactive=true;
-		heat_index_db->heat_index_tr->time_enable=false;
-		heat_index_db->heat_index_tr->value_enable=false;
-		if(heat_index_db->heat_index_enable && !heat_index_db->heat_index_tr->trigger_inactive){
-			timeout_remove(heat_index_db->timeout_id);
-			update_heat_index_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(heat_index_db->heat_index_tr->time_enable)
-	heat_index_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(heat_index_db->g_update_timer!=heat_index_db->g_current_timer && heat_index_db->heat_index_tr->time_enable){
-		timeout_remove(heat_index_db->timeout_id);
-		update_heat_index_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Humidity characteristics                       ***
-*/
-
-
-static void humidity_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=humidity_db->humidity_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static void humidity_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = humidity_db->humidity_ms->sample;
-	value[3] = humidity_db->humidity_ms->m_period[0];
-	value[4] = humidity_db->humidity_ms->m_period[1];
-	value[5] = humidity_db->humidity_ms->m_period[2];
-	value[6] = humidity_db->humidity_ms->u_interval[0];
-	value[7] = humidity_db->humidity_ms->u_interval[1];
-	value[8] = humidity_db->humidity_ms->u_interval[2];
-	value[9] = humidity_db->humidity_ms->applicatn;
-	value[10] = humidity_db->humidity_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void humidity_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=humidity_db->lower_humidity;
-	value[1]=humidity_db->upper_humidity;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void humidity_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=humidity_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void humidity_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	 /*initializing the string with zero's and then copying the new string to the data base*/ 
-
-	memset(humidity_db->user_desc,0,21);
-	memcpy(humidity_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void humidity_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=humidity_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool humidity_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,humidity_db->humidity_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool humidity_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(humidity_db->humidity_tr->condition){
-
-		case 0x03 : if( pdu == humidity_db->humidity_data)
-				notify=false;
-			    else
-			    	humidity_db->humidity_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= humidity_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > humidity_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= humidity_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < humidity_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != humidity_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == humidity_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,humidity_db->humidity_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_humidity_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	humidity_db->g_current_timer=((humidity_db->humidity_tr->data[0]) | (humidity_db->humidity_tr->data[1]<<8) | (humidity_db->humidity_tr->data[2]<<16));
-
-
-	if(!humidity_db->humidity_enable || humidity_db->humidity_tr->trigger_inactive){
-	timeout_remove(humidity_db->timeout_id);
-	return;
-	}
-	
-	timer=humidity_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(humidity_db->humidity_tr->time_enable)   
-	humidity_db->timeout_id=timeout_add(timer,humidity_time_calculation,server,NULL);
-	else
-	humidity_db->timeout_id=timeout_add(1000,humidity_value_calculation,server,NULL);
-	
-}
-
-
-static void humidity_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || humidity_db->humidity_tr->trigger_inactive)
-		humidity_db->humidity_enable = false;
-	else if (value[0] == 0x01) {
-		humidity_db->humidity_enable = true;
-		humidity_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_humidity_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void humidity_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=humidity_db->humidity_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = humidity_db->humidity_tr->data[0];
-		val[2] = humidity_db->humidity_tr->data[1];
-		val[3] = humidity_db->humidity_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)humidity_db->tr_value;
-		val[2]=(uint8_t)(humidity_db->tr_value>>8);
-		len=3;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void humidity_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		humidity_db->humidity_tr->trigger_inactive=false;
-		humidity_db->humidity_tr->data[0] = value[1];		/* if trigger is time based  */
-		humidity_db->humidity_tr->data[1] = value[2];
-		humidity_db->humidity_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		humidity_db->humidity_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		humidity_db->humidity_tr->trigger_inactive=true;
-		if(humidity_db->timeout_id!=0){
-			timeout_remove(humidity_db->timeout_id);
-			humidity_db->humidity_enable = false;
-			humidity_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		humidity_db->humidity_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}		
-		error=0;
-		humidity_db->humidity_tr->trigger_inactive=false;		/* if trigger is value based */
-		humidity_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	humidity_db->humidity_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( humidity_db->humidity_tr->condition==0x01 || humidity_db->humidity_tr->condition==0x02){
-		humidity_db->humidity_tr->value_enable=false;
-		humidity_db->humidity_tr->time_enable=true;
-	} else if( humidity_db->humidity_tr->condition>=0x03 && humidity_db->humidity_tr->condition<= 0x09){
-		humidity_db->humidity_tr->time_enable=false;
-		humidity_db->humidity_tr->value_enable=true;
-		if(humidity_db->humidity_enable && !humidity_db->humidity_tr->trigger_inactive){
-			timeout_remove(humidity_db->timeout_id);
-			update_humidity_timer(conn);
-		}	
-	} else{	
-
-		humidity_db->humidity_tr->trigger_inactive=true;
-		humidity_db->humidity_tr->time_enable=false;
-		humidity_db->humidity_tr->value_enable=false;
-		if(humidity_db->humidity_enable && !humidity_db->humidity_tr->trigger_inactive){
-			timeout_remove(humidity_db->timeout_id);
-			update_humidity_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(humidity_db->humidity_tr->time_enable)
-	humidity_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(humidity_db->g_update_timer!=humidity_db->g_current_timer && humidity_db->humidity_tr->time_enable){
-		timeout_remove(humidity_db->timeout_id);
-		update_humidity_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Irradiance characteristics                     ***
-*/
-
-
-static void irradiance_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=irradiance_db->irradiance_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static void irradiance_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = irradiance_db->irradiance_ms->sample;
-	value[3] = irradiance_db->irradiance_ms->m_period[0];
-	value[4] = irradiance_db->irradiance_ms->m_period[1];
-	value[5] = irradiance_db->irradiance_ms->m_period[2];
-	value[6] = irradiance_db->irradiance_ms->u_interval[0];
-	value[7] = irradiance_db->irradiance_ms->u_interval[1];
-	value[8] = irradiance_db->irradiance_ms->u_interval[2];
-	value[9] = irradiance_db->irradiance_ms->applicatn;
-	value[10] = irradiance_db->irradiance_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void irradiance_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=irradiance_db->lower_irradiance;
-	value[1]=irradiance_db->upper_irradiance;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void irradiance_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=irradiance_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void irradiance_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(irradiance_db->user_desc,0,21);
-	memcpy(irradiance_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void irradiance_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=irradiance_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool irradiance_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,irradiance_db->irradiance_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool irradiance_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(irradiance_db->irradiance_tr->condition){
-
-		case 0x03 : if( pdu == irradiance_db->irradiance_data)
-				notify=false;
-			    else
-			    	irradiance_db->irradiance_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= irradiance_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > irradiance_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= irradiance_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < irradiance_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != irradiance_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == irradiance_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,irradiance_db->irradiance_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_irradiance_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	irradiance_db->g_current_timer=((irradiance_db->irradiance_tr->data[0]) | (irradiance_db->irradiance_tr->data[1]<<8) | (irradiance_db->irradiance_tr->data[2]<<16));
-
-
-	if(!irradiance_db->irradiance_enable || irradiance_db->irradiance_tr->trigger_inactive){
-	timeout_remove(irradiance_db->timeout_id);
-	return;
-	}
-	
-	timer=irradiance_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(irradiance_db->irradiance_tr->time_enable)   
-	irradiance_db->timeout_id=timeout_add(timer,irradiance_time_calculation,server,NULL);
-	else
-	irradiance_db->timeout_id=timeout_add(1000,irradiance_value_calculation,server,NULL);
-	
-}
-
-
-static void irradiance_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || irradiance_db->irradiance_tr->trigger_inactive)
-		irradiance_db->irradiance_enable = false;
-	else if (value[0] == 0x01) {
-		irradiance_db->irradiance_enable = true;
-		irradiance_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_irradiance_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void irradiance_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=irradiance_db->irradiance_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = irradiance_db->irradiance_tr->data[0];
-		val[2] = irradiance_db->irradiance_tr->data[1];
-		val[3] = irradiance_db->irradiance_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)irradiance_db->tr_value;
-		val[2]=(uint8_t)(irradiance_db->tr_value>>8);
-		len=3;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void irradiance_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		irradiance_db->irradiance_tr->trigger_inactive=false;
-		irradiance_db->irradiance_tr->data[0] = value[1];		/* if trigger is time based  */
-		irradiance_db->irradiance_tr->data[1] = value[2];
-		irradiance_db->irradiance_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		irradiance_db->irradiance_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		irradiance_db->irradiance_tr->trigger_inactive=true;
-		if(irradiance_db->timeout_id!=0){
-			timeout_remove(irradiance_db->timeout_id);
-			irradiance_db->irradiance_enable = false;
-			irradiance_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		irradiance_db->irradiance_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {	
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}	
-		error=0;
-		irradiance_db->irradiance_tr->trigger_inactive=false;		/* if trigger is value based */
-		irradiance_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	irradiance_db->irradiance_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( irradiance_db->irradiance_tr->condition==0x01 || irradiance_db->irradiance_tr->condition==0x02){
-		irradiance_db->irradiance_tr->value_enable=false;
-		irradiance_db->irradiance_tr->time_enable=true;
-	} else if( irradiance_db->irradiance_tr->condition>=0x03 && irradiance_db->irradiance_tr->condition<= 0x09){
-		irradiance_db->irradiance_tr->time_enable=false;
-		irradiance_db->irradiance_tr->value_enable=true;
-		if(irradiance_db->irradiance_enable && !irradiance_db->irradiance_tr->trigger_inactive){
-			timeout_remove(irradiance_db->timeout_id);
-			update_irradiance_timer(conn);
-		}	
-	} else{	
-
-		irradiance_db->irradiance_tr->trigger_inactive=true;
-		irradiance_db->irradiance_tr->time_enable=false;
-		irradiance_db->irradiance_tr->value_enable=false;
-		if(irradiance_db->irradiance_enable && !irradiance_db->irradiance_tr->trigger_inactive){
-			timeout_remove(irradiance_db->timeout_id);
-			update_irradiance_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(irradiance_db->irradiance_tr->time_enable)
-	irradiance_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(irradiance_db->g_update_timer!=irradiance_db->g_current_timer && irradiance_db->irradiance_tr->time_enable){
-		timeout_remove(irradiance_db->timeout_id);
-		update_irradiance_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Pollen Concentration characteristics           ***
-*/
-
-
-static void pollen_concentration_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint32_t value;
-
-	value=pollen_concentration_db->pollen_concentration_data;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 3);
-
-}
-
-static void pollen_concentration_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = pollen_concentration_db->pollen_concentration_ms->sample;
-	value[3] = pollen_concentration_db->pollen_concentration_ms->m_period[0];
-	value[4] = pollen_concentration_db->pollen_concentration_ms->m_period[1];
-	value[5] = pollen_concentration_db->pollen_concentration_ms->m_period[2];
-	value[6] = pollen_concentration_db->pollen_concentration_ms->u_interval[0];
-	value[7] = pollen_concentration_db->pollen_concentration_ms->u_interval[1];
-	value[8] = pollen_concentration_db->pollen_concentration_ms->u_interval[2];
-	value[9] = pollen_concentration_db->pollen_concentration_ms->applicatn;
-	value[10] = pollen_concentration_db->pollen_concentration_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}	
-
-
-static void pollen_concentration_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint8_t value[2][3];
-
-	value[0][0]=pollen_concentration_db->lower_pollen_concentration[0];
-	value[0][1]=pollen_concentration_db->upper_pollen_concentration[1];
-	value[0][2]=pollen_concentration_db->upper_pollen_concentration[2];
-	value[1][0]=pollen_concentration_db->lower_pollen_concentration[0];
-	value[1][1]=pollen_concentration_db->upper_pollen_concentration[1];
-	value[1][2]=pollen_concentration_db->upper_pollen_concentration[2];
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 6);
-
-}
-
-
-static void pollen_concentration_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=pollen_concentration_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void pollen_concentration_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(pollen_concentration_db->user_desc,0,21);
-	memcpy(pollen_concentration_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void pollen_concentration_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=pollen_concentration_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool pollen_concentration_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint32_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,pollen_concentration_db->pollen_concentration_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool pollen_concentration_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint32_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand()&0x00FFFFFF;
-
-
-
-	 /*checking the trigger condition and notifying based on the particular condition */
- 
-	switch(pollen_concentration_db->pollen_concentration_tr->condition){
-
-		case 0x03 : if( pdu == pollen_concentration_db->pollen_concentration_data)
-				notify=false;
-			    else
-			    	pollen_concentration_db->pollen_concentration_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= pollen_concentration_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > pollen_concentration_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= pollen_concentration_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < pollen_concentration_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != pollen_concentration_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == pollen_concentration_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,pollen_concentration_db->pollen_concentration_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
- /*Timer function will read the trigger setting and call a function to send notification based on value or time  */
-
-static void update_pollen_concentration_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	pollen_concentration_db->g_current_timer=((pollen_concentration_db->pollen_concentration_tr->data[0]) | (pollen_concentration_db->pollen_concentration_tr->data[1]<<8) | (pollen_concentration_db->pollen_concentration_tr->data[2]<<16));
-
-
-	if(!pollen_concentration_db->pollen_concentration_enable || pollen_concentration_db->pollen_concentration_tr->trigger_inactive){
-	timeout_remove(pollen_concentration_db->timeout_id);
-	return;
-	}
-	
-	timer=pollen_concentration_db->g_current_timer*1000;
-	
-
-	/*
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(pollen_concentration_db->pollen_concentration_tr->time_enable)   
-	pollen_concentration_db->timeout_id=timeout_add(timer,pollen_concentration_time_calculation,server,NULL);
-	else
-	pollen_concentration_db->timeout_id=timeout_add(1000,pollen_concentration_value_calculation,server,NULL);
-	
-}
-
-
-static void pollen_concentration_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/*enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || pollen_concentration_db->pollen_concentration_tr->trigger_inactive)
-		pollen_concentration_db->pollen_concentration_enable = false;
-	else if (value[0] == 0x01) {
-		pollen_concentration_db->pollen_concentration_enable = true;
-		pollen_concentration_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_pollen_concentration_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void pollen_concentration_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=pollen_concentration_db->pollen_concentration_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = pollen_concentration_db->pollen_concentration_tr->data[0];
-		val[2] = pollen_concentration_db->pollen_concentration_tr->data[1];
-		val[3] = pollen_concentration_db->pollen_concentration_tr->data[2];
-		len=4;
-	}else{
-		error=0;
-		val[1]=(uint8_t)pollen_concentration_db->tr_value;
-		val[2]=(uint8_t)(pollen_concentration_db->tr_value>>8);
-		val[3]=(uint8_t)(pollen_concentration_db->tr_value>>16);
-		len=3;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void pollen_concentration_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	 /* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=false;
-		pollen_concentration_db->pollen_concentration_tr->data[0] = value[1];		/* if trigger is time based  */
-		pollen_concentration_db->pollen_concentration_tr->data[1] = value[2];
-		pollen_concentration_db->pollen_concentration_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pollen_concentration_db->pollen_concentration_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=true;
-		if(pollen_concentration_db->timeout_id!=0){
-			timeout_remove(pollen_concentration_db->timeout_id);
-			pollen_concentration_db->pollen_concentration_enable = false;
-			pollen_concentration_db->indication = 0x0000;
-			goto done;
-		}
-	} else  if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=false;		/* if trigger is value based */
-		pollen_concentration_db->tr_value=value[1] | value[2]<<8 | value[3]<<16 | 0<<24 ;
-		
-	}
-
-	pollen_concentration_db->pollen_concentration_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( pollen_concentration_db->pollen_concentration_tr->condition==0x01 || pollen_concentration_db->pollen_concentration_tr->condition==0x02){
-		pollen_concentration_db->pollen_concentration_tr->value_enable=false;
-		pollen_concentration_db->pollen_concentration_tr->time_enable=true;
-	} else if( pollen_concentration_db->pollen_concentration_tr->condition>=0x03 && pollen_concentration_db->pollen_concentration_tr->condition<= 0x09){
-		pollen_concentration_db->pollen_concentration_tr->time_enable=false;
-		pollen_concentration_db->pollen_concentration_tr->value_enable=true;
-		if(pollen_concentration_db->pollen_concentration_enable && !pollen_concentration_db->pollen_concentration_tr->trigger_inactive){
-			timeout_remove(pollen_concentration_db->timeout_id);
-			update_pollen_concentration_timer(conn);
-		}	
-	} else{	
-
-		pollen_concentration_db->pollen_concentration_tr->trigger_inactive=true;
-		pollen_concentration_db->pollen_concentration_tr->time_enable=false;
-		pollen_concentration_db->pollen_concentration_tr->value_enable=false;
-		if(pollen_concentration_db->pollen_concentration_enable && !pollen_concentration_db->pollen_concentration_tr->trigger_inactive){
-			timeout_remove(pollen_concentration_db->timeout_id);
-			update_pollen_concentration_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(pollen_concentration_db->pollen_concentration_tr->time_enable)
-	pollen_concentration_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(pollen_concentration_db->g_update_timer!=pollen_concentration_db->g_current_timer && pollen_concentration_db->pollen_concentration_tr->time_enable){
-		timeout_remove(pollen_concentration_db->timeout_id);
-		update_pollen_concentration_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** rainfall characteristics                       ***
-*/
-
-
-static void rainfall_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=rainfall_db->rainfall_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static void rainfall_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = rainfall_db->rainfall_ms->sample;
-	value[3] = rainfall_db->rainfall_ms->m_period[0];
-	value[4] = rainfall_db->rainfall_ms->m_period[1];
-	value[5] = rainfall_db->rainfall_ms->m_period[2];
-	value[6] = rainfall_db->rainfall_ms->u_interval[0];
-	value[7] = rainfall_db->rainfall_ms->u_interval[1];
-	value[8] = rainfall_db->rainfall_ms->u_interval[2];
-	value[9] = rainfall_db->rainfall_ms->applicatn;
-	value[10] = rainfall_db->rainfall_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void rainfall_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=rainfall_db->lower_rainfall;
-	value[1]=rainfall_db->upper_rainfall;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void rainfall_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=rainfall_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void rainfall_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(rainfall_db->user_desc,0,21);
-	memcpy(rainfall_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void rainfall_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=rainfall_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool rainfall_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,rainfall_db->rainfall_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool rainfall_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(rainfall_db->rainfall_tr->condition){
-
-		case 0x03 : if( pdu == rainfall_db->rainfall_data)
-				notify=false;
-			    else
-			    	rainfall_db->rainfall_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= rainfall_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > rainfall_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= rainfall_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < rainfall_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != rainfall_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == rainfall_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,rainfall_db->rainfall_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_rainfall_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	rainfall_db->g_current_timer=((rainfall_db->rainfall_tr->data[0]) | (rainfall_db->rainfall_tr->data[1]<<8) | (rainfall_db->rainfall_tr->data[2]<<16));
-
-
-	if(!rainfall_db->rainfall_enable || rainfall_db->rainfall_tr->trigger_inactive){
-	timeout_remove(rainfall_db->timeout_id);
-	return;
-	}
-	
-	timer=rainfall_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(rainfall_db->rainfall_tr->time_enable)   
-	rainfall_db->timeout_id=timeout_add(timer,rainfall_time_calculation,server,NULL);
-	else
-	rainfall_db->timeout_id=timeout_add(1000,rainfall_value_calculation,server,NULL);
-	
-}
-
-
-static void rainfall_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || rainfall_db->rainfall_tr->trigger_inactive)
-		rainfall_db->rainfall_enable = false;
-	else if (value[0] == 0x01) {
-		rainfall_db->rainfall_enable = true;
-		rainfall_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_rainfall_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void rainfall_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=rainfall_db->rainfall_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = rainfall_db->rainfall_tr->data[0];
-		val[2] = rainfall_db->rainfall_tr->data[1];
-		val[3] = rainfall_db->rainfall_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)rainfall_db->tr_value;
-		val[2]=(uint8_t)(rainfall_db->tr_value>>8);
-		len=3;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void rainfall_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		rainfall_db->rainfall_tr->trigger_inactive=false;
-		rainfall_db->rainfall_tr->data[0] = value[1];		/* if trigger is time based  */
-		rainfall_db->rainfall_tr->data[1] = value[2];
-		rainfall_db->rainfall_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		rainfall_db->rainfall_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		rainfall_db->rainfall_tr->trigger_inactive=true;
-		if(rainfall_db->timeout_id!=0){
-			timeout_remove(rainfall_db->timeout_id);
-			rainfall_db->rainfall_enable = false;
-			rainfall_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		rainfall_db->rainfall_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {	
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}	
-		error=0;
-		rainfall_db->rainfall_tr->trigger_inactive=false;		/* if trigger is value based */
-		rainfall_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	rainfall_db->rainfall_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( rainfall_db->rainfall_tr->condition==0x01 || rainfall_db->rainfall_tr->condition==0x02){
-		rainfall_db->rainfall_tr->value_enable=false;
-		rainfall_db->rainfall_tr->time_enable=true;
-	} else if( rainfall_db->rainfall_tr->condition>=0x03 && rainfall_db->rainfall_tr->condition<= 0x09){
-		rainfall_db->rainfall_tr->time_enable=false;
-		rainfall_db->rainfall_tr->value_enable=true;
-		if(rainfall_db->rainfall_enable && !rainfall_db->rainfall_tr->trigger_inactive){
-			timeout_remove(rainfall_db->timeout_id);
-			update_rainfall_timer(conn);
-		}	
-	} else{	
-
-		rainfall_db->rainfall_tr->trigger_inactive=true;
-		rainfall_db->rainfall_tr->time_enable=false;
-		rainfall_db->rainfall_tr->value_enable=false;
-		if(rainfall_db->rainfall_enable && !rainfall_db->rainfall_tr->trigger_inactive){
-			timeout_remove(rainfall_db->timeout_id);
-			update_rainfall_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(rainfall_db->rainfall_tr->time_enable)
-	rainfall_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(rainfall_db->g_update_timer!=rainfall_db->g_current_timer && rainfall_db->rainfall_tr->time_enable){
-		timeout_remove(rainfall_db->timeout_id);
-		update_rainfall_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Pressure characteristics                       ***
-*/
-
-static void pressure_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint32_t value;
-
-	value=pressure_db->pressure_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 4);
-
-}
-
-
-static void pressure_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = pressure_db->pressure_ms->sample;
-	value[3] = pressure_db->pressure_ms->m_period[0];
-	value[4] = pressure_db->pressure_ms->m_period[1];
-	value[5] = pressure_db->pressure_ms->m_period[2];
-	value[6] = pressure_db->pressure_ms->u_interval[0];
-	value[7] = pressure_db->pressure_ms->u_interval[1];
-	value[8] = pressure_db->pressure_ms->u_interval[2];
-	value[9] = pressure_db->pressure_ms->applicatn;
-	value[10] = pressure_db->pressure_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void pressure_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint32_t value[2];
-
-	value[0]=pressure_db->lower_pressure;
-	value[1]=pressure_db->upper_pressure;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 8);
-
-}
-	
-
-
-static void pressure_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=pressure_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void pressure_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(pressure_db->user_desc,0,21);
-	memcpy(pressure_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void pressure_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=pressure_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool pressure_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint32_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,pressure_db->pressure_handle,
-						(uint8_t *)&pdu, 4);
-
-	return true;
-}
-
-
-static bool pressure_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint32_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(pressure_db->pressure_tr->condition){
-
-		case 0x03 : if( pdu == pressure_db->pressure_data)
-				notify=false;
-			    else
-			    	pressure_db->pressure_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= pressure_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > pressure_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= pressure_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < pressure_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != pressure_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == pressure_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,pressure_db->pressure_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_pressure_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	pressure_db->g_current_timer=((pressure_db->pressure_tr->data[0]) | (pressure_db->pressure_tr->data[1]<<8) | (pressure_db->pressure_tr->data[2]<<16));
-
-
-	if(!pressure_db->pressure_enable || pressure_db->pressure_tr->trigger_inactive){
-	timeout_remove(pressure_db->timeout_id);
-	return;
-	}
-	
-	timer=pressure_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(pressure_db->pressure_tr->time_enable)   
-	pressure_db->timeout_id=timeout_add(timer,pressure_time_calculation,server,NULL);
-	else
-	pressure_db->timeout_id=timeout_add(1000,pressure_value_calculation,server,NULL);
-	
-}
-
-
-static void pressure_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || pressure_db->pressure_tr->trigger_inactive)
-		pressure_db->pressure_enable = false;
-	else if (value[0] == 0x01) {
-		pressure_db->pressure_enable = true;
-		pressure_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_pressure_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void pressure_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[5];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=pressure_db->pressure_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = pressure_db->pressure_tr->data[0];
-		val[2] = pressure_db->pressure_tr->data[1];
-		val[3] = pressure_db->pressure_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)pressure_db->tr_value;
-		val[2]=(uint8_t)(pressure_db->tr_value>>8);
-		val[3]=(uint8_t)(pressure_db->tr_value>>16);
-		val[4]=(uint8_t)(pressure_db->tr_value>>24);
-		len=5;
-	}
-	
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void pressure_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>5) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		pressure_db->pressure_tr->trigger_inactive=false;
-		pressure_db->pressure_tr->data[0] = value[1];		/* if trigger is time based  */
-		pressure_db->pressure_tr->data[1] = value[2];
-		pressure_db->pressure_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pressure_db->pressure_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		pressure_db->pressure_tr->trigger_inactive=true;
-		if(pressure_db->timeout_id!=0){
-			timeout_remove(pressure_db->timeout_id);
-			pressure_db->pressure_enable = false;
-			pressure_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pressure_db->pressure_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {
-		if(len!=5){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		pressure_db->pressure_tr->trigger_inactive=false;		/* if trigger is value based */
-		pressure_db->tr_value=value[1] | value[2]<<8 | value[3]<<16 | value[4]<<24 ;
-		
-	}
-
-	pressure_db->pressure_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( pressure_db->pressure_tr->condition==0x01 || pressure_db->pressure_tr->condition==0x02){
-		pressure_db->pressure_tr->value_enable=false;
-		pressure_db->pressure_tr->time_enable=true;
-	} else if( pressure_db->pressure_tr->condition>=0x03 && pressure_db->pressure_tr->condition<= 0x09){
-		pressure_db->pressure_tr->time_enable=false;
-		pressure_db->pressure_tr->value_enable=true;
-		if(pressure_db->pressure_enable && !pressure_db->pressure_tr->trigger_inactive){
-			timeout_remove(pressure_db->timeout_id);
-			update_pressure_timer(conn);
-		}	
-	} else{	
-
-		pressure_db->pressure_tr->trigger_inactive=true;
-		pressure_db->pressure_tr->time_enable=false;
-		pressure_db->pressure_tr->value_enable=false;
-		if(pressure_db->pressure_enable && !pressure_db->pressure_tr->trigger_inactive){
-			timeout_remove(pressure_db->timeout_id);
-			update_pressure_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(pressure_db->pressure_tr->time_enable)
-	pressure_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(pressure_db->g_update_timer!=pressure_db->g_current_timer && pressure_db->pressure_tr->time_enable){
-		timeout_remove(pressure_db->timeout_id);
-		update_pressure_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** True Wind Direction characteristics            ***
-*/
-
-
-static void true_direction_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=true_direction_db->true_direction_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static void true_direction_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = true_direction_db->true_direction_ms->sample;
-	value[3] = true_direction_db->true_direction_ms->m_period[0];
-	value[4] = true_direction_db->true_direction_ms->m_period[1];
-	value[5] = true_direction_db->true_direction_ms->m_period[2];
-	value[6] = true_direction_db->true_direction_ms->u_interval[0];
-	value[7] = true_direction_db->true_direction_ms->u_interval[1];
-	value[8] = true_direction_db->true_direction_ms->u_interval[2];
-	value[9] = true_direction_db->true_direction_ms->applicatn;
-	value[10] = true_direction_db->true_direction_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void true_direction_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=true_direction_db->lower_true_direction;
-	value[1]=true_direction_db->upper_true_direction;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void true_direction_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=true_direction_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void true_direction_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(true_direction_db->user_desc,0,21);
-	memcpy(true_direction_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void true_direction_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=true_direction_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool true_direction_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,true_direction_db->true_direction_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool true_direction_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(true_direction_db->true_direction_tr->condition){
-
-		case 0x03 : if( pdu == true_direction_db->true_direction_data)
-				notify=false;
-			    else
-			    	true_direction_db->true_direction_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= true_direction_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > true_direction_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= true_direction_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < true_direction_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != true_direction_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == true_direction_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,true_direction_db->true_direction_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_true_direction_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	true_direction_db->g_current_timer=((true_direction_db->true_direction_tr->data[0]) | (true_direction_db->true_direction_tr->data[1]<<8) | (true_direction_db->true_direction_tr->data[2]<<16));
-
-
-	if(!true_direction_db->true_direction_enable || true_direction_db->true_direction_tr->trigger_inactive){
-	timeout_remove(true_direction_db->timeout_id);
-	return;
-	}
-	
-	timer=true_direction_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(true_direction_db->true_direction_tr->time_enable)   
-	true_direction_db->timeout_id=timeout_add(timer,true_direction_time_calculation,server,NULL);
-	else
-	true_direction_db->timeout_id=timeout_add(1000,true_direction_value_calculation,server,NULL);
-	
-}
-
-
-static void true_direction_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || true_direction_db->true_direction_tr->trigger_inactive)
-		true_direction_db->true_direction_enable = false;
-	else if (value[0] == 0x01) {
-		true_direction_db->true_direction_enable = true;
-		true_direction_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_true_direction_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void true_direction_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=true_direction_db->true_direction_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = true_direction_db->true_direction_tr->data[0];
-		val[2] = true_direction_db->true_direction_tr->data[1];
-		val[3] = true_direction_db->true_direction_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else{
-		error=0;
-		val[1]=(uint8_t)true_direction_db->tr_value;
-		val[2]=(uint8_t)(true_direction_db->tr_value>>8);
-		len=3;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void true_direction_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		true_direction_db->true_direction_tr->trigger_inactive=false;
-		true_direction_db->true_direction_tr->data[0] = value[1];		/* if trigger is time based  */
-		true_direction_db->true_direction_tr->data[1] = value[2];
-		true_direction_db->true_direction_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		true_direction_db->true_direction_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		true_direction_db->true_direction_tr->trigger_inactive=true;
-		if(true_direction_db->timeout_id!=0){
-			timeout_remove(true_direction_db->timeout_id);
-			true_direction_db->true_direction_enable = false;
-			true_direction_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		true_direction_db->true_direction_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {	
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}	
-		error=0;
-		true_direction_db->true_direction_tr->trigger_inactive=false;		/* if trigger is value based */
-		true_direction_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	true_direction_db->true_direction_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( true_direction_db->true_direction_tr->condition==0x01 || true_direction_db->true_direction_tr->condition==0x02){
-		true_direction_db->true_direction_tr->value_enable=false;
-		true_direction_db->true_direction_tr->time_enable=true;
-	} else if( true_direction_db->true_direction_tr->condition>=0x03 && true_direction_db->true_direction_tr->condition<= 0x09){
-		true_direction_db->true_direction_tr->time_enable=false;
-		true_direction_db->true_direction_tr->value_enable=true;
-		if(true_direction_db->true_direction_enable && !true_direction_db->true_direction_tr->trigger_inactive){
-			timeout_remove(true_direction_db->timeout_id);
-			update_true_direction_timer(conn);
-		}	
-	} else{	
-
-		true_direction_db->true_direction_tr->trigger_inactive=true;
-		true_direction_db->true_direction_tr->time_enable=false;
-		true_direction_db->true_direction_tr->value_enable=false;
-		if(true_direction_db->true_direction_enable && !true_direction_db->true_direction_tr->trigger_inactive){
-			timeout_remove(true_direction_db->timeout_id);
-			update_true_direction_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(true_direction_db->true_direction_tr->time_enable)
-	true_direction_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(true_direction_db->g_update_timer!=true_direction_db->g_current_timer && true_direction_db->true_direction_tr->time_enable){
-		timeout_remove(true_direction_db->timeout_id);
-		update_true_direction_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** True Wind Speed characteristics                ***
-*/
-
-
-static void true_speed_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=true_speed_db->true_speed_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error,(uint8_t  *)&value, 2);
-
-}
-
-
-static void true_speed_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = true_speed_db->true_speed_ms->sample;
-	value[3] = true_speed_db->true_speed_ms->m_period[0];
-	value[4] = true_speed_db->true_speed_ms->m_period[1];
-	value[5] = true_speed_db->true_speed_ms->m_period[2];
-	value[6] = true_speed_db->true_speed_ms->u_interval[0];
-	value[7] = true_speed_db->true_speed_ms->u_interval[1];
-	value[8] = true_speed_db->true_speed_ms->u_interval[2];
-	value[9] = true_speed_db->true_speed_ms->applicatn;
-	value[10] = true_speed_db->true_speed_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void true_speed_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=true_speed_db->lower_true_speed;
-	value[1]=true_speed_db->upper_true_speed;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void true_speed_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=true_speed_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void true_speed_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(true_speed_db->user_desc,0,21);
-	memcpy(true_speed_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void true_speed_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=true_speed_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool true_speed_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,true_speed_db->true_speed_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool true_speed_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(true_speed_db->true_speed_tr->condition){
-
-		case 0x03 : if( pdu == true_speed_db->true_speed_data)
-				notify=false;
-			    else
-			    	true_speed_db->true_speed_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= true_speed_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > true_speed_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= true_speed_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < true_speed_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != true_speed_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == true_speed_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,true_speed_db->true_speed_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_true_speed_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	true_speed_db->g_current_timer=((true_speed_db->true_speed_tr->data[0]) | (true_speed_db->true_speed_tr->data[1]<<8) | (true_speed_db->true_speed_tr->data[2]<<16));
-
-
-	if(!true_speed_db->true_speed_enable || true_speed_db->true_speed_tr->trigger_inactive){
-	timeout_remove(true_speed_db->timeout_id);
-	return;
-	}
-	
-	timer=true_speed_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(true_speed_db->true_speed_tr->time_enable)   
-	true_speed_db->timeout_id=timeout_add(timer,true_speed_time_calculation,server,NULL);
-	else
-	true_speed_db->timeout_id=timeout_add(1000,true_speed_value_calculation,server,NULL);
-	
-}
-
-
-static void true_speed_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || true_speed_db->true_speed_tr->trigger_inactive)
-		true_speed_db->true_speed_enable = false;
-	else if (value[0] == 0x01) {
-		true_speed_db->true_speed_enable = true;
-		true_speed_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_true_speed_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void true_speed_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=true_speed_db->true_speed_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = true_speed_db->true_speed_tr->data[0];
-		val[2] = true_speed_db->true_speed_tr->data[1];
-		val[3] = true_speed_db->true_speed_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else{
-		error=0;
-		val[1]=(uint8_t)true_speed_db->tr_value;
-		val[2]=(uint8_t)(true_speed_db->tr_value>>8);
-		len=3;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void true_speed_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		true_speed_db->true_speed_tr->trigger_inactive=false;
-		true_speed_db->true_speed_tr->data[0] = value[1];		/* if trigger is time based  */
-		true_speed_db->true_speed_tr->data[1] = value[2];
-		true_speed_db->true_speed_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		true_speed_db->true_speed_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		true_speed_db->true_speed_tr->trigger_inactive=true;
-		if(true_speed_db->timeout_id!=0){
-			timeout_remove(true_speed_db->timeout_id);
-			true_speed_db->true_speed_enable = false;
-			true_speed_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		true_speed_db->true_speed_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {	
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}	
-		error=0;
-		true_speed_db->true_speed_tr->trigger_inactive=false;		/* if trigger is value based */
-		true_speed_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	true_speed_db->true_speed_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( true_speed_db->true_speed_tr->condition==0x01 || true_speed_db->true_speed_tr->condition==0x02){
-		true_speed_db->true_speed_tr->value_enable=false;
-		true_speed_db->true_speed_tr->time_enable=true;
-	} else if( true_speed_db->true_speed_tr->condition>=0x03 && true_speed_db->true_speed_tr->condition<= 0x09){
-		true_speed_db->true_speed_tr->time_enable=false;
-		true_speed_db->true_speed_tr->value_enable=true;
-		if(true_speed_db->true_speed_enable && !true_speed_db->true_speed_tr->trigger_inactive){
-			timeout_remove(true_speed_db->timeout_id);
-			update_true_speed_timer(conn);
-		}	
-	} else{	
-
-		true_speed_db->true_speed_tr->trigger_inactive=true;
-		true_speed_db->true_speed_tr->time_enable=false;
-		true_speed_db->true_speed_tr->value_enable=false;
-		if(true_speed_db->true_speed_enable && !true_speed_db->true_speed_tr->trigger_inactive){
-			timeout_remove(true_speed_db->timeout_id);
-			update_true_speed_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(true_speed_db->true_speed_tr->time_enable)
-	true_speed_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(true_speed_db->g_update_timer!=true_speed_db->g_current_timer && true_speed_db->true_speed_tr->time_enable){
-		timeout_remove(true_speed_db->timeout_id);
-		update_true_speed_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** UV Index characteristics                       ***
-*/
-
-
-static void uv_index_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint8_t value;
-
-	value=uv_index_db->uv_index_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, &value, 1);
-
-}
-
-
-static void uv_index_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = uv_index_db->uv_index_ms->sample;
-	value[3] = uv_index_db->uv_index_ms->m_period[0];
-	value[4] = uv_index_db->uv_index_ms->m_period[1];
-	value[5] = uv_index_db->uv_index_ms->m_period[2];
-	value[6] = uv_index_db->uv_index_ms->u_interval[0];
-	value[7] = uv_index_db->uv_index_ms->u_interval[1];
-	value[8] = uv_index_db->uv_index_ms->u_interval[2];
-	value[9] = uv_index_db->uv_index_ms->applicatn;
-	value[10] = uv_index_db->uv_index_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void uv_index_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint8_t value[2];
-
-	value[0]=uv_index_db->lower_uv_index;
-	value[1]=uv_index_db->upper_uv_index;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
-
-}
-	
-
-
-static void uv_index_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=uv_index_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void uv_index_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(uv_index_db->user_desc,0,21);
-	memcpy(uv_index_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Wind Chill characteristics                     ***
-*/
-
-static void uv_index_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=uv_index_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool uv_index_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint8_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,uv_index_db->uv_index_handle,
-						(uint8_t *)&pdu, 1);
-
-	return true;
-}
-
-
-static bool uv_index_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint8_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(uv_index_db->uv_index_tr->condition){
-
-		case 0x03 : if( pdu == uv_index_db->uv_index_data)
-				notify=false;
-			    else
-			    	uv_index_db->uv_index_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= uv_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > uv_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= uv_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < uv_index_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != uv_index_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == uv_index_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,uv_index_db->uv_index_handle,
-						(uint8_t *)&pdu, 1);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_uv_index_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	uv_index_db->g_current_timer=((uv_index_db->uv_index_tr->data[0]) | (uv_index_db->uv_index_tr->data[1]<<8) | (uv_index_db->uv_index_tr->data[2]<<16));
-
-
-	if(!uv_index_db->uv_index_enable || uv_index_db->uv_index_tr->trigger_inactive){
-	timeout_remove(uv_index_db->timeout_id);
-	return;
-	}
-	
-	timer=uv_index_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(uv_index_db->uv_index_tr->time_enable)   
-	uv_index_db->timeout_id=timeout_add(timer,uv_index_time_calculation,server,NULL);
-	else
-	uv_index_db->timeout_id=timeout_add(1000,uv_index_value_calculation,server,NULL);
-	
-}
-
-
-static void uv_index_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || uv_index_db->uv_index_tr->trigger_inactive)
-		uv_index_db->uv_index_enable = false;
-	else if (value[0] == 0x01) {
-		uv_index_db->uv_index_enable = true;
-		uv_index_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_uv_index_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void uv_index_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=uv_index_db->uv_index_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = uv_index_db->uv_index_tr->data[0];
-		val[2] = uv_index_db->uv_index_tr->data[1];
-		val[3] = uv_index_db->uv_index_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else{
-		error=0;
-		val[1]=(uint8_t)uv_index_db->tr_value;
-		len=2;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void uv_index_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		uv_index_db->uv_index_tr->trigger_inactive=false;
-		uv_index_db->uv_index_tr->data[0] = value[1];		/* if trigger is time based  */
-		uv_index_db->uv_index_tr->data[1] = value[2];
-		uv_index_db->uv_index_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		uv_index_db->uv_index_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		uv_index_db->uv_index_tr->trigger_inactive=true;
-		if(uv_index_db->timeout_id!=0){
-			timeout_remove(uv_index_db->timeout_id);
-			uv_index_db->uv_index_enable = false;
-			uv_index_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		uv_index_db->uv_index_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else{
-		if(len!=2){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		uv_index_db->uv_index_tr->trigger_inactive=false;		/* if trigger is value based */
-		uv_index_db->tr_value=value[1];
-		
-	}
-
-	uv_index_db->uv_index_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( uv_index_db->uv_index_tr->condition==0x01 || uv_index_db->uv_index_tr->condition==0x02){
-		uv_index_db->uv_index_tr->value_enable=false;
-		uv_index_db->uv_index_tr->time_enable=true;
-	} else if( uv_index_db->uv_index_tr->condition>=0x03 && uv_index_db->uv_index_tr->condition<= 0x09){
-		uv_index_db->uv_index_tr->time_enable=false;
-		uv_index_db->uv_index_tr->value_enable=true;
-		if(uv_index_db->uv_index_enable && !uv_index_db->uv_index_tr->trigger_inactive){
-			timeout_remove(uv_index_db->timeout_id);
-			update_uv_index_timer(conn);
-		}	
-	} else{	
-
-		uv_index_db->uv_index_tr->trigger_inactive=true;
-		uv_index_db->uv_index_tr->time_enable=false;
-		uv_index_db->uv_index_tr->value_enable=false;
-		if(uv_index_db->uv_index_enable && !uv_index_db->uv_index_tr->trigger_inactive){
-			timeout_remove(uv_index_db->timeout_id);
-			update_uv_index_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(uv_index_db->uv_index_tr->time_enable)
-	uv_index_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(uv_index_db->g_update_timer!=uv_index_db->g_current_timer && uv_index_db->uv_index_tr->time_enable){
-		timeout_remove(uv_index_db->timeout_id);
-		update_uv_index_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void wind_chill_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int8_t value;
-
-	value=wind_chill_db->wind_chill_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 1);
-
-}
-
-
-static void wind_chill_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = wind_chill_db->wind_chill_ms->sample;
-	value[3] = wind_chill_db->wind_chill_ms->m_period[0];
-	value[4] = wind_chill_db->wind_chill_ms->m_period[1];
-	value[5] = wind_chill_db->wind_chill_ms->m_period[2];
-	value[6] = wind_chill_db->wind_chill_ms->u_interval[0];
-	value[7] = wind_chill_db->wind_chill_ms->u_interval[1];
-	value[8] = wind_chill_db->wind_chill_ms->u_interval[2];
-	value[9] = wind_chill_db->wind_chill_ms->applicatn;
-	value[10] = wind_chill_db->wind_chill_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void wind_chill_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int8_t value[2];
-
-	value[0]=wind_chill_db->lower_wind_chill;
-	value[1]=wind_chill_db->upper_wind_chill;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
-
-}
-	
-
-
-static void wind_chill_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=wind_chill_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void wind_chill_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(wind_chill_db->user_desc,0,21);
-	memcpy(wind_chill_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void wind_chill_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=wind_chill_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool wind_chill_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,wind_chill_db->wind_chill_handle,
-						(uint8_t *)&pdu, 1);
-
-	return true;
-}
-
-
-static bool wind_chill_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int8_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(wind_chill_db->wind_chill_tr->condition){
-
-		case 0x03 : if( pdu == wind_chill_db->wind_chill_data)
-				notify=false;
-			    else
-			    	wind_chill_db->wind_chill_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= wind_chill_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > wind_chill_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= wind_chill_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < wind_chill_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != wind_chill_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == wind_chill_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,wind_chill_db->wind_chill_handle,
-						(uint8_t *)&pdu, 1);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_wind_chill_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	wind_chill_db->g_current_timer=((wind_chill_db->wind_chill_tr->data[0]) | (wind_chill_db->wind_chill_tr->data[1]<<8) | (wind_chill_db->wind_chill_tr->data[2]<<16));
-
-
-	if(!wind_chill_db->wind_chill_enable || wind_chill_db->wind_chill_tr->trigger_inactive){
-	timeout_remove(wind_chill_db->timeout_id);
-	return;
-	}
-	
-	timer=wind_chill_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(wind_chill_db->wind_chill_tr->time_enable)   
-	wind_chill_db->timeout_id=timeout_add(timer,wind_chill_time_calculation,server,NULL);
-	else
-	wind_chill_db->timeout_id=timeout_add(1000,wind_chill_value_calculation,server,NULL);
-	
-}
-
-
-static void wind_chill_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || wind_chill_db->wind_chill_tr->trigger_inactive)
-		wind_chill_db->wind_chill_enable = false;
-	else if (value[0] == 0x01) {
-		wind_chill_db->wind_chill_enable = true;
-		wind_chill_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_wind_chill_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void wind_chill_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=wind_chill_db->wind_chill_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = wind_chill_db->wind_chill_tr->data[0];
-		val[2] = wind_chill_db->wind_chill_tr->data[1];
-		val[3] = wind_chill_db->wind_chill_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	} else{
-		error=0;
-		val[1]=(uint8_t)wind_chill_db->tr_value;
-		len=2;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void wind_chill_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		wind_chill_db->wind_chill_tr->trigger_inactive=false;
-		wind_chill_db->wind_chill_tr->data[0] = value[1];		/* if trigger is time based  */
-		wind_chill_db->wind_chill_tr->data[1] = value[2];
-		wind_chill_db->wind_chill_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		wind_chill_db->wind_chill_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		wind_chill_db->wind_chill_tr->trigger_inactive=true;
-		if(wind_chill_db->timeout_id!=0){
-			timeout_remove(wind_chill_db->timeout_id);
-			wind_chill_db->wind_chill_enable = false;
-			wind_chill_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		wind_chill_db->wind_chill_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else{
-		if(len!=2){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		wind_chill_db->wind_chill_tr->trigger_inactive=false;		/* if trigger is value based */
-		wind_chill_db->tr_value=value[1];
-		
-	}
-
-	wind_chill_db->wind_chill_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( wind_chill_db->wind_chill_tr->condition==0x01 || wind_chill_db->wind_chill_tr->condition==0x02){
-		wind_chill_db->wind_chill_tr->value_enable=false;
-		wind_chill_db->wind_chill_tr->time_enable=true;
-	} else if( wind_chill_db->wind_chill_tr->condition>=0x03 && wind_chill_db->wind_chill_tr->condition<= 0x09){
-		wind_chill_db->wind_chill_tr->time_enable=false;
-		wind_chill_db->wind_chill_tr->value_enable=true;
-		if(wind_chill_db->wind_chill_enable && !wind_chill_db->wind_chill_tr->trigger_inactive){
-			timeout_remove(wind_chill_db->timeout_id);
-			update_wind_chill_timer(conn);
-		}	
-	} else{	
-
-		wind_chill_db->wind_chill_tr->trigger_inactive=true;
-		wind_chill_db->wind_chill_tr->time_enable=false;
-		wind_chill_db->wind_chill_tr->value_enable=false;
-		if(wind_chill_db->wind_chill_enable && !wind_chill_db->wind_chill_tr->trigger_inactive){
-			timeout_remove(wind_chill_db->timeout_id);
-			update_wind_chill_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(wind_chill_db->wind_chill_tr->time_enable)
-	wind_chill_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(wind_chill_db->g_update_timer!=wind_chill_db->g_current_timer && wind_chill_db->wind_chill_tr->time_enable){
-		timeout_remove(wind_chill_db->timeout_id);
-		update_wind_chill_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Barometric Pressure Trend characteristics      ***
-*/
-
-
-static void barometric_pressure_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint8_t value;
-
-	value=barometric_pressure_db->barometric_pressure_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, &value, 1);
-
-}
-
-
-static void barometric_pressure_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = barometric_pressure_db->barometric_pressure_ms->sample;
-	value[3] = barometric_pressure_db->barometric_pressure_ms->m_period[0];
-	value[4] = barometric_pressure_db->barometric_pressure_ms->m_period[1];
-	value[5] = barometric_pressure_db->barometric_pressure_ms->m_period[2];
-	value[6] = barometric_pressure_db->barometric_pressure_ms->u_interval[0];
-	value[7] = barometric_pressure_db->barometric_pressure_ms->u_interval[1];
-	value[8] = barometric_pressure_db->barometric_pressure_ms->u_interval[2];
-	value[9] = barometric_pressure_db->barometric_pressure_ms->applicatn;
-	value[10] = barometric_pressure_db->barometric_pressure_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void barometric_pressure_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint8_t value[2];
-/*
-	value[0]=barometric_pressure_db->lower_barometric_pressure;
-	value[1]=barometric_pressure_db->upper_barometric_pressure;
-*/	
-	value[0]=rand();
-	value[1]=rand();
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 2);
-
-}
-	
-
-
-static void barometric_pressure_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=barometric_pressure_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void barometric_pressure_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(barometric_pressure_db->user_desc,0,21);
-	memcpy(barometric_pressure_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Magnetic Declination characteristics           ***
-*/
-
-
-static void magnetic_declination_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value;
-
-	value=magnetic_declination_db->magnetic_declination_data;	
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static void magnetic_declination_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = magnetic_declination_db->magnetic_declination_ms->sample;
-	value[3] = magnetic_declination_db->magnetic_declination_ms->m_period[0];
-	value[4] = magnetic_declination_db->magnetic_declination_ms->m_period[1];
-	value[5] = magnetic_declination_db->magnetic_declination_ms->m_period[2];
-	value[6] = magnetic_declination_db->magnetic_declination_ms->u_interval[0];
-	value[7] = magnetic_declination_db->magnetic_declination_ms->u_interval[1];
-	value[8] = magnetic_declination_db->magnetic_declination_ms->u_interval[2];
-	value[9] = magnetic_declination_db->magnetic_declination_ms->applicatn;
-	value[10] = magnetic_declination_db->magnetic_declination_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void magnetic_declination_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	uint16_t value[2];
-
-	value[0]=magnetic_declination_db->lower_magnetic_declination;
-	value[1]=magnetic_declination_db->upper_magnetic_declination;
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-	
-
-
-static void magnetic_declination_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=magnetic_declination_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void magnetic_declination_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(magnetic_declination_db->user_desc,0,21);
-	memcpy(magnetic_declination_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void magnetic_declination_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=magnetic_declination_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool magnetic_declination_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-
-	
-
-		
-	pdu=rand();
-
-	bt_gatt_server_send_notification(server->gatt,magnetic_declination_db->magnetic_declination_handle,
-						(uint8_t *)&pdu, 2);
-
-	return true;
-}
-
-
-static bool magnetic_declination_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	uint16_t pdu;
-	uint8_t notify=true;
-
-	
-
-		
-	pdu=rand();
-
-
-
-	/* checking the trigger condition and notifying based on the particular condition */
- 
-	switch(magnetic_declination_db->magnetic_declination_tr->condition){
-
-		case 0x03 : if( pdu == magnetic_declination_db->magnetic_declination_data)
-				notify=false;
-			    else
-			    	magnetic_declination_db->magnetic_declination_data= pdu;
-			    break;
-
-		case 0x04 : if( pdu >= magnetic_declination_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu > magnetic_declination_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu <= magnetic_declination_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu < magnetic_declination_db->tr_value)
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu != magnetic_declination_db->tr_value)
-				notify=false;
-			    break;
-
-		default   : if( pdu == magnetic_declination_db->tr_value)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,magnetic_declination_db->magnetic_declination_handle,
-						(uint8_t *)&pdu, 2);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_magnetic_declination_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	magnetic_declination_db->g_current_timer=((magnetic_declination_db->magnetic_declination_tr->data[0]) | (magnetic_declination_db->magnetic_declination_tr->data[1]<<8) | (magnetic_declination_db->magnetic_declination_tr->data[2]<<16));
-
-
-	if(!magnetic_declination_db->magnetic_declination_enable || magnetic_declination_db->magnetic_declination_tr->trigger_inactive){
-	timeout_remove(magnetic_declination_db->timeout_id);
-	return;
-	}
-	
-	timer=magnetic_declination_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(magnetic_declination_db->magnetic_declination_tr->time_enable)   
-	magnetic_declination_db->timeout_id=timeout_add(timer,magnetic_declination_time_calculation,server,NULL);
-	else
-	magnetic_declination_db->timeout_id=timeout_add(1000,magnetic_declination_value_calculation,server,NULL);
-	
-}
-
-
-static void magnetic_declination_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || magnetic_declination_db->magnetic_declination_tr->trigger_inactive)
-		magnetic_declination_db->magnetic_declination_enable = false;
-	else if (value[0] == 0x01) {
-		magnetic_declination_db->magnetic_declination_enable = true;
-		magnetic_declination_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_magnetic_declination_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void magnetic_declination_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[4];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-
-	val[0]=magnetic_declination_db->magnetic_declination_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = magnetic_declination_db->magnetic_declination_tr->data[0];
-		val[2] = magnetic_declination_db->magnetic_declination_tr->data[1];
-		val[3] = magnetic_declination_db->magnetic_declination_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else{
-		error=0;
-		val[1]=(uint8_t)magnetic_declination_db->tr_value;
-		val[2]=(uint8_t)(magnetic_declination_db->tr_value>>8);
-		len=3;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void magnetic_declination_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>4) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=false;
-		magnetic_declination_db->magnetic_declination_tr->data[0] = value[1];		/* if trigger is time based  */
-		magnetic_declination_db->magnetic_declination_tr->data[1] = value[2];
-		magnetic_declination_db->magnetic_declination_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_declination_db->magnetic_declination_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=true;
-		if(magnetic_declination_db->timeout_id!=0){
-			timeout_remove(magnetic_declination_db->timeout_id);
-			magnetic_declination_db->magnetic_declination_enable = false;
-			magnetic_declination_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {
-		if(len!=3){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}		
-		error=0;
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=false;		/* if trigger is value based */
-		magnetic_declination_db->tr_value=value[1] | value[2]<<8 ;
-		
-	}
-
-	magnetic_declination_db->magnetic_declination_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( magnetic_declination_db->magnetic_declination_tr->condition==0x01 || magnetic_declination_db->magnetic_declination_tr->condition==0x02){
-		magnetic_declination_db->magnetic_declination_tr->value_enable=false;
-		magnetic_declination_db->magnetic_declination_tr->time_enable=true;
-	} else if( magnetic_declination_db->magnetic_declination_tr->condition>=0x03 && magnetic_declination_db->magnetic_declination_tr->condition<= 0x09){
-		magnetic_declination_db->magnetic_declination_tr->time_enable=false;
-		magnetic_declination_db->magnetic_declination_tr->value_enable=true;
-		if(magnetic_declination_db->magnetic_declination_enable && !magnetic_declination_db->magnetic_declination_tr->trigger_inactive){
-			timeout_remove(magnetic_declination_db->timeout_id);
-			update_magnetic_declination_timer(conn);
-		}	
-	} else{	
-
-		magnetic_declination_db->magnetic_declination_tr->trigger_inactive=true;
-		magnetic_declination_db->magnetic_declination_tr->time_enable=false;
-		magnetic_declination_db->magnetic_declination_tr->value_enable=false;
-		if(magnetic_declination_db->magnetic_declination_enable && !magnetic_declination_db->magnetic_declination_tr->trigger_inactive){
-			timeout_remove(magnetic_declination_db->timeout_id);
-			update_magnetic_declination_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(magnetic_declination_db->magnetic_declination_tr->time_enable)
-	magnetic_declination_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(magnetic_declination_db->g_update_timer!=magnetic_declination_db->g_current_timer && magnetic_declination_db->magnetic_declination_tr->time_enable){
-		timeout_remove(magnetic_declination_db->timeout_id);
-		update_magnetic_declination_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Magnetic Flux Density 2D characteristics       ***
-*/
-
-static void magnetic_flux_2D_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int16_t value[2];
-
-	value[0]=magnetic_flux_2D_db->magnetic_flux_2D_xdata;
-	value[1]=magnetic_flux_2D_db->magnetic_flux_2D_ydata;		
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 4);
-
-}
-
-
-static void magnetic_flux_2D_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = magnetic_flux_2D_db->magnetic_flux_2D_ms->sample;
-	value[3] = magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[0];
-	value[4] = magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[1];
-	value[5] = magnetic_flux_2D_db->magnetic_flux_2D_ms->m_period[2];
-	value[6] = magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[0];
-	value[7] = magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[1];
-	value[8] = magnetic_flux_2D_db->magnetic_flux_2D_ms->u_interval[2];
-	value[9] = magnetic_flux_2D_db->magnetic_flux_2D_ms->applicatn;
-	value[10] = magnetic_flux_2D_db->magnetic_flux_2D_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void magnetic_flux_2D_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int16_t value[4];
-
-	value[0]=magnetic_flux_2D_db->xlower_magnetic_flux_2D;
-	value[1]=magnetic_flux_2D_db->xupper_magnetic_flux_2D;
-	value[2]=magnetic_flux_2D_db->ylower_magnetic_flux_2D;
-	value[3]=magnetic_flux_2D_db->yupper_magnetic_flux_2D;
-	
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 8);
-
-}
-	
-
-
-static void magnetic_flux_2D_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=magnetic_flux_2D_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void magnetic_flux_2D_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(magnetic_flux_2D_db->user_desc,0,21);
-	memcpy(magnetic_flux_2D_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void magnetic_flux_2D_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=magnetic_flux_2D_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool magnetic_flux_2D_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int16_t pdu[2];
-
-	
-
-		
-	pdu[0]=rand();
-	pdu[1]=rand();
-
-	bt_gatt_server_send_notification(server->gatt,magnetic_flux_2D_db->magnetic_flux_2D_handle,
-						(uint8_t *)pdu, 4);
-
-	return true;
-}
-
-
-static bool magnetic_flux_2D_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int16_t pdu[2];
-	uint8_t notify=true;
-
-	
-
-		
-	pdu[0]=rand();
-	pdu[1]=rand();
-
-
-
-	/*
-	*** checking the trigger condition and notifying based on the particular condition                 ***
-	*** in Condition 0x04,0x05,0x06,0x07,0x08,0x09 the x,y flux values are checked with trigger values ***
-	*** if any one or two values are matching the trigger condition they will be notified              ***
-	*** and previously value will be notified for the one's not matching trigger condition             ***   
-	*/
- 
-	switch(magnetic_flux_2D_db->magnetic_flux_2D_tr->condition){
-
-		case 0x03 : if( pdu[0] == magnetic_flux_2D_db->magnetic_flux_2D_xdata && pdu[1]== magnetic_flux_2D_db->magnetic_flux_2D_ydata)
-				notify=false;
-			    break;
-
-		case 0x04 : if( pdu[0]>=magnetic_flux_2D_db->tr_valuex && pdu[1]>=magnetic_flux_2D_db->tr_valuey)
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu[0] > magnetic_flux_2D_db->tr_valuex && pdu[1] > magnetic_flux_2D_db->tr_valuey)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu[0] <= magnetic_flux_2D_db->tr_valuex &&  pdu[1] <= magnetic_flux_2D_db->tr_valuey)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu[0] < magnetic_flux_2D_db->tr_valuex && pdu[1] < magnetic_flux_2D_db->tr_valuey )
-				notify=false;
-			    break;
-
-		case 0x08 : if( pdu[0] != magnetic_flux_2D_db->tr_valuex && pdu[1] != magnetic_flux_2D_db->tr_valuey )
-				notify=false;
-			    break;
-
-		default   : if( pdu[0] == magnetic_flux_2D_db->tr_valuex && pdu[1]== magnetic_flux_2D_db->tr_valuey)
-				notify=false;
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,magnetic_flux_2D_db->magnetic_flux_2D_handle,
-						(uint8_t *)pdu, 4);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_magnetic_flux_2D_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	magnetic_flux_2D_db->g_current_timer=((magnetic_flux_2D_db->magnetic_flux_2D_tr->data[0]) | (magnetic_flux_2D_db->magnetic_flux_2D_tr->data[1]<<8) | (magnetic_flux_2D_db->magnetic_flux_2D_tr->data[2]<<16));
-
-
-	if(!magnetic_flux_2D_db->magnetic_flux_2D_enable || magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive){
-	timeout_remove(magnetic_flux_2D_db->timeout_id);
-	return;
-	}
-	
-	timer=magnetic_flux_2D_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable)   
-	magnetic_flux_2D_db->timeout_id=timeout_add(timer,magnetic_flux_2D_time_calculation,server,NULL);
-	else
-	magnetic_flux_2D_db->timeout_id=timeout_add(1000,magnetic_flux_2D_value_calculation,server,NULL);
-	
-}
-
-
-static void magnetic_flux_2D_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive)
-		magnetic_flux_2D_db->magnetic_flux_2D_enable = false;
-	else if (value[0] == 0x01) {
-		magnetic_flux_2D_db->magnetic_flux_2D_enable = true;
-		magnetic_flux_2D_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_magnetic_flux_2D_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void magnetic_flux_2D_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[5];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=magnetic_flux_2D_db->magnetic_flux_2D_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = magnetic_flux_2D_db->magnetic_flux_2D_tr->data[0];
-		val[2] = magnetic_flux_2D_db->magnetic_flux_2D_tr->data[1];
-		val[3] = magnetic_flux_2D_db->magnetic_flux_2D_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03){
-		error=0;
-		len=1;
-	}else {
-		error=0;
-		val[1]=(uint8_t)magnetic_flux_2D_db->tr_valuex;
-		val[2]=(uint8_t)(magnetic_flux_2D_db->tr_valuex>>8);
-		val[3]=(uint8_t)magnetic_flux_2D_db->tr_valuey;
-		val[4]=(uint8_t)(magnetic_flux_2D_db->tr_valuey>>8);
-		len=5;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void magnetic_flux_2D_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>5) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=false;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->data[0] = value[1];		/* if trigger is time based  */
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->data[1] = value[2];
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=true;
-		if(magnetic_flux_2D_db->timeout_id!=0){
-			timeout_remove(magnetic_flux_2D_db->timeout_id);
-			magnetic_flux_2D_db->magnetic_flux_2D_enable = false;
-			magnetic_flux_2D_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=false;		/* if trigger is value based */
-	}else {
-		if(len!=5){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=false;		/* if trigger is value based */
-		magnetic_flux_2D_db->tr_valuex=value[1] | value[2]<<8 ;
-		magnetic_flux_2D_db->tr_valuey=value[3] | value[4]<<8 ;
-		
-	}
-
-	magnetic_flux_2D_db->magnetic_flux_2D_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( magnetic_flux_2D_db->magnetic_flux_2D_tr->condition==0x01 || magnetic_flux_2D_db->magnetic_flux_2D_tr->condition==0x02){
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->value_enable=false;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable=true;
-	} else if( magnetic_flux_2D_db->magnetic_flux_2D_tr->condition>=0x03 && magnetic_flux_2D_db->magnetic_flux_2D_tr->condition<= 0x09){
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable=false;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->value_enable=true;
-		if(magnetic_flux_2D_db->magnetic_flux_2D_enable && !magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive){
-			timeout_remove(magnetic_flux_2D_db->timeout_id);
-			update_magnetic_flux_2D_timer(conn);
-		}	
-	} else{	
-
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive=true;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable=false;
-		magnetic_flux_2D_db->magnetic_flux_2D_tr->value_enable=false;
-		if(magnetic_flux_2D_db->magnetic_flux_2D_enable && !magnetic_flux_2D_db->magnetic_flux_2D_tr->trigger_inactive){
-			timeout_remove(magnetic_flux_2D_db->timeout_id);
-			update_magnetic_flux_2D_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable)
-	magnetic_flux_2D_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(magnetic_flux_2D_db->g_update_timer!=magnetic_flux_2D_db->g_current_timer && magnetic_flux_2D_db->magnetic_flux_2D_tr->time_enable){
-		timeout_remove(magnetic_flux_2D_db->timeout_id);
-		update_magnetic_flux_2D_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-/*
-*** This section cocnsist of all the call backs of ***
-*** Magnetic Flux Density 3D characteristics       ***
-*/
-
-
-static void magnetic_flux_3D_read(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int16_t value[3];
-
-	value[0]=magnetic_flux_3D_db->magnetic_flux_3D_xdata;
-	value[1]=magnetic_flux_3D_db->magnetic_flux_3D_ydata;		
-	value[2]=magnetic_flux_3D_db->magnetic_flux_3D_zdata;		
-	
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 6);
-
-}
-
-
-static void magnetic_flux_3D_measurement_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0,value[11];
-
-	value[0] = 0;
-	value[1] = 0;
-	value[2] = magnetic_flux_3D_db->magnetic_flux_3D_ms->sample;
-	value[3] = magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[0];
-	value[4] = magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[1];
-	value[5] = magnetic_flux_3D_db->magnetic_flux_3D_ms->m_period[2];
-	value[6] = magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[0];
-	value[7] = magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[1];
-	value[8] = magnetic_flux_3D_db->magnetic_flux_3D_ms->u_interval[2];
-	value[9] = magnetic_flux_3D_db->magnetic_flux_3D_ms->applicatn;
-	value[10] = magnetic_flux_3D_db->magnetic_flux_3D_ms->m_uncertainity;
-
-	gatt_db_attribute_read_result(attrib, id, error, value, 11);
-
-}
-
-
-
-static void magnetic_flux_3D_valid_range_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	int16_t value[6];
-
-	value[0]=magnetic_flux_3D_db->xlower_magnetic_flux_3D;
-	value[1]=magnetic_flux_3D_db->xupper_magnetic_flux_3D;
-	value[2]=magnetic_flux_3D_db->ylower_magnetic_flux_3D;
-	value[3]=magnetic_flux_3D_db->yupper_magnetic_flux_3D;
-	value[4]=magnetic_flux_3D_db->zlower_magnetic_flux_3D;
-	value[5]=magnetic_flux_3D_db->zupper_magnetic_flux_3D;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 12);
-
-}
-	
-
-
-static void magnetic_flux_3D_char_user_desc_read_cb(struct gatt_db_attribute *attrib,
-		      unsigned int id, uint16_t offset,
-		      uint8_t opcode, struct bt_att *att, void *user_data)
-{
-
-	uint8_t error=0;
-	wchar_t *value;
-
-	value=magnetic_flux_3D_db->user_desc;
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)value, 21);
-
-}
-
-
-static void magnetic_flux_3D_char_user_desc_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	/* checking if user string is empty or more than the default size */
-	
-	if(!value || len>=22){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if(offset){
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	/* initializing the string with zero's and then copying the new string to the data base */
-
-	memset(magnetic_flux_3D_db->user_desc,0,21);
-	memcpy(magnetic_flux_3D_db->user_desc,value,len+1);
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-
-static void magnetic_flux_3D_msrmt_ccc_read_cb(struct gatt_db_attribute *attrib,
-					unsigned int id, uint16_t offset,
-					uint8_t opcode, struct bt_att *att,
-					void *user_data)
-{
-
-	uint8_t error;
-	static uint16_t value;
-
-	if(offset>2)
-	{
-	error=BT_ATT_ERROR_INVALID_OFFSET;
-	}
-	else
-	{
-	error=0;
-	value=magnetic_flux_3D_db->indication;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, (uint8_t *)&value, 2);
-
-}
-
-
-static bool magnetic_flux_3D_time_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int16_t pdu[3];
-
-	
-
-		
-	pdu[0]=rand();
-	pdu[1]=rand();
-	pdu[2]=rand();
-
-	bt_gatt_server_send_notification(server->gatt,magnetic_flux_3D_db->magnetic_flux_3D_handle,
-						(uint8_t *)pdu, 6);
-
-	return true;
-}
-
-
-static bool magnetic_flux_3D_value_calculation(void *user_data)
-{
-
-	struct gatt_conn *server=user_data;
-	int16_t pdu[3];
-	uint8_t notify=true;
-
-	
-
-		
-	pdu[0]=rand();
-	pdu[1]=rand();
-	pdu[2]=rand();
-
-
-
-	/*
-	*** checking the trigger condition and notifying based on the particular condition         ***
-	*** in Condition 0x04,0x05,0x06,0x07 the x,y,z flux values are checked with trigger values ***
-	*** if any one,two or all values are matching the trigger condition they will be notified  ***
-	*** and previously value will be notified for the one's not matching trigger condition     ***   
-	*/
- 
-	switch(magnetic_flux_3D_db->magnetic_flux_3D_tr->condition){
-
-		case 0x03 : if( pdu[0] == magnetic_flux_3D_db->magnetic_flux_3D_xdata &&  pdu[1] == magnetic_flux_3D_db->magnetic_flux_3D_ydata &&  pdu[2] == magnetic_flux_3D_db->magnetic_flux_3D_zdata)
-				notify=false;
-			    else{
-			    	magnetic_flux_3D_db->magnetic_flux_3D_xdata= pdu[0];
-			    	magnetic_flux_3D_db->magnetic_flux_3D_ydata= pdu[1];
-			    	magnetic_flux_3D_db->magnetic_flux_3D_zdata= pdu[2];
-			    }
-			    break;
-
-		case 0x04 : if( pdu[0] >= magnetic_flux_3D_db->tr_valuex && pdu[1] >= magnetic_flux_3D_db->tr_valuey && pdu[2] >= magnetic_flux_3D_db->tr_valuez )
-				notify=false;
-			    break;
-
-		case 0x05 : if( pdu[0] > magnetic_flux_3D_db->tr_valuex && pdu[1] > magnetic_flux_3D_db->tr_valuey && pdu[2] > magnetic_flux_3D_db->tr_valuez)
-				notify=false;
-			    break;
-
-		case 0x06 : if( pdu[0] <= magnetic_flux_3D_db->tr_valuex && pdu[1] <= magnetic_flux_3D_db->tr_valuey && pdu[2] <= magnetic_flux_3D_db->tr_valuez)
-				notify=false;
-			    break;
-
-		case 0x07 : if( pdu[0] < magnetic_flux_3D_db->tr_valuex && pdu[1] < magnetic_flux_3D_db->tr_valuey && pdu[2] < magnetic_flux_3D_db->tr_valuez)
-				notify=false;
-			    break;
-
-		default   : if( pdu[0] == magnetic_flux_3D_db->tr_valuex && pdu[1] == magnetic_flux_3D_db->tr_valuey && pdu[2] == magnetic_flux_3D_db->tr_valuez)
-				notify=false;
-
-	}
-	
-	/* notify only if its satisfying the trigger condition */			
-	if(notify){
-	bt_gatt_server_send_notification(server->gatt,magnetic_flux_3D_db->magnetic_flux_3D_handle,
-						(uint8_t *)pdu, 6);
-	}
-
-	return true;
-}
-
-/* Timer function will read the trigger setting and call a function to send notification based on value or time */ 
-
-static void update_magnetic_flux_3D_timer(struct gatt_conn *server)
-{
-	
-	unsigned int timer;
-
-	magnetic_flux_3D_db->g_current_timer=((magnetic_flux_3D_db->magnetic_flux_3D_tr->data[0]) | (magnetic_flux_3D_db->magnetic_flux_3D_tr->data[1]<<8) | (magnetic_flux_3D_db->magnetic_flux_3D_tr->data[2]<<16));
-
-
-	if(!magnetic_flux_3D_db->magnetic_flux_3D_enable || magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive){
-	timeout_remove(magnetic_flux_3D_db->timeout_id);
-	return;
-	}
-	
-	timer=magnetic_flux_3D_db->g_current_timer*1000;
-	
-
-	/* 
-	** if trigger is based on time call the notification based on trigger value **
-	** if trigger is based on value call the function on every one sec and check the trigger condition and notify **
-	*/
-
- 
-	if(magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable)   
-	magnetic_flux_3D_db->timeout_id=timeout_add(timer,magnetic_flux_3D_time_calculation,server,NULL);
-	else
-	magnetic_flux_3D_db->timeout_id=timeout_add(1000,magnetic_flux_3D_value_calculation,server,NULL);
-	
-}
-
-
-static void magnetic_flux_3D_msrmt_ccc_write_cb(struct gatt_db_attribute *attrib,
-				    unsigned int id, uint16_t offset,
-				    const uint8_t * value, size_t len,
-				    uint8_t opcode, struct bt_att *att,
-				    void *user_data)
-{
-
-	uint8_t error = 0;
-	struct gatt_conn *server = conn;
-
-	if (!value || len != 2) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-		goto done;
-	}
-
-	if (offset) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		goto done;
-	}
-
-	/* enabling the notification and updating the data base */
-	
-	if (value[0] == 0x00 || magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive)
-		magnetic_flux_3D_db->magnetic_flux_3D_enable = false;
-	else if (value[0] == 0x01) {
-		magnetic_flux_3D_db->magnetic_flux_3D_enable = true;
-		magnetic_flux_3D_db->indication = 0x0001;
-	} else
-		error = 0x80;
-
-	/* updating a timer function to call notification on a periodic interval */
-
-	update_magnetic_flux_3D_timer(server);
-
- done:
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void magnetic_flux_3D_triger_read_cb(struct gatt_db_attribute *attrib,
-			       unsigned int id, uint16_t offset,
-			       uint8_t opcode, struct bt_att *att,
-			       void *user_data)
-{
-	uint8_t error,len;
-	uint8_t val[7];
-
-	/* checking the trigger conditions and sending time or value based on the conition */
-	val[0]=magnetic_flux_3D_db->magnetic_flux_3D_tr->condition;
-
-	if(val[0] == 0x00){
-		error=0;
-		len=1;
-	}else if(val[0] == 0x01 || val[0]==0x02){
-		error = 0;
-		val[1] = magnetic_flux_3D_db->magnetic_flux_3D_tr->data[0];
-		val[2] = magnetic_flux_3D_db->magnetic_flux_3D_tr->data[1];
-		val[3] = magnetic_flux_3D_db->magnetic_flux_3D_tr->data[2];
-		len=4;
-	}else if(val[0]==0x03) {
-		error=0;
-		len=1;
-	} else {
-		error=0;
-		val[1]=(uint8_t)magnetic_flux_3D_db->tr_valuex;
-		val[2]=(uint8_t)(magnetic_flux_3D_db->tr_valuex>>8);
-		val[3]=(uint8_t)magnetic_flux_3D_db->tr_valuey;
-		val[4]=(uint8_t)(magnetic_flux_3D_db->tr_valuey>>8);
-		val[5]=(uint8_t)magnetic_flux_3D_db->tr_valuez;
-		val[6]=(uint8_t)(magnetic_flux_3D_db->tr_valuez>>8);
-		len=7;
-	}
-	
-
-	gatt_db_attribute_read_result(attrib, id, error, val, len);
-
-}
-
-
-static void magnetic_flux_3D_triger_write_cb(struct gatt_db_attribute *attrib,
-				unsigned int id, uint16_t offset,
-				const uint8_t * value, size_t len,
-				uint8_t opcode, struct bt_att *att,
-				void *user_data)
-{
-
-	uint8_t error;
-
-	if (len<1 || len>7) {
-		error = BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN;
-	} else if(value[0] < 255 && value[0]>= 10){ 	/* checking if the value is RFU */
-		error = BT_ERROR_OUT_OF_RANGE ;	
-	} else if(value[0]==0x01 || value[0]==0x02){
-		if(len!=4){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error = 0;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=false;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->data[0] = value[1];		/* if trigger is time based  */
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->data[1] = value[2];
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->data[2] = value[3];
-	}else if(value[0]==0x00){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->condition = value[0] ;	/* if trigger is inactive check notification is enable if yes disable the 												notification */
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=true;
-		if(magnetic_flux_3D_db->timeout_id!=0){
-			timeout_remove(magnetic_flux_3D_db->timeout_id);
-			magnetic_flux_3D_db->magnetic_flux_3D_enable = false;
-			magnetic_flux_3D_db->indication = 0x0000;
-			goto done;
-		}
-	} else if(value[0]==0x03){
-		if(len!=1){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=false;		/* if trigger is value based */
-	} else {
-		if(len!=7){
-			error=BT_ATT_ERROR_INVALID_PDU;
-			goto done;
-		}
-		error=0;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=false;		/* if trigger is value based */
-		magnetic_flux_3D_db->tr_valuex=value[1] | value[2]<<8 ;
-		magnetic_flux_3D_db->tr_valuey=value[3] | value[4]<<8 ;
-		magnetic_flux_3D_db->tr_valuez=value[5] | value[6]<<8 ;
-		
-	}
-
-	magnetic_flux_3D_db->magnetic_flux_3D_tr->condition=value[0] ;
-	
-
-	/*
-	** checking if trigger is time or value based which will use in enabling the notification **
-	** if notification is already enabled update the timer with new values  **
-	*/
-
-	if( magnetic_flux_3D_db->magnetic_flux_3D_tr->condition==0x01 || magnetic_flux_3D_db->magnetic_flux_3D_tr->condition==0x02){
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->value_enable=false;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable=true;
-	} else if( magnetic_flux_3D_db->magnetic_flux_3D_tr->condition>=0x03 && magnetic_flux_3D_db->magnetic_flux_3D_tr->condition<= 0x09){
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable=false;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->value_enable=true;
-		if(magnetic_flux_3D_db->magnetic_flux_3D_enable && !magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive){
-			timeout_remove(magnetic_flux_3D_db->timeout_id);
-			update_magnetic_flux_3D_timer(conn);
-		}	
-	} else{	
-
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive=true;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable=false;
-		magnetic_flux_3D_db->magnetic_flux_3D_tr->value_enable=false;
-		if(magnetic_flux_3D_db->magnetic_flux_3D_enable && !magnetic_flux_3D_db->magnetic_flux_3D_tr->trigger_inactive){
-			timeout_remove(magnetic_flux_3D_db->timeout_id);
-			update_magnetic_flux_3D_timer(conn);
-		}	
-		
-	}
-	
-	/*
-	*** updating the gloabal timer and checking if its not equal to current timer *** 
-	*** then calling the update timer function to update the timer to notify      ***
-	*/
-	
-	if(magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable)
-	magnetic_flux_3D_db->g_update_timer=(value[1])|(value[2]<<8)| (value[3]<<16);
-
-
-	if(magnetic_flux_3D_db->g_update_timer!=magnetic_flux_3D_db->g_current_timer && magnetic_flux_3D_db->magnetic_flux_3D_tr->time_enable){
-		timeout_remove(magnetic_flux_3D_db->timeout_id);
-		update_magnetic_flux_3D_timer(conn);
-	}
-	
-
-done :
-
-	gatt_db_attribute_write_result(attrib, id, error);
-
-}
-
-static void gap_device_name_read(struct gatt_db_attribute *attrib,
-				 unsigned int id, uint16_t offset,
-				 uint8_t opcode, struct bt_att *att,
-				 void *user_data)
-{
-	uint8_t error;
-	const uint8_t *value;
-	size_t len;
-
-	if (offset > dev_name_len) {
-		error = BT_ATT_ERROR_INVALID_OFFSET;
-		value = NULL;
-		len = dev_name_len;
-	} else {
-		error = 0;
-		len = dev_name_len - offset;
-		value = len ? &dev_name[offset] : NULL;
-	}
-
-	gatt_db_attribute_read_result(attrib, id, error, value, len);
-}
-
-static void populate_gap_service(struct gatt_db *db)
-{
-	struct gatt_db_attribute *service;
-	bt_uuid_t uuid;
-
-	bt_uuid16_create(&uuid, UUID_GAP);
-	service = gatt_db_add_service(db, &uuid, true, 6);
-
-	bt_uuid16_create(&uuid, GATT_CHARAC_DEVICE_NAME);
-	gatt_db_service_add_characteristic(service, &uuid,
-					   BT_ATT_PERM_READ,
-					   BT_GATT_CHRC_PROP_READ,
-					   gap_device_name_read, NULL, NULL);
-
-	gatt_db_service_set_active(service, true);
-}
-
-static void populate_devinfo_service(struct gatt_db *db)
-{
-	struct gatt_db_attribute *service;
-	bt_uuid_t uuid;
-
-	bt_uuid16_create(&uuid, 0x180a);
-	service = gatt_db_add_service(db, &uuid, true, 9);
-
-	gatt_db_service_set_active(service, true);
-}
-
-/* This function will initialize the fields of all the characteristic and descriptor with server designed initial values */
-
-static void ess_all_characteristics_init(void)
-{
-
-	es_temp_init();
-	es_speed_init();
-	es_apparent_direction_init();
-	es_dew_point_init();
-	es_elevation_init();
-	es_gust_factor_init();
-	es_heat_index_init();
-	es_humidity_init();
-	es_irradiance_init();
-	es_pollen_concentration_init();
-	es_rainfall_init();
-	es_pressure_init();
-	es_true_direction_init();
-	es_true_speed_init();
-	es_uv_index_init();
-	es_wind_chill_init();
-	es_barometric_pressure_init();
-	es_magnetic_declination_init();
-	es_magnetic_flux_2D_init();
-	es_magnetic_flux_3D_init();
-
-}
-
-
-/*
-*   This Functions populate the gatt data base with all the service ,   *
-*   characteristic and descriptors of ESS Profile                       *
-*/
-
-static void populate_environmental_service(struct gatt_db *db)
-{
-	struct gatt_db_attribute *service, *temp,*apparent_direction,*apparent_speed,*elevation,*dew_point,*gust_factor,*heat_index,*humidity,*irradiance,*rainfall,*pressure,*true_direction,*true_speed,*uv_index,*wind_chill,*magnetic_declination,*magnetic_flux_2D,*magnetic_flux_3D;
-	bt_uuid_t uuid;
-
-	/*  Adding ESS service as primary service  */ 
-
-	bt_uuid16_create(&uuid, UUID_ESS_SERVICE);
-	service = gatt_db_add_service(db, &uuid, true, 160);	
-
-
-	ess_all_characteristics_init();
-
-	/*  Adding Tempertaure characteristics and it's descriptors  */ 
-
-	bt_uuid16_create(&uuid, UUID_TEMPERATURE);
-
-	temp = gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  temp_read, NULL, NULL);
-
-	temp_db->temp_handle = gatt_db_attribute_get_handle(temp);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       temp_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       temp_triger_read_cb, temp_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       temp_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE, 
-				       temp_char_user_desc_read_cb,temp_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       temp_msrmt_ccc_read_cb,
-				       temp_msrmt_ccc_write_cb, conn);
-
-
-	/*  Adding apparent wind Speed characteristics and it's descriptors  */ 
-
-	bt_uuid16_create(&uuid, UUID_APPARENT_WIND_SPEED);
-
-	apparent_speed=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  apparent_speed_read, NULL, NULL);
-
-	apparent_speed_db->apparent_speed_handle = gatt_db_attribute_get_handle(apparent_speed);
-
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       apparent_speed_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_speed_triger_read_cb, apparent_speed_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       apparent_speed_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_speed_char_user_desc_read_cb,apparent_speed_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_speed_msrmt_ccc_read_cb,
-				       apparent_speed_msrmt_ccc_write_cb, conn);
-
-	/*  Adding apparent wind Direction characteristics and it's descriptors  */ 
-
-	bt_uuid16_create(&uuid, UUID_APPARENT_WIND_DIRECTION);
-
-	apparent_direction=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  apparent_direction_read, NULL, NULL);
-
-	apparent_direction_db->apparent_direction_handle = gatt_db_attribute_get_handle(apparent_direction);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       apparent_direction_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_direction_triger_read_cb, apparent_direction_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       apparent_direction_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_direction_char_user_desc_read_cb,apparent_direction_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       apparent_direction_msrmt_ccc_read_cb,
-				       apparent_direction_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Dew point characteristics and it's descriptors  */ 
-
-	bt_uuid16_create(&uuid, UUID_DEW_POINT);
-
-	dew_point=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  dew_point_read, NULL, NULL);
-
-	dew_point_db->dew_point_handle = gatt_db_attribute_get_handle(dew_point);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       dew_point_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       dew_point_triger_read_cb, dew_point_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       dew_point_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       dew_point_char_user_desc_read_cb,dew_point_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       dew_point_msrmt_ccc_read_cb,
-				       dew_point_msrmt_ccc_write_cb, conn);
-	
-	/*  Adding Elevation characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_ELEVATION);
-
-	elevation=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  elevation_read, NULL, NULL);
-
-	elevation_db->elevation_handle = gatt_db_attribute_get_handle(elevation);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       elevation_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       elevation_triger_read_cb, elevation_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       elevation_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       elevation_char_user_desc_read_cb,elevation_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       elevation_msrmt_ccc_read_cb,
-				       elevation_msrmt_ccc_write_cb, conn);
-
-	/* Adding Gust Factor characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_GUST_FACTOR);
-
-	gust_factor=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  gust_factor_read, NULL, NULL);
-
-	gust_factor_db->gust_factor_handle = gatt_db_attribute_get_handle(gust_factor);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       gust_factor_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       gust_factor_triger_read_cb, gust_factor_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       gust_factor_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       gust_factor_char_user_desc_read_cb,gust_factor_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       gust_factor_msrmt_ccc_read_cb,
-				       gust_factor_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Heat Index characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_HEAT_INDEX);
-
-	heat_index=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  heat_index_read, NULL, NULL);
-
-	heat_index_db->heat_index_handle = gatt_db_attribute_get_handle(heat_index);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       heat_index_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       heat_index_triger_read_cb, heat_index_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       heat_index_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       heat_index_char_user_desc_read_cb,heat_index_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       heat_index_msrmt_ccc_read_cb,
-				       heat_index_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Humidity characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_HUMIDITY);
-
-	humidity=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  humidity_read, NULL, NULL);
-
-	humidity_db->humidity_handle = gatt_db_attribute_get_handle(humidity);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       humidity_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       humidity_triger_read_cb, humidity_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       humidity_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       humidity_char_user_desc_read_cb,humidity_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       humidity_msrmt_ccc_read_cb,
-				       humidity_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Irradiance characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_IRRADIANCE);	
-
-	irradiance=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  irradiance_read, NULL, NULL);
-
-	irradiance_db->irradiance_handle = gatt_db_attribute_get_handle(irradiance);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       irradiance_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       irradiance_triger_read_cb, irradiance_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       irradiance_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       irradiance_char_user_desc_read_cb,irradiance_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       irradiance_msrmt_ccc_read_cb,
-				       irradiance_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Pollen concentration characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_POLLEN_CONCENTRATION);
-
-	gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  pollen_concentration_read, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       pollen_concentration_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pollen_concentration_triger_read_cb, pollen_concentration_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       pollen_concentration_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pollen_concentration_char_user_desc_read_cb,pollen_concentration_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pollen_concentration_msrmt_ccc_read_cb,
-				       pollen_concentration_msrmt_ccc_write_cb, conn);
-
-	/* Adding Rainfall characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_RAIN_FALL);
-
-	rainfall=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  rainfall_read, NULL, NULL);
-
-	rainfall_db->rainfall_handle = gatt_db_attribute_get_handle(rainfall);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       rainfall_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       rainfall_triger_read_cb, rainfall_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       rainfall_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       rainfall_char_user_desc_read_cb,rainfall_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       rainfall_msrmt_ccc_read_cb,
-				       rainfall_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Pressure characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_PRESSURE);
-
-	pressure=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  pressure_read, NULL, NULL);
-
-	pressure_db->pressure_handle = gatt_db_attribute_get_handle(pressure);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       pressure_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pressure_triger_read_cb, pressure_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       pressure_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pressure_char_user_desc_read_cb,pressure_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       pressure_msrmt_ccc_read_cb,
-				       pressure_msrmt_ccc_write_cb, conn);
-
-	/*  Adding True Wind Direction characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_TRUE_WIND_DIRECTION);
-
-	true_direction=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ|
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  true_direction_read, NULL, NULL);
-
-	true_direction_db->true_direction_handle = gatt_db_attribute_get_handle(true_direction);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       true_direction_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_direction_triger_read_cb, true_direction_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       true_direction_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_direction_char_user_desc_read_cb,true_direction_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_direction_msrmt_ccc_read_cb,
-				       true_direction_msrmt_ccc_write_cb, conn);
-
-	/*  Adding True Wind Speed characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_TRUE_WIND_SPEED);
-
-	true_speed=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  true_speed_read, NULL, NULL);
-
-	true_speed_db->true_speed_handle = gatt_db_attribute_get_handle(true_speed);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       true_speed_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_speed_triger_read_cb, true_speed_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       true_speed_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_speed_char_user_desc_read_cb,true_speed_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       true_speed_msrmt_ccc_read_cb,
-				       true_speed_msrmt_ccc_write_cb, conn);
-
-	/*  Adding UV Index characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_UV_INDEX);
-
-	uv_index=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  uv_index_read, NULL, NULL);
-
-	uv_index_db->uv_index_handle = gatt_db_attribute_get_handle(uv_index);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       uv_index_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       uv_index_triger_read_cb, uv_index_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       uv_index_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       uv_index_char_user_desc_read_cb,uv_index_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       uv_index_msrmt_ccc_read_cb,
-				       uv_index_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Wind Chill characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_WIND_CHILL);
-
-	wind_chill=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  wind_chill_read, NULL, NULL);
-
-	wind_chill_db->wind_chill_handle = gatt_db_attribute_get_handle(wind_chill);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       wind_chill_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       wind_chill_triger_read_cb, wind_chill_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       wind_chill_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       wind_chill_char_user_desc_read_cb,wind_chill_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       wind_chill_msrmt_ccc_read_cb,
-				       wind_chill_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Barometric Pressure characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_BAROMETRIC_PRESSURE_TREND);
-	
-	gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ ,
-						  barometric_pressure_read, NULL, NULL);
-
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       barometric_pressure_measurement_read_cb, NULL, NULL);
-
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       barometric_pressure_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       barometric_pressure_char_user_desc_read_cb,barometric_pressure_char_user_desc_write_cb, NULL);
-
-	/*  Adding Magnetic Declination characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_MAGNETIC_DECLINATION);
-
-	magnetic_declination=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  magnetic_declination_read, NULL, NULL);
-
-	magnetic_declination_db->magnetic_declination_handle = gatt_db_attribute_get_handle(magnetic_declination);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_declination_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_declination_triger_read_cb, magnetic_declination_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_declination_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_declination_char_user_desc_read_cb,magnetic_declination_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_declination_msrmt_ccc_read_cb,
-				       magnetic_declination_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Magnetic flux 2D characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_MAGNETIC_FLUX_DENSITY_2D);
-
-	magnetic_flux_2D=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  magnetic_flux_2D_read, NULL, NULL);
-
-	magnetic_flux_2D_db->magnetic_flux_2D_handle = gatt_db_attribute_get_handle(magnetic_flux_2D);
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_flux_2D_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_2D_triger_read_cb, magnetic_flux_2D_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_flux_2D_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_2D_char_user_desc_read_cb,magnetic_flux_2D_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_2D_msrmt_ccc_read_cb,
-				       magnetic_flux_2D_msrmt_ccc_write_cb, conn);
-
-	/*  Adding Magnetic flux 3D characteristics and it's descriptors  */
-
-	bt_uuid16_create(&uuid, UUID_MAGNETIC_FLUX_DENSITY_3D);
-
-	magnetic_flux_3D=gatt_db_service_add_characteristic(service, &uuid,
-						  BT_ATT_PERM_READ,
-						  BT_GATT_CHRC_PROP_READ |
-						  BT_GATT_CHRC_PROP_NOTIFY,
-						  magnetic_flux_3D_read, NULL, NULL);
-
-	magnetic_flux_3D_db->magnetic_flux_3D_handle = gatt_db_attribute_get_handle(magnetic_flux_3D);
-
-
-	bt_uuid16_create(&uuid, ESS_MEASUREMENT_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_flux_3D_measurement_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_TRIGER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_3D_triger_read_cb, magnetic_flux_3D_triger_write_cb,
-				       NULL);
-
-	bt_uuid16_create(&uuid, ESS_VALID_RANGE_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ,
-				       magnetic_flux_3D_valid_range_read_cb, NULL, NULL);
-
-	bt_uuid16_create(&uuid, ESS_CHAR_USER_DESC);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_3D_char_user_desc_read_cb,magnetic_flux_3D_char_user_desc_write_cb, NULL);
-
-	bt_uuid16_create(&uuid, CLIENT_CHARAC_CFG_UUID);
-	gatt_db_service_add_descriptor(service, &uuid,
-				       BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
-				       magnetic_flux_3D_msrmt_ccc_read_cb,
-				       magnetic_flux_3D_msrmt_ccc_write_cb, conn);
-	
-	/* activating the ESS service all the characteristic and descriptor */
-
-	gatt_db_service_set_active(service, true);
-
-}
-
-void gatt_server_start(void)
-{
-	struct sockaddr_l2 addr;
-
-	if (att_fd >= 0)
-		return;
-
-	att_fd = socket(PF_BLUETOOTH, SOCK_SEQPACKET | SOCK_CLOEXEC,
-			BTPROTO_L2CAP);
-	if (att_fd < 0) {
-		fprintf(stderr, "Failed to create ATT server socket: %m\n");
-		return;
-	}
-
-	memset(&addr, 0, sizeof(addr));
-	addr.l2_family = AF_BLUETOOTH;
-	addr.l2_cid = htobs(ATT_CID);
-	memcpy(&addr.l2_bdaddr, public_addr, 6);
-	addr.l2_bdaddr_type = BDADDR_LE_PUBLIC;
-
-	if (bind(att_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-		fprintf(stderr, "Failed to bind ATT server socket: %m\n");
-		close(att_fd);
-		att_fd = -1;
-		return;
-	}
-
-	if (listen(att_fd, 1) < 0) {
-		fprintf(stderr, "Failed to listen on ATT server socket: %m\n");
-		close(att_fd);
-		att_fd = -1;
-		return;
-	}
-
-	gatt_db = gatt_db_new();
-	if (!gatt_db) {
-		close(att_fd);
-		att_fd = -1;
-		return;
-	}
-
-	populate_environmental_service(gatt_db);
-	populate_gap_service(gatt_db);
-	populate_devinfo_service(gatt_db);
-
-	gatt_cache = gatt_db_new();
-
-	conn_list = queue_new();
-	if (!conn_list) {
-		gatt_db_unref(gatt_db);
-		gatt_db = NULL;
-		close(att_fd);
-		att_fd = -1;
-		return;
-	}
-
-	mainloop_add_fd(att_fd, EPOLLIN, att_conn_callback, NULL, NULL);
-}
-
-void gatt_server_stop(void)
-{
-	if (att_fd < 0)
-		return;
-
-	mainloop_remove_fd(att_fd);
-
-	queue_destroy(conn_list, gatt_conn_destroy);
-
-	gatt_db_unref(gatt_cache);
-	gatt_cache = NULL;
-
-	gatt_db_unref(gatt_db);
-	gatt_db = NULL;
+	/* the sockets still belong to the old process, only drop our copies */
+	gatt_server_stop();
 
-	close(att_fd);
-	att_fd = -1;
+	return false;
 }
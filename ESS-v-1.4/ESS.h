@@ -23,6 +23,11 @@
 
 #include <stdint.h>
 
+#include "peripheral/ESS/ess_uuid.h"
+
+/* Most axes of a type in the build profile of ess_uuid.h */
+#define ESS_MAX_AXES (ESS_PROFILE_AXES & 4 ? 3 : ESS_PROFILE_AXES & 2 ? 2 : 1)
+#define ESS_USER_DESC_LEN 21
 
 /* ess_measurement structure is measurement descriptor structure with all necessary fields */
 
@@ -35,390 +40,287 @@ struct ess_measurement {
 	uint8_t m_uncertainity;
 };
 
-/* This trigger_setting holds the trigger setting  */
+/*
+ * Static description of one ESS characteristic type. The value is made of
+ * "axes" fields of "len" octets each (only the magnetic flux densities have
+ * more than one axis). The remaining fields are the initial values used when
+ * the profile does not override them.
+ */
 
-struct trigger_setting {
-	uint8_t condition;
-	uint8_t data[3]; // Time based data
-	bool time_enable;
-	bool value_enable;
-	bool trigger_inactive;
+struct ess_char_type {
+	uint16_t uuid;
+	const char *name;
+	uint8_t len;
+	uint8_t axes;
+	bool is_signed;
+	bool notify;
+	const char *user_desc;
+	int32_t value;
+	int32_t lower;
+	int32_t upper;
+	uint8_t sample;
+	uint8_t period;
+	uint8_t interval;
+	uint8_t applicatn;
+	uint8_t m_uncertainity;
 };
 
+/* Where the samples of a characteristic come from */
 
-/* This structure hold all the fields required for Temprature characteristic and its descriptors */
-struct ess_temp {
-	int16_t temp_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t temp_handle;
-	int16_t tr_value;
-	unsigned int timeout_id;
-	bool temp_enable;
-	int16_t lower_temp;
-	int16_t upper_temp;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	struct ess_measurement *temp_ms;
-	struct trigger_setting *temp_tr;
-
+enum ess_source_type {
+	ESS_SOURCE_RANDOM,
+	ESS_SOURCE_CONSTANT,
+	ESS_SOURCE_FILE,
+	ESS_SOURCE_WALK,
+	ESS_SOURCE_DIURNAL,
+	ESS_SOURCE_PUBLISH,
 };
 
-/* This structure hold all the fields required for Apparent Wind Speed characteristic and its descriptors */
-
-struct ess_apparent_speed {
-	uint16_t apparent_speed_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t apparent_speed_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool apparent_speed_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_speed;
-	uint16_t upper_speed;
-	struct ess_measurement *apparent_speed_ms;
-	struct trigger_setting *apparent_speed_tr;
-};
+/* xoshiro256** state, all zero until the first sample seeds it */
 
-/* This structure hold all the fields required for Apparent Wind Direction characteristic and its descriptors */
-
-struct ess_apparent_direction {
-	uint16_t apparent_direction_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t apparent_direction_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool apparent_direction_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_direction;
-	uint16_t upper_direction;
-	struct ess_measurement *apparent_direction_ms;
-	struct trigger_setting *apparent_direction_tr;
+struct ess_rng {
+	uint64_t s[4];
 };
 
-/* This structure hold all the fields required for Dew Point characteristic and its descriptors */
-
-struct ess_dew_point {
-	int8_t dew_point_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t dew_point_handle;
-	int8_t tr_value;
-	unsigned int timeout_id;
-	bool dew_point_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	int8_t lower_dew_point;
-	int8_t upper_dew_point;
-	struct ess_measurement *dew_point_ms;
-	struct trigger_setting *dew_point_tr;
+struct ess_source {
+	enum ess_source_type type;
+	char *path;
+	/* the file of ESS_SOURCE_FILE, open from the first sample on or -1 */
+	int fd;
+	int32_t mul;
+	int32_t div;
+	int32_t step;
+	struct ess_rng rng;
+	/* last value handed over by gatt_server_publish(), 0 until then */
+	uint64_t published;
+	int32_t value[ESS_MAX_AXES];
 };
 
-/* This structure hold all the fields required for Elevation characteristic and its descriptors */
-
-struct ess_elevation {
-	int32_t elevation_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t elevation_handle;
-	int32_t tr_value;
-	unsigned int timeout_id;
-	bool elevation_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	int8_t lower_elevation[3];
-	int8_t upper_elevation[3];
-	struct ess_measurement *elevation_ms;
-	struct trigger_setting *elevation_tr;
+/* Counters of one instance, exported through the metrics socket */
+
+struct ess_char_stats {
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t notifications;
+	uint64_t suppressed;
+	uint64_t send_failures;
+	/* samples the trigger fired on that the damping held back */
+	uint64_t damped;
+	/* queued notifications a newer value replaced or that were dropped */
+	uint64_t replaced;
 };
 
-/* This structure hold all the fields required for Gust Factor characteristic and its descriptors */
-
-struct ess_gust_factor {
-	uint8_t gust_factor_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t gust_factor_handle;
-	uint8_t tr_value;
-	unsigned int timeout_id;
-	bool gust_factor_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint8_t lower_gust_factor;
-	uint8_t upper_gust_factor;
-	struct ess_measurement *gust_factor_ms;
-	struct trigger_setting *gust_factor_tr;
-};
+/*
+ * Stages a sample goes through before it leaves the node. The first one is
+ * the delay between the due time of the tick and the sample being taken,
+ * every other one is the age of the sample when it reached that point.
+ */
 
-/* This structure hold all the fields required for Heat Index characteristic and its descriptors */
-
-struct ess_heat_index {
-	int8_t heat_index_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t heat_index_handle;
-	int8_t tr_value;
-	unsigned int timeout_id;
-	bool heat_index_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	int8_t lower_heat_index;
-	int8_t upper_heat_index;
-	struct ess_measurement *heat_index_ms;
-	struct trigger_setting *heat_index_tr;
+enum ess_stage {
+	ESS_STAGE_SCHED,
+	ESS_STAGE_TRIGGER,
+	ESS_STAGE_ENCODE,
+	ESS_STAGE_QUEUE,
+	ESS_STAGE_SEND,
+	ESS_STAGE_COMPLETE,
+	ESS_STAGE_MAX,
 };
 
-/* This structure hold all the fields required for Humidity characteristic and its descriptors */
-
-struct ess_humidity {
-	uint16_t humidity_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t humidity_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool humidity_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_humidity;
-	uint16_t upper_humidity;
-	struct ess_measurement *humidity_ms;
-	struct trigger_setting *humidity_tr;
-};
+struct metrics_hist;
 
-/* This structure hold all the fields required for Irradiance characteristic and its descriptors */
-
-struct ess_irradiance {
-	uint16_t irradiance_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t irradiance_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool irradiance_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_irradiance;
-	uint16_t upper_irradiance;
-	struct ess_measurement *irradiance_ms;
-	struct trigger_setting *irradiance_tr;
-};
+/*
+ * An instance has up to ESS_MAX_TRIGGERS ES Trigger Setting descriptors,
+ * combined through its ES Configuration descriptor. The first setting is
+ * kept in struct ess_state like that of any instance, the others in
+ * "triggers" of struct ess_char.
+ */
 
-/* This structure hold all the fields required for Pollen Concentration characteristic and its descriptors */
-
-struct ess_pollen_concentration {
-	uint32_t pollen_concentration_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t pollen_concentration_handle;
-	uint32_t tr_value;
-	unsigned int timeout_id;
-	bool pollen_concentration_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint8_t lower_pollen_concentration[3];
-	uint8_t upper_pollen_concentration[3];
-	struct ess_measurement *pollen_concentration_ms;
-	struct trigger_setting *pollen_concentration_tr;
-};
+#define ESS_MAX_TRIGGERS 3
 
-/* This structure hold all the fields required for Rainfall characteristic and its descriptors */
-
-struct ess_rainfall {
-	uint16_t rainfall_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t rainfall_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool rainfall_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_rainfall;
-	uint16_t upper_rainfall;
-	struct ess_measurement *rainfall_ms;
-	struct trigger_setting *rainfall_tr;
+/* ES Configuration values, how the trigger settings are combined */
+#define ESS_CONFIG_AND 0x00
+#define ESS_CONFIG_OR 0x01
+
+struct ess_trigger_setting {
+	uint8_t condition;
+	uint32_t interval;
+	int32_t threshold[ESS_MAX_AXES];
 };
 
-/* This structure hold all the fields required for Pressure characteristic and its descriptors */
-
-struct ess_pressure {
-	uint32_t pressure_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t pressure_handle;
-	uint32_t tr_value;
-	unsigned int timeout_id;
-	bool pressure_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint32_t lower_pressure;
-	uint32_t upper_pressure;
-	struct ess_measurement *pressure_ms;
-	struct trigger_setting *pressure_tr;
+/*
+ * The settings of an instance with more than one, compiled by
+ * ess_trigger_combine() into what ess_trigger_eval() needs per sample:
+ * the relations of every setting, which ones wait for an interval and a
+ * decision table indexed by the settings that fired (bit n for setting
+ * n). Changes are relative to "sent", the value last notified.
+ */
+
+struct ess_trigger_combo {
+	uint8_t table;
+	uint8_t timed;
+	uint8_t trigger[ESS_MAX_TRIGGERS];
+	uint32_t interval[ESS_MAX_TRIGGERS];
+	uint32_t due[ESS_MAX_TRIGGERS];
+	int32_t threshold[ESS_MAX_TRIGGERS][ESS_MAX_AXES];
+	int32_t sent[ESS_MAX_AXES];
 };
 
-/* This structure hold all the fields required for True Wind Direction characteristic and its descriptors */
-
-struct ess_true_direction {
-	uint16_t true_direction_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t true_direction_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool true_direction_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_true_direction;
-	uint16_t upper_true_direction;
-	struct ess_measurement *true_direction_ms;
-	struct trigger_setting *true_direction_tr;
+/*
+ * Vendor damping of the value triggers, in units of the characteristic.
+ * With a hysteresis a threshold condition (0x04 to 0x07) notifies when
+ * the value gets past the threshold and again only once it went back by
+ * more than the hysteresis. With a dead band a sample is only notified
+ * when an axis moved by more than the dead band since "sent", the value
+ * last notified.
+ */
+
+struct ess_damping {
+	uint32_t hysteresis;
+	uint32_t deadband;
+	bool latched;
+	int32_t sent[ESS_MAX_AXES];
 };
 
-/* This structure hold all the fields required for True Wind Speed characteristic and its descriptors */
-
-struct ess_true_speed {
-	uint16_t true_speed_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t true_speed_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool true_speed_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_true_speed;
-	uint16_t upper_true_speed;
-	struct ess_measurement *true_speed_ms;
-	struct trigger_setting *true_speed_tr;
+/*
+ * This structure hold the descriptors and everything else of one
+ * characteristic instance that is not read on every tick. The value,
+ * trigger setting, deadline and enable bits are in the slot "id" of
+ * struct ess_state.
+ */
+
+struct ess_char {
+	const struct ess_char_type *type;
+	uint16_t instance;
+	unsigned int id;
+	char user_desc[ESS_USER_DESC_LEN + 1];
+	uint16_t handle;
+	int32_t lower;
+	int32_t upper;
+	struct ess_measurement ms;
+	bool es_config_enable;
+	uint8_t es_config;
+	/* notification class, 0 is the most urgent */
+	uint8_t priority;
+	uint8_t num_triggers;
+	struct ess_trigger_setting triggers[ESS_MAX_TRIGGERS - 1];
+	struct ess_trigger_combo combo;
+	struct ess_damping damping;
+	struct ess_source source;
+	struct ess_char_stats stats;
+	uint64_t sampled;
+	struct metrics_hist *age;
 };
 
-/* This structure hold all the fields required for UV Index characteristic and its descriptors */
-
-struct ess_uv_index {
-	uint8_t uv_index_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t uv_index_handle;
-	uint8_t tr_value;
-	unsigned int timeout_id;
-	bool uv_index_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint8_t lower_uv_index;
-	uint8_t upper_uv_index;
-	struct ess_measurement *uv_index_ms;
-	struct trigger_setting *uv_index_tr;
+/* What an attribute handle of the ESS service is, see gatt_server_attr() */
+
+enum ess_attr_kind {
+	ESS_ATTR_DECL,
+	ESS_ATTR_VALUE,
+	ESS_ATTR_MEASUREMENT,
+	ESS_ATTR_TRIGGER,
+	ESS_ATTR_CONFIG,
+	ESS_ATTR_RANGE,
+	ESS_ATTR_USER_DESC,
+	ESS_ATTR_CCC,
+	ESS_ATTR_DAMPING,
 };
 
-/* This structure hold all the fields required for Wind Chill characteristic and its descriptors */
-
-struct ess_wind_chill {
-	int8_t wind_chill_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t wind_chill_handle;
-	int8_t tr_value;
-	unsigned int timeout_id;
-	bool wind_chill_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	int8_t lower_wind_chill;
-	int8_t upper_wind_chill;
-	struct ess_measurement *wind_chill_ms;
-	struct trigger_setting *wind_chill_tr;
+struct ess_attr {
+	struct ess_char *chr;
+	uint8_t kind;
+	/* which trigger setting, for ESS_ATTR_TRIGGER */
+	uint8_t index;
 };
 
-/* This structure hold all the fields required for Barometric pressure characteristic and its descriptors */
+/* A notification waiting for its kernel transmit timestamps */
 
-struct ess_barometric_pressure {
-	uint8_t barometric_pressure_data;
-	wchar_t *user_desc;
-	uint8_t lower_barometric_pressure;
-	uint8_t upper_barometric_pressure;
-	struct ess_measurement *barometric_pressure_ms;
+#define ESS_TX_PENDING 64
+
+struct ess_tx {
+	uint16_t handle;
+	uint8_t len;
+	uint64_t sampled;
 };
 
-/* This structure hold all the fields required for Magnetic Declination characteristic and its descriptors */
-
-struct ess_magnetic_declination {
-	uint16_t magnetic_declination_data;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t magnetic_declination_handle;
-	uint16_t tr_value;
-	unsigned int timeout_id;
-	bool magnetic_declination_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	uint16_t lower_magnetic_declination;
-	uint16_t upper_magnetic_declination;
-	struct ess_measurement *magnetic_declination_ms;
-	struct trigger_setting *magnetic_declination_tr;
+/*
+ * Notifications of a connection wait in one queue per priority class until
+ * the end of the tick. A class holds at most one notification per
+ * instance, a newer value replaces the one queued. The classes share the
+ * link by weighted fair queueing on virtual finish times, as far as the
+ * token bucket of the connection allows.
+ */
+
+#define ESS_SCHED_CLASSES 4
+#define ESS_SCHED_PENDING 16
+#define ESS_SCHED_DEFAULT_PRIORITY 1
+
+struct ess_sched_entry {
+	struct ess_char *chr;
+	uint64_t finish;
+	uint64_t sampled;
+	uint8_t len;
+	uint8_t pdu[4 * ESS_MAX_AXES];
 };
 
-/* This structure hold all the fields required for Magnetic Flux 2D characteristic and its descriptors */
-
-struct ess_magnetic_flux_2D {
-	uint16_t magnetic_flux_2D_xdata;
-	uint16_t magnetic_flux_2D_ydata;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t magnetic_flux_2D_handle;
-	uint16_t tr_valuex;
-	uint16_t tr_valuey;
-	unsigned int timeout_id;
-	bool magnetic_flux_2D_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;
-	int16_t xlower_magnetic_flux_2D;
-	int16_t xupper_magnetic_flux_2D;
-	int16_t ylower_magnetic_flux_2D;
-	int16_t yupper_magnetic_flux_2D;
-	struct ess_measurement *magnetic_flux_2D_ms;
-	struct trigger_setting *magnetic_flux_2D_tr;
+struct ess_sched_class {
+	struct ess_sched_entry entry[ESS_SCHED_PENDING];
+	unsigned int head;
+	unsigned int len;
+	uint64_t finish;
 };
 
-/* This structure hold all the fields required for Magnetic Flux 3D characteristic and its descriptors */
-
-struct ess_magnetic_flux_3D {
-	uint16_t magnetic_flux_3D_xdata;
-	uint16_t magnetic_flux_3D_ydata;
-	uint16_t magnetic_flux_3D_zdata;
-	wchar_t *user_desc;
-	uint16_t indication;
-	uint16_t magnetic_flux_3D_handle;
-	uint16_t tr_valuex;
-	uint16_t tr_valuey;
-	uint16_t tr_valuez;
-	unsigned int timeout_id;
-	bool magnetic_flux_3D_enable;
-	uint32_t g_update_timer;
-	uint32_t g_current_timer;	
-	int16_t xlower_magnetic_flux_3D;
-	int16_t xupper_magnetic_flux_3D;
-	int16_t ylower_magnetic_flux_3D;
-	int16_t yupper_magnetic_flux_3D;
-	int16_t zlower_magnetic_flux_3D;
-	int16_t zupper_magnetic_flux_3D;
-	struct ess_measurement *magnetic_flux_3D_ms;
-	struct trigger_setting *magnetic_flux_3D_tr;
+struct ess_sched {
+	struct ess_sched_class cls[ESS_SCHED_CLASSES];
+	uint64_t vtime;
+	/* octets the connection may still send, unlimited without a rate */
+	uint32_t tokens;
+	unsigned int len;
 };
 
+/*
+ * Every connection holds one of ESS_MAX_CONNS slots, its bit in the
+ * per instance mask of subscribed connections (ess_state.ccc)
+ */
+
+#define ESS_MAX_CONNS 64
 
 struct gatt_conn {
 	struct bt_att *att;
 	struct bt_gatt_server *gatt;
 	struct bt_gatt_client *client;
+	bool svc_chngd_enabled;
+	unsigned int slot;
+	int tstamp_fd;
+	bool tx_complete;
+	struct ess_tx tx[ESS_TX_PENDING];
+	unsigned int tx_head;
+	unsigned int tx_sent;
+	unsigned int tx_len;
+	/* src/shared objects of the connection, measured when set up */
+	int64_t mem;
+	struct ess_sched sched;
 };
 
+struct metrics_buf;
+struct gatt_db;
+
 void gatt_set_public_address(uint8_t addr[6]);
 void gatt_set_device_name(uint8_t name[20], uint8_t len);
+void gatt_set_profile(const char *path);
+void gatt_set_tx_timestamps(bool enable);
+void gatt_set_notify_budget(uint32_t rate, uint32_t burst);
 
 void gatt_server_start(void);
 void gatt_server_stop(void);
+bool gatt_server_attach(int fd);
+struct gatt_db *gatt_server_get_db(void);
+void gatt_server_reload(void);
+typedef void (*gatt_handover_func_t)(bool success, void *user_data);
+
+bool gatt_server_handover(int sk, gatt_handover_func_t func,
+							void *user_data);
+bool gatt_server_takeover(int sk);
+void gatt_server_collect(struct metrics_buf *buf);
+const struct ess_attr *gatt_server_attr(uint16_t handle);
+bool gatt_server_publish(uint16_t uuid, uint16_t instance,
+				const int32_t *value, uint64_t timestamp);
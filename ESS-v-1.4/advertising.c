@@ -34,13 +34,18 @@
 #include "src/shared/mgmt.h"
 #include "peripheral/ESS/ESS.h"
 #include "peripheral/ESS/advertising.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
 
 static struct mgmt *mgmt = NULL;
+static int64_t mgmt_mem = 0;
 static uint16_t mgmt_index = MGMT_INDEX_NONE;
+static uint16_t use_index = MGMT_INDEX_NONE;
 
 static bool adv_features = false;
 static bool adv_instances = false;
 static bool require_connectable = true;
+static bool keep_powered = false;
 
 static uint8_t static_addr[6] = { 0x0A, 0x71, 0xDA, 0x7D, 0x1A, 0x00};
 static uint8_t dev_name[260] = { 0x43,0x53,0x52,0x20,0x44,0x4F,0x4E,0x47,0x4C,0x45 };
@@ -50,11 +55,25 @@ void gap_set_static_address(uint8_t addr[6])
 {
 	memcpy(static_addr, addr, sizeof(static_addr));
 
-	printf("Using static address %02x:%02x:%02x:%02x:%02x:%02x\n",
+	ess_info("Using static address %02x:%02x:%02x:%02x:%02x:%02x\n",
 			static_addr[5], static_addr[4], static_addr[3],
 			static_addr[2], static_addr[1], static_addr[0]);
 }
 
+/* Only use this controller instead of the first LE capable one */
+
+void gap_set_index(uint16_t index)
+{
+	use_index = index;
+}
+
+/* After a live upgrade the controller still carries our connections */
+
+void gap_set_keep_powered(bool keep)
+{
+	keep_powered = keep;
+}
+
 
 /*
 *    Adding Advertisement DATA      *
@@ -68,14 +87,10 @@ static void add_advertising(uint16_t index)
 	const char ad[] = { 0x07, 0x08,0x53,0x61,0x6D,0x70,0x6C,
 			0x65,0x07,0x1B,0x0A,0x71,0xDA,0x7D,0x1A,0x00,0x03,0x14,0x1A,0x18};
 	struct mgmt_cp_add_advertising *cp;
-	void *buf;
-
-	buf = malloc(sizeof(*cp) + sizeof(ad));
-	if (!buf)
-		return;
+	uint8_t buf[sizeof(*cp) + sizeof(ad)];
 
-	memset(buf, 0, sizeof(*cp) + sizeof(ad));
-	cp = buf;
+	memset(buf, 0, sizeof(buf));
+	cp = (void *) buf;
 	cp->instance = 0x01;
 	cp->flags = cpu_to_le32((1 << 0) | (1 << 1) | (1 << 4));
 	cp->duration = cpu_to_le16(0);
@@ -84,10 +99,8 @@ static void add_advertising(uint16_t index)
 	cp->scan_rsp_len = 0;
 	memcpy(cp->data, ad, sizeof(ad));
 
-	mgmt_send(mgmt, MGMT_OP_ADD_ADVERTISING, index,
-			sizeof(*cp) + sizeof(ad), buf, NULL, NULL, NULL);
-
-	free(buf);
+	mgmt_send(mgmt, MGMT_OP_ADD_ADVERTISING, index, sizeof(buf), buf,
+							NULL, NULL, NULL);
 }
 
 
@@ -117,73 +130,73 @@ static void enable_advertising(uint16_t index)
 static void new_settings_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("New settings\n");
+	ess_info("New settings\n");
 }
 
 static void local_name_changed_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Local name changed\n");
+	ess_info("Local name changed\n");
 }
 
 static void device_connected_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Device connected\n");
+	ess_info("Device connected\n");
 }
 
 static void device_disconnected_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Device disconnected\n");
+	ess_info("Device disconnected\n");
 }
 
 static void user_confirm_request_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("User confirm request\n");
+	ess_info("User confirm request\n");
 }
 
 static void user_passkey_request_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("User passkey request\n");
+	ess_info("User passkey request\n");
 }
 
 static void auth_failed_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Authentication failed\n");
+	ess_info("Authentication failed\n");
 }
 
 static void device_unpaired_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Device unpaired\n");
+	ess_info("Device unpaired\n");
 }
 
 static void passkey_notify_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Passkey notification\n");
+	ess_info("Passkey notification\n");
 }
 
 static void new_conn_param_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("New connection parameter\n");
+	ess_info("New connection parameter\n");
 }
 
 static void advertising_added_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Advertising added\n");
+	ess_info("Advertising added\n");
 }
 
 static void advertising_removed_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Advertising removed\n");
+	ess_info("Advertising removed\n");
 }
 
 static void read_adv_features_complete(uint8_t status, uint16_t len,
@@ -216,12 +229,13 @@ static void read_info_complete(uint8_t status, uint16_t len,
 	uint16_t index = PTR_TO_UINT(user_data);
 	uint32_t required_settings = MGMT_SETTING_LE;
 	uint32_t supported_settings, current_settings;
+	uint8_t addr[6];
 	uint8_t val;
 
 	required_settings = MGMT_SETTING_LE;
 
 	if (status) {
-		fprintf(stderr, "Reading info for index %u failed: %s\n",
+		ess_error("Reading info for index %u failed: %s\n",
 						index, mgmt_errstr(status));
 		return;
 	}
@@ -229,13 +243,16 @@ static void read_info_complete(uint8_t status, uint16_t len,
 	if (mgmt_index != MGMT_INDEX_NONE)
 		return;
 
+	if (use_index != MGMT_INDEX_NONE && index != use_index)
+		return;
+
 	supported_settings = le32_to_cpu(rp->supported_settings);
 	current_settings = le32_to_cpu(rp->current_settings);
 
 	if ((supported_settings & required_settings) != required_settings)
 		return;
 
-	printf("Selecting index %u\n", index);
+	ess_info("Selecting index %u\n", index);
 	mgmt_index = index;
 
 	mgmt_register(mgmt, MGMT_EV_NEW_SETTINGS, index,
@@ -263,7 +280,7 @@ static void read_info_complete(uint8_t status, uint16_t len,
 	mgmt_register(mgmt, MGMT_EV_ADVERTISING_REMOVED, index,
 					advertising_removed_event, NULL, NULL);
 
-	if (current_settings & MGMT_SETTING_POWERED) {
+	if ((current_settings & MGMT_SETTING_POWERED) && !keep_powered) {
 		val = 0x00;
 		mgmt_send(mgmt, MGMT_OP_SET_POWERED, index, 1, &val,
 							NULL, NULL, NULL);
@@ -307,7 +324,9 @@ static void read_info_complete(uint8_t status, uint16_t len,
 	mgmt_send(mgmt, MGMT_OP_SET_LOCAL_NAME, index,
 					260, dev_name, NULL, NULL, NULL);
 
-	gatt_set_public_address(static_addr);
+	/* the ATT socket listens on the address the controller really has */
+	memcpy(addr, &rp->bdaddr, sizeof(addr));
+	gatt_set_public_address(addr);
 	gatt_set_device_name(dev_name, dev_name_len);
 	gatt_server_start();
 
@@ -327,14 +346,14 @@ static void read_index_list_complete(uint8_t status, uint16_t len,
 	int i;
 
 	if (status) {
-		fprintf(stderr, "Reading index list failed: %s\n",
+		ess_error("Reading index list failed: %s\n",
 						mgmt_errstr(status));
 		return;
 	}
 
 	count = le16_to_cpu(rp->num_controllers);
 
-	printf("Index list: %u\n", count);
+	ess_info("Index list: %u\n", count);
 
 	for (i = 0; i < count; i++) {
 		uint16_t index = cpu_to_le16(rp->index[i]);
@@ -347,7 +366,7 @@ static void read_index_list_complete(uint8_t status, uint16_t len,
 static void index_added_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Index added\n");
+	ess_info("Index added\n");
 
 	if (mgmt_index != MGMT_INDEX_NONE)
 		return;
@@ -359,7 +378,7 @@ static void index_added_event(uint16_t index, uint16_t length,
 static void index_removed_event(uint16_t index, uint16_t length,
 					const void *param, void *user_data)
 {
-	printf("Index removed\n");
+	ess_info("Index removed\n");
 
 	if (mgmt_index != index)
 		return;
@@ -375,14 +394,14 @@ static void read_ext_index_list_complete(uint8_t status, uint16_t len,
 	int i;
 
 	if (status) {
-		fprintf(stderr, "Reading extended index list failed: %s\n",
+		ess_error("Reading extended index list failed: %s\n",
 						mgmt_errstr(status));
 		return;
 	}
 
 	count = le16_to_cpu(rp->num_controllers);
 
-	printf("Extended index list: %u\n", count);
+	ess_info("Extended index list: %u\n", count);
 
 	for (i = 0; i < count; i++) {
 		uint16_t index = cpu_to_le16(rp->entry[i].index);
@@ -400,7 +419,7 @@ static void ext_index_added_event(uint16_t index, uint16_t length,
 {
 	const struct mgmt_ev_ext_index_added *ev = param;
 
-	printf("Extended index added: %u\n", ev->type);
+	ess_info("Extended index added: %u\n", ev->type);
 
 	if (mgmt_index != MGMT_INDEX_NONE)
 		return;
@@ -417,7 +436,7 @@ static void ext_index_removed_event(uint16_t index, uint16_t length,
 {
 	const struct mgmt_ev_ext_index_added *ev = param;
 
-	printf("Extended index removed: %u\n", ev->type);
+	ess_info("Extended index removed: %u\n", ev->type);
 
 	if (mgmt_index != index)
 		return;
@@ -438,7 +457,7 @@ static void read_commands_complete(uint8_t status, uint16_t len,
 	int i;
 
 	if (status) {
-		fprintf(stderr, "Reading index list failed: %s\n",
+		ess_error("Reading index list failed: %s\n",
 						mgmt_errstr(status));
 		return;
 	}
@@ -464,7 +483,7 @@ static void read_commands_complete(uint8_t status, uint16_t len,
 		if (!mgmt_send(mgmt, MGMT_OP_READ_EXT_INDEX_LIST,
 				MGMT_INDEX_NONE, 0, NULL,
 				read_ext_index_list_complete, NULL, NULL)) {
-			fprintf(stderr, "Failed to read extended index list\n");
+			ess_error("Failed to read extended index list\n");
 			return;
 		}
 	} else {
@@ -476,7 +495,7 @@ static void read_commands_complete(uint8_t status, uint16_t len,
 		if (!mgmt_send(mgmt, MGMT_OP_READ_INDEX_LIST,
 				MGMT_INDEX_NONE, 0, NULL,
 				read_index_list_complete, NULL, NULL)) {
-			fprintf(stderr, "Failed to read index list\n");
+			ess_error("Failed to read index list\n");
 			return;
 		}
 	}
@@ -484,16 +503,23 @@ static void read_commands_complete(uint8_t status, uint16_t len,
 
 void gap_start(void)
 {
+	struct ess_mem_probe probe;
+
+	ess_mem_probe_start(&probe);
+
 	mgmt = mgmt_new_default();
 	if (!mgmt) {
-		fprintf(stderr, "Failed to open management socket\n");
+		ess_error("Failed to open management socket\n");
 		return;
 	}
 
+	mgmt_mem = ess_mem_probe_end(&probe);
+	ess_mem_charge(ESS_MEM_SHARED, mgmt_mem);
+
 	if (!mgmt_send(mgmt, MGMT_OP_READ_COMMANDS,
 				MGMT_INDEX_NONE, 0, NULL,
 				read_commands_complete, NULL, NULL)) {
-		fprintf(stderr, "Failed to read supported commands\n");
+		ess_error("Failed to read supported commands\n");
 		return;
 	}
 }
@@ -508,5 +534,8 @@ void gap_stop(void)
         mgmt_unref(mgmt);
 	mgmt = NULL;
 
+	ess_mem_charge(ESS_MEM_SHARED, -mgmt_mem);
+	mgmt_mem = 0;
+
 	mgmt_index = MGMT_INDEX_NONE;
 }
@@ -22,8 +22,11 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 void gap_set_static_address(uint8_t addr[6]);
+void gap_set_keep_powered(bool keep);
+void gap_set_index(uint16_t index);
 
 void gap_start(void);
 void gap_stop(void);
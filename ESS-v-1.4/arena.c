@@ -0,0 +1,194 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
+
+static bool sealed;
+
+bool ess_mem_enabled = false;
+
+static struct ess_mem_stat mem_stat[ESS_MEM_MAX];
+
+/* Heap bytes charged to any subsystem, what a probe does not count */
+static int64_t mem_charged;
+
+static const char *mem_sub_str[ESS_MEM_MAX] = {
+	[ESS_MEM_CHARS] = "chars",
+	[ESS_MEM_STATE] = "state",
+	[ESS_MEM_HISTORY] = "history",
+	[ESS_MEM_DB] = "db",
+	[ESS_MEM_CONNS] = "conns",
+	[ESS_MEM_METRICS] = "metrics",
+	[ESS_MEM_SHARED] = "shared",
+};
+
+/*
+ * Only before the first allocation, what was allocated earlier would be
+ * released without having been charged.
+ */
+
+void ess_mem_enable(void)
+{
+	ess_mem_enabled = true;
+}
+
+void ess_mem_account(enum ess_mem_sub sub, int64_t delta, bool heap)
+{
+	struct ess_mem_stat *stat = &mem_stat[sub];
+
+	stat->bytes += delta;
+	if (stat->bytes > stat->peak)
+		stat->peak = stat->bytes;
+
+	if (heap)
+		mem_charged += delta;
+}
+
+const struct ess_mem_stat *ess_mem_stat(enum ess_mem_sub sub)
+{
+	return &mem_stat[sub];
+}
+
+const char *ess_mem_sub_str(enum ess_mem_sub sub)
+{
+	return mem_sub_str[sub];
+}
+
+static int64_t heap_used(void)
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+	return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+	return (unsigned int) mallinfo().uordblks;
+#else
+	return 0;
+#endif
+}
+
+void ess_mem_probe_start(struct ess_mem_probe *probe)
+{
+	if (!ess_mem_enabled)
+		return;
+
+	probe->heap = heap_used();
+	probe->charged = mem_charged;
+}
+
+int64_t ess_mem_probe_end(const struct ess_mem_probe *probe)
+{
+	if (!ess_mem_enabled)
+		return 0;
+
+	return heap_used() - probe->heap - (mem_charged - probe->charged);
+}
+
+#ifdef ESS_STATIC
+
+/* Slots are few, a scan is cheaper than keeping a free list in order */
+
+void *ess_arena_new(struct ess_arena *arena)
+{
+	unsigned int i;
+
+	for (i = 0; i < arena->count; i++) {
+		void *ptr;
+
+		if (arena->busy[i])
+			continue;
+
+		arena->busy[i] = 1;
+		arena->used++;
+		ess_mem_charge_static(arena->sub, arena->size);
+
+		ptr = arena->mem + i * arena->size;
+		memset(ptr, 0, arena->size);
+
+		return ptr;
+	}
+
+	ess_warn("Arena %s full (%u)\n", arena->name, arena->count);
+
+	return NULL;
+}
+
+void ess_arena_free(struct ess_arena *arena, void *ptr)
+{
+	unsigned int i;
+
+	if (!ptr)
+		return;
+
+	i = ((uint8_t *) ptr - arena->mem) / arena->size;
+
+	arena->busy[i] = 0;
+	arena->used--;
+	ess_mem_charge_static(arena->sub, -(int64_t) arena->size);
+}
+
+#else
+
+void *ess_arena_new(struct ess_arena *arena)
+{
+	void *ptr;
+
+	ptr = calloc(1, arena->size);
+	if (ptr) {
+		arena->used++;
+		ess_mem_charge(arena->sub, arena->size);
+	}
+
+	return ptr;
+}
+
+void ess_arena_free(struct ess_arena *arena, void *ptr)
+{
+	if (!ptr)
+		return;
+
+	arena->used--;
+	ess_mem_charge(arena->sub, -(int64_t) arena->size);
+	free(ptr);
+}
+
+#endif
+
+void ess_arena_seal(bool seal)
+{
+	sealed = seal;
+}
+
+bool ess_arena_sealed(void)
+{
+	return sealed;
+}
@@ -0,0 +1,179 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Static allocation build, enabled with -DESS_STATIC. The characteristic
+ * instances, their state arrays and age histograms, the connection slots
+ * and the metrics answers come from arenas reserved at build time and
+ * sized by the limits below, so nothing the sample allocates itself comes
+ * from the heap once it runs. A reload needs room for the old and the new
+ * profile at the same time.
+ *
+ * Startup ends with ess_arena_seal(). From then on a heap allocation of
+ * the sample trips an assertion in a debug (!NDEBUG) static build. The
+ * allocations inside src/shared (ATT PDUs, queue entries, mainloop
+ * watches) are not covered.
+ *
+ * Without ESS_STATIC an arena is a plain heap allocator and the limits
+ * do not apply.
+ */
+
+#ifndef ESS_STATIC_CHARS
+#define ESS_STATIC_CHARS	256
+#endif
+
+/* ESS service declaration and at most 11 handles per instance */
+#define ESS_STATIC_HANDLES	(ESS_STATIC_CHARS * 11 + 1)
+
+#ifndef ESS_STATIC_CONNS
+#define ESS_STATIC_CONNS	8
+#endif
+
+#ifndef ESS_STATIC_CLIENTS
+#define ESS_STATIC_CLIENTS	2
+#endif
+
+/* One metrics answer, larger ones fail */
+#ifndef ESS_STATIC_METRICS_BUF
+#define ESS_STATIC_METRICS_BUF	(256 * 1024)
+#endif
+
+#if ESS_STATIC_CHARS % 64
+#error "ESS_STATIC_CHARS must be a multiple of 64"
+#endif
+
+/*
+ * Memory accounting, enabled at startup with ess_mem_enable(). Every
+ * arena and every heap allocation of the sample is charged to one of the
+ * subsystems below, which keep their current size and high-water mark.
+ * The objects of src/shared (gatt_db, ATT, GATT server and client, mgmt,
+ * queues) cannot be charged where they are allocated, so the growth of
+ * the heap around their construction that is not charged to anything
+ * else goes to ESS_MEM_SHARED, see ess_mem_probe_start(). Sizes are the
+ * requested ones, the malloc overhead of a probed window lands in
+ * ESS_MEM_SHARED as well.
+ *
+ * Disabled, a charge is one load and one branch.
+ */
+
+enum ess_mem_sub {
+	ESS_MEM_CHARS,		/* instances and their source paths */
+	ESS_MEM_STATE,		/* struct ess_state arrays */
+	ESS_MEM_HISTORY,	/* sample age histograms */
+	ESS_MEM_DB,		/* attribute handle table */
+	ESS_MEM_CONNS,		/* connection slots */
+	ESS_MEM_METRICS,	/* metrics clients and their answers */
+	ESS_MEM_SHARED,		/* src/shared objects, measured */
+	ESS_MEM_MAX,
+};
+
+struct ess_mem_stat {
+	int64_t bytes;
+	int64_t peak;
+};
+
+extern bool ess_mem_enabled;
+
+void ess_mem_enable(void);
+void ess_mem_account(enum ess_mem_sub sub, int64_t delta, bool heap);
+const struct ess_mem_stat *ess_mem_stat(enum ess_mem_sub sub);
+const char *ess_mem_sub_str(enum ess_mem_sub sub);
+
+/* Charge (or with a negative delta release) heap memory */
+
+static inline void ess_mem_charge(enum ess_mem_sub sub, int64_t delta)
+{
+	if (ess_mem_enabled)
+		ess_mem_account(sub, delta, true);
+}
+
+/* Same for memory reserved at build time, see ESS_STATIC */
+
+static inline void ess_mem_charge_static(enum ess_mem_sub sub, int64_t delta)
+{
+	if (ess_mem_enabled)
+		ess_mem_account(sub, delta, false);
+}
+
+/*
+ * Heap growth from ess_mem_probe_start() to ess_mem_probe_end() that was
+ * not charged to a subsystem, i.e. what src/shared allocated meanwhile.
+ * It needs mallinfo() and is 0 while accounting is disabled.
+ */
+
+struct ess_mem_probe {
+	int64_t heap;
+	int64_t charged;
+};
+
+void ess_mem_probe_start(struct ess_mem_probe *probe);
+int64_t ess_mem_probe_end(const struct ess_mem_probe *probe);
+
+struct ess_arena {
+	const char *name;
+	enum ess_mem_sub sub;
+	size_t size;
+	unsigned int count;
+	unsigned int used;
+	uint8_t *mem;
+	uint8_t *busy;
+};
+
+#ifdef ESS_STATIC
+#define ESS_ARENA(arena, type, num, mem_sub)				\
+	static __typeof__(type) arena##_mem[num];			\
+	static uint8_t arena##_busy[num];				\
+	static struct ess_arena arena = {				\
+		.name = #arena,						\
+		.sub = mem_sub,						\
+		.size = sizeof(type),					\
+		.count = num,						\
+		.mem = (uint8_t *) arena##_mem,				\
+		.busy = arena##_busy,					\
+	}
+#else
+#define ESS_ARENA(arena, type, num, mem_sub)				\
+	static struct ess_arena arena = {				\
+		.name = #arena,						\
+		.sub = mem_sub,						\
+		.size = sizeof(type),					\
+		.count = num,						\
+	}
+#endif
+
+void *ess_arena_new(struct ess_arena *arena);
+void ess_arena_free(struct ess_arena *arena, void *ptr);
+
+void ess_arena_seal(bool sealed);
+bool ess_arena_sealed(void);
+
+#if defined(ESS_STATIC) && !defined(NDEBUG)
+#include <assert.h>
+#define ess_heap_check() assert(!ess_arena_sealed())
+#else
+#define ess_heap_check() do { } while (0)
+#endif
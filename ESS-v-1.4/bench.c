@@ -0,0 +1,1532 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <getopt.h>
+#include <time.h>
+#include <malloc.h>
+#include <sys/socket.h>
+
+#include "lib/bluetooth.h"
+#include "lib/hci.h"
+#include "lib/hci_lib.h"
+#include "lib/l2cap.h"
+#include "lib/uuid.h"
+#include "src/shared/mainloop.h"
+#include "src/shared/util.h"
+#include "src/shared/timeout.h"
+#include "src/shared/att.h"
+#include "src/shared/gatt-db.h"
+#include "src/shared/gatt-client.h"
+#include "src/shared/gatt-helpers.h"
+#include "peripheral/ESS/ess_uuid.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/sim.h"
+
+/*
+*   Loopback benchmark: the ESS server is attached to one end of a         *
+*   socketpair and a bt_gatt_client to the other, so discovery, reads,     *
+*   descriptor writes and notification fan-out can be measured without a  *
+*   controller. The phases run one after the other: notifications, then   *
+*   reads of every characteristic value, then writes of every writable     *
+*   descriptor with the value it already holds.                            *
+*                                                                          *
+*   With --connect the client connects over LE from a local controller     *
+*   to a running sample instead, which is how the multi-central scenario   *
+*   drives virtual controllers. Adding --reconnect times the phases of     *
+*   repeated connections instead of the three phases above.               *
+*                                                                          *
+*   With --soak the loopback harness cycles connections instead and        *
+*   watches the memory of the process for leaks.                           *
+*/
+
+/* Descriptors written back, at most one of each per characteristic */
+
+static const uint16_t write_uuids[] = {
+	0x2901,		/* Characteristic User Description */
+	0x2902,		/* Client Characteristic Configuration */
+	0x290b,		/* Environmental Sensing Configuration */
+	0x290d,		/* Environmental Sensing Trigger Setting */
+};
+
+struct bench_samples {
+	uint64_t *value;
+	unsigned int count;
+	unsigned int errors;
+};
+
+struct bench_target {
+	uint16_t handle;
+	uint16_t uuid;
+	uint8_t value[32];
+	uint16_t len;
+	bool primed;
+	struct bench_samples samples;
+};
+
+static struct bt_att *att;
+static struct gatt_db *db;
+static struct bt_gatt_client *client;
+
+static unsigned int duration = 10;
+static unsigned int num_reads = 1000;
+static unsigned int num_writes = 100;
+static unsigned int pending;
+static unsigned int subscribed;
+static unsigned long notifications;
+static unsigned long received;
+
+static unsigned int *notify_ids;
+static unsigned int num_notify_ids;
+
+static struct bench_target *reads;
+static unsigned int reads_len;
+static struct bench_target *writes;
+static unsigned int writes_len;
+static unsigned int current;
+
+static struct timespec start_time;
+static struct timespec ready_time;
+static struct timespec subscribe_time;
+static struct timespec stop_time;
+static struct timespec read_time;
+static struct timespec write_time;
+static struct timespec done_time;
+static struct timespec request_time;
+static uint64_t virtual_start;
+static uint64_t virtual_stop;
+
+static double elapsed_ms(const struct timespec *from, const struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) * 1000.0 +
+				(to->tv_nsec - from->tv_nsec) / 1000000.0;
+}
+
+static uint64_t elapsed_ns(const struct timespec *from,
+						const struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) * 1000000000ull +
+						to->tv_nsec - from->tv_nsec;
+}
+
+static void samples_add(struct bench_samples *samples, bool success)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if (!success) {
+		samples->errors++;
+		return;
+	}
+
+	samples->value[samples->count++] = elapsed_ns(&request_time, &now);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* Nearest rank percentile in microseconds, the samples get sorted */
+
+static double percentile(struct bench_samples *samples, unsigned int pct)
+{
+	unsigned int rank;
+
+	if (!samples->count)
+		return 0.0;
+
+	qsort(samples->value, samples->count, sizeof(uint64_t), cmp_u64);
+
+	rank = (samples->count * pct + 99) / 100;
+
+	return samples->value[rank ? rank - 1 : 0] / 1000.0;
+}
+
+static unsigned long count_samples(const struct bench_target *targets,
+					unsigned int len, unsigned long *errors)
+{
+	unsigned long count = 0;
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		count += targets[i].samples.count;
+
+		if (errors)
+			*errors += targets[i].samples.errors;
+	}
+
+	return count;
+}
+
+static void report_writes(void)
+{
+	unsigned int i, j;
+
+	printf("Descriptor writes (us):\n");
+	printf("  uuid      writes   errors      p50      p99\n");
+
+	/* every descriptor of one type goes into one distribution */
+	for (i = 0; i < NELEM(write_uuids); i++) {
+		struct bench_samples all = { };
+
+		for (j = 0; j < writes_len; j++) {
+			if (writes[j].uuid != write_uuids[i])
+				continue;
+
+			all.count += writes[j].samples.count;
+			all.errors += writes[j].samples.errors;
+		}
+
+		if (!all.count && !all.errors)
+			continue;
+
+		all.value = malloc(sizeof(uint64_t) * (all.count + 1));
+		if (!all.value)
+			continue;
+
+		all.count = 0;
+
+		for (j = 0; j < writes_len; j++) {
+			if (writes[j].uuid != write_uuids[i])
+				continue;
+
+			memcpy(all.value + all.count, writes[j].samples.value,
+				sizeof(uint64_t) * writes[j].samples.count);
+			all.count += writes[j].samples.count;
+		}
+
+		printf("  0x%04x  %8u %8u %8.1f %8.1f\n", write_uuids[i],
+				all.count, all.errors, percentile(&all, 50),
+				percentile(&all, 99));
+
+		free(all.value);
+	}
+}
+
+static void report(void)
+{
+	double run = elapsed_ms(&subscribe_time, &stop_time);
+	double read_run = elapsed_ms(&read_time, &write_time);
+	double write_run = elapsed_ms(&write_time, &done_time);
+	unsigned long read_errors = 0, write_errors = 0;
+	unsigned long total_reads, total_writes;
+	unsigned int i;
+
+	total_reads = count_samples(reads, reads_len, &read_errors);
+	total_writes = count_samples(writes, writes_len, &write_errors);
+
+	printf("Characteristics subscribed: %u\n", subscribed);
+	printf("Discovery:                  %.3f ms\n",
+					elapsed_ms(&start_time, &ready_time));
+	printf("Subscription:               %.3f ms\n",
+					elapsed_ms(&ready_time, &subscribe_time));
+	printf("Notifications:              %lu in %.3f s\n",
+					notifications, run / 1000.0);
+	printf("Notification rate:          %.1f /s\n",
+				run > 0 ? notifications * 1000.0 / run : 0.0);
+
+	if (ess_clock_simulated())
+		printf("Virtual time:               %.0f s\n",
+				(double) (virtual_stop - virtual_start) /
+							ESS_NSEC_PER_SEC);
+
+	printf("Notifications received:     %lu\n", received);
+	printf("Reads:                      %lu in %.3f s, %lu errors\n",
+				total_reads, read_run / 1000.0, read_errors);
+	printf("Read rate:                  %.1f /s\n",
+			read_run > 0 ? total_reads * 1000.0 / read_run : 0.0);
+	printf("Descriptor writes:          %lu in %.3f s, %lu errors\n",
+				total_writes, write_run / 1000.0, write_errors);
+	printf("Write rate:                 %.1f /s\n",
+			write_run > 0 ? total_writes * 1000.0 / write_run : 0.0);
+
+	printf("Read latency per characteristic (us):\n");
+	printf("  handle  uuid        p50      p99\n");
+
+	for (i = 0; i < reads_len; i++)
+		printf("  0x%04x  0x%04x %8.1f %8.1f\n", reads[i].handle,
+					reads[i].uuid,
+					percentile(&reads[i].samples, 50),
+					percentile(&reads[i].samples, 99));
+
+	report_writes();
+}
+
+static void write_next(void);
+
+static void write_cb(bool success, uint8_t att_ecode, void *user_data)
+{
+	samples_add(&writes[current].samples, success);
+
+	write_next();
+}
+
+static void write_read_cb(bool success, uint8_t att_ecode,
+					const uint8_t *value, uint16_t length,
+					void *user_data)
+{
+	struct bench_target *target = &writes[current];
+
+	if (!success || length > sizeof(target->value)) {
+		target->samples.errors = num_writes;
+		write_next();
+		return;
+	}
+
+	memcpy(target->value, value, length);
+	target->len = length;
+	target->primed = true;
+
+	write_next();
+}
+
+/*
+*   Writes go out one at a time so each sample is the round trip of a     *
+*   single Write Request. The current value of a descriptor is read first *
+*   and written back, so the run does not change the server state.       *
+*/
+
+static void write_next(void)
+{
+	struct bench_target *target;
+	unsigned int id;
+
+	while (current < writes_len &&
+		writes[current].samples.count + writes[current].samples.errors
+								>= num_writes)
+		current++;
+
+	if (current == writes_len) {
+		clock_gettime(CLOCK_MONOTONIC, &done_time);
+		report();
+		mainloop_quit();
+		return;
+	}
+
+	target = &writes[current];
+
+	if (!target->primed) {
+		id = bt_gatt_client_read_value(client, target->handle,
+						write_read_cb, NULL, NULL);
+	} else {
+		clock_gettime(CLOCK_MONOTONIC, &request_time);
+		id = bt_gatt_client_write_value(client, target->handle,
+						target->value, target->len,
+						write_cb, NULL, NULL);
+	}
+
+	if (!id) {
+		fprintf(stderr, "Failed to send request\n");
+		mainloop_exit_failure();
+	}
+}
+
+static void read_next(void);
+
+static void read_cb(bool success, uint8_t att_ecode, const uint8_t *value,
+					uint16_t length, void *user_data)
+{
+	samples_add(&reads[current].samples, success);
+
+	read_next();
+}
+
+static void read_next(void)
+{
+	while (current < reads_len && reads[current].samples.count +
+				reads[current].samples.errors >= num_reads)
+		current++;
+
+	if (current == reads_len) {
+		clock_gettime(CLOCK_MONOTONIC, &write_time);
+		current = 0;
+		write_next();
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &request_time);
+
+	if (!bt_gatt_client_read_value(client, reads[current].handle, read_cb,
+								NULL, NULL)) {
+		fprintf(stderr, "Failed to send request\n");
+		mainloop_exit_failure();
+	}
+}
+
+static bool stop_cb(void *user_data)
+{
+	unsigned int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &stop_time);
+	virtual_stop = ess_clock_now();
+
+	/* quiet link for the request phases */
+	for (i = 0; i < num_notify_ids; i++)
+		bt_gatt_client_unregister_notify(client, notify_ids[i]);
+
+	clock_gettime(CLOCK_MONOTONIC, &read_time);
+	current = 0;
+	read_next();
+
+	return false;
+}
+
+static void notify_cb(uint16_t value_handle, const uint8_t *value,
+					uint16_t length, void *user_data)
+{
+	notifications++;
+}
+
+/* Every notification PDU, subscribed or not, until the link goes down */
+
+static void att_notify_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+	received++;
+}
+
+static void register_cb(uint16_t att_ecode, void *user_data)
+{
+	if (att_ecode)
+		fprintf(stderr, "Failed to subscribe: 0x%02x\n", att_ecode);
+	else
+		subscribed++;
+
+	if (--pending)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &subscribe_time);
+	virtual_start = ess_clock_now();
+	timeout_add(duration * 1000, stop_cb, NULL, NULL);
+}
+
+static bool target_init(struct bench_target *target, uint16_t handle,
+					uint16_t uuid, unsigned int count)
+{
+	target->handle = handle;
+	target->uuid = uuid;
+	target->samples.value = malloc(sizeof(uint64_t) * count);
+
+	return target->samples.value != NULL;
+}
+
+static void targets_free(struct bench_target *targets, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		free(targets[i].samples.value);
+
+	free(targets);
+}
+
+static uint16_t attribute_uuid16(const struct gatt_db_attribute *attrib)
+{
+	const bt_uuid_t *uuid = gatt_db_attribute_get_type(attrib);
+
+	return uuid->type == BT_UUID16 ? uuid->value.u16 : 0;
+}
+
+static void desc_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	uint16_t uuid = attribute_uuid16(attrib);
+	unsigned int i;
+
+	for (i = 0; i < NELEM(write_uuids); i++) {
+		if (uuid != write_uuids[i])
+			continue;
+
+		if (target_init(&writes[writes_len],
+					gatt_db_attribute_get_handle(attrib),
+					uuid, num_writes))
+			writes_len++;
+
+		return;
+	}
+}
+
+static void char_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	uint16_t value_handle;
+	uint8_t properties;
+	bt_uuid_t uuid;
+
+	if (!gatt_db_attribute_get_char_data(attrib, NULL, &value_handle,
+						&properties, &uuid))
+		return;
+
+	if (target_init(&reads[reads_len], value_handle,
+				uuid.type == BT_UUID16 ? uuid.value.u16 : 0,
+				num_reads))
+		reads_len++;
+
+	gatt_db_service_foreach_desc(attrib, desc_cb, NULL);
+
+	if (!(properties & BT_GATT_CHRC_PROP_NOTIFY))
+		return;
+
+	notify_ids[num_notify_ids] = bt_gatt_client_register_notify(client,
+						value_handle, register_cb,
+						notify_cb, NULL, NULL);
+	if (notify_ids[num_notify_ids]) {
+		num_notify_ids++;
+		pending++;
+	}
+}
+
+static void service_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	gatt_db_service_foreach_char(attrib, char_cb, NULL);
+}
+
+static void count_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	unsigned int *count = user_data;
+	uint16_t start, end;
+
+	if (gatt_db_attribute_get_service_handles(attrib, &start, &end))
+		*count += end - start + 1;
+}
+
+static void ready_cb(bool success, uint8_t att_ecode, void *user_data)
+{
+	unsigned int count = 0;
+	bt_uuid_t uuid;
+
+	clock_gettime(CLOCK_MONOTONIC, &ready_time);
+
+	if (!success) {
+		fprintf(stderr, "Discovery failed: 0x%02x\n", att_ecode);
+		mainloop_exit_failure();
+		return;
+	}
+
+	bt_uuid16_create(&uuid, 0x181a);
+
+	/* the handles of the service bound characteristics and descriptors */
+	gatt_db_foreach_service(db, &uuid, count_cb, &count);
+
+	reads = calloc(count, sizeof(*reads));
+	writes = calloc(count, sizeof(*writes));
+	notify_ids = calloc(count, sizeof(*notify_ids));
+	if (!reads || !writes || !notify_ids) {
+		fprintf(stderr, "Out of memory\n");
+		mainloop_exit_failure();
+		return;
+	}
+
+	gatt_db_foreach_service(db, &uuid, service_cb, NULL);
+
+	if (!pending) {
+		fprintf(stderr, "No characteristic supports notifications\n");
+		mainloop_exit_failure();
+	}
+}
+
+/* Profile with "instances" temperature probes notifying every second */
+
+static bool write_profile(char *path, unsigned int instances)
+{
+	FILE *fp;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to create profile: %m\n");
+		return false;
+	}
+
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(path);
+		return false;
+	}
+
+	fprintf(fp, "[temperature]\n"
+			"Description = Probe %%u\n"
+			"Instances = %u\n"
+			"Trigger = 0x01 1\n", instances);
+	fclose(fp);
+
+	return true;
+}
+
+static int connect_att(const char *remote, int index, int sec_level)
+{
+	struct sockaddr_l2 addr;
+	struct bt_security sec;
+	int sk;
+
+	sk = socket(PF_BLUETOOTH, SOCK_SEQPACKET | SOCK_CLOEXEC,
+							BTPROTO_L2CAP);
+	if (sk < 0) {
+		fprintf(stderr, "Failed to create L2CAP socket: %m\n");
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.l2_family = AF_BLUETOOTH;
+	addr.l2_cid = htobs(ATT_CID);
+	addr.l2_bdaddr_type = BDADDR_LE_PUBLIC;
+
+	if (hci_devba(index, &addr.l2_bdaddr) < 0) {
+		fprintf(stderr, "No controller hci%d\n", index);
+		close(sk);
+		return -1;
+	}
+
+	if (bind(sk, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "Failed to bind L2CAP socket: %m\n");
+		close(sk);
+		return -1;
+	}
+
+	if (str2ba(remote, &addr.l2_bdaddr) < 0) {
+		fprintf(stderr, "Invalid address %s\n", remote);
+		close(sk);
+		return -1;
+	}
+
+	/* pairs on the first connection, encrypts with its keys afterwards */
+	if (sec_level > BT_SECURITY_LOW) {
+		memset(&sec, 0, sizeof(sec));
+		sec.level = sec_level;
+
+		if (setsockopt(sk, SOL_BLUETOOTH, BT_SECURITY, &sec,
+							sizeof(sec)) < 0) {
+			fprintf(stderr, "Failed to set security level: %m\n");
+			close(sk);
+			return -1;
+		}
+	}
+
+	if (connect(sk, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "Failed to connect to %s: %m\n", remote);
+		close(sk);
+		return -1;
+	}
+
+	return sk;
+}
+
+/*
+*   Reconnect benchmark: the client connects to a running sample again and *
+*   again and times every phase a gateway goes through before it has data: *
+*   the LE connection (with encryption when bonded), the MTU exchange,     *
+*   discovery, the CCC writes and the first notification.                  *
+*                                                                          *
+*   A cold client discovers on every connection. A bonded one trusts the   *
+*   attribute cache it kept from the previous connection. A hash cached    *
+*   one reads the Database Hash and only discovers when it changed. The    *
+*   first connection pairs and fills the cache, it is not counted.         *
+*/
+
+enum reconnect_mode {
+	RECONNECT_COLD,
+	RECONNECT_BONDED,
+	RECONNECT_CACHED,
+};
+
+enum reconnect_phase {
+	PHASE_CONNECT,
+	PHASE_MTU,
+	PHASE_DISCOVERY,
+	PHASE_CCC,
+	PHASE_NOTIFY,
+	PHASE_TOTAL,
+	PHASE_MAX,
+};
+
+static const char *mode_names[] = { "cold", "bonded", "cached" };
+
+static const char *phase_names[PHASE_MAX] = {
+	"connect", "mtu exchange", "discovery", "ccc writes",
+	"first notification", "total",
+};
+
+/* The link has to drop before the sample advertises again */
+
+#define RECONNECT_DELAY 3000
+
+static const char *remote_addr;
+static int remote_index;
+static enum reconnect_mode reconnect_mode = RECONNECT_COLD;
+static unsigned int num_reconnects;
+static unsigned int round_count;
+static struct bench_samples phases[PHASE_MAX];
+static struct timespec phase_end[PHASE_MAX];
+static struct timespec round_start;
+static uint16_t *ccc_handles;
+static unsigned int num_ccc;
+static unsigned int ccc_pending;
+static bool notified;
+static uint8_t cached_hash[16];
+static bool hash_cached;
+
+static void reconnect_report(void)
+{
+	unsigned int i;
+
+	printf("Reconnects:                 %u (%s)\n", phases[0].count,
+					mode_names[reconnect_mode]);
+	printf("Phase latency (us):\n");
+	printf("  phase                     p50      p99\n");
+
+	for (i = 0; i < PHASE_MAX; i++)
+		printf("  %-20s %8.1f %8.1f\n", phase_names[i],
+					percentile(&phases[i], 50),
+					percentile(&phases[i], 99));
+}
+
+static void phase_done(enum reconnect_phase phase)
+{
+	clock_gettime(CLOCK_MONOTONIC, &phase_end[phase]);
+}
+
+static bool reconnect_timeout(void *user_data);
+
+static bool timespec_before(const struct timespec *a,
+						const struct timespec *b)
+{
+	return a->tv_sec < b->tv_sec ||
+		(a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void reconnect_record(void)
+{
+	struct timespec *prev = &round_start;
+	unsigned int i;
+
+	for (i = 0; i < PHASE_TOTAL; i++) {
+		phases[i].value[phases[i].count++] =
+					elapsed_ns(prev, &phase_end[i]);
+		prev = &phase_end[i];
+	}
+
+	phases[PHASE_TOTAL].value[phases[PHASE_TOTAL].count++] =
+				elapsed_ns(&round_start, &phase_end[PHASE_TOTAL]);
+}
+
+/*
+ * The first notification may overtake the CCC writes, the subscription
+ * of the previous connection is still in place on the sample. Its phase
+ * is then empty.
+ */
+
+static void reconnect_done(void)
+{
+	if (timespec_before(&phase_end[PHASE_NOTIFY], &phase_end[PHASE_CCC]))
+		phase_end[PHASE_NOTIFY] = phase_end[PHASE_CCC];
+
+	phase_end[PHASE_TOTAL] = phase_end[PHASE_NOTIFY];
+
+	/* the first round pairs and fills the cache */
+	if (round_count++)
+		reconnect_record();
+
+	/* not from within the callbacks of the ATT layer */
+	timeout_add(1, reconnect_timeout, NULL, NULL);
+}
+
+static void reconnect_notify_cb(uint8_t opcode, const void *pdu,
+					uint16_t length, void *user_data)
+{
+	if (notified)
+		return;
+
+	notified = true;
+	phase_done(PHASE_NOTIFY);
+
+	if (!ccc_pending && phase_end[PHASE_CCC].tv_sec)
+		reconnect_done();
+}
+
+static void ccc_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+	if (opcode != BT_ATT_OP_WRITE_RSP)
+		fprintf(stderr, "Failed to write CCC\n");
+
+	if (--ccc_pending)
+		return;
+
+	phase_done(PHASE_CCC);
+
+	if (notified)
+		reconnect_done();
+}
+
+static void discovery_done(void)
+{
+	uint8_t pdu[4];
+	unsigned int i;
+
+	phase_done(PHASE_DISCOVERY);
+
+	if (!num_ccc) {
+		fprintf(stderr, "No characteristic supports notifications\n");
+		mainloop_exit_failure();
+		return;
+	}
+
+	put_le16(0x0001, &pdu[2]);
+
+	for (i = 0; i < num_ccc; i++) {
+		put_le16(ccc_handles[i], &pdu[0]);
+
+		if (bt_att_send(att, BT_ATT_OP_WRITE_REQ, pdu, sizeof(pdu),
+							ccc_cb, NULL, NULL))
+			ccc_pending++;
+	}
+}
+
+static void ccc_desc_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	if (attribute_uuid16(attrib) == CLIENT_CHARAC_CFG_UUID)
+		ccc_handles[num_ccc++] = gatt_db_attribute_get_handle(attrib);
+}
+
+static void ccc_char_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	uint8_t properties;
+
+	if (!gatt_db_attribute_get_char_data(attrib, NULL, NULL, &properties,
+									NULL))
+		return;
+
+	if (properties & BT_GATT_CHRC_PROP_NOTIFY)
+		gatt_db_service_foreach_desc(attrib, ccc_desc_cb, NULL);
+}
+
+static void ccc_service_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	gatt_db_service_foreach_char(attrib, ccc_char_cb, NULL);
+}
+
+static void reconnect_ready_cb(bool success, uint8_t att_ecode,
+							void *user_data)
+{
+	unsigned int count = 0;
+	bt_uuid_t uuid;
+
+	if (!success) {
+		fprintf(stderr, "Discovery failed: 0x%02x\n", att_ecode);
+		mainloop_exit_failure();
+		return;
+	}
+
+	bt_uuid16_create(&uuid, UUID_ESS_SERVICE);
+	gatt_db_foreach_service(db, &uuid, count_cb, &count);
+
+	free(ccc_handles);
+	ccc_handles = calloc(count, sizeof(*ccc_handles));
+	num_ccc = 0;
+
+	if (ccc_handles)
+		gatt_db_foreach_service(db, &uuid, ccc_service_cb, NULL);
+
+	discovery_done();
+}
+
+static void discover(void)
+{
+	bt_gatt_client_unref(client);
+	gatt_db_unref(db);
+
+	db = gatt_db_new();
+	client = bt_gatt_client_new(db, att, 0);
+	if (!client) {
+		fprintf(stderr, "Failed to create GATT client\n");
+		mainloop_exit_failure();
+		return;
+	}
+
+	bt_gatt_client_set_ready_handler(client, reconnect_ready_cb, NULL,
+									NULL);
+}
+
+/* Read By Type response: one handle/value pair, the 16 octet hash */
+
+static void hash_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+	const uint8_t *rsp = pdu;
+
+	if (opcode != BT_ATT_OP_READ_BY_TYPE_RSP || length < 19 ||
+							rsp[0] != 18) {
+		fprintf(stderr, "Failed to read Database Hash\n");
+		mainloop_exit_failure();
+		return;
+	}
+
+	if (hash_cached && !memcmp(cached_hash, rsp + 3, 16)) {
+		discovery_done();
+		return;
+	}
+
+	memcpy(cached_hash, rsp + 3, 16);
+	hash_cached = true;
+
+	discover();
+}
+
+static void mtu_cb(bool success, uint8_t att_ecode, void *user_data)
+{
+	uint8_t pdu[6];
+
+	phase_done(PHASE_MTU);
+
+	if (!success) {
+		fprintf(stderr, "MTU exchange failed: 0x%02x\n", att_ecode);
+		mainloop_exit_failure();
+		return;
+	}
+
+	if (reconnect_mode == RECONNECT_COLD || !ccc_handles) {
+		discover();
+		return;
+	}
+
+	if (reconnect_mode == RECONNECT_BONDED) {
+		discovery_done();
+		return;
+	}
+
+	put_le16(0x0001, &pdu[0]);
+	put_le16(0xffff, &pdu[2]);
+	put_le16(UUID_DATABASE_HASH, &pdu[4]);
+
+	bt_att_send(att, BT_ATT_OP_READ_BY_TYPE_REQ, pdu, sizeof(pdu),
+							hash_cb, NULL, NULL);
+}
+
+static bool reconnect_start(void *user_data)
+{
+	int sk;
+
+	memset(phase_end, 0, sizeof(phase_end));
+	ccc_pending = 0;
+	notified = false;
+
+	clock_gettime(CLOCK_MONOTONIC, &round_start);
+
+	sk = connect_att(remote_addr, remote_index,
+				reconnect_mode == RECONNECT_BONDED ?
+				BT_SECURITY_MEDIUM : BT_SECURITY_LOW);
+	if (sk < 0) {
+		mainloop_exit_failure();
+		return false;
+	}
+
+	phase_done(PHASE_CONNECT);
+
+	att = bt_att_new(sk, false);
+	if (!att) {
+		close(sk);
+		mainloop_exit_failure();
+		return false;
+	}
+
+	bt_att_set_close_on_unref(att, true);
+	bt_att_register(att, BT_ATT_OP_HANDLE_VAL_NOT, reconnect_notify_cb,
+								NULL, NULL);
+
+	if (!bt_gatt_exchange_mtu(att, BT_ATT_MAX_LE_MTU, mtu_cb, NULL,
+								NULL)) {
+		mainloop_exit_failure();
+		return false;
+	}
+
+	return false;
+}
+
+static bool reconnect_timeout(void *user_data)
+{
+	/* the cache of a bonded or hash cached client is the database */
+	bt_gatt_client_unref(client);
+	client = NULL;
+	bt_att_unref(att);
+	att = NULL;
+
+	if (round_count > num_reconnects) {
+		reconnect_report();
+		mainloop_quit();
+		return false;
+	}
+
+	timeout_add(RECONNECT_DELAY, reconnect_start, NULL, NULL);
+
+	return false;
+}
+
+static int reconnect_run(void)
+{
+	unsigned int i;
+	int exit_status;
+
+	for (i = 0; i < PHASE_MAX; i++) {
+		phases[i].value = calloc(num_reconnects, sizeof(uint64_t));
+		if (!phases[i].value) {
+			exit_status = EXIT_FAILURE;
+			goto done;
+		}
+	}
+
+	reconnect_start(NULL);
+
+	exit_status = mainloop_run();
+
+done:
+	bt_gatt_client_unref(client);
+	bt_att_unref(att);
+	gatt_db_unref(db);
+	free(ccc_handles);
+
+	for (i = 0; i < PHASE_MAX; i++)
+		free(phases[i].value);
+
+	return exit_status;
+}
+
+/*
+*   Soak test: connect and disconnect over the loopback harness, enabling  *
+*   notifications, writing a trigger setting and disabling notifications   *
+*   again on every connection. RSS and the bytes the allocator has handed  *
+*   out are sampled every SOAK_SAMPLE cycles, the first sample is the      *
+*   baseline and growth beyond a fixed slack fails the run.                *
+*/
+
+#define SOAK_SAMPLE		10000
+#define SOAK_RSS_SLACK		(4 * 1024 * 1024)
+#define SOAK_HEAP_SLACK		(256 * 1024)
+
+static unsigned int soak_cycles;
+static unsigned int soak_count;
+static unsigned int soak_step;
+static uint16_t soak_ccc;
+static uint16_t soak_trigger;
+static uint64_t soak_rss_base;
+static uint64_t soak_heap_base;
+
+static uint64_t soak_rss(void)
+{
+	unsigned long size, resident;
+	FILE *fp;
+
+	fp = fopen("/proc/self/statm", "r");
+	if (!fp)
+		return 0;
+
+	if (fscanf(fp, "%lu %lu", &size, &resident) != 2)
+		resident = 0;
+
+	fclose(fp);
+
+	return (uint64_t) resident * sysconf(_SC_PAGESIZE);
+}
+
+/* In use bytes of the allocator, 0 where glibc does not tell */
+
+static uint64_t soak_heap(void)
+{
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+	struct mallinfo2 mi = mallinfo2();
+#else
+	struct mallinfo mi = mallinfo();
+#endif
+
+	return (uint64_t) mi.uordblks + mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static bool soak_sample(void)
+{
+	uint64_t rss = soak_rss();
+	uint64_t heap = soak_heap();
+
+	if (soak_count == SOAK_SAMPLE) {
+		soak_rss_base = rss;
+		soak_heap_base = heap;
+	}
+
+	printf("%10u %10llu %10llu\n", soak_count,
+					(unsigned long long) rss / 1024,
+					(unsigned long long) heap / 1024);
+
+	if (rss > soak_rss_base + SOAK_RSS_SLACK) {
+		fprintf(stderr, "RSS grew by %llu kB after %u cycles\n",
+			(unsigned long long) (rss - soak_rss_base) / 1024,
+			soak_count);
+		return false;
+	}
+
+	if (heap > soak_heap_base + SOAK_HEAP_SLACK) {
+		fprintf(stderr, "Heap grew by %llu kB after %u cycles\n",
+			(unsigned long long) (heap - soak_heap_base) / 1024,
+			soak_count);
+		return false;
+	}
+
+	return true;
+}
+
+static void soak_write_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data);
+
+static void soak_write(uint16_t handle, const uint8_t *value, uint16_t len)
+{
+	uint8_t pdu[6];
+
+	put_le16(handle, pdu);
+	memcpy(pdu + 2, value, len);
+
+	if (!bt_att_send(att, BT_ATT_OP_WRITE_REQ, pdu, 2 + len,
+						soak_write_cb, NULL, NULL)) {
+		fprintf(stderr, "Failed to send write request\n");
+		mainloop_exit_failure();
+	}
+}
+
+static void soak_write_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+	static const uint8_t disable[] = { 0x00, 0x00 };
+	static const uint8_t trigger[] = { 0x01, 0x05, 0x00, 0x00 };
+
+	if (opcode != BT_ATT_OP_WRITE_RSP) {
+		fprintf(stderr, "Write failed after %u cycles\n", soak_count);
+		mainloop_exit_failure();
+		return;
+	}
+
+	switch (soak_step++) {
+	case 0:
+		soak_write(soak_trigger, trigger, sizeof(trigger));
+		break;
+	case 1:
+		soak_write(soak_ccc, disable, sizeof(disable));
+		break;
+	default:
+		/* both ends see the hangup on the next loop iteration */
+		shutdown(bt_att_get_fd(att), SHUT_RDWR);
+		break;
+	}
+}
+
+static void soak_disconnect_cb(int err, void *user_data);
+
+static void soak_connect(void)
+{
+	static const uint8_t enable[] = { 0x01, 0x00 };
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+		fprintf(stderr, "Failed to create socket pair: %m\n");
+		mainloop_exit_failure();
+		return;
+	}
+
+	if (!gatt_server_attach(fds[0])) {
+		close(fds[0]);
+		close(fds[1]);
+		mainloop_exit_failure();
+		return;
+	}
+
+	att = bt_att_new(fds[1], false);
+	if (!att) {
+		close(fds[1]);
+		mainloop_exit_failure();
+		return;
+	}
+
+	bt_att_set_close_on_unref(att, true);
+	bt_att_register_disconnect(att, soak_disconnect_cb, NULL, NULL);
+
+	soak_step = 0;
+	soak_write(soak_ccc, enable, sizeof(enable));
+}
+
+static void soak_disconnect_cb(int err, void *user_data)
+{
+	bt_att_unref(att);
+	att = NULL;
+
+	soak_count++;
+
+	if (!(soak_count % SOAK_SAMPLE) && !soak_sample()) {
+		mainloop_exit_failure();
+		return;
+	}
+
+	if (soak_count == soak_cycles) {
+		mainloop_quit();
+		return;
+	}
+
+	soak_connect();
+}
+
+static void soak_desc_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	uint16_t handle = gatt_db_attribute_get_handle(attrib);
+
+	switch (attribute_uuid16(attrib)) {
+	case CLIENT_CHARAC_CFG_UUID:
+		soak_ccc = handle;
+		break;
+	case ESS_TRIGER_DESC:
+		soak_trigger = handle;
+		break;
+	}
+}
+
+/* The first characteristic that notifies and has a trigger setting */
+
+static void soak_char_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	uint8_t properties;
+
+	if (soak_ccc && soak_trigger)
+		return;
+
+	if (!gatt_db_attribute_get_char_data(attrib, NULL, NULL, &properties,
+									NULL))
+		return;
+
+	if (!(properties & BT_GATT_CHRC_PROP_NOTIFY))
+		return;
+
+	soak_ccc = 0;
+	soak_trigger = 0;
+	gatt_db_service_foreach_desc(attrib, soak_desc_cb, NULL);
+}
+
+static void soak_service_cb(struct gatt_db_attribute *attrib,
+							void *user_data)
+{
+	gatt_db_service_foreach_char(attrib, soak_char_cb, NULL);
+}
+
+static int soak_run(void)
+{
+	struct gatt_db *server_db;
+	bt_uuid_t uuid;
+	int exit_status;
+
+	server_db = gatt_server_get_db();
+	if (!server_db)
+		return EXIT_FAILURE;
+
+	bt_uuid16_create(&uuid, UUID_ESS_SERVICE);
+	gatt_db_foreach_service(server_db, &uuid, soak_service_cb, NULL);
+
+	if (!soak_ccc || !soak_trigger) {
+		fprintf(stderr, "No characteristic with a trigger setting\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%10s %10s %10s\n", "cycles", "rss(kB)", "heap(kB)");
+
+	soak_connect();
+
+	exit_status = mainloop_run();
+
+	bt_att_unref(att);
+	att = NULL;
+
+	return exit_status;
+}
+
+/* Whole number of seconds for the virtual clock */
+
+static bool parse_seconds(const char *str, unsigned int *val)
+{
+	unsigned long sec;
+	char *end;
+
+	errno = 0;
+	sec = strtoul(str, &end, 0);
+	if (errno || end == str || *end != '\0' || sec > UINT_MAX)
+		return false;
+
+	*val = sec;
+
+	return true;
+}
+
+/* Seed of the value generators, any 64 bit number */
+
+static bool parse_seed(const char *str, uint64_t *seed)
+{
+	unsigned long long val;
+	char *end;
+
+	errno = 0;
+	val = strtoull(str, &end, 0);
+	if (errno || end == str || *end != '\0')
+		return false;
+
+	*seed = val;
+
+	return true;
+}
+
+static void usage(void)
+{
+	printf("ess-bench - ESS loopback benchmark\n"
+		"Usage:\n");
+	printf("\tess-bench [options]\n");
+	printf("Options:\n"
+		"\t-n, --instances <num>  Temperature instances (default 100)\n"
+		"\t-d, --duration <sec>   Notification run time (default 10)\n"
+		"\t-r, --reads <num>      Reads per characteristic (default 1000)\n"
+		"\t-w, --writes <num>     Writes per descriptor (default 100)\n"
+		"\t-c, --connect <addr>   Connect to a sample over LE instead\n"
+		"\t-i, --index <num>      Controller to connect from (default 0)\n"
+		"\t-R, --reconnect <num>  Time the phases of num reconnects\n"
+		"\t-m, --mode <mode>      Reconnect as cold, bonded or cached\n"
+		"\t-k, --soak <num>       Cycle num loopback connections\n"
+		"\t-S, --simulate <speed> Virtual clock, seconds per second\n"
+		"\t-s, --seed <num>       Seed of the value generators\n"
+		"\t-p, --profile <file>   Use profile instead of generated one\n"
+		"\t-h, --help             Show help options\n");
+}
+
+static const struct option main_options[] = {
+	{ "instances", required_argument, NULL, 'n' },
+	{ "duration",  required_argument, NULL, 'd' },
+	{ "reads",     required_argument, NULL, 'r' },
+	{ "writes",    required_argument, NULL, 'w' },
+	{ "profile",   required_argument, NULL, 'p' },
+	{ "connect",   required_argument, NULL, 'c' },
+	{ "index",     required_argument, NULL, 'i' },
+	{ "reconnect", required_argument, NULL, 'R' },
+	{ "mode",      required_argument, NULL, 'm' },
+	{ "soak",      required_argument, NULL, 'k' },
+	{ "simulate",  required_argument, NULL, 'S' },
+	{ "seed",      required_argument, NULL, 's' },
+	{ "help",      no_argument,       NULL, 'h' },
+	{ }
+};
+
+int main(int argc, char *argv[])
+{
+	char tmp_path[] = "/tmp/ess-bench-XXXXXX";
+	const char *profile = NULL;
+	const char *remote = NULL;
+	unsigned int instances = 100;
+	int index = 0;
+	int fds[2];
+	int exit_status;
+	unsigned int speed;
+	uint64_t seed;
+	unsigned int i;
+
+	for (;;) {
+		int opt;
+
+		opt = getopt_long(argc, argv, "n:d:r:w:p:c:i:R:m:k:S:s:h",
+							main_options, NULL);
+		if (opt < 0)
+			break;
+
+		switch (opt) {
+		case 'n':
+			instances = atoi(optarg);
+			break;
+		case 'd':
+			duration = atoi(optarg);
+			break;
+		case 'r':
+			num_reads = atoi(optarg);
+			break;
+		case 'w':
+			num_writes = atoi(optarg);
+			break;
+		case 'p':
+			profile = optarg;
+			break;
+		case 'c':
+			remote = optarg;
+			break;
+		case 'i':
+			index = atoi(optarg);
+			break;
+		case 'R':
+			num_reconnects = atoi(optarg);
+			break;
+		case 'm':
+			for (i = 0; i < NELEM(mode_names); i++)
+				if (!strcmp(optarg, mode_names[i]))
+					break;
+
+			if (i == NELEM(mode_names)) {
+				fprintf(stderr, "Invalid mode %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+
+			reconnect_mode = i;
+			break;
+		case 'k':
+			soak_cycles = atoi(optarg);
+			break;
+		case 'S':
+			if (!parse_seconds(optarg, &speed)) {
+				fprintf(stderr, "Invalid speed %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			ess_clock_simulate(speed, 0);
+			break;
+		case 's':
+			if (!parse_seed(optarg, &seed)) {
+				fprintf(stderr, "Invalid seed %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			ess_rng_set_seed(seed);
+			break;
+		case 'h':
+			usage();
+			return EXIT_SUCCESS;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!instances || !duration) {
+		fprintf(stderr, "Invalid instances or duration\n");
+		return EXIT_FAILURE;
+	}
+
+	if (num_reconnects && !remote) {
+		fprintf(stderr, "Reconnects need a sample to connect to\n");
+		return EXIT_FAILURE;
+	}
+
+	mainloop_init();
+
+	if (num_reconnects) {
+		remote_addr = remote;
+		remote_index = index;
+
+		return reconnect_run();
+	}
+
+	if (remote) {
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+		fds[1] = connect_att(remote, index, BT_SECURITY_LOW);
+		if (fds[1] < 0)
+			return EXIT_FAILURE;
+
+		goto attached;
+	}
+
+	if (!profile) {
+		if (!write_profile(tmp_path, instances))
+			return EXIT_FAILURE;
+
+		profile = tmp_path;
+	}
+
+	gatt_set_profile(profile);
+
+	if (soak_cycles) {
+		exit_status = soak_run();
+		goto stop;
+	}
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+		fprintf(stderr, "Failed to create socket pair: %m\n");
+		exit_status = EXIT_FAILURE;
+		goto done;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	if (!gatt_server_attach(fds[0])) {
+		close(fds[0]);
+		close(fds[1]);
+		exit_status = EXIT_FAILURE;
+		goto done;
+	}
+
+attached:
+	att = bt_att_new(fds[1], false);
+	if (!att) {
+		close(fds[1]);
+		exit_status = EXIT_FAILURE;
+		goto stop;
+	}
+
+	bt_att_set_close_on_unref(att, true);
+	bt_att_register(att, BT_ATT_OP_HANDLE_VAL_NOT, att_notify_cb, NULL,
+									NULL);
+
+	db = gatt_db_new();
+	client = bt_gatt_client_new(db, att, 0);
+	if (!client) {
+		exit_status = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	bt_gatt_client_set_ready_handler(client, ready_cb, NULL, NULL);
+
+	exit_status = mainloop_run();
+
+	bt_gatt_client_unref(client);
+
+cleanup:
+	targets_free(reads, reads_len);
+	targets_free(writes, writes_len);
+	free(notify_ids);
+	gatt_db_unref(db);
+	bt_att_unref(att);
+
+stop:
+	gatt_server_stop();
+
+done:
+	if (profile == tmp_path)
+		unlink(tmp_path);
+
+	return exit_status;
+}
@@ -1,11 +1,16 @@
 
 #define ATT_CID 4
 
-/*UUID of Gap and ESS service */
+/*UUID of Gap, Gatt and ESS service */
 
 #define UUID_GAP 0x1800
+#define UUID_GATT 0x1801
 #define UUID_ESS_SERVICE 0x181A
 
+/* Database Hash characteristic of the GATT service */
+
+#define UUID_DATABASE_HASH 0x2B2A
+
 /*UUID's of all the ESS characteristics */
 
 #define UUID_TEMPERATURE 0x2A6E
@@ -33,6 +38,120 @@
 
 #define ESS_MEASUREMENT_DESC 0x290C
 #define ESS_TRIGER_DESC 0x290D
+#define ESS_CONFIGURATION_DESC 0x290B
 #define ESS_VALID_RANGE_DESC 0x2906
 #define ESS_CHAR_USER_DESC 0x2901
 #define CLIENT_CHARAC_CFG_UUID 0x2902
+
+/* Vendor descriptor of the hysteresis and dead band of the value triggers */
+#define ESS_DAMPING_DESC "8f3c2a61-5d0e-4b7a-9e21-6c4d8b0f1e93"
+
+/*
+*   Characteristic types. ESS_TYPE_<NAME>(X) expands to X(uuid, name, len,  *
+*   axes, signed, notify, user description, value, lower, upper, sample,   *
+*   measurement period, update interval, application, uncertainty), the   *
+*   fields of struct ess_char_type and the defaults the server has always  *
+*   used when no profile file is given.                                    *
+*/
+
+#define ESS_TYPE_TEMPERATURE(X) X(UUID_TEMPERATURE, "temperature", 2, 1, \
+	true, true, "Temperature Charact", 0x0A8C, 0x0000, 0x2710, \
+	0x01, 0x14, 0x1D, 0x1D, 0x15)
+#define ESS_TYPE_APPARENT_WIND_SPEED(X) X(UUID_APPARENT_WIND_SPEED, \
+	"apparent_wind_speed", 2, 1, false, true, \
+	"Apparent wind Speed", 0x0100, 0x0000, 0x2710, \
+	0x01, 0x0A, 0x0F, 0x01, 0x15)
+#define ESS_TYPE_APPARENT_WIND_DIRECTION(X) X(UUID_APPARENT_WIND_DIRECTION, \
+	"apparent_wind_direction", 2, 1, false, true, \
+	"Apparent Direction", 0x0123, 0x0000, 0xAAAA, \
+	0x03, 0x3C, 0x3C, 0x01, 0x15)
+#define ESS_TYPE_DEW_POINT(X) X(UUID_DEW_POINT, "dew_point", 1, 1, \
+	true, true, "Dew Point", 0x23, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_ELEVATION(X) X(UUID_ELEVATION, "elevation", 3, 1, \
+	true, true, "Elevation", 0x002515, 0x002515, 0x002555, \
+	0x07, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_GUST_FACTOR(X) X(UUID_GUST_FACTOR, "gust_factor", 1, 1, \
+	false, true, "Gust Factor", 10, 10, 45, \
+	0x05, 0x3C, 0x3C, 0x09, 0x08)
+#define ESS_TYPE_HEAT_INDEX(X) X(UUID_HEAT_INDEX, "heat_index", 1, 1, \
+	true, true, "Heat index", 0x23, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_HUMIDITY(X) X(UUID_HUMIDITY, "humidity", 2, 1, \
+	false, true, "Humidity", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_IRRADIANCE(X) X(UUID_IRRADIANCE, "irradiance", 2, 1, \
+	false, true, "Irradiance", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_POLLEN_CONCENTRATION(X) X(UUID_POLLEN_CONCENTRATION, \
+	"pollen_concentration", 3, 1, false, true, \
+	"Pollen Concentration", 0x002515, 0x002515, 0x002555, \
+	0x07, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_RAIN_FALL(X) X(UUID_RAIN_FALL, "rainfall", 2, 1, \
+	false, true, "Rain Fall", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_PRESSURE(X) X(UUID_PRESSURE, "pressure", 4, 1, \
+	false, true, "Pressure", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_TRUE_WIND_DIRECTION(X) X(UUID_TRUE_WIND_DIRECTION, \
+	"true_wind_direction", 2, 1, false, true, \
+	"True Wind Direction", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_TRUE_WIND_SPEED(X) X(UUID_TRUE_WIND_SPEED, \
+	"true_wind_speed", 2, 1, false, true, \
+	"True Wind Speed", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_UV_INDEX(X) X(UUID_UV_INDEX, "uv_index", 1, 1, \
+	false, true, "UV Index", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_WIND_CHILL(X) X(UUID_WIND_CHILL, "wind_chill", 1, 1, \
+	true, true, "Wind Chill", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_BAROMETRIC_PRESSURE_TREND(X) \
+	X(UUID_BAROMETRIC_PRESSURE_TREND, "barometric_pressure_trend", 1, 1, \
+	false, false, "Barometric pressure", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_MAGNETIC_DECLINATION(X) X(UUID_MAGNETIC_DECLINATION, \
+	"magnetic_declination", 2, 1, false, true, \
+	"Magnetic Declination", 10, 10, 45, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_MAGNETIC_FLUX_DENSITY_2D(X) X(UUID_MAGNETIC_FLUX_DENSITY_2D, \
+	"magnetic_flux_density_2d", 2, 2, true, true, \
+	"Magnetic Flux 2D", 0, -32768, 32767, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+#define ESS_TYPE_MAGNETIC_FLUX_DENSITY_3D(X) X(UUID_MAGNETIC_FLUX_DENSITY_3D, \
+	"magnetic_flux_density_3d", 2, 3, true, true, \
+	"Magnetic Flux 3D", 0, -32768, 32767, \
+	0x02, 0x3C, 0x3C, 0x15, 0x15)
+
+/*
+*   Build profiles, the types compiled into the server in the order of     *
+*   the default profile. Pick one with -DESS_PROFILE=ESS_PROFILE_<NAME>,   *
+*   a type not in the list has no table entry, no attributes and cannot    *
+*   be named in a profile file.                                            *
+*/
+
+#define ESS_PROFILE_FULL(T) T(TEMPERATURE) T(APPARENT_WIND_SPEED) \
+	T(APPARENT_WIND_DIRECTION) T(DEW_POINT) T(ELEVATION) \
+	T(GUST_FACTOR) T(HEAT_INDEX) T(HUMIDITY) T(IRRADIANCE) \
+	T(POLLEN_CONCENTRATION) T(RAIN_FALL) T(PRESSURE) \
+	T(TRUE_WIND_DIRECTION) T(TRUE_WIND_SPEED) T(UV_INDEX) \
+	T(WIND_CHILL) T(BAROMETRIC_PRESSURE_TREND) \
+	T(MAGNETIC_DECLINATION) T(MAGNETIC_FLUX_DENSITY_2D) \
+	T(MAGNETIC_FLUX_DENSITY_3D)
+
+#define ESS_PROFILE_WEATHER(T) T(TEMPERATURE) T(HUMIDITY) T(PRESSURE) \
+	T(DEW_POINT) T(TRUE_WIND_SPEED) T(TRUE_WIND_DIRECTION) \
+	T(RAIN_FALL) T(UV_INDEX)
+
+#define ESS_PROFILE_TH(T) T(TEMPERATURE) T(HUMIDITY)
+
+#ifndef ESS_PROFILE
+#define ESS_PROFILE ESS_PROFILE_FULL
+#endif
+
+/* One bit per axis count used by the profile, 1 << (axes - 1) */
+
+#define ESS_TYPE_AXES_BIT(uuid, name, len, axes, ...) | (1 << ((axes) - 1))
+#define ESS_PROFILE_AXES_BIT(NAME) ESS_TYPE_##NAME(ESS_TYPE_AXES_BIT)
+#define ESS_PROFILE_AXES (0 ESS_PROFILE(ESS_PROFILE_AXES_BIT))
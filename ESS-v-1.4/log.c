@@ -0,0 +1,659 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "peripheral/ESS/log.h"
+
+#define RING_SIZE	(1 << 18)
+#define RING_MASK	(RING_SIZE - 1)
+#define MAX_STR_LEN	255
+#define MAX_ARGS_LEN	(ESS_LOG_MAX_ARGS * (MAX_STR_LEN + 1))
+#define DRAIN_INTERVAL	10
+
+enum log_arg {
+	LOG_ARG_INT,
+	LOG_ARG_UINT,
+	LOG_ARG_LONG,
+	LOG_ARG_ULONG,
+	LOG_ARG_LLONG,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STR,
+	LOG_ARG_PTR,
+	LOG_ARG_ERRNO,
+};
+
+extern struct ess_log_fmt __start___ess_log[] __attribute__((weak));
+extern struct ess_log_fmt __stop___ess_log[] __attribute__((weak));
+
+int ess_log_level = ESS_LOG_INFO;
+
+static uint8_t ring[RING_SIZE];
+static uint64_t ring_head;
+static uint64_t ring_tail;
+static uint64_t ring_dropped;
+static uint64_t ring_reported;
+
+static bool running = false;
+static bool stopping = false;
+static pthread_t drainer;
+static int log_fd = -1;
+
+static const char *level_str[] = { "error", "warn", "info", "debug" };
+
+/* Find the next conversion of a format, returns its length or 0 at the end */
+
+static size_t next_spec(const char *str, const char **spec, char *conv,
+							char *length)
+{
+	const char *p;
+
+	while ((p = strchr(str, '%'))) {
+		if (p[1] == '%') {
+			str = p + 2;
+			continue;
+		}
+
+		*spec = p++;
+		length[0] = length[1] = '\0';
+
+		while (*p && strchr("-+ #0123456789.*", *p))
+			p++;
+
+		while (*p && strchr("hlzjt", *p)) {
+			if (!length[0])
+				length[0] = *p;
+			else
+				length[1] = *p;
+			p++;
+		}
+
+		if (!*p)
+			return 0;
+
+		*conv = *p;
+
+		return p + 1 - *spec;
+	}
+
+	return 0;
+}
+
+void ess_log_parse(struct ess_log_fmt *fmt)
+{
+	const char *str = fmt->format, *spec;
+	char conv, length[2];
+	size_t len;
+
+	fmt->nargs = 0;
+
+	while ((len = next_spec(str, &spec, &conv, length))) {
+		bool wide = length[0] == 'l' || length[0] == 'z' ||
+				length[0] == 'j' || length[0] == 't';
+		bool longlong = (length[0] == 'l' && length[1] == 'l') ||
+							length[0] == 'j';
+		uint8_t type;
+
+		str = spec + len;
+
+		if (memchr(spec, '*', len) || fmt->nargs == ESS_LOG_MAX_ARGS)
+			break;
+
+		switch (conv) {
+		case 'd':
+		case 'i':
+		case 'c':
+			type = longlong ? LOG_ARG_LLONG :
+					wide ? LOG_ARG_LONG : LOG_ARG_INT;
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			type = longlong ? LOG_ARG_LLONG :
+					wide ? LOG_ARG_ULONG : LOG_ARG_UINT;
+			break;
+		case 's':
+			type = LOG_ARG_STR;
+			break;
+		case 'p':
+			type = LOG_ARG_PTR;
+			break;
+		case 'm':
+			type = LOG_ARG_ERRNO;
+			break;
+		default:
+			type = LOG_ARG_DOUBLE;
+			break;
+		}
+
+		fmt->types[fmt->nargs++] = type;
+	}
+
+	fmt->parsed = 1;
+}
+
+/* Copy the arguments as they are, the only work is walking va_list */
+
+static uint16_t pack_args(const struct ess_log_fmt *fmt, va_list ap, int err,
+								uint8_t *buf)
+{
+	uint16_t len = 0;
+	int i;
+
+	for (i = 0; i < fmt->nargs; i++) {
+		union {
+			int i;
+			long l;
+			long long ll;
+			double d;
+			void *p;
+		} v;
+		const char *str;
+		size_t n;
+
+		switch (fmt->types[i]) {
+		case LOG_ARG_INT:
+		case LOG_ARG_UINT:
+			v.i = va_arg(ap, int);
+			memcpy(buf + len, &v.i, sizeof(int));
+			len += sizeof(int);
+			break;
+		case LOG_ARG_LONG:
+		case LOG_ARG_ULONG:
+			v.l = va_arg(ap, long);
+			memcpy(buf + len, &v.l, sizeof(long));
+			len += sizeof(long);
+			break;
+		case LOG_ARG_LLONG:
+			v.ll = va_arg(ap, long long);
+			memcpy(buf + len, &v.ll, sizeof(long long));
+			len += sizeof(long long);
+			break;
+		case LOG_ARG_DOUBLE:
+			v.d = va_arg(ap, double);
+			memcpy(buf + len, &v.d, sizeof(double));
+			len += sizeof(double);
+			break;
+		case LOG_ARG_PTR:
+			v.p = va_arg(ap, void *);
+			memcpy(buf + len, &v.p, sizeof(void *));
+			len += sizeof(void *);
+			break;
+		case LOG_ARG_ERRNO:
+			memcpy(buf + len, &err, sizeof(int));
+			len += sizeof(int);
+			break;
+		case LOG_ARG_STR:
+			str = va_arg(ap, const char *);
+			if (!str)
+				str = "(null)";
+			n = strnlen(str, MAX_STR_LEN);
+			buf[len++] = n;
+			memcpy(buf + len, str, n);
+			len += n;
+			break;
+		}
+	}
+
+	return len;
+}
+
+/* Append literal format text, collapsing "%%" */
+
+static void append_literal(char *str, size_t size, size_t *out,
+					const char *text, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len && *out < size - 1; i++) {
+		if (text[i] == '%' && i + 1 < len && text[i + 1] == '%')
+			i++;
+
+		str[(*out)++] = text[i];
+	}
+
+	str[*out] = '\0';
+}
+
+int ess_log_render(const struct ess_log_fmt *fmt, const uint8_t *args,
+					uint16_t len, char *str, size_t size)
+{
+	const char *format = fmt->format, *spec;
+	char conv, length[2];
+	size_t out = 0, speclen;
+	uint16_t pos = 0;
+	int i;
+
+	if (!size)
+		return 0;
+
+	str[0] = '\0';
+
+	for (i = 0; i < fmt->nargs; i++) {
+		char tmp[MAX_STR_LEN + 1];
+		char buf[32];
+		int n = 0;
+
+		speclen = next_spec(format, &spec, &conv, length);
+		if (!speclen || speclen >= sizeof(buf))
+			break;
+
+		append_literal(str, size, &out, format, spec - format);
+
+		memcpy(buf, spec, speclen);
+		buf[speclen] = '\0';
+
+		switch (fmt->types[i]) {
+		case LOG_ARG_INT:
+		case LOG_ARG_UINT: {
+			int v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, buf, v);
+			break;
+		}
+		case LOG_ARG_LONG:
+		case LOG_ARG_ULONG: {
+			long v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, buf, v);
+			break;
+		}
+		case LOG_ARG_LLONG: {
+			long long v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, buf, v);
+			break;
+		}
+		case LOG_ARG_DOUBLE: {
+			double v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, buf, v);
+			break;
+		}
+		case LOG_ARG_PTR: {
+			void *v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, buf, v);
+			break;
+		}
+		case LOG_ARG_ERRNO: {
+			int v;
+
+			if (pos + sizeof(v) > len)
+				goto done;
+			memcpy(&v, args + pos, sizeof(v));
+			pos += sizeof(v);
+			n = snprintf(str + out, size - out, "%s", strerror(v));
+			break;
+		}
+		case LOG_ARG_STR: {
+			uint8_t slen;
+
+			if (pos + 1 > len || pos + 1 + args[pos] > len)
+				goto done;
+			slen = args[pos++];
+			memcpy(tmp, args + pos, slen);
+			tmp[slen] = '\0';
+			pos += slen;
+			n = snprintf(str + out, size - out, buf, tmp);
+			break;
+		}
+		}
+
+		if (n < 0)
+			goto done;
+
+		out += (size_t) n < size - out ? (size_t) n : size - out - 1;
+		format = spec + speclen;
+	}
+
+	/* whatever follows the last argument, unsupported specs included */
+	append_literal(str, size, &out, format, strlen(format));
+
+done:
+	return out;
+}
+
+static void ring_copy_in(uint64_t pos, const void *data, size_t len)
+{
+	size_t off = pos & RING_MASK;
+	size_t first = RING_SIZE - off < len ? RING_SIZE - off : len;
+
+	memcpy(ring + off, data, first);
+	memcpy(ring, (const uint8_t *) data + first, len - first);
+}
+
+static void ring_copy_out(uint64_t pos, void *data, size_t len)
+{
+	size_t off = pos & RING_MASK;
+	size_t first = RING_SIZE - off < len ? RING_SIZE - off : len;
+
+	memcpy(data, ring + off, first);
+	memcpy((uint8_t *) data + first, ring, len - first);
+}
+
+static uint64_t log_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void print_text(const struct ess_log_fmt *fmt, const uint8_t *args,
+								uint16_t len)
+{
+	char str[1024];
+
+	ess_log_render(fmt, args, len, str, sizeof(str));
+
+	fputs(str, fmt->level <= ESS_LOG_WARN ? stderr : stdout);
+}
+
+void ess_log_write(struct ess_log_fmt *fmt, ...)
+{
+	struct ess_log_record rec;
+	uint8_t args[MAX_ARGS_LEN];
+	uint64_t head, tail;
+	int err = errno;
+	va_list ap;
+
+	if (!fmt->parsed)
+		ess_log_parse(fmt);
+
+	va_start(ap, fmt);
+	rec.len = pack_args(fmt, ap, err, args);
+	va_end(ap);
+
+	/* before the drainer runs, and in tools without one, print directly */
+	if (!running) {
+		print_text(fmt, args, rec.len);
+		errno = err;
+		return;
+	}
+
+	rec.time = log_now();
+	rec.id = fmt - __start___ess_log;
+
+	head = ring_head;
+	tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail + sizeof(rec) + rec.len > RING_SIZE) {
+		__atomic_store_n(&ring_dropped, ring_dropped + 1,
+							__ATOMIC_RELAXED);
+		errno = err;
+		return;
+	}
+
+	ring_copy_in(head, &rec, sizeof(rec));
+	ring_copy_in(head + sizeof(rec), args, rec.len);
+
+	__atomic_store_n(&ring_head, head + sizeof(rec) + rec.len,
+							__ATOMIC_RELEASE);
+
+	errno = err;
+}
+
+static void drain_record(const struct ess_log_record *rec,
+							const uint8_t *args)
+{
+	const struct ess_log_fmt *fmt = &__start___ess_log[rec->id];
+
+	if (log_fd < 0) {
+		print_text(fmt, args, rec->len);
+		return;
+	}
+
+	if (write(log_fd, rec, sizeof(*rec)) < 0 ||
+				write(log_fd, args, rec->len) < 0)
+		return;
+}
+
+static void *drainer_thread(void *user_data)
+{
+	for (;;) {
+		uint64_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+		uint64_t tail = ring_tail;
+		uint64_t now_dropped;
+
+		while (tail != head) {
+			struct ess_log_record rec;
+			uint8_t args[MAX_ARGS_LEN];
+
+			ring_copy_out(tail, &rec, sizeof(rec));
+			ring_copy_out(tail + sizeof(rec), args, rec.len);
+			tail += sizeof(rec) + rec.len;
+
+			__atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+
+			drain_record(&rec, args);
+		}
+
+		now_dropped = __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+		if (now_dropped != ring_reported) {
+			fprintf(stderr, "%llu log messages dropped\n",
+				(unsigned long long) (now_dropped - ring_reported));
+			ring_reported = now_dropped;
+		}
+
+		fflush(stdout);
+		fflush(stderr);
+
+		if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE) &&
+			tail == __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE))
+			break;
+
+		usleep(DRAIN_INTERVAL * 1000);
+	}
+
+	return NULL;
+}
+
+static bool write_header(int fd)
+{
+	struct ess_log_fmt *fmt;
+	struct timespec ts;
+	uint8_t hdr[23];
+	uint64_t val;
+	uint16_t count = __stop___ess_log - __start___ess_log;
+
+	memcpy(hdr, ESS_LOG_MAGIC, 4);
+	hdr[4] = ESS_LOG_VERSION;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	val = htole64(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+	memcpy(&hdr[5], &val, 8);
+
+	val = htole64(log_now());
+	memcpy(&hdr[13], &val, 8);
+
+	count = htole16(count);
+	memcpy(&hdr[21], &count, 2);
+
+	if (write(fd, hdr, sizeof(hdr)) != sizeof(hdr))
+		return false;
+
+	for (fmt = __start___ess_log; fmt < __stop___ess_log; fmt++) {
+		uint16_t len = strlen(fmt->format);
+		uint8_t desc[3];
+
+		desc[0] = fmt->level;
+		desc[1] = len;
+		desc[2] = len >> 8;
+
+		if (write(fd, desc, 3) != 3 ||
+				write(fd, fmt->format, len) != len)
+			return false;
+	}
+
+	return true;
+}
+
+/* A writer appending to a log of another one starts over with its header */
+
+static bool write_continue(int fd)
+{
+	struct ess_log_record rec;
+	struct stat st;
+
+	if (fstat(fd, &st) < 0)
+		return false;
+
+	if (!st.st_size)
+		return true;
+
+	rec.time = log_now();
+	rec.id = ESS_LOG_ID_HEADER;
+	rec.len = 0;
+
+	return write(fd, &rec, sizeof(rec)) == sizeof(rec);
+}
+
+/*
+*   Start the drainer. With a path the records go to that file unrendered  *
+*   (see ess-logdump), otherwise they are rendered to stdout and stderr.   *
+*   Log calls keep printing synchronously until this is called. With       *
+*   append the file is continued instead of truncated, the writer before   *
+*   must have stopped.                                                     *
+*/
+
+bool ess_log_start(const char *path, bool append)
+{
+	struct ess_log_fmt *fmt;
+
+	if (running)
+		return true;
+
+	/* the drainer only reads descriptors, parse all of them up front */
+	for (fmt = __start___ess_log; fmt < __stop___ess_log; fmt++) {
+		if (!fmt->parsed)
+			ess_log_parse(fmt);
+	}
+
+	if (path) {
+		log_fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC |
+				(append ? O_APPEND : O_TRUNC), 0644);
+		if (log_fd < 0 || (append && !write_continue(log_fd)) ||
+						!write_header(log_fd)) {
+			fprintf(stderr, "Failed to open log %s: %m\n", path);
+			if (log_fd >= 0)
+				close(log_fd);
+			log_fd = -1;
+			return false;
+		}
+	}
+
+	stopping = false;
+
+	if (pthread_create(&drainer, NULL, drainer_thread, NULL)) {
+		fprintf(stderr, "Failed to start log drainer\n");
+		if (log_fd >= 0)
+			close(log_fd);
+		log_fd = -1;
+		return false;
+	}
+
+	running = true;
+
+	return true;
+}
+
+void ess_log_stop(void)
+{
+	if (!running)
+		return;
+
+	__atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+	pthread_join(drainer, NULL);
+
+	running = false;
+
+	if (log_fd >= 0) {
+		close(log_fd);
+		log_fd = -1;
+	}
+}
+
+int ess_log_parse_level(const char *str)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(level_str) / sizeof(level_str[0]); i++) {
+		if (!strcasecmp(str, level_str[i]))
+			return i;
+	}
+
+	return -1;
+}
+
+void ess_log_set_level(int level)
+{
+	if (level < ESS_LOG_ERROR || level > ESS_LOG_DEBUG)
+		return;
+
+	__atomic_store_n(&ess_log_level, level, __ATOMIC_RELAXED);
+}
+
+const char *ess_log_level_str(int level)
+{
+	if (level < ESS_LOG_ERROR || level > ESS_LOG_DEBUG)
+		return "unknown";
+
+	return level_str[level];
+}
@@ -0,0 +1,105 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Binary logging. A log call stores the id of its format string and the
+ * raw arguments in a ring buffer, nothing is formatted on the calling
+ * thread. A drainer thread renders the records to stdout/stderr or writes
+ * them unchanged to a log file which ess-logdump renders later. When the
+ * ring is full the record is dropped and counted, a caller never blocks.
+ *
+ * Every format string is a static descriptor in the "__ess_log" section,
+ * its id is its index there. Records are produced by the mainloop thread
+ * only.
+ */
+
+#define ESS_LOG_ERROR	0
+#define ESS_LOG_WARN	1
+#define ESS_LOG_INFO	2
+#define ESS_LOG_DEBUG	3
+
+#define ESS_LOG_MAX_ARGS 8
+
+struct ess_log_fmt {
+	uint8_t level;
+	uint8_t parsed;
+	uint8_t nargs;
+	uint8_t types[ESS_LOG_MAX_ARGS];
+	const char *format;
+} __attribute__((aligned(8)));
+
+extern int ess_log_level;
+
+void ess_log_write(struct ess_log_fmt *fmt, ...);
+
+#define ess_log(lvl, fmt, arg...) do {					\
+	static struct ess_log_fmt __ess_log_desc			\
+	__attribute__((used, section("__ess_log"), aligned(8))) = {	\
+		.level = lvl, .format = fmt,				\
+	};								\
+	if (lvl <= ess_log_level)					\
+		ess_log_write(&__ess_log_desc , ## arg);		\
+} while (0)
+
+#define ess_error(fmt, arg...) ess_log(ESS_LOG_ERROR, fmt, ## arg)
+#define ess_warn(fmt, arg...) ess_log(ESS_LOG_WARN, fmt, ## arg)
+#define ess_info(fmt, arg...) ess_log(ESS_LOG_INFO, fmt, ## arg)
+#define ess_debug(fmt, arg...) ess_log(ESS_LOG_DEBUG, fmt, ## arg)
+
+bool ess_log_start(const char *path, bool append);
+void ess_log_stop(void);
+
+int ess_log_parse_level(const char *str);
+void ess_log_set_level(int level);
+const char *ess_log_level_str(int level);
+
+/*
+ * Log file layout: the magic "ESSL", a version octet, the realtime and
+ * monotonic clocks in ns when the file was started (u64 each), the number
+ * of formats (u16) and for each format its level (u8), length (u16) and
+ * text, all little endian. Records follow, a struct ess_log_record and
+ * "len" octets of arguments, both in the byte order of the writer.
+ *
+ * A process appending to the log of another one, the new process of a
+ * live upgrade, writes a record with id ESS_LOG_ID_HEADER and no
+ * arguments, followed by a header of its own; its formats replace the
+ * previous ones from there on.
+ */
+
+#define ESS_LOG_MAGIC "ESSL"
+#define ESS_LOG_VERSION 1
+#define ESS_LOG_ID_HEADER 0xffff
+
+struct ess_log_record {
+	uint64_t time;
+	uint16_t id;
+	uint16_t len;
+} __attribute__((packed));
+
+void ess_log_parse(struct ess_log_fmt *fmt);
+int ess_log_render(const struct ess_log_fmt *fmt, const uint8_t *args,
+					uint16_t len, char *str, size_t size);
@@ -0,0 +1,176 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <endian.h>
+
+#include "peripheral/ESS/log.h"
+
+/* Render a binary log written by "sample --log-file" */
+
+static bool read_all(FILE *fp, void *buf, size_t len)
+{
+	return fread(buf, 1, len, fp) == len;
+}
+
+static const char *level_tag[] = { "E", "W", "I", "D" };
+
+static struct ess_log_fmt *fmts = NULL;
+static uint16_t count = 0;
+static uint64_t realtime, monotonic;
+
+static void free_formats(void)
+{
+	uint16_t i;
+
+	for (i = 0; i < count; i++)
+		free((char *) fmts[i].format);
+
+	free(fmts);
+	fmts = NULL;
+	count = 0;
+}
+
+/* The header at the start of the log, and after an ESS_LOG_ID_HEADER record */
+
+static bool read_header(FILE *fp)
+{
+	uint8_t hdr[23];
+	uint16_t num, i;
+
+	free_formats();
+
+	if (!read_all(fp, hdr, sizeof(hdr)) ||
+				memcmp(hdr, ESS_LOG_MAGIC, 4) ||
+				hdr[4] != ESS_LOG_VERSION)
+		return false;
+
+	memcpy(&realtime, &hdr[5], 8);
+	memcpy(&monotonic, &hdr[13], 8);
+	memcpy(&num, &hdr[21], 2);
+	realtime = le64toh(realtime);
+	monotonic = le64toh(monotonic);
+	num = le16toh(num);
+
+	fmts = calloc(num ? num : 1, sizeof(*fmts));
+	if (!fmts)
+		return false;
+
+	for (i = 0; i < num; i++) {
+		uint8_t desc[3];
+		uint16_t len;
+		char *format;
+
+		if (!read_all(fp, desc, sizeof(desc)))
+			return false;
+
+		len = desc[1] | (desc[2] << 8);
+
+		format = malloc(len + 1);
+		if (!format || !read_all(fp, format, len)) {
+			free(format);
+			return false;
+		}
+
+		format[len] = '\0';
+
+		fmts[i].level = desc[0];
+		fmts[i].format = format;
+		ess_log_parse(&fmts[i]);
+		count = i + 1;
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ess_log_record rec;
+	FILE *fp;
+
+	if (argc != 2) {
+		printf("ess-logdump - render an ESS binary log\n"
+			"Usage:\n\tess-logdump <file>\n");
+		return EXIT_FAILURE;
+	}
+
+	fp = fopen(argv[1], "rb");
+	if (!fp) {
+		fprintf(stderr, "Failed to open %s: %m\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if (!read_header(fp)) {
+		fprintf(stderr, "%s is not an ESS log\n", argv[1]);
+		free_formats();
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+
+	while (read_all(fp, &rec, sizeof(rec))) {
+		uint8_t args[UINT16_MAX];
+		char str[1024];
+		uint64_t ns;
+
+		/* a new process continued the log, see log.h */
+		if (rec.id == ESS_LOG_ID_HEADER && !rec.len) {
+			if (!read_header(fp))
+				goto truncated;
+			continue;
+		}
+
+		if (!read_all(fp, args, rec.len) || rec.id >= count)
+			goto truncated;
+
+		ns = realtime + (rec.time - monotonic);
+
+		ess_log_render(&fmts[rec.id], args, rec.len, str, sizeof(str));
+
+		printf("%llu.%06llu %s %s", (unsigned long long) ns / 1000000000,
+				(unsigned long long) (ns % 1000000000) / 1000,
+				fmts[rec.id].level < 4 ?
+					level_tag[fmts[rec.id].level] : "?",
+				str);
+
+		if (!*str || str[strlen(str) - 1] != '\n')
+			printf("\n");
+	}
+
+	goto done;
+
+truncated:
+	fprintf(stderr, "%s is truncated\n", argv[1]);
+
+done:
+	free_formats();
+	fclose(fp);
+
+	return EXIT_SUCCESS;
+}
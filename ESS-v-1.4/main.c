@@ -32,8 +32,12 @@
 #include <stdbool.h>
 #include <signal.h>
 #include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <poll.h>
 #include <sys/wait.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/mount.h>
@@ -43,19 +47,419 @@
 #endif
 
 #include "src/shared/mainloop.h"
+#include "src/shared/util.h"
 #include "peripheral/ESS/advertising.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/metrics.h"
+#include "peripheral/ESS/profile.h"
+#include "peripheral/ESS/sched.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
+#include "peripheral/ESS/sim.h"
+
+static char **main_argv;
+static int main_argc;
+static const char *log_path = NULL;
+static bool upgraded = false;
+/* the new process while it takes over, -1 once it exited before that */
+static pid_t upgrade_pid = 0;
+
+/*
+*   Live upgrade: start the binary at argv[0] again, it gets one end of a  *
+*   socket pair through --handover and takes every connection over. This  *
+*   process only exits once the new one has acknowledged the takeover,    *
+*   its connections are not served any more while it waits. The log file  *
+*   goes to the new process as well, this one logs as text meanwhile.     *
+*/
+
+/* The log file is written by one process at a time */
+
+static void upgrade_log(bool own)
+{
+	if (!log_path)
+		return;
+
+	ess_log_stop();
+
+	if (!own || !ess_log_start(log_path, true))
+		ess_log_start(NULL, false);
+}
+
+static void upgrade_done(bool success, void *user_data)
+{
+	close(PTR_TO_INT(user_data));
+
+	if (success) {
+		upgraded = true;
+		mainloop_quit();
+		return;
+	}
+
+	/* a new process that did not answer may be stuck anywhere */
+	if (upgrade_pid > 0) {
+		kill(upgrade_pid, SIGKILL);
+		waitpid(upgrade_pid, NULL, 0);
+	}
+
+	upgrade_pid = 0;
+
+	upgrade_log(true);
+}
+
+static void upgrade(void)
+{
+	/* on the stack, the heap is not touched once the sample runs */
+	char *argv[main_argc + 2];
+	char arg[32];
+	int fds[2];
+	int i, n = 0;
+	pid_t pid;
+
+	if (upgrade_pid) {
+		ess_warn("Upgrade already in progress\n");
+		return;
+	}
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+		ess_error("Failed to create upgrade socket: %m\n");
+		return;
+	}
+
+	for (i = 0; i < main_argc; i++) {
+		if (!strncmp(main_argv[i], "--handover=", 11))
+			continue;
+
+		argv[n++] = main_argv[i];
+	}
+
+	snprintf(arg, sizeof(arg), "--handover=%d", fds[1]);
+	argv[n++] = arg;
+	argv[n] = NULL;
+
+	/* the new process appends to the log once everything is written */
+	upgrade_log(false);
+
+	pid = fork();
+	if (pid < 0) {
+		ess_error("Failed to start new process: %m\n");
+		close(fds[0]);
+		close(fds[1]);
+		upgrade_log(true);
+		return;
+	}
+
+	if (pid == 0) {
+		sigset_t mask;
+
+		sigemptyset(&mask);
+		sigprocmask(SIG_SETMASK, &mask, NULL);
+
+		close(fds[0]);
+		fcntl(fds[1], F_SETFD, 0);
+
+		execvp(argv[0], argv);
+		_exit(EXIT_FAILURE);
+	}
+
+	close(fds[1]);
+	upgrade_pid = pid;
+
+	if (!gatt_server_handover(fds[0], upgrade_done, INT_TO_PTR(fds[0])))
+		upgrade_done(false, INT_TO_PTR(fds[0]));
+}
+
+static void signal_callback(int signum, void *user_data)
+{
+	switch (signum) {
+	case SIGINT:
+	case SIGTERM:
+		mainloop_quit();
+		break;
+	case SIGHUP:
+		ess_info("Reloading profile\n");
+		gatt_server_reload();
+		break;
+	case SIGUSR2:
+		ess_info("Upgrading\n");
+		upgrade();
+		break;
+	case SIGUSR1:
+		/* cycle error -> warn -> info -> debug -> error */
+		ess_log_set_level((ess_log_level + 1) % (ESS_LOG_DEBUG + 1));
+		ess_warn("Log level %s\n", ess_log_level_str(ess_log_level));
+		break;
+	case SIGCHLD:
+		while (1) {
+			int status;
+			pid_t pid = waitpid(WAIT_ANY, &status, WNOHANG);
+
+			if (pid < 0 || pid == 0)
+				break;
+
+			if (pid == upgrade_pid)
+				upgrade_pid = -1;
+		}
+		break;
+	}
+}
+
+/* Whole number of seconds for the virtual clock */
+
+static bool parse_seconds(const char *str, unsigned int *val)
+{
+	unsigned long sec;
+	char *end;
+
+	errno = 0;
+	sec = strtoul(str, &end, 0);
+	if (errno || end == str || *end != '\0' || sec > UINT_MAX)
+		return false;
+
+	*val = sec;
+
+	return true;
+}
+
+/* Seed of the value generators, any 64 bit number */
+
+static bool parse_seed(const char *str, uint64_t *seed)
+{
+	unsigned long long val;
+	char *end;
+
+	errno = 0;
+	val = strtoull(str, &end, 0);
+	if (errno || end == str || *end != '\0')
+		return false;
+
+	*seed = val;
+
+	return true;
+}
+
+/* Descriptor inherited from the process handing over */
+
+static bool parse_fd(const char *str, int *fd)
+{
+	long val;
+	char *end;
+
+	errno = 0;
+	val = strtol(str, &end, 10);
+	if (errno || end == str || *end != '\0' || val < 0 || val > INT_MAX)
+		return false;
+
+	*fd = val;
+
+	return true;
+}
+
+/* Rate and optional burst in octets, the burst is one second by default */
+
+static bool parse_budget(const char *str)
+{
+	unsigned long rate, burst;
+	char *end;
+
+	errno = 0;
+	rate = strtoul(str, &end, 0);
+	if (errno || end == str || rate > UINT32_MAX)
+		return false;
+
+	burst = rate;
+
+	if (*end == ':') {
+		str = end + 1;
+		burst = strtoul(str, &end, 0);
+		if (errno || end == str || burst > UINT32_MAX)
+			return false;
+	}
+
+	if (*end != '\0')
+		return false;
+
+	/* the bucket has to hold the largest notification at least once */
+	if (rate && (burst > rate ? burst : rate) <
+			ess_char_type_max_len() + ESS_SCHED_ATT_HDR)
+		return false;
+
+	gatt_set_notify_budget(rate, burst);
+
+	return true;
+}
+
+static void usage(void)
+{
+	printf("ESS sample - Environmental Sensing Service peripheral\n"
+		"Usage:\n");
+	printf("\tsample [options]\n");
+	printf("Options:\n"
+		"\t-p, --profile <file>   Characteristics to expose\n"
+		"\t-m, --metrics <path>   Serve metrics on a unix socket\n"
+		"\t-l, --log-level <lvl>  error, warn, info (default) or debug\n"
+		"\t-L, --log-file <file>  Write the binary log to a file\n"
+		"\t-i, --index <num>      Use this controller\n"
+		"\t-t, --tx-timestamps    Measure sample age with kernel\n"
+		"\t                       transmit timestamps\n"
+		"\t-S, --simulate <speed> Virtual clock, seconds per second\n"
+		"\t-u, --until <sec>      Exit at this virtual time\n"
+		"\t-s, --seed <num>       Seed of the value generators\n"
+		"\t-M, --mem-accounting   Account memory by subsystem, served\n"
+		"\t                       with the metrics\n"
+		"\t-b, --notify-budget <rate>[:<burst>]\n"
+		"\t                       Notification octets per second and\n"
+		"\t                       connection, urgent ones first\n"
+		"\t--handover <fd>        Take over from a running instance\n"
+		"\t-h, --help             Show help options\n");
+}
+
+static const struct option main_options[] = {
+	{ "profile", required_argument, NULL, 'p' },
+	{ "metrics", required_argument, NULL, 'm' },
+	{ "log-level", required_argument, NULL, 'l' },
+	{ "log-file", required_argument, NULL, 'L' },
+	{ "index",   required_argument, NULL, 'i' },
+	{ "tx-timestamps", no_argument, NULL, 't' },
+	{ "simulate", required_argument, NULL, 'S' },
+	{ "until",   required_argument, NULL, 'u' },
+	{ "seed",    required_argument, NULL, 's' },
+	{ "mem-accounting", no_argument, NULL, 'M' },
+	{ "notify-budget", required_argument, NULL, 'b' },
+	{ "handover", required_argument, NULL, 'H' },
+	{ "help",    no_argument,       NULL, 'h' },
+	{ }
+};
 
 int main(int argc, char *argv[])
 {
 	sigset_t mask;
+	const char *metrics_path = NULL;
+	int handover_fd = -1;
+	unsigned int speed = 0;
+	unsigned int until = 0;
+	bool tx_timestamps = false;
+	uint64_t seed;
 	int exit_status;
-	
+
+	main_argv = argv;
+	main_argc = argc;
+
+	for (;;) {
+		int opt;
+
+		opt = getopt_long(argc, argv, "p:m:l:L:i:tS:u:s:Mb:h", main_options, NULL);
+		if (opt < 0)
+			break;
+
+		switch (opt) {
+		case 'p':
+			gatt_set_profile(optarg);
+			break;
+		case 'm':
+			metrics_path = optarg;
+			break;
+		case 'l':
+			if (ess_log_parse_level(optarg) < 0) {
+				fprintf(stderr, "Invalid log level %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			ess_log_set_level(ess_log_parse_level(optarg));
+			break;
+		case 'L':
+			log_path = optarg;
+			break;
+		case 'i':
+			gap_set_index(atoi(optarg));
+			break;
+		case 't':
+			tx_timestamps = true;
+			break;
+		case 'S':
+			if (!parse_seconds(optarg, &speed)) {
+				fprintf(stderr, "Invalid speed %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'u':
+			if (!parse_seconds(optarg, &until)) {
+				fprintf(stderr, "Invalid time %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 's':
+			if (!parse_seed(optarg, &seed)) {
+				fprintf(stderr, "Invalid seed %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			ess_rng_set_seed(seed);
+			break;
+		case 'M':
+			ess_mem_enable();
+			break;
+		case 'b':
+			if (!parse_budget(optarg)) {
+				fprintf(stderr, "Invalid budget %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'H':
+			if (!parse_fd(optarg, &handover_fd)) {
+				fprintf(stderr, "Invalid descriptor %s\n",
+									optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'h':
+			usage();
+			return EXIT_SUCCESS;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (speed || until) {
+		/* kernel timestamps are wall clock, not virtual time */
+		if (tx_timestamps) {
+			fprintf(stderr, "Timestamps do not work in simulation\n");
+			return EXIT_FAILURE;
+		}
+
+		ess_clock_simulate(speed, until);
+	}
+
+	gatt_set_tx_timestamps(tx_timestamps);
+
 	mainloop_init();
 
 	sigemptyset(&mask);
 	sigaddset(&mask, SIGINT);
 	sigaddset(&mask, SIGTERM);
 	sigaddset(&mask, SIGCHLD);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGUSR1);
+	sigaddset(&mask, SIGUSR2);
+
+	mainloop_set_signal(&mask, signal_callback, NULL, NULL);
+
+	/* the drainer thread inherits the blocked signal mask */
+	if (!ess_log_start(log_path, handover_fd >= 0))
+		return EXIT_FAILURE;
+
+	if (handover_fd >= 0) {
+		bool taken = gatt_server_takeover(handover_fd);
+
+		close(handover_fd);
+
+		if (!taken) {
+			ess_log_stop();
+			return EXIT_FAILURE;
+		}
+
+		gap_set_keep_powered(true);
+	}
+
+	if (metrics_path)
+		metrics_start(metrics_path, gatt_server_collect);
 
 	gap_start();
 
@@ -63,5 +467,9 @@ int main(int argc, char *argv[])
 
 	gap_stop();
 
+	metrics_stop(!upgraded);
+
+	ess_log_stop();
+
 	return exit_status;
 }
@@ -0,0 +1,476 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lib/bluetooth.h"
+#include "src/shared/mainloop.h"
+#include "src/shared/util.h"
+#include "peripheral/ESS/metrics.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
+
+struct metrics_buf {
+	uint8_t *data;
+	size_t len;
+	size_t size;
+	bool binary;
+	bool failed;
+	bool described[METRIC_MAX];
+};
+
+struct metrics_client {
+	int fd;
+	bool requested;
+	struct metrics_buf buf;
+	size_t sent;
+#ifdef ESS_STATIC
+	uint8_t data[ESS_STATIC_METRICS_BUF];
+#endif
+};
+
+ESS_ARENA(client_arena, struct metrics_client, ESS_STATIC_CLIENTS,
+								ESS_MEM_METRICS);
+
+static const struct {
+	const char *name;
+	const char *type;
+	const char *help;
+} metrics_desc[METRIC_MAX] = {
+	[METRIC_READS] = { "ess_reads_total", "counter",
+		"ATT reads of a characteristic and its descriptors" },
+	[METRIC_WRITES] = { "ess_writes_total", "counter",
+		"ATT writes to the descriptors of a characteristic" },
+	[METRIC_NOTIFICATIONS] = { "ess_notifications_total", "counter",
+		"Notifications queued to connected clients" },
+	[METRIC_SUPPRESSED] = { "ess_notifications_suppressed_total",
+		"counter", "Samples not notified because of the trigger" },
+	[METRIC_SEND_FAILURES] = { "ess_send_failures_total", "counter",
+		"Notifications the ATT layer refused" },
+	[METRIC_CONNECTIONS] = { "ess_connections", "gauge",
+		"Connected clients" },
+	[METRIC_CONN_QUEUE] = { "ess_connection_queue_bytes", "gauge",
+		"Octets waiting in the socket send queue of a connection" },
+	[METRIC_ATT_LATENCY] = { "ess_att_handling_nanoseconds", "histogram",
+		"Time spent handling an ATT request, by opcode" },
+	[METRIC_AGE_SCHED] = { "ess_tick_delay_nanoseconds", "histogram",
+		"Delay between the due time of a tick and the sample it took" },
+	[METRIC_AGE_TRIGGER] = { "ess_sample_age_trigger_nanoseconds",
+		"histogram", "Age of a sample once its trigger was evaluated" },
+	[METRIC_AGE_ENCODE] = { "ess_sample_age_encoded_nanoseconds",
+		"histogram", "Age of a sample once it was encoded" },
+	[METRIC_AGE_QUEUE] = { "ess_sample_age_queued_nanoseconds",
+		"histogram", "Age of a sample once queued to the ATT layer" },
+	[METRIC_AGE_SEND] = { "ess_sample_age_sent_nanoseconds", "histogram",
+		"Age of a sample when the kernel passed it to the driver" },
+	[METRIC_AGE_COMPLETE] = { "ess_sample_age_completed_nanoseconds",
+		"histogram", "Age of a sample when the controller sent it" },
+	[METRIC_CONN_ACCEPT] = { "ess_conn_accept_nanoseconds", "histogram",
+		"Time spent accepting an ATT connection" },
+	[METRIC_CONN_SETUP] = { "ess_conn_setup_nanoseconds", "histogram",
+		"Time spent setting up the ATT and GATT layers of a connection" },
+	[METRIC_MEMORY] = { "ess_memory_bytes", "gauge",
+		"Memory held by a subsystem" },
+	[METRIC_MEMORY_PEAK] = { "ess_memory_peak_bytes", "gauge",
+		"High-water mark of the memory held by a subsystem" },
+	[METRIC_CHAR_MEMORY] = { "ess_char_memory_bytes", "gauge",
+		"Memory held by a characteristic instance" },
+	[METRIC_CONN_MEMORY] = { "ess_connection_memory_bytes", "gauge",
+		"Memory held by a connection, its ATT and GATT objects included" },
+	[METRIC_DAMPED] = { "ess_notifications_damped_total", "counter",
+		"Samples the trigger fired on held back by the damping" },
+	[METRIC_REPLACED] = { "ess_notifications_replaced_total", "counter",
+		"Queued notifications replaced by a newer value or dropped" },
+	[METRIC_CONN_PENDING] = { "ess_connection_pending_notifications",
+		"gauge", "Notifications a connection holds back for its budget" },
+};
+
+static int metrics_fd = -1;
+static char *metrics_path = NULL;
+static metrics_collect_func_t metrics_collect = NULL;
+
+/* indexed by ATT opcode, only opcodes that were seen are exported */
+static struct metrics_hist att_latency[256];
+
+void metrics_observe(struct metrics_hist *hist, uint64_t value)
+{
+	unsigned int i = 0;
+
+	while (i < METRICS_BUCKETS - 1 && value >= (1ull << (i + 8)))
+		i++;
+
+	__atomic_store_n(&hist->bucket[i], hist->bucket[i] + 1,
+							__ATOMIC_RELAXED);
+	__atomic_store_n(&hist->sum, hist->sum + value, __ATOMIC_RELAXED);
+	__atomic_store_n(&hist->count, hist->count + 1, __ATOMIC_RELAXED);
+}
+
+void metrics_att_observe(uint8_t opcode, uint64_t elapsed)
+{
+	metrics_observe(&att_latency[opcode], elapsed);
+}
+
+static void buf_append(struct metrics_buf *buf, const void *data, size_t len)
+{
+	if (buf->failed)
+		return;
+
+	if (buf->len + len > buf->size) {
+#ifdef ESS_STATIC
+		buf->failed = true;
+		return;
+#else
+		size_t size = buf->size ? buf->size : 4096;
+		uint8_t *tmp;
+
+		while (size < buf->len + len)
+			size *= 2;
+
+		tmp = realloc(buf->data, size);
+		if (!tmp) {
+			buf->failed = true;
+			return;
+		}
+
+		ess_mem_charge(ESS_MEM_METRICS, size - buf->size);
+		buf->data = tmp;
+		buf->size = size;
+#endif
+	}
+
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
+
+static void buf_printf(struct metrics_buf *buf, const char *format, ...)
+{
+	char str[512];
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(str, sizeof(str), format, ap);
+	va_end(ap);
+
+	if (len < 0 || (size_t) len >= sizeof(str)) {
+		buf->failed = true;
+		return;
+	}
+
+	buf_append(buf, str, len);
+}
+
+static void buf_record(struct metrics_buf *buf, enum metrics_id id,
+				uint8_t sub, uint16_t key, uint64_t value)
+{
+	uint8_t rec[12];
+
+	rec[0] = id;
+	rec[1] = sub;
+	put_le16(key, &rec[2]);
+	put_le64(value, &rec[4]);
+
+	buf_append(buf, rec, sizeof(rec));
+}
+
+static void buf_describe(struct metrics_buf *buf, enum metrics_id id)
+{
+	if (buf->described[id])
+		return;
+
+	buf->described[id] = true;
+
+	buf_printf(buf, "# HELP %s %s\n# TYPE %s %s\n",
+				metrics_desc[id].name, metrics_desc[id].help,
+				metrics_desc[id].name, metrics_desc[id].type);
+}
+
+void metrics_put(struct metrics_buf *buf, enum metrics_id id, uint16_t key,
+					const char *labels, uint64_t value)
+{
+	if (buf->binary) {
+		buf_record(buf, id, 0, key, value);
+		return;
+	}
+
+	buf_describe(buf, id);
+
+	if (labels && *labels)
+		buf_printf(buf, "%s{%s} %llu\n", metrics_desc[id].name, labels,
+						(unsigned long long) value);
+	else
+		buf_printf(buf, "%s %llu\n", metrics_desc[id].name,
+						(unsigned long long) value);
+}
+
+void metrics_put_hist(struct metrics_buf *buf, enum metrics_id id,
+					uint16_t key, const char *labels,
+					const struct metrics_hist *hist)
+{
+	const char *name = metrics_desc[id].name;
+	const char *sep = labels && *labels ? "," : "";
+	uint64_t total = 0;
+	unsigned int i;
+
+	if (!labels)
+		labels = "";
+
+	if (buf->binary) {
+		for (i = 0; i < METRICS_BUCKETS; i++)
+			buf_record(buf, id, i, key, hist->bucket[i]);
+
+		buf_record(buf, id, 0xfe, key, hist->sum);
+		buf_record(buf, id, 0xff, key, hist->count);
+		return;
+	}
+
+	buf_describe(buf, id);
+
+	for (i = 0; i < METRICS_BUCKETS - 1; i++) {
+		total += hist->bucket[i];
+		buf_printf(buf, "%s_bucket{%s%sle=\"%llu\"} %llu\n", name,
+					labels, sep, 1ull << (i + 8),
+					(unsigned long long) total);
+	}
+
+	buf_printf(buf, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep,
+					(unsigned long long) hist->count);
+	buf_printf(buf, "%s_sum{%s} %llu\n", name, labels,
+					(unsigned long long) hist->sum);
+	buf_printf(buf, "%s_count{%s} %llu\n", name, labels,
+					(unsigned long long) hist->count);
+}
+
+/* A measured src/shared figure may come out slightly below zero */
+
+static void put_mem(struct metrics_buf *buf, enum metrics_id id,
+					enum ess_mem_sub sub, int64_t bytes)
+{
+	char labels[32];
+
+	snprintf(labels, sizeof(labels), "subsystem=\"%s\"",
+							ess_mem_sub_str(sub));
+	metrics_put(buf, id, sub, labels, bytes > 0 ? bytes : 0);
+}
+
+static void collect(struct metrics_buf *buf)
+{
+	unsigned int opcode;
+	enum ess_mem_sub sub;
+
+	if (buf->binary) {
+		uint8_t hdr[5] = { 'E', 'S', 'S', 'M', METRICS_BINARY_VERSION };
+
+		buf_append(buf, hdr, sizeof(hdr));
+	}
+
+	if (metrics_collect)
+		metrics_collect(buf);
+
+	for (opcode = 0; opcode < 256; opcode++) {
+		char labels[32];
+
+		if (!att_latency[opcode].count)
+			continue;
+
+		snprintf(labels, sizeof(labels), "opcode=\"0x%02x\"", opcode);
+		metrics_put_hist(buf, METRIC_ATT_LATENCY, opcode, labels,
+							&att_latency[opcode]);
+	}
+
+	if (!ess_mem_enabled)
+		return;
+
+	for (sub = 0; sub < ESS_MEM_MAX; sub++)
+		put_mem(buf, METRIC_MEMORY, sub, ess_mem_stat(sub)->bytes);
+
+	for (sub = 0; sub < ESS_MEM_MAX; sub++)
+		put_mem(buf, METRIC_MEMORY_PEAK, sub, ess_mem_stat(sub)->peak);
+}
+
+static void client_destroy(void *user_data)
+{
+	struct metrics_client *client = user_data;
+
+	close(client->fd);
+#ifndef ESS_STATIC
+	ess_mem_charge(ESS_MEM_METRICS, -(int64_t) client->buf.size);
+	free(client->buf.data);
+#endif
+	ess_arena_free(&client_arena, client);
+}
+
+/*
+*   A client gets one answer per connection. The answer is built when the  *
+*   request arrives and written as the socket drains, a slow reader never  *
+*   blocks the mainloop.                                                   *
+*/
+
+static void client_callback(int fd, uint32_t events, void *user_data)
+{
+	struct metrics_client *client = user_data;
+	ssize_t n;
+
+	if (events & (EPOLLERR | EPOLLHUP)) {
+		mainloop_remove_fd(fd);
+		return;
+	}
+
+	if (!client->requested) {
+		char cmd[16];
+
+		n = read(fd, cmd, sizeof(cmd) - 1);
+		if (n <= 0) {
+			if (n < 0 && errno == EAGAIN)
+				return;
+
+			mainloop_remove_fd(fd);
+			return;
+		}
+
+		cmd[n] = '\0';
+		client->requested = true;
+		client->buf.binary = !strncmp(cmd, "binary", 6);
+
+		collect(&client->buf);
+
+		if (client->buf.failed || !client->buf.len) {
+			mainloop_remove_fd(fd);
+			return;
+		}
+
+		mainloop_modify_fd(fd, EPOLLOUT);
+	}
+
+	n = send(fd, client->buf.data + client->sent,
+				client->buf.len - client->sent,
+				MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (n < 0) {
+		if (errno != EAGAIN)
+			mainloop_remove_fd(fd);
+		return;
+	}
+
+	client->sent += n;
+
+	if (client->sent == client->buf.len)
+		mainloop_remove_fd(fd);
+}
+
+static void metrics_accept(int fd, uint32_t events, void *user_data)
+{
+	struct metrics_client *client;
+	int new_fd;
+
+	new_fd = accept4(fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (new_fd < 0)
+		return;
+
+	client = ess_arena_new(&client_arena);
+	if (!client) {
+		close(new_fd);
+		return;
+	}
+
+	client->fd = new_fd;
+#ifdef ESS_STATIC
+	client->buf.data = client->data;
+	client->buf.size = sizeof(client->data);
+#endif
+
+	if (mainloop_add_fd(new_fd, EPOLLIN, client_callback, client,
+						client_destroy) < 0)
+		client_destroy(client);
+}
+
+bool metrics_start(const char *path, metrics_collect_func_t collect_func)
+{
+	struct sockaddr_un addr;
+
+	if (metrics_fd >= 0)
+		return true;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		ess_error("Metrics socket path too long\n");
+		return false;
+	}
+
+	metrics_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+									0);
+	if (metrics_fd < 0) {
+		ess_error("Failed to create metrics socket: %m\n");
+		return false;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	unlink(path);
+
+	if (bind(metrics_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+						listen(metrics_fd, 5) < 0) {
+		ess_error("Failed to listen on %s: %m\n", path);
+		close(metrics_fd);
+		metrics_fd = -1;
+		return false;
+	}
+
+	metrics_path = strdup(path);
+	metrics_collect = collect_func;
+
+	mainloop_add_fd(metrics_fd, EPOLLIN, metrics_accept, NULL, NULL);
+
+	return true;
+}
+
+/* The path is left alone once a new process of a live upgrade owns it */
+
+void metrics_stop(bool unlink_path)
+{
+	if (metrics_fd < 0)
+		return;
+
+	mainloop_remove_fd(metrics_fd);
+	close(metrics_fd);
+	metrics_fd = -1;
+
+	if (metrics_path && unlink_path)
+		unlink(metrics_path);
+
+	free(metrics_path);
+	metrics_path = NULL;
+	metrics_collect = NULL;
+}
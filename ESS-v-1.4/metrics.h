@@ -0,0 +1,119 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*
+ * Counters and histograms are only ever written from the mainloop thread,
+ * so an update is a plain relaxed load and store of one word: no lock, no
+ * atomic read-modify-write, and a scrape running on the same loop always
+ * sees whole values.
+ */
+
+#define METRICS_BUCKETS 24
+
+/*
+ * A client connects to the metrics socket and writes "text" or "binary".
+ * "text" answers in the Prometheus exposition format. "binary" answers
+ * with the magic "ESSM", a version octet and then 12 octet little endian
+ * records { u8 metric, u8 sub, u16 key, u64 value }. The key is the value
+ * handle for characteristic metrics, the connection index for connection
+ * metrics, the opcode for ATT latency and the enum ess_mem_sub for memory
+ * metrics. For histograms sub is the bucket
+ * index, 0xfe the sum and 0xff the count; it is 0 otherwise.
+ */
+
+#define METRICS_BINARY_VERSION 1
+
+/* Metric ids, also used as the "metric" field of the binary format */
+
+enum metrics_id {
+	METRIC_READS,
+	METRIC_WRITES,
+	METRIC_NOTIFICATIONS,
+	METRIC_SUPPRESSED,
+	METRIC_SEND_FAILURES,
+	METRIC_CONNECTIONS,
+	METRIC_CONN_QUEUE,
+	METRIC_ATT_LATENCY,
+	/* one per pipeline stage, in the order of enum ess_stage */
+	METRIC_AGE_SCHED,
+	METRIC_AGE_TRIGGER,
+	METRIC_AGE_ENCODE,
+	METRIC_AGE_QUEUE,
+	METRIC_AGE_SEND,
+	METRIC_AGE_COMPLETE,
+	METRIC_CONN_ACCEPT,
+	METRIC_CONN_SETUP,
+	/* only with memory accounting enabled */
+	METRIC_MEMORY,
+	METRIC_MEMORY_PEAK,
+	METRIC_CHAR_MEMORY,
+	METRIC_CONN_MEMORY,
+	/* appended to keep the ids of the binary format */
+	METRIC_DAMPED,
+	METRIC_REPLACED,
+	METRIC_CONN_PENDING,
+	METRIC_MAX,
+};
+
+/* Histogram of nanosecond values, bucket i counts values below 2^(i + 8) */
+
+struct metrics_hist {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t bucket[METRICS_BUCKETS];
+};
+
+struct metrics_buf;
+
+typedef void (*metrics_collect_func_t)(struct metrics_buf *buf);
+
+static inline void metrics_inc(uint64_t *counter)
+{
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + 1,
+							__ATOMIC_RELAXED);
+}
+
+static inline uint64_t metrics_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void metrics_observe(struct metrics_hist *hist, uint64_t value);
+void metrics_att_observe(uint8_t opcode, uint64_t elapsed);
+
+void metrics_put(struct metrics_buf *buf, enum metrics_id id, uint16_t key,
+					const char *labels, uint64_t value);
+void metrics_put_hist(struct metrics_buf *buf, enum metrics_id id,
+					uint16_t key, const char *labels,
+					const struct metrics_hist *hist);
+
+bool metrics_start(const char *path, metrics_collect_func_t collect);
+void metrics_stop(bool unlink_path);
@@ -0,0 +1,840 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "lib/bluetooth.h"
+#include "lib/uuid.h"
+#include "src/shared/util.h"
+#include "src/shared/queue.h"
+#include "src/shared/att.h"
+#include "src/shared/gatt-db.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/profile.h"
+#include "peripheral/ESS/sim.h"
+#include "peripheral/ESS/trigger.h"
+#include "peripheral/ESS/state.h"
+
+/*
+*   Microbenchmarks of the per sample hot paths: trigger evaluation for   *
+*   every value condition on every characteristic width, combined trigger *
+*   settings, value encoding and the read callback of every attribute of  *
+*   the service. Each loop reports ns/op and, when perf_event_open is     *
+*   allowed, the user space instructions retired per op.                  *
+*/
+
+/* pre-generated samples, a power of two so the index is a mask */
+#define SAMPLES 1024
+
+#define COND_FIRST 0x02
+#define COND_LAST 0x09
+
+struct measure {
+	struct timespec start;
+	uint64_t insns;
+};
+
+struct result {
+	double ns;
+	double insns;
+};
+
+static unsigned long iterations = 1000000;
+static int perf_fd = -1;
+
+static int32_t samples[SAMPLES][ESS_MAX_AXES];
+
+/* results are summed here so the loops cannot be optimized away */
+static volatile unsigned long sink;
+
+static void perf_init(void)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	perf_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if (perf_fd < 0)
+		fprintf(stderr, "No instruction counter (%m), "
+					"reporting time only\n");
+}
+
+static void measure_start(struct measure *m)
+{
+	if (perf_fd >= 0) {
+		ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &m->start);
+}
+
+static void measure_stop(struct measure *m, unsigned long ops,
+							struct result *res)
+{
+	struct timespec end;
+	uint64_t insns = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (perf_fd >= 0) {
+		ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+		if (read(perf_fd, &insns, sizeof(insns)) != sizeof(insns))
+			insns = 0;
+	}
+
+	res->ns = ((end.tv_sec - m->start.tv_sec) * 1e9 +
+				(end.tv_nsec - m->start.tv_nsec)) / ops;
+	res->insns = perf_fd >= 0 ? (double) insns / ops : -1.0;
+}
+
+static void print_result(const struct result *res)
+{
+	if (res->insns < 0)
+		printf(" %7.1f      ", res->ns);
+	else
+		printf(" %7.1f (%4.0f)", res->ns, res->insns);
+}
+
+/* Samples spread over the valid range, the operand sits in the middle */
+
+static void fill_samples(struct ess_char *chr)
+{
+	struct ess_rng rng;
+	int i, j;
+
+	ess_rng_init(&rng, chr->type->uuid, chr->instance);
+
+	for (i = 0; i < SAMPLES; i++)
+		for (j = 0; j < chr->type->axes; j++)
+			samples[i][j] = ess_rng_range(&rng, chr->lower,
+								chr->upper);
+
+	for (j = 0; j < chr->type->axes; j++)
+		ess_state.threshold[j][chr->id] = chr->lower +
+				((int64_t) chr->upper - chr->lower) / 2;
+}
+
+static void bench_trigger(void *data, void *user_data)
+{
+	struct ess_char *chr = data;
+	uint8_t condition;
+
+	fill_samples(chr);
+
+	printf("%-26s %3u %4u", chr->type->name, chr->type->len,
+							chr->type->axes);
+
+	for (condition = COND_FIRST; condition <= COND_LAST; condition++) {
+		struct measure m;
+		struct result res;
+		unsigned long n, fired = 0;
+
+		ess_state.condition[chr->id] = condition;
+		ess_trigger_setup(chr);
+
+		measure_start(&m);
+
+		for (n = 0; n < iterations; n++)
+			fired += ess_trigger_check(chr,
+						samples[n & (SAMPLES - 1)]);
+
+		measure_stop(&m, iterations, &res);
+
+		sink += fired;
+		print_result(&res);
+	}
+
+	printf("\n");
+}
+
+/* Greater than the middle, less than a quarter and any change */
+
+static const uint8_t combo_conditions[ESS_MAX_TRIGGERS] = {
+	0x06, 0x04, 0x03
+};
+
+static void bench_combo(struct ess_char *chr)
+{
+	struct ess_trigger_setting settings[ESS_MAX_TRIGGERS];
+	struct ess_trigger_combo combo;
+	unsigned int num, k;
+	int j;
+
+	fill_samples(chr);
+
+	memset(settings, 0, sizeof(settings));
+	for (k = 0; k < ESS_MAX_TRIGGERS; k++) {
+		settings[k].condition = combo_conditions[k];
+		for (j = 0; j < chr->type->axes; j++)
+			settings[k].threshold[j] = chr->lower +
+				((int64_t) chr->upper - chr->lower) / (k + 2);
+	}
+
+	for (num = 1; num <= ESS_MAX_TRIGGERS; num++) {
+		uint8_t config;
+
+		printf("%8u", num);
+
+		/* in the order of the ES Configuration values */
+		for (config = ESS_CONFIG_AND; config <= ESS_CONFIG_OR;
+								config++) {
+			struct measure m;
+			struct result res;
+			unsigned long n, fired = 0;
+
+			ess_trigger_combine(&combo, settings, num, config,
+							chr->type->axes);
+			ess_trigger_arm(&combo, samples[0], 0);
+
+			measure_start(&m);
+
+			for (n = 0; n < iterations; n++)
+				fired += ess_trigger_eval(&combo,
+						samples[n & (SAMPLES - 1)],
+						chr->type->axes, n);
+
+			measure_stop(&m, iterations, &res);
+
+			sink += fired;
+			print_result(&res);
+		}
+
+		printf("\n");
+	}
+}
+
+static void bench_encode(void *data, void *user_data)
+{
+	struct ess_char *chr = data;
+	uint8_t pdu[4 * ESS_MAX_AXES];
+	int32_t value[ESS_MAX_AXES];
+	struct measure m;
+	struct result res;
+	unsigned long n, sum = 0;
+
+	fill_samples(chr);
+
+	printf("%-26s %3u %4u", chr->type->name, chr->type->len,
+							chr->type->axes);
+
+	measure_start(&m);
+
+	for (n = 0; n < iterations; n++)
+		sum += ess_value_encode(chr->type, samples[n & (SAMPLES - 1)],
+									pdu);
+
+	measure_stop(&m, iterations, &res);
+	print_result(&res);
+
+	measure_start(&m);
+
+	for (n = 0; n < iterations; n++) {
+		ess_value_decode(chr->type, pdu, value);
+		sum += value[0];
+	}
+
+	measure_stop(&m, iterations, &res);
+	print_result(&res);
+
+	sink += sum;
+	printf("\n");
+}
+
+/*
+*   Read callbacks are driven through gatt_db_attribute_read(), the way   *
+*   bt_gatt_server calls them, on the first instance of the default       *
+*   profile. Every attribute type of a characteristic is read once.       *
+*/
+
+struct read_target {
+	const char *name;
+	uint16_t uuid;
+	struct gatt_db_attribute *attrib;
+};
+
+static struct read_target read_targets[] = {
+	{ "value",              0x0000 },
+	{ "measurement",        0x290c },
+	{ "trigger setting",    0x290d },
+	{ "valid range",        0x2906 },
+	{ "user description",   0x2901 },
+	{ "ccc",                0x2902 },
+	{ "es configuration",   0x290b },
+};
+
+static void read_cb(struct gatt_db_attribute *attrib, int err,
+			const uint8_t *value, size_t length, void *user_data)
+{
+	sink += err ? 0 : length;
+}
+
+static void desc_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	const bt_uuid_t *uuid = gatt_db_attribute_get_type(attrib);
+	unsigned int i;
+
+	if (uuid->type != BT_UUID16)
+		return;
+
+	for (i = 1; i < NELEM(read_targets); i++) {
+		if (read_targets[i].uuid == uuid->value.u16 &&
+						!read_targets[i].attrib)
+			read_targets[i].attrib = attrib;
+	}
+}
+
+static void char_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	struct gatt_db *db = user_data;
+	uint16_t value_handle;
+
+	if (!read_targets[0].attrib &&
+		gatt_db_attribute_get_char_data(attrib, NULL, &value_handle,
+							NULL, NULL))
+		read_targets[0].attrib = gatt_db_get_attribute(db,
+								value_handle);
+
+	gatt_db_service_foreach_desc(attrib, desc_cb, NULL);
+}
+
+static void service_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	gatt_db_service_foreach_char(attrib, char_cb, user_data);
+}
+
+static void bench_reads(struct gatt_db *db)
+{
+	bt_uuid_t uuid;
+	unsigned int i;
+
+	bt_uuid16_create(&uuid, 0x181a);
+	gatt_db_foreach_service(db, &uuid, service_cb, db);
+
+	for (i = 0; i < NELEM(read_targets); i++) {
+		struct read_target *target = &read_targets[i];
+		struct measure m;
+		struct result res;
+		unsigned long n;
+
+		if (!target->attrib)
+			continue;
+
+		printf("%-35s", target->name);
+
+		measure_start(&m);
+
+		for (n = 0; n < iterations; n++)
+			gatt_db_attribute_read(target->attrib, 0,
+						BT_ATT_OP_READ_REQ, NULL,
+						read_cb, NULL);
+
+		measure_stop(&m, iterations, &res);
+		print_result(&res);
+		printf("\n");
+	}
+}
+
+/*
+*   Batch trigger evaluation: N instances cycling through every type and   *
+*   every value condition, the samples of one tick in struct ess_state.    *
+*   The per instance check the tick used to do is compared with the scalar *
+*   and the vector batch, whose masks have to agree with it.               *
+*/
+
+#define BATCH_TYPES 32
+
+static const struct ess_char_type *batch_types[BATCH_TYPES];
+static unsigned int batch_num_types;
+
+static void collect_type(void *data, void *user_data)
+{
+	struct ess_char *chr = data;
+
+	if (batch_num_types < BATCH_TYPES)
+		batch_types[batch_num_types++] = chr->type;
+}
+
+static bool bench_batch(unsigned int num)
+{
+	struct ess_char **chrs;
+	int32_t (*vals)[ESS_MAX_AXES];
+	uint64_t *ref, *mask;
+	unsigned int i, j, words, rounds;
+	struct measure m;
+	struct result res;
+	struct ess_rng rng;
+	bool ok = true;
+
+	chrs = calloc(num, sizeof(*chrs));
+	vals = calloc(num, sizeof(*vals));
+	if (!chrs || !vals) {
+		free(chrs);
+		free(vals);
+		return false;
+	}
+
+	ess_rng_init(&rng, 0x181a, num);
+
+	for (i = 0; i < num; i++) {
+		struct ess_char *chr;
+
+		chr = ess_char_new(batch_types[i % batch_num_types]);
+		if (!chr) {
+			ok = false;
+			goto done;
+		}
+
+		chrs[i] = chr;
+
+		ess_state.condition[chr->id] = COND_FIRST +
+					i % (COND_LAST - COND_FIRST + 1);
+		ess_trigger_setup(chr);
+
+		for (j = 0; j < chr->type->axes; j++) {
+			vals[i][j] = ess_rng_range(&rng, chr->lower,
+								chr->upper);
+			ess_state.sample[j][chr->id] = vals[i][j];
+			ess_state.threshold[j][chr->id] = ess_rng_range(&rng,
+						chr->lower, chr->upper);
+			ess_state.value[j][chr->id] = ess_rng_range(&rng,
+						chr->lower, chr->upper);
+		}
+	}
+
+	words = (ess_state.len + 63) / 64;
+	ref = calloc(words, sizeof(uint64_t));
+	mask = calloc(words, sizeof(uint64_t));
+	if (!ref || !mask) {
+		ok = false;
+		goto free_masks;
+	}
+
+	rounds = iterations / num ? iterations / num : 1;
+
+	printf("%9u", num);
+
+	measure_start(&m);
+
+	for (j = 0; j < rounds; j++) {
+		memset(ref, 0, words * sizeof(uint64_t));
+
+		for (i = 0; i < num; i++)
+			if (ess_trigger_check(chrs[i], vals[i]))
+				ref[chrs[i]->id / 64] |= 1ull <<
+							(chrs[i]->id % 64);
+	}
+
+	measure_stop(&m, (unsigned long) rounds * num, &res);
+	print_result(&res);
+
+	measure_start(&m);
+
+	for (j = 0; j < rounds; j++)
+		ess_trigger_batch_scalar(ess_state.len, mask);
+
+	measure_stop(&m, (unsigned long) rounds * num, &res);
+	print_result(&res);
+
+	ok = !memcmp(ref, mask, words * sizeof(uint64_t));
+
+	measure_start(&m);
+
+	for (j = 0; j < rounds; j++)
+		ess_trigger_batch(ess_state.len, mask);
+
+	measure_stop(&m, (unsigned long) rounds * num, &res);
+	print_result(&res);
+
+	ok = ok && !memcmp(ref, mask, words * sizeof(uint64_t));
+
+	printf("%s\n", ok ? "" : "  MISMATCH");
+
+	sink += mask[0];
+
+free_masks:
+	free(ref);
+	free(mask);
+
+done:
+	for (i = 0; i < num; i++)
+		if (chrs[i])
+			ess_char_free(chrs[i]);
+
+	free(chrs);
+	free(vals);
+
+	return ok;
+}
+
+/*
+*   Request handling as the database grows: a profile of N temperature    *
+*   instances, the value of the first, middle and last one. "lookup" is   *
+*   the handle to attribute lookup bt_gatt_server does for every request, *
+*   "read" adds the read callback and "attr" is the handle to instance    *
+*   resolution of gatt_server_attr().                                     *
+*/
+
+static const unsigned int db_sizes[] = { 16, 128, 512 };
+
+static bool write_profile(char *path, const char *profile)
+{
+	FILE *fp;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		return false;
+
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(path);
+		return false;
+	}
+
+	fputs(profile, fp);
+	fclose(fp);
+
+	return true;
+}
+
+static void bench_handle(struct gatt_db *db, const char *name,
+							uint16_t handle)
+{
+	struct gatt_db_attribute *attrib;
+	struct measure m;
+	struct result res;
+	unsigned long n, sum = 0;
+
+	printf("%9s %-6s 0x%04x", "", name, handle);
+
+	measure_start(&m);
+
+	for (n = 0; n < iterations; n++)
+		sum += !!gatt_db_get_attribute(db, handle);
+
+	measure_stop(&m, iterations, &res);
+	print_result(&res);
+
+	measure_start(&m);
+
+	for (n = 0; n < iterations; n++) {
+		attrib = gatt_db_get_attribute(db, handle);
+		gatt_db_attribute_read(attrib, 0, BT_ATT_OP_READ_REQ, NULL,
+								read_cb, NULL);
+	}
+
+	measure_stop(&m, iterations, &res);
+	print_result(&res);
+
+	measure_start(&m);
+
+	for (n = 0; n < iterations; n++)
+		sum += !!gatt_server_attr(handle);
+
+	measure_stop(&m, iterations, &res);
+	print_result(&res);
+
+	sink += sum;
+	printf("\n");
+}
+
+static bool bench_db_size(unsigned int instances)
+{
+	char path[] = "/tmp/ess-microbench-XXXXXX";
+	char profile[64];
+	uint16_t first = 0, last = 0, mid = 0;
+	unsigned int handle, num = 0;
+	struct gatt_db *db;
+
+	snprintf(profile, sizeof(profile), "[temperature]\nInstances = %u\n",
+								instances);
+
+	if (!write_profile(path, profile))
+		return false;
+
+	gatt_set_profile(path);
+	db = gatt_server_get_db();
+	gatt_set_profile(NULL);
+	unlink(path);
+
+	if (!db)
+		return false;
+
+	for (handle = 1; handle <= UINT16_MAX; handle++) {
+		const struct ess_attr *attr = gatt_server_attr(handle);
+
+		if (!attr || attr->kind != ESS_ATTR_VALUE)
+			continue;
+
+		if (!first)
+			first = handle;
+
+		if (num++ == instances / 2)
+			mid = handle;
+
+		last = handle;
+	}
+
+	printf("%9u\n", instances);
+
+	bench_handle(db, "first", first);
+	bench_handle(db, "middle", mid);
+	bench_handle(db, "last", last);
+
+	gatt_server_stop();
+
+	return true;
+}
+
+/*
+*   ES Configuration written over the air to an instance triggering above *
+*   1000 and below 2000: with AND (0x00) only the samples from 1001 to    *
+*   1999 fire, with OR (0x01) every sample does.                          *
+*/
+
+static const struct {
+	int32_t sample;
+	bool all;
+	bool any;
+} config_checks[] = {
+	{  500, false, true },
+	{ 1500, true,  true },
+	{ 2500, false, true },
+};
+
+static void write_cb(struct gatt_db_attribute *attrib, int err,
+							void *user_data)
+{
+	int *result = user_data;
+
+	*result = err;
+}
+
+static bool check_config_value(struct gatt_db *db, uint16_t handle,
+					struct ess_char *chr, uint8_t config)
+{
+	struct gatt_db_attribute *attrib = gatt_db_get_attribute(db, handle);
+	int err = -1;
+	unsigned int i;
+
+	if (!attrib || !gatt_db_attribute_write(attrib, 0, &config, 1,
+					BT_ATT_OP_WRITE_REQ, NULL, write_cb,
+					&err) || err)
+		return false;
+
+	for (i = 0; i < NELEM(config_checks); i++) {
+		bool fire = config == ESS_CONFIG_AND ? config_checks[i].all :
+							config_checks[i].any;
+
+		if (ess_trigger_eval(&chr->combo, &config_checks[i].sample,
+						chr->type->axes, 0) != fire)
+			return false;
+	}
+
+	return true;
+}
+
+static bool check_config(void)
+{
+	char path[] = "/tmp/ess-microbench-XXXXXX";
+	uint16_t handle, config = 0;
+	struct ess_char *chr = NULL;
+	struct gatt_db *db;
+	bool ok;
+
+	if (!write_profile(path, "[temperature]\nTrigger = 0x06 1000\n"
+						"Trigger2 = 0x04 2000\n"))
+		return false;
+
+	gatt_set_profile(path);
+	db = gatt_server_get_db();
+	gatt_set_profile(NULL);
+	unlink(path);
+
+	if (!db)
+		return false;
+
+	for (handle = 1; handle < UINT16_MAX && !config; handle++) {
+		const struct ess_attr *attr = gatt_server_attr(handle);
+
+		if (attr && attr->kind == ESS_ATTR_CONFIG) {
+			config = handle;
+			chr = attr->chr;
+		}
+	}
+
+	ok = config && check_config_value(db, config, chr, ESS_CONFIG_AND) &&
+			check_config_value(db, config, chr, ESS_CONFIG_OR);
+
+	gatt_server_stop();
+
+	return ok;
+}
+
+static void usage(void)
+{
+	printf("ess-microbench - ESS hot path microbenchmarks\n"
+		"Usage:\n");
+	printf("\tess-microbench [options]\n");
+	printf("Options:\n"
+		"\t-n, --iterations <num> Calls per measurement "
+							"(default 1000000)\n"
+		"\t-h, --help             Show help options\n");
+}
+
+static const struct option main_options[] = {
+	{ "iterations", required_argument, NULL, 'n' },
+	{ "help",       no_argument,       NULL, 'h' },
+	{ }
+};
+
+int main(int argc, char *argv[])
+{
+	struct queue *chars;
+	struct ess_char *chr;
+	struct gatt_db *db;
+	uint8_t condition;
+	unsigned int i;
+	bool ok = true;
+
+	for (;;) {
+		int opt;
+
+		opt = getopt_long(argc, argv, "n:h", main_options, NULL);
+		if (opt < 0)
+			break;
+
+		switch (opt) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'h':
+			usage();
+			return EXIT_SUCCESS;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!iterations) {
+		fprintf(stderr, "Invalid iterations\n");
+		return EXIT_FAILURE;
+	}
+
+	/* one instance of every characteristic type */
+	chars = ess_profile_default();
+	if (!chars)
+		return EXIT_FAILURE;
+
+	perf_init();
+
+	printf("Trigger evaluation, ns/op (instructions/op)\n");
+	printf("%-26s len axes", "characteristic");
+	for (condition = COND_FIRST; condition <= COND_LAST; condition++)
+		printf("    0x%02x       ", condition);
+	printf("\n");
+
+	queue_foreach(chars, bench_trigger, NULL);
+
+	printf("\nValue codec, ns/op (instructions/op)\n");
+	printf("%-26s len axes  encode         decode\n",
+							"characteristic");
+
+	queue_foreach(chars, bench_encode, NULL);
+
+	chr = queue_peek_head(chars);
+
+	printf("\nCombined trigger settings of %s, ns/sample "
+				"(instructions/sample)\n", chr->type->name);
+	printf("%8s  0x00 (AND)     0x01 (OR)\n", "settings");
+
+	bench_combo(chr);
+
+	queue_foreach(chars, collect_type, NULL);
+	ess_profile_free(chars);
+
+	printf("\nBatch trigger evaluation, ns/instance (instructions/instance)\n");
+	printf("%9s  check          scalar         %-6s\n", "instances",
+						ess_trigger_batch_name());
+
+	ok = ok && bench_batch(64);
+	ok = ok && bench_batch(512);
+	ok = ok && bench_batch(4096);
+
+	db = gatt_server_get_db();
+	if (db) {
+		printf("\nRead callbacks, ns/op (instructions/op)\n");
+		bench_reads(db);
+		gatt_server_stop();
+	}
+
+	printf("\nRequest handling by database size, ns/op "
+						"(instructions/op)\n");
+	printf("%9s %-6s %-6s  lookup         read           attr\n",
+					"instances", "value", "handle");
+
+	for (i = 0; i < NELEM(db_sizes); i++) {
+		if (!bench_db_size(db_sizes[i])) {
+			fprintf(stderr, "Failed to set up %u instances\n",
+								db_sizes[i]);
+			ok = false;
+		}
+	}
+
+	printf("\nES Configuration written as 0x00 (AND) and 0x01 (OR): ");
+
+	if (check_config()) {
+		printf("ok\n");
+	} else {
+		printf("FAILED\n");
+		ok = false;
+	}
+
+	if (perf_fd >= 0)
+		close(perf_fd);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+#!/bin/sh
+#
+# Multi-central notification throughput on virtual controllers
+#
+# btvirt creates one LE controller for the ESS sample and one for every
+# central. Each round starts the sample on the first controller, connects
+# 1, 2, 4 ... up to MAX centrals running ess-bench --connect, lets them
+# subscribe to every characteristic and reports for the round:
+#
+#   delivered  notifications/sec summed over all centrals
+#   drops      notifications queued by the sample minus those received,
+#              plus those the ATT layer refused
+#   cpu        CPU time of the sample per queued notification
+#
+# Needs root, the vhci module and no other controller on the host, since
+# the virtual ones have to come up as hci0 ... hciMAX. Run it from the top
+# of the build tree or point BUILDDIR at it.
+#
+#   peripheral/ESS/multi-central.sh [max centrals] [seconds] [instances]
+#
+
+MAX=${1:-32}
+DURATION=${2:-10}
+INSTANCES=${3:-4}
+
+BUILDDIR=${BUILDDIR:-.}
+BTVIRT=$BUILDDIR/emulator/btvirt
+BTMGMT=$BUILDDIR/tools/btmgmt
+SAMPLE=$BUILDDIR/peripheral/ESS/sample
+BENCH=$BUILDDIR/peripheral/ESS/ess-bench
+
+TMP=$(mktemp -d /tmp/ess-multi-XXXXXX) || exit 1
+PROFILE=$TMP/profile.conf
+METRICS=$TMP/metrics
+
+cleanup() {
+	[ -n "$SAMPLE_PID" ] && kill $SAMPLE_PID 2>/dev/null
+	[ -n "$BTVIRT_PID" ] && kill $BTVIRT_PID 2>/dev/null
+	wait 2>/dev/null
+	rm -rf $TMP
+}
+
+trap cleanup EXIT INT TERM
+
+# Every notifying characteristic type, INSTANCES of each, every second
+# (the shortest interval a time trigger can express)
+for type in temperature apparent_wind_speed apparent_wind_direction \
+		dew_point elevation gust_factor heat_index humidity \
+		irradiance pollen_concentration rainfall pressure \
+		true_wind_direction true_wind_speed uv_index wind_chill \
+		magnetic_declination magnetic_flux_density_2d \
+		magnetic_flux_density_3d; do
+	printf "[%s]\nInstances = %u\nTrigger = 0x01 1\n\n" $type \
+						$INSTANCES >> $PROFILE
+done
+
+# Sum of one counter of the sample over all characteristics
+metric() {
+	printf text | socat - UNIX-CONNECT:$METRICS 2>/dev/null |
+		awk -v name="$1" 'index($1, name "{") == 1 { sum += $2 }
+					END { printf "%d\n", sum }'
+}
+
+# utime + stime of a process in clock ticks
+cputime() {
+	awk '{ print $14 + $15 }' /proc/$1/stat
+}
+
+$BTVIRT -L -l$((MAX + 1)) &
+BTVIRT_PID=$!
+
+for i in $(seq 50); do
+	[ -e /sys/class/bluetooth/hci$MAX ] && break
+	sleep 0.1
+done
+
+if [ ! -e /sys/class/bluetooth/hci$MAX ]; then
+	echo "Virtual controllers did not come up" >&2
+	exit 1
+fi
+
+for i in $(seq $MAX); do
+	$BTMGMT --index $i le on > /dev/null
+	$BTMGMT --index $i power on > /dev/null
+done
+
+TCK=$(getconf CLK_TCK)
+
+printf "%8s %14s %10s %10s %14s\n" centrals "delivered/s" sent drops \
+								"cpu/notif(us)"
+
+n=1
+while [ $n -le $MAX ]; do
+	$SAMPLE -i 0 -p $PROFILE -m $METRICS -l error &
+	SAMPLE_PID=$!
+
+	# wait for the sample to advertise
+	sleep 2
+
+	ADDR=$($BTMGMT --index 0 info | awk '/addr/ { print $2; exit }')
+	CPU_START=$(cputime $SAMPLE_PID)
+
+	PIDS=
+	for i in $(seq $n); do
+		$BENCH -c $ADDR -i $i -d $DURATION -r 0 -w 0 \
+					> $TMP/central.$i 2>&1 &
+		PIDS="$PIDS $!"
+	done
+
+	wait $PIDS
+	sleep 1
+
+	CPU=$(( $(cputime $SAMPLE_PID) - CPU_START ))
+	SENT=$(metric ess_notifications_total)
+	FAILED=$(metric ess_send_failures_total)
+
+	kill $SAMPLE_PID
+	wait $SAMPLE_PID 2>/dev/null
+	SAMPLE_PID=
+
+	cat $TMP/central.* | awk -v sent=$SENT -v failed=$FAILED \
+				-v cpu=$CPU -v tck=$TCK -v n=$n '
+		/^Notification rate:/ { rate += $3 }
+		/^Notifications received:/ { received += $3 }
+		END {
+			drops = sent - received + failed
+			if (drops < 0)
+				drops = 0
+			printf "%8d %14.1f %10d %10d %14.2f\n", n, rate, sent,
+				drops, sent ? cpu * 1000000 / tck / sent : 0
+		}'
+
+	rm -f $TMP/central.*
+	n=$((n * 2))
+done
@@ -0,0 +1,818 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "src/shared/util.h"
+#include "src/shared/queue.h"
+#include "peripheral/ESS/ess_uuid.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/state.h"
+#include "peripheral/ESS/trigger.h"
+#include "peripheral/ESS/profile.h"
+#include "peripheral/ESS/metrics.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
+
+/*
+*   Table of the characteristics of the build profile (ess_uuid.h), in     *
+*   the order they appear in the default profile.                         *
+*/
+
+#define ESS_TYPE_ENTRY(uuid, name, len, axes, is_signed, notify, desc, \
+				value, lower, upper, sample, period, \
+				interval, applicatn, uncertainity) \
+	{ uuid, name, len, axes, is_signed, notify, desc, value, lower, \
+		upper, sample, period, interval, applicatn, uncertainity },
+#define ESS_PROFILE_ENTRY(NAME) ESS_TYPE_##NAME(ESS_TYPE_ENTRY)
+
+static const struct ess_char_type ess_char_types[] = {
+	ESS_PROFILE(ESS_PROFILE_ENTRY)
+	{ }
+};
+
+const struct ess_char_type *ess_char_type_find(const char *name)
+{
+	const struct ess_char_type *type;
+
+	for (type = ess_char_types; type->name; type++) {
+		if (!strcasecmp(type->name, name))
+			return type;
+	}
+
+	return NULL;
+}
+
+/* The table is constant, any thread may look a type up */
+
+const struct ess_char_type *ess_char_type_get(uint16_t uuid)
+{
+	const struct ess_char_type *type;
+
+	for (type = ess_char_types; type->name; type++) {
+		if (type->uuid == uuid)
+			return type;
+	}
+
+	return NULL;
+}
+
+/* Longest value of the characteristics of the build profile */
+
+unsigned int ess_char_type_max_len(void)
+{
+	const struct ess_char_type *type;
+	unsigned int len = 0;
+
+	for (type = ess_char_types; type->name; type++) {
+		if (type->len * type->axes > len)
+			len = type->len * type->axes;
+	}
+
+	return len;
+}
+
+/* Trigger setting "index", the first one lives in struct ess_state */
+
+void ess_trigger_get(const struct ess_char *chr, unsigned int index,
+				struct ess_trigger_setting *setting)
+{
+	if (index) {
+		*setting = chr->triggers[index - 1];
+		return;
+	}
+
+	setting->condition = ess_state.condition[chr->id];
+	setting->interval = ess_state.interval[chr->id];
+	ess_state_get(ess_state.threshold, chr->id, setting->threshold);
+}
+
+void ess_trigger_set(struct ess_char *chr, unsigned int index,
+				const struct ess_trigger_setting *setting)
+{
+	if (index) {
+		chr->triggers[index - 1] = *setting;
+	} else {
+		ess_state.condition[chr->id] = setting->condition;
+		ess_state.interval[chr->id] = setting->interval;
+		ess_state_set(ess_state.threshold, chr->id,
+							setting->threshold);
+	}
+
+	ess_trigger_setup(chr);
+}
+
+/*
+ * Derive the time/value/inactive flags and the compiled value trigger from
+ * the trigger condition
+ */
+
+void ess_trigger_setup(struct ess_char *chr)
+{
+	uint8_t condition = ess_state.condition[chr->id];
+	uint8_t flags = ess_state.flags[chr->id];
+	uint8_t damped = 0;
+
+	flags &= ~(ESS_STATE_TIME | ESS_STATE_VALUE | ESS_STATE_INACTIVE |
+					ESS_STATE_SPACED | ESS_STATE_MULTI |
+					ESS_STATE_DAMPED);
+
+	/* the damping only applies to value triggers, from scratch */
+	if (chr->damping.hysteresis || chr->damping.deadband)
+		damped = ESS_STATE_DAMPED;
+
+	chr->damping.latched = false;
+
+	/* several settings are evaluated per instance on every tick */
+	if (chr->num_triggers > 1) {
+		struct ess_trigger_setting settings[ESS_MAX_TRIGGERS];
+		unsigned int k;
+
+		for (k = 0; k < chr->num_triggers; k++)
+			ess_trigger_get(chr, k, &settings[k]);
+
+		if (ess_trigger_combine(&chr->combo, settings,
+					chr->num_triggers, chr->es_config,
+					chr->type->axes))
+			flags |= ESS_STATE_VALUE | ESS_STATE_MULTI | damped;
+		else
+			flags |= ESS_STATE_INACTIVE;
+
+		ess_state.flags[chr->id] = flags;
+		ess_state.trigger[chr->id] = 0;
+		return;
+	}
+
+	/*
+	 * 0x02 notifies a changed value no more often than the interval: a
+	 * change trigger that is not sampled again before the interval has
+	 * passed since the last notification
+	 */
+	if (condition == 0x01)
+		flags |= ESS_STATE_TIME;
+	else if (condition == 0x02)
+		flags |= ESS_STATE_VALUE | ESS_STATE_SPACED | damped;
+	else if (condition >= 0x03 && condition <= 0x09)
+		flags |= ESS_STATE_VALUE | damped;
+	else
+		flags |= ESS_STATE_INACTIVE;
+
+	ess_state.flags[chr->id] = flags;
+	ess_state.trigger[chr->id] = ess_trigger_compile(condition,
+							chr->type->axes);
+}
+
+/*
+***  This function will allocate the memory and initialize all the initials values requiered   ***
+***  for one characteristic instance and its descriptors from the defaults of its type          ***
+*/
+
+ESS_ARENA(char_arena, struct ess_char, ESS_STATIC_CHARS, ESS_MEM_CHARS);
+ESS_ARENA(age_arena, struct metrics_hist[ESS_STAGE_MAX], ESS_STATIC_CHARS,
+								ESS_MEM_HISTORY);
+
+struct ess_char *ess_char_new(const struct ess_char_type *type)
+{
+	struct ess_char *chr;
+	int i;
+
+	chr = ess_arena_new(&char_arena);
+	if (!chr)
+		return NULL;
+
+	if (!ess_state_add(chr)) {
+		ess_arena_free(&char_arena, chr);
+		return NULL;
+	}
+
+	chr->type = type;
+
+	strncpy(chr->user_desc, type->user_desc, ESS_USER_DESC_LEN);
+	chr->lower = type->lower;
+	chr->upper = type->upper;
+
+	for (i = 0; i < type->axes; i++)
+		ess_state.value[i][chr->id] = type->value;
+
+	chr->ms.flags = 0;
+	chr->ms.sample = type->sample;
+	chr->ms.m_period[0] = type->period;
+	chr->ms.u_interval[0] = type->interval;
+	chr->ms.applicatn = type->applicatn;
+	chr->ms.m_uncertainity = type->m_uncertainity;
+
+	chr->es_config = ESS_CONFIG_OR;
+	chr->priority = ESS_SCHED_DEFAULT_PRIORITY;
+
+	if (type->notify) {
+		ess_state.condition[chr->id] = 0x01;
+		ess_state.interval[chr->id] = 60;
+		chr->num_triggers = 1;
+	}
+
+	ess_trigger_setup(chr);
+
+	chr->source.type = ESS_SOURCE_RANDOM;
+	chr->source.fd = -1;
+	chr->source.mul = 1;
+	chr->source.div = 1;
+
+	return chr;
+}
+
+/* Source paths are charged to the instances, see ess_char_mem() */
+
+static void set_source_path(struct ess_char *chr, char *path)
+{
+	if (ess_mem_enabled && chr->source.path)
+		ess_mem_charge(ESS_MEM_CHARS,
+				-(int64_t) (strlen(chr->source.path) + 1));
+
+	free(chr->source.path);
+	chr->source.path = path;
+
+	if (chr->source.fd >= 0) {
+		close(chr->source.fd);
+		chr->source.fd = -1;
+	}
+
+	if (ess_mem_enabled && path)
+		ess_mem_charge(ESS_MEM_CHARS, strlen(path) + 1);
+}
+
+void ess_char_free(void *data)
+{
+	struct ess_char *chr = data;
+
+	ess_state_remove(chr);
+
+	set_source_path(chr, NULL);
+	ess_arena_free(&age_arena, chr->age);
+	ess_arena_free(&char_arena, chr);
+}
+
+/* The age histograms of an instance, set up when it first samples */
+
+bool ess_char_age_new(struct ess_char *chr)
+{
+	chr->age = ess_arena_new(&age_arena);
+
+	return chr->age;
+}
+
+/* Memory held by one instance, its slot of struct ess_state included */
+
+size_t ess_char_mem(const struct ess_char *chr)
+{
+	size_t size = char_arena.size + ess_state_slot_size();
+
+	if (chr->age)
+		size += age_arena.size;
+
+	if (chr->source.path)
+		size += strlen(chr->source.path) + 1;
+
+	return size;
+}
+
+/* The default profile holds one instance of every characteristic type */
+
+struct queue *ess_profile_default(void)
+{
+	const struct ess_char_type *type;
+	struct queue *profile;
+
+	ess_heap_check();
+
+	profile = queue_new();
+
+	for (type = ess_char_types; type->name; type++) {
+		struct ess_char *chr = ess_char_new(type);
+
+		if (!chr || !queue_push_tail(profile, chr)) {
+			if (chr)
+				ess_char_free(chr);
+			ess_profile_free(profile);
+			return NULL;
+		}
+	}
+
+	return profile;
+}
+
+void ess_profile_free(struct queue *profile)
+{
+	queue_destroy(profile, ess_char_free);
+}
+
+static char *strip(char *str)
+{
+	char *end;
+
+	while (isspace((unsigned char) *str))
+		str++;
+
+	end = str + strlen(str);
+	while (end > str && isspace((unsigned char) end[-1]))
+		*--end = '\0';
+
+	return str;
+}
+
+/* Parse up to "max" whitespace separated integers, returns how many were found */
+
+static int parse_ints(const char *str, int32_t *val, int max)
+{
+	char *end;
+	int n;
+
+	for (n = 0; n < max; n++) {
+		long v;
+
+		while (isspace((unsigned char) *str))
+			str++;
+
+		if (*str == '\0')
+			break;
+
+		errno = 0;
+		v = strtol(str, &end, 0);
+		if (errno || end == str)
+			return -1;
+
+		val[n] = v;
+		str = end;
+	}
+
+	while (isspace((unsigned char) *str))
+		str++;
+
+	return *str == '\0' ? n : -1;
+}
+
+static bool parse_u24(const char *str, uint8_t out[3])
+{
+	int32_t val;
+
+	if (parse_ints(str, &val, 1) != 1 || val < 0 || val > 0xFFFFFF)
+		return false;
+
+	out[0] = val;
+	out[1] = val >> 8;
+	out[2] = val >> 16;
+
+	return true;
+}
+
+static bool parse_u8(const char *str, uint8_t *out)
+{
+	int32_t val;
+
+	if (parse_ints(str, &val, 1) != 1 || val < 0 || val > 0xFF)
+		return false;
+
+	*out = val;
+
+	return true;
+}
+
+/* "Trigger", "Trigger2" and "Trigger3", the later ones need the earlier */
+
+static bool parse_trigger(struct ess_char *chr, unsigned int index,
+							const char *str)
+{
+	struct ess_trigger_setting setting;
+	int32_t val[1 + ESS_MAX_AXES];
+	int axes = chr->type->axes;
+	int n, i;
+
+	if (index > chr->num_triggers)
+		return false;
+
+	n = parse_ints(str, val, 1 + ESS_MAX_AXES);
+	if (n < 1 || val[0] < 0x00 || val[0] > 0x09)
+		return false;
+
+	ess_trigger_get(chr, index, &setting);
+	setting.condition = val[0];
+
+	if (val[0] == 0x01 || val[0] == 0x02) {
+		if (n != 2 || val[1] <= 0 || val[1] > 0xFFFFFF)
+			return false;
+
+		setting.interval = val[1];
+	} else if (val[0] >= 0x04) {
+		if (n != 1 + axes)
+			return false;
+
+		for (i = 0; i < axes; i++)
+			setting.threshold[i] = val[1 + i];
+	} else if (n != 1)
+		return false;
+
+	/* more than one setting needs the ES Configuration descriptor */
+	if (index == chr->num_triggers) {
+		chr->num_triggers++;
+		chr->es_config_enable = true;
+	}
+
+	ess_trigger_set(chr, index, &setting);
+
+	return true;
+}
+
+static bool parse_source(struct ess_char *chr, const char *str)
+{
+	if (!strcasecmp(str, "random")) {
+		chr->source.type = ESS_SOURCE_RANDOM;
+		return true;
+	}
+
+	if (!strcasecmp(str, "constant")) {
+		chr->source.type = ESS_SOURCE_CONSTANT;
+		return true;
+	}
+
+	/* bounded random walk, at most "step" per sample */
+	if (!strncasecmp(str, "walk", 4) && isspace((unsigned char) str[4])) {
+		if (parse_ints(str + 4, &chr->source.step, 1) != 1 ||
+						chr->source.step <= 0)
+			return false;
+
+		chr->source.type = ESS_SOURCE_WALK;
+		return true;
+	}
+
+	/* daily cycle over the valid range, "step" of noise on top */
+	if (!strncasecmp(str, "diurnal", 7) && isspace((unsigned char) str[7])) {
+		if (parse_ints(str + 7, &chr->source.step, 1) != 1 ||
+						chr->source.step < 0)
+			return false;
+
+		chr->source.type = ESS_SOURCE_DIURNAL;
+		return true;
+	}
+
+	/* values handed over by the application, see publish.h */
+	if (!strcasecmp(str, "publish")) {
+		chr->source.type = ESS_SOURCE_PUBLISH;
+		return true;
+	}
+
+	if (!strncasecmp(str, "file:", 5) && str[5] != '\0') {
+		char *path = strdup(str + 5);
+
+		if (!path)
+			return false;
+
+		set_source_path(chr, path);
+
+		chr->source.type = ESS_SOURCE_FILE;
+		return true;
+	}
+
+	return false;
+}
+
+static bool parse_key(struct ess_char *chr, const char *key, const char *val)
+{
+	/* a value has up to ESS_MAX_AXES fields, ranges and scales two */
+	int32_t v[ESS_MAX_AXES > 2 ? ESS_MAX_AXES : 2];
+	int i;
+
+	if (!strcasecmp(key, "Description")) {
+		if (strlen(val) > ESS_USER_DESC_LEN)
+			return false;
+
+		memset(chr->user_desc, 0, sizeof(chr->user_desc));
+		strcpy(chr->user_desc, val);
+	} else if (!strcasecmp(key, "Value")) {
+		if (parse_ints(val, v, chr->type->axes) != chr->type->axes)
+			return false;
+
+		for (i = 0; i < chr->type->axes; i++)
+			ess_state.value[i][chr->id] = v[i];
+	} else if (!strcasecmp(key, "ValidRange")) {
+		if (parse_ints(val, v, 2) != 2 || v[0] > v[1])
+			return false;
+
+		chr->lower = v[0];
+		chr->upper = v[1];
+	} else if (!strcasecmp(key, "Sampling")) {
+		return parse_u8(val, &chr->ms.sample);
+	} else if (!strcasecmp(key, "MeasurementPeriod")) {
+		return parse_u24(val, chr->ms.m_period);
+	} else if (!strcasecmp(key, "UpdateInterval")) {
+		return parse_u24(val, chr->ms.u_interval);
+	} else if (!strcasecmp(key, "Application")) {
+		return parse_u8(val, &chr->ms.applicatn);
+	} else if (!strcasecmp(key, "Uncertainty")) {
+		return parse_u8(val, &chr->ms.m_uncertainity);
+	} else if (!strcasecmp(key, "Priority")) {
+		return parse_u8(val, &chr->priority) &&
+					chr->priority < ESS_SCHED_CLASSES;
+	} else if (!strcasecmp(key, "Trigger")) {
+		if (!chr->type->notify)
+			return false;
+
+		return parse_trigger(chr, 0, val);
+	} else if (!strcasecmp(key, "Trigger2") ||
+					!strcasecmp(key, "Trigger3")) {
+		if (!chr->type->notify)
+			return false;
+
+		return parse_trigger(chr, key[7] - '1', val);
+	} else if (!strcasecmp(key, "Source")) {
+		return parse_source(chr, val);
+	} else if (!strcasecmp(key, "Configuration")) {
+		if (!strcasecmp(val, "and") || !strcmp(val, "0"))
+			chr->es_config = ESS_CONFIG_AND;
+		else if (!strcasecmp(val, "or") || !strcmp(val, "1"))
+			chr->es_config = ESS_CONFIG_OR;
+		else
+			return false;
+
+		chr->es_config_enable = true;
+		ess_trigger_setup(chr);
+	} else if (!strcasecmp(key, "Hysteresis") ||
+					!strcasecmp(key, "DeadBand")) {
+		if (parse_ints(val, v, 1) != 1 || v[0] < 0)
+			return false;
+
+		if (key[0] == 'H' || key[0] == 'h')
+			chr->damping.hysteresis = v[0];
+		else
+			chr->damping.deadband = v[0];
+
+		ess_trigger_setup(chr);
+	} else if (!strcasecmp(key, "Scale")) {
+		if (parse_ints(val, v, 2) != 2 || v[1] == 0)
+			return false;
+
+		chr->source.mul = v[0];
+		chr->source.div = v[1];
+	} else {
+		ess_error("Unknown profile key %s ignored\n", key);
+	}
+
+	return true;
+}
+
+/* Copy fmt into buf replacing the first "%u" with the instance index */
+
+static bool format_index(const char *fmt, unsigned int index, char *buf,
+								size_t size)
+{
+	const char *pos = strstr(fmt, "%u");
+	int len;
+
+	if (!pos)
+		len = snprintf(buf, size, "%s", fmt);
+	else
+		len = snprintf(buf, size, "%.*s%u%s", (int) (pos - fmt), fmt,
+							index, pos + 2);
+
+	return len >= 0 && (size_t) len < size;
+}
+
+static bool set_instance_strings(struct ess_char *chr,
+					const struct ess_char *tmpl,
+					unsigned int index)
+{
+	char desc[ESS_USER_DESC_LEN + 1];
+	char *path = NULL;
+
+	if (!format_index(tmpl->user_desc, index, desc, sizeof(desc)))
+		return false;
+
+	if (tmpl->source.path) {
+		size_t size = strlen(tmpl->source.path) + 11;
+
+		path = malloc(size);
+		if (!path || !format_index(tmpl->source.path, index, path,
+									size)) {
+			free(path);
+			return false;
+		}
+	}
+
+	memset(chr->user_desc, 0, sizeof(chr->user_desc));
+	strcpy(chr->user_desc, desc);
+
+	set_source_path(chr, path);
+
+	return true;
+}
+
+/*
+*   Turn the last section into "count" instances. The copies share every   *
+*   setting of the section, only "%u" in Description and Source is         *
+*   replaced by the index of the copy (starting at 0).                      *
+*/
+
+static bool expand_instances(struct queue *profile, struct ess_char *tmpl,
+				unsigned int count, uint16_t *numbers)
+{
+	unsigned int i;
+
+	for (i = 1; i < count; i++) {
+		struct ess_char *chr = ess_arena_new(&char_arena);
+
+		if (!chr)
+			return false;
+
+		*chr = *tmpl;
+		chr->source.path = NULL;
+		chr->source.fd = -1;
+		chr->age = NULL;
+
+		if (!ess_state_add(chr)) {
+			ess_arena_free(&char_arena, chr);
+			return false;
+		}
+
+		ess_state_copy(chr->id, tmpl->id);
+		chr->instance = numbers[tmpl->type - ess_char_types]++;
+
+		if (!set_instance_strings(chr, tmpl, i) ||
+					!queue_push_tail(profile, chr)) {
+			ess_char_free(chr);
+			return false;
+		}
+	}
+
+	return set_instance_strings(tmpl, tmpl, 0);
+}
+
+/*
+*   Load a profile file. Every [section] names a characteristic type and   *
+*   adds one instance of it to the service, in file order. Keys inside a   *
+*   section override the defaults of that instance, e.g.                   *
+*                                                                          *
+*       [temperature]                                                      *
+*       Description = Outdoor                                              *
+*       ValidRange = -4000 6000                                            *
+*       Trigger = 1 30                                                     *
+*       Source = file:/sys/bus/iio/devices/iio:device0/in_temp_input       *
+*       Scale = 1 10                                                       *
+*                                                                          *
+*   "Instances = N" repeats a section N times, see expand_instances().     *
+*/
+
+struct queue *ess_profile_load(const char *path)
+{
+	struct queue *profile;
+	struct ess_char *chr = NULL;
+	uint16_t numbers[NELEM(ess_char_types)] = { 0 };
+	unsigned int instances = 1;
+	char line[256];
+	unsigned int lineno = 0;
+	FILE *fp;
+
+	/* loading allocates, it belongs to startup or a reload */
+	ess_heap_check();
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		ess_error("Failed to open profile %s: %m\n", path);
+		return NULL;
+	}
+
+	profile = queue_new();
+
+	while (fgets(line, sizeof(line), fp)) {
+		char *str, *val;
+
+		lineno++;
+
+		str = strpbrk(line, "#;");
+		if (str)
+			*str = '\0';
+
+		str = strip(line);
+		if (*str == '\0')
+			continue;
+
+		if (*str == '[') {
+			const struct ess_char_type *type;
+			char *end = strchr(str, ']');
+
+			if (!end || end[1] != '\0')
+				goto syntax;
+
+			*end = '\0';
+
+			if (chr && !expand_instances(profile, chr, instances,
+								numbers))
+				goto expand;
+
+			instances = 1;
+
+			type = ess_char_type_find(strip(str + 1));
+			if (!type) {
+				ess_error("%s:%u: unknown characteristic %s\n",
+						path, lineno, strip(str + 1));
+				goto fail;
+			}
+
+			chr = ess_char_new(type);
+			if (!chr || !queue_push_tail(profile, chr)) {
+				if (chr)
+					ess_char_free(chr);
+				goto fail;
+			}
+
+			chr->instance = numbers[type - ess_char_types]++;
+
+			continue;
+		}
+
+		val = strchr(str, '=');
+		if (!val || !chr)
+			goto syntax;
+
+		*val++ = '\0';
+
+		if (!strcasecmp(strip(str), "Instances")) {
+			int32_t n;
+
+			if (parse_ints(strip(val), &n, 1) != 1 || n < 1 ||
+						n > ESS_MAX_INSTANCES) {
+				ess_error("%s:%u: invalid value for %s\n",
+						path, lineno, strip(str));
+				goto fail;
+			}
+
+			instances = n;
+			continue;
+		}
+
+		if (!parse_key(chr, strip(str), strip(val))) {
+			ess_error("%s:%u: invalid value for %s\n",
+						path, lineno, strip(str));
+			goto fail;
+		}
+	}
+
+	fclose(fp);
+
+	if (chr && !expand_instances(profile, chr, instances, numbers)) {
+		ess_error("%s: failed to expand [%s]\n", path,
+							chr->type->name);
+		ess_profile_free(profile);
+		return NULL;
+	}
+
+	if (queue_isempty(profile)) {
+		ess_error("Profile %s has no characteristics\n", path);
+		ess_profile_free(profile);
+		return NULL;
+	}
+
+	return profile;
+
+syntax:
+	ess_error("%s:%u: syntax error\n", path, lineno);
+	goto fail;
+
+expand:
+	ess_error("%s:%u: failed to expand [%s]\n", path, lineno,
+							chr->type->name);
+
+fail:
+	fclose(fp);
+	ess_profile_free(profile);
+
+	return NULL;
+}
@@ -0,0 +1,45 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/* Upper bound for "Instances", the handle space runs out well before it */
+#define ESS_MAX_INSTANCES 4096
+
+struct queue;
+
+const struct ess_char_type *ess_char_type_find(const char *name);
+const struct ess_char_type *ess_char_type_get(uint16_t uuid);
+unsigned int ess_char_type_max_len(void);
+
+struct ess_char *ess_char_new(const struct ess_char_type *type);
+void ess_char_free(void *data);
+bool ess_char_age_new(struct ess_char *chr);
+size_t ess_char_mem(const struct ess_char *chr);
+void ess_trigger_setup(struct ess_char *chr);
+void ess_trigger_get(const struct ess_char *chr, unsigned int index,
+				struct ess_trigger_setting *setting);
+void ess_trigger_set(struct ess_char *chr, unsigned int index,
+				const struct ess_trigger_setting *setting);
+
+struct queue *ess_profile_default(void);
+struct queue *ess_profile_load(const char *path);
+void ess_profile_free(struct queue *profile);
@@ -0,0 +1,226 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "src/shared/mainloop.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/profile.h"
+#include "peripheral/ESS/publish.h"
+#include "peripheral/ESS/log.h"
+
+#define RING_MASK	(ESS_PUBLISH_RING - 1)
+
+#if ESS_PUBLISH_RING & RING_MASK
+#error "ESS_PUBLISH_RING must be a power of two"
+#endif
+
+/*
+ * Bounded multi producer, single consumer ring. Every slot carries a
+ * sequence number: a producer claims position pos with a compare and swap
+ * when the slot reads pos, fills it and releases it as pos + 1; the
+ * mainloop takes it once it reads pos + 1 and hands it back for the next
+ * lap as pos + ESS_PUBLISH_RING. Producers only contend on the claim.
+ */
+
+struct publish_slot {
+	uint64_t seq;
+	uint64_t timestamp;
+	uint16_t uuid;
+	uint16_t instance;
+	int32_t value[ESS_MAX_AXES];
+} __attribute__ ((aligned(64)));
+
+static struct publish_slot ring[ESS_PUBLISH_RING];
+static uint64_t ring_head __attribute__ ((aligned(64)));
+static uint64_t ring_tail __attribute__ ((aligned(64)));
+static uint64_t ring_dropped;
+static uint64_t ring_reported;
+
+/* Set by the producer that wakes the mainloop, cleared by the mainloop */
+static bool wake_pending;
+
+static int publish_fd = -1;
+
+static void publish_drain(void)
+{
+	struct publish_slot *slot;
+
+	while (1) {
+		slot = &ring[ring_tail & RING_MASK];
+
+		/* empty, or the producer of this slot is not done yet */
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) !=
+								ring_tail + 1)
+			break;
+
+		if (!gatt_server_publish(slot->uuid, slot->instance,
+					slot->value, slot->timestamp))
+			ess_debug("No publish instance %u of 0x%04x\n",
+						slot->instance, slot->uuid);
+
+		__atomic_store_n(&slot->seq, ring_tail + ESS_PUBLISH_RING,
+							__ATOMIC_RELEASE);
+		ring_tail++;
+	}
+}
+
+static void publish_callback(int fd, uint32_t events, void *user_data)
+{
+	uint64_t count, dropped;
+
+	if (read(fd, &count, sizeof(count)) < 0)
+		return;
+
+	/*
+	 * A producer that still finds the flag set has released its slot
+	 * before this exchange, it is drained below. Any later one wakes
+	 * the mainloop again.
+	 */
+	(void) __atomic_exchange_n(&wake_pending, false, __ATOMIC_ACQ_REL);
+
+	publish_drain();
+
+	dropped = __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+	if (dropped != ring_reported) {
+		ess_warn("%llu published values dropped, ring full\n",
+				(unsigned long long) (dropped - ring_reported));
+		ring_reported = dropped;
+	}
+}
+
+bool ess_publish_start(void)
+{
+	unsigned int i;
+	int fd;
+
+	if (publish_fd >= 0)
+		return true;
+
+	fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		ess_error("Failed to create publish eventfd: %m\n");
+		return false;
+	}
+
+	for (i = 0; i < ESS_PUBLISH_RING; i++)
+		ring[i].seq = i;
+
+	ring_head = 0;
+	ring_tail = 0;
+	wake_pending = false;
+
+	if (mainloop_add_fd(fd, EPOLLIN, publish_callback, NULL, NULL) < 0) {
+		close(fd);
+		return false;
+	}
+
+	__atomic_store_n(&publish_fd, fd, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/* Only once no thread publishes anymore, what is still queued is dropped */
+
+void ess_publish_stop(void)
+{
+	int fd = publish_fd;
+
+	if (fd < 0)
+		return;
+
+	__atomic_store_n(&publish_fd, -1, __ATOMIC_RELEASE);
+
+	mainloop_remove_fd(fd);
+	close(fd);
+}
+
+bool ess_publish(uint16_t uuid, uint16_t instance, const int32_t *value,
+							uint64_t timestamp)
+{
+	const struct ess_char_type *type;
+	struct publish_slot *slot;
+	uint64_t pos, one = 1;
+	int fd;
+
+	fd = __atomic_load_n(&publish_fd, __ATOMIC_ACQUIRE);
+	if (fd < 0)
+		return false;
+
+	type = ess_char_type_get(uuid);
+	if (!type)
+		return false;
+
+	pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+
+	while (1) {
+		uint64_t seq;
+		int64_t diff;
+
+		slot = &ring[pos & RING_MASK];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		diff = (int64_t) (seq - pos);
+
+		if (diff == 0) {
+			/* on failure pos is reloaded with the current head */
+			if (__atomic_compare_exchange_n(&ring_head, &pos,
+						pos + 1, true, __ATOMIC_RELAXED,
+						__ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0) {
+			/* the slot of the previous lap is not drained yet */
+			__atomic_fetch_add(&ring_dropped, 1, __ATOMIC_RELAXED);
+			return false;
+		} else {
+			pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+		}
+	}
+
+	slot->uuid = uuid;
+	slot->instance = instance;
+	slot->timestamp = timestamp;
+	memset(slot->value, 0, sizeof(slot->value));
+	memcpy(slot->value, value, type->axes * sizeof(*value));
+
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+	if (!__atomic_exchange_n(&wake_pending, true, __ATOMIC_ACQ_REL) &&
+				write(fd, &one, sizeof(one)) < 0)
+		__atomic_store_n(&wake_pending, false, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+uint64_t ess_publish_dropped(void)
+{
+	return __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+}
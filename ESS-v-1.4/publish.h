@@ -0,0 +1,60 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Values published by the application that embeds libess. The sample
+ * itself is main.c around the same objects; an application instead calls
+ * mainloop_init(), gap_start() (or gatt_server_start() on a controller it
+ * set up itself), ess_publish_start() and mainloop_run(), and feeds the
+ * instances whose profile Source is "publish" from its own threads.
+ *
+ * ess_publish() may be called from any thread once ess_publish_start()
+ * returned. It copies the value into a bounded lock-free ring and wakes
+ * the mainloop through an eventfd, at most once until the mainloop has
+ * drained the ring. It never blocks and never allocates. It fails when
+ * publishing is not started or the ring is full; a full ring means the
+ * mainloop is not keeping up and the value is dropped and counted.
+ *
+ * "uuid" is the characteristic UUID (e.g. 0x2a6e for temperature) and
+ * "instance" the instance number of the profile. "value" holds one field
+ * per axis in the units of the characteristic as sent over the air, e.g.
+ * 0.01 degrees Celsius for temperature. "timestamp" is when the value was
+ * measured on CLOCK_MONOTONIC in nanoseconds (the virtual clock in
+ * simulation), 0 stands for the time the mainloop picks the value up.
+ *
+ * Values of unknown instances, and of instances with another Source, are
+ * dropped on the mainloop. Values of the same instance are applied in the
+ * order they were published by a given thread; the next tick samples the
+ * latest.
+ */
+
+#define ESS_PUBLISH_RING	1024
+
+bool ess_publish_start(void);
+void ess_publish_stop(void);
+bool ess_publish(uint16_t uuid, uint16_t instance, const int32_t *value,
+							uint64_t timestamp);
+uint64_t ess_publish_dropped(void);
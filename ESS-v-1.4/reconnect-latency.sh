@@ -0,0 +1,108 @@
+#!/bin/sh
+#
+# Connect-to-first-notification latency on virtual controllers
+#
+# btvirt creates one LE controller for the ESS sample and one for the
+# gateway. ess-bench --reconnect connects COUNT times per mode and reports
+# p50/p99 of every phase the gateway sees: LE connection, MTU exchange,
+# discovery, CCC writes and first notification. The sample side of each
+# connection, the accept in att_conn_callback and the construction of the
+# connection in gatt_conn_new, comes from its metrics socket.
+#
+#   cold    full discovery on every connection
+#   cached  Database Hash read, discovery only when it changed
+#   bonded  encrypted with the keys of the first connection, attribute
+#           cache trusted without any read
+#
+# Secure Connections are turned off so Just Works pairing completes in the
+# kernel without an agent. Needs root, the vhci module and no other
+# controller on the host. Run it from the top of the build tree or point
+# BUILDDIR at it.
+#
+#   peripheral/ESS/reconnect-latency.sh [count]
+#
+
+COUNT=${1:-20}
+
+BUILDDIR=${BUILDDIR:-.}
+BTVIRT=$BUILDDIR/emulator/btvirt
+BTMGMT=$BUILDDIR/tools/btmgmt
+SAMPLE=$BUILDDIR/peripheral/ESS/sample
+BENCH=$BUILDDIR/peripheral/ESS/ess-bench
+
+TMP=$(mktemp -d /tmp/ess-reconnect-XXXXXX) || exit 1
+METRICS=$TMP/metrics
+
+cleanup() {
+	[ -n "$SAMPLE_PID" ] && kill $SAMPLE_PID 2>/dev/null
+	[ -n "$BTVIRT_PID" ] && kill $BTVIRT_PID 2>/dev/null
+	wait 2>/dev/null
+	rm -rf $TMP
+}
+
+trap cleanup EXIT INT TERM
+
+# Sum of one metric of the sample over all its series
+metric() {
+	printf text | socat - UNIX-CONNECT:$METRICS 2>/dev/null |
+		awk -v name="$1" 'index($1, name "{") == 1 { sum += $2 }
+					END { printf "%d\n", sum }'
+}
+
+$BTVIRT -L -l2 &
+BTVIRT_PID=$!
+
+for i in $(seq 50); do
+	[ -e /sys/class/bluetooth/hci1 ] && break
+	sleep 0.1
+done
+
+if [ ! -e /sys/class/bluetooth/hci1 ]; then
+	echo "Virtual controllers did not come up" >&2
+	exit 1
+fi
+
+for i in 0 1; do
+	$BTMGMT --index $i le on > /dev/null
+	$BTMGMT --index $i sc off > /dev/null
+	$BTMGMT --index $i bondable on > /dev/null
+	$BTMGMT --index $i io-cap 3 > /dev/null
+done
+
+$BTMGMT --index 1 power on > /dev/null
+
+$SAMPLE -i 0 -m $METRICS -l error &
+SAMPLE_PID=$!
+
+# wait for the sample to advertise
+sleep 2
+
+ADDR=$($BTMGMT --index 0 info | awk '/addr/ { print $2; exit }')
+
+for mode in cold cached bonded; do
+	ACCEPT_SUM=$(metric ess_conn_accept_nanoseconds_sum)
+	ACCEPT_COUNT=$(metric ess_conn_accept_nanoseconds_count)
+	SETUP_SUM=$(metric ess_conn_setup_nanoseconds_sum)
+
+	if ! $BENCH -c $ADDR -i 1 -R $COUNT -m $mode; then
+		echo "Reconnect benchmark failed ($mode)" >&2
+		exit 1
+	fi
+
+	ACCEPT_SUM=$(( $(metric ess_conn_accept_nanoseconds_sum) - ACCEPT_SUM ))
+	ACCEPT_COUNT=$(( $(metric ess_conn_accept_nanoseconds_count) - \
+								ACCEPT_COUNT ))
+	SETUP_SUM=$(( $(metric ess_conn_setup_nanoseconds_sum) - SETUP_SUM ))
+
+	# the means include the warm-up connection of the benchmark
+	awk -v accept=$ACCEPT_SUM -v setup=$SETUP_SUM -v n=$ACCEPT_COUNT '
+		BEGIN {
+			if (!n)
+				n = 1
+			printf "Sample side, mean (us):\n"
+			printf "  %-20s %8.1f\n", "accept", accept / n / 1000
+			printf "  %-20s %8.1f\n", "gatt_conn_new",
+							setup / n / 1000
+		}'
+	echo
+done
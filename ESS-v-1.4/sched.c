@@ -0,0 +1,159 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/sched.h"
+
+/*
+*** Weighted fair queueing. A notification finishes one cost per octet    ***
+*** after the later of the virtual time and the finish of the one queued  ***
+*** before it in its class, the class of weight 8 paying 1 and that of    ***
+*** weight 1 paying 8. Taking the earliest finish first shares the link   ***
+*** 8:4:2:1 between busy classes and lets urgent data go first, a class   ***
+*** being a FIFO only the heads of the classes are compared.              ***
+*/
+
+static const uint8_t sched_cost[ESS_SCHED_CLASSES] = { 1, 2, 4, 8 };
+
+void ess_sched_init(struct ess_sched *sched)
+{
+	memset(sched, 0, sizeof(*sched));
+	sched->tokens = UINT32_MAX;
+}
+
+static struct ess_sched_entry *class_entry(struct ess_sched_class *cls,
+							unsigned int i)
+{
+	return &cls->entry[(cls->head + i) % ESS_SCHED_PENDING];
+}
+
+struct ess_char *ess_sched_push(struct ess_sched *sched, struct ess_char *chr,
+				const uint8_t *pdu, uint8_t len,
+				uint64_t sampled)
+{
+	unsigned int prio = chr->priority < ESS_SCHED_CLASSES ?
+				chr->priority : ESS_SCHED_CLASSES - 1;
+	struct ess_sched_class *cls = &sched->cls[prio];
+	struct ess_sched_entry *entry;
+	struct ess_char *lost = NULL;
+	uint64_t start;
+	unsigned int i;
+
+	/* the newer value takes the place of the queued one */
+	for (i = 0; i < cls->len; i++) {
+		entry = class_entry(cls, i);
+
+		if (entry->chr != chr)
+			continue;
+
+		memcpy(entry->pdu, pdu, len);
+		entry->len = len;
+		entry->sampled = sampled;
+
+		return chr;
+	}
+
+	/* the oldest value of the class is the stalest one */
+	if (cls->len == ESS_SCHED_PENDING) {
+		lost = class_entry(cls, 0)->chr;
+		cls->head = (cls->head + 1) % ESS_SCHED_PENDING;
+		cls->len--;
+		sched->len--;
+	}
+
+	start = cls->finish > sched->vtime ? cls->finish : sched->vtime;
+
+	entry = class_entry(cls, cls->len);
+	entry->chr = chr;
+	entry->finish = start + (uint64_t) (len + ESS_SCHED_ATT_HDR) *
+							sched_cost[prio];
+	entry->sampled = sampled;
+	entry->len = len;
+	memcpy(entry->pdu, pdu, len);
+
+	cls->finish = entry->finish;
+	cls->len++;
+	sched->len++;
+
+	return lost;
+}
+
+void ess_sched_refill(struct ess_sched *sched, uint32_t rate, uint32_t burst)
+{
+	if (!rate) {
+		sched->tokens = UINT32_MAX;
+		return;
+	}
+
+	if (sched->tokens > burst || burst - sched->tokens < rate)
+		sched->tokens = burst;
+	else
+		sched->tokens += rate;
+}
+
+bool ess_sched_pop(struct ess_sched *sched, struct ess_sched_entry *entry)
+{
+	struct ess_sched_class *cls = NULL;
+	struct ess_sched_entry *head;
+	unsigned int c;
+
+	for (c = 0; c < ESS_SCHED_CLASSES; c++) {
+		struct ess_sched_class *cur = &sched->cls[c];
+
+		if (!cur->len)
+			continue;
+
+		if (!cls || class_entry(cur, 0)->finish <
+						class_entry(cls, 0)->finish)
+			cls = cur;
+	}
+
+	if (!cls)
+		return false;
+
+	head = class_entry(cls, 0);
+
+	if (sched->tokens != UINT32_MAX) {
+		if (sched->tokens < head->len + ESS_SCHED_ATT_HDR)
+			return false;
+
+		sched->tokens -= head->len + ESS_SCHED_ATT_HDR;
+	}
+
+	*entry = *head;
+	sched->vtime = head->finish;
+
+	cls->head = (cls->head + 1) % ESS_SCHED_PENDING;
+	cls->len--;
+	sched->len--;
+
+	return true;
+}
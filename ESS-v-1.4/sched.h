@@ -0,0 +1,52 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Notification scheduling of one connection, see struct ess_sched.
+ *
+ * ess_sched_push() queues a notification of chr in the class of its
+ * priority. It returns the instance whose queued value was lost: chr
+ * itself when its older value was replaced, the oldest instance of the
+ * class when the class was full, NULL otherwise.
+ *
+ * ess_sched_refill() adds a tick worth of "rate" octets to the token
+ * bucket, which holds at most "burst" octets; a rate of 0 lifts the limit.
+ * ess_sched_pop() takes the notification with the earliest virtual finish
+ * time into entry, as long as the bucket covers it with its ATT header.
+ * It fails when nothing is queued or the bucket is short, the next refill
+ * resumes where it stopped, so a burst below the largest notification
+ * with its ATT header would stall the connection for good.
+ */
+
+/* opcode and handle in front of the value */
+#define ESS_SCHED_ATT_HDR	3u
+
+void ess_sched_init(struct ess_sched *sched);
+struct ess_char *ess_sched_push(struct ess_sched *sched, struct ess_char *chr,
+				const uint8_t *pdu, uint8_t len,
+				uint64_t sampled);
+void ess_sched_refill(struct ess_sched *sched, uint32_t rate, uint32_t burst);
+bool ess_sched_pop(struct ess_sched *sched, struct ess_sched_entry *entry);
@@ -0,0 +1,263 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <time.h>
+
+#include "src/shared/mainloop.h"
+#include "src/shared/timeout.h"
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/sim.h"
+
+static bool simulated = false;
+static uint64_t virtual_now = 0;
+static uint64_t virtual_until = 0;
+static unsigned int sim_period = 1000;
+static unsigned int sim_batch = 1;
+static unsigned int sim_id = 0;
+static ess_clock_tick_func_t sim_func = NULL;
+static void *sim_data = NULL;
+
+static uint64_t rng_seed = 0x4553530000000001ull;
+
+void ess_clock_simulate(unsigned int speed, uint32_t until)
+{
+	simulated = true;
+	virtual_until = until * ESS_NSEC_PER_SEC;
+
+	/* the mainloop timer resolution is a millisecond */
+	if (speed >= 1000) {
+		sim_period = 1;
+		sim_batch = speed / 1000;
+	} else {
+		sim_period = 1000 / (speed ? speed : 1);
+		sim_batch = 1;
+	}
+}
+
+bool ess_clock_simulated(void)
+{
+	return simulated;
+}
+
+uint64_t ess_clock_now(void)
+{
+	struct timespec ts;
+
+	if (simulated)
+		return virtual_now;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * ESS_NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/* Seconds since midnight, local time unless simulated */
+
+uint32_t ess_clock_daytime(void)
+{
+	struct tm tm;
+	time_t now;
+
+	if (simulated)
+		return (virtual_now / ESS_NSEC_PER_SEC) % 86400;
+
+	now = time(NULL);
+	localtime_r(&now, &tm);
+
+	return tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+}
+
+static bool sim_timeout(void *user_data)
+{
+	unsigned int i;
+
+	for (i = 0; i < sim_batch; i++) {
+		virtual_now += ESS_NSEC_PER_SEC;
+
+		if (!sim_func(sim_data)) {
+			sim_id = 0;
+			return false;
+		}
+
+		if (virtual_until && virtual_now >= virtual_until) {
+			mainloop_quit();
+			sim_id = 0;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+unsigned int ess_clock_tick_add(ess_clock_tick_func_t func, void *user_data)
+{
+	if (!simulated)
+		return timeout_add(1000, func, user_data, NULL);
+
+	/* there is a single tick, the one of the server */
+	if (sim_id)
+		return 0;
+
+	sim_func = func;
+	sim_data = user_data;
+	sim_id = timeout_add(sim_period, sim_timeout, NULL, NULL);
+
+	return sim_id;
+}
+
+void ess_clock_tick_remove(unsigned int id)
+{
+	timeout_remove(id);
+
+	if (id == sim_id)
+		sim_id = 0;
+}
+
+/*
+*** xoshiro256** by Blackman and Vigna, seeded through splitmix64 so that ***
+*** nearby seeds still give unrelated streams                             ***
+*/
+
+static uint64_t splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+	return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+void ess_rng_set_seed(uint64_t seed)
+{
+	rng_seed = seed;
+}
+
+void ess_rng_init(struct ess_rng *rng, uint16_t uuid, uint16_t instance)
+{
+	uint64_t x = rng_seed ^ ((uint64_t) uuid << 32 | instance);
+	int i;
+
+	for (i = 0; i < 4; i++)
+		rng->s[i] = splitmix64(&x);
+}
+
+uint64_t ess_rng_next(struct ess_rng *rng)
+{
+	uint64_t *s = rng->s;
+	uint64_t result = rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
+
+/* Uniform in [lower, upper], multiply-shift instead of a biased modulo */
+
+int32_t ess_rng_range(struct ess_rng *rng, int32_t lower, int32_t upper)
+{
+	uint64_t span = (int64_t) upper - lower + 1;
+
+	return lower + (int64_t) (((ess_rng_next(rng) >> 32) * span) >> 32);
+}
+
+/*
+ * Random walk of at most "step" per sample with a slight pull towards the
+ * middle of the range, reflected at its bounds
+ */
+
+int32_t ess_sim_walk(struct ess_rng *rng, int32_t value, int32_t step,
+						int32_t lower, int32_t upper)
+{
+	int64_t mid = ((int64_t) lower + upper) / 2;
+	int64_t v = value;
+
+	v += ess_rng_range(rng, -step, step) + (mid - v) / 64;
+
+	if (v > upper)
+		v = 2 * (int64_t) upper - v;
+
+	if (v < lower)
+		v = 2 * (int64_t) lower - v;
+
+	if (v > upper)
+		v = upper;
+
+	return v;
+}
+
+/* sin(deg) in thousandths, Bhaskara I approximation (error below 0.2%) */
+
+static int32_t sin_milli(uint32_t deg)
+{
+	int64_t x = deg % 180;
+	int64_t p = x * (180 - x);
+	int32_t s = 4000 * p / (40500 - p);
+
+	return (deg % 360) < 180 ? s : -s;
+}
+
+/*
+ * Daily cycle: lowest at 03:00, highest at 15:00, spanning the range less
+ * the noise added on top
+ */
+
+int32_t ess_sim_diurnal(struct ess_rng *rng, uint32_t daytime, int32_t noise,
+						int32_t lower, int32_t upper)
+{
+	int64_t mid = ((int64_t) lower + upper) / 2;
+	int64_t amp = ((int64_t) upper - lower) / 2 - noise;
+	uint32_t deg = ((daytime + 86400 - 9 * 3600) % 86400) / 240;
+	int64_t v;
+
+	if (amp < 0)
+		amp = 0;
+
+	v = mid + amp * sin_milli(deg) / 1000;
+
+	if (noise)
+		v += ess_rng_range(rng, -noise, noise);
+
+	if (v < lower)
+		v = lower;
+
+	if (v > upper)
+		v = upper;
+
+	return v;
+}
@@ -0,0 +1,61 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ESS_NSEC_PER_SEC 1000000000ull
+
+/*
+ * Clock driving the triggers. By default it is CLOCK_MONOTONIC with a real
+ * one second tick. In simulation the time is virtual, starts at midnight
+ * and every tick advances it by one second, "speed" ticks for each second
+ * of wall clock, so a day of triggers runs in seconds and two runs with the
+ * same seed send the same values at the same virtual times.
+ */
+
+typedef bool (*ess_clock_tick_func_t)(void *user_data);
+
+void ess_clock_simulate(unsigned int speed, uint32_t until);
+bool ess_clock_simulated(void);
+uint64_t ess_clock_now(void);
+uint32_t ess_clock_daytime(void);
+unsigned int ess_clock_tick_add(ess_clock_tick_func_t func, void *user_data);
+void ess_clock_tick_remove(unsigned int id);
+
+/*
+ * Seeded value generators, one xoshiro256** stream per characteristic
+ * instance derived from the global seed, its UUID and its instance number.
+ */
+
+struct ess_rng;
+
+void ess_rng_set_seed(uint64_t seed);
+void ess_rng_init(struct ess_rng *rng, uint16_t uuid, uint16_t instance);
+uint64_t ess_rng_next(struct ess_rng *rng);
+int32_t ess_rng_range(struct ess_rng *rng, int32_t lower, int32_t upper);
+
+int32_t ess_sim_walk(struct ess_rng *rng, int32_t value, int32_t step,
+						int32_t lower, int32_t upper);
+int32_t ess_sim_diurnal(struct ess_rng *rng, uint32_t daytime, int32_t noise,
+						int32_t lower, int32_t upper);
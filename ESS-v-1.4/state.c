@@ -0,0 +1,252 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/state.h"
+#include "peripheral/ESS/arena.h"
+#include "peripheral/ESS/log.h"
+
+/* Every array starts on a cache line of its own */
+
+#define STATE_ALIGN	64
+#define STATE_MIN_SIZE	64
+
+struct ess_state ess_state;
+
+/* Slots of freed instances below len, reused before len grows */
+static unsigned int num_free;
+
+/* Octets of every array for one instance, the bitmaps left out */
+
+size_t ess_state_slot_size(void)
+{
+	return sizeof(*ess_state.flags) + sizeof(*ess_state.condition) +
+		sizeof(*ess_state.trigger) + sizeof(*ess_state.deadline) +
+		sizeof(*ess_state.interval) + sizeof(*ess_state.chr) +
+		sizeof(*ess_state.ccc) + ESS_MAX_AXES * (sizeof(*ess_state.value[0]) +
+					sizeof(*ess_state.threshold[0]) +
+					sizeof(*ess_state.sample[0]));
+}
+
+/* The arrays never shrink, growing them is all there is to charge */
+
+static int64_t state_mem(unsigned int size)
+{
+	return size * ess_state_slot_size() + size / 64 *
+			(sizeof(*ess_state.due) + sizeof(*ess_state.fire));
+}
+
+#ifdef ESS_STATIC
+
+/* Reserved at build time, the arrays are handed out once and never grow */
+
+#define STATE_ARRAY __attribute__((aligned(STATE_ALIGN)))
+
+static uint8_t static_flags[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint8_t static_condition[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint8_t static_trigger[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint32_t static_deadline[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint32_t static_interval[ESS_STATIC_CHARS] STATE_ARRAY;
+static int32_t static_value[ESS_MAX_AXES][ESS_STATIC_CHARS] STATE_ARRAY;
+static int32_t static_threshold[ESS_MAX_AXES][ESS_STATIC_CHARS] STATE_ARRAY;
+static int32_t static_sample[ESS_MAX_AXES][ESS_STATIC_CHARS] STATE_ARRAY;
+static struct ess_char *static_chr[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint64_t static_ccc[ESS_STATIC_CHARS] STATE_ARRAY;
+static uint64_t static_due[ESS_STATIC_CHARS / 64] STATE_ARRAY;
+static uint64_t static_fire[ESS_STATIC_CHARS / 64] STATE_ARRAY;
+
+static bool state_grow(void)
+{
+	int i;
+
+	if (ess_state.size) {
+		ess_warn("State arena full (%u)\n", ESS_STATIC_CHARS);
+		return false;
+	}
+
+	ess_state.flags = static_flags;
+	ess_state.condition = static_condition;
+	ess_state.trigger = static_trigger;
+	ess_state.deadline = static_deadline;
+	ess_state.interval = static_interval;
+	ess_state.chr = static_chr;
+	ess_state.ccc = static_ccc;
+	ess_state.due = static_due;
+	ess_state.fire = static_fire;
+
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		ess_state.value[i] = static_value[i];
+		ess_state.threshold[i] = static_threshold[i];
+		ess_state.sample[i] = static_sample[i];
+	}
+
+	ess_state.size = ESS_STATIC_CHARS;
+	ess_mem_charge_static(ESS_MEM_STATE, state_mem(ess_state.size));
+
+	return true;
+}
+
+#else
+
+static void *grow_array(void *old, size_t elem, unsigned int old_len,
+							unsigned int len)
+{
+	void *array;
+
+	if (posix_memalign(&array, STATE_ALIGN, elem * len))
+		return NULL;
+
+	memset(array, 0, elem * len);
+
+	if (old)
+		memcpy(array, old, elem * old_len);
+
+	free(old);
+
+	return array;
+}
+
+#define STATE_GROW(field, old_len, len) do {				\
+	void *array = grow_array(ess_state.field,			\
+				sizeof(*ess_state.field), old_len, len);\
+	if (!array)							\
+		return false;						\
+	ess_state.field = array;					\
+} while (0)
+
+static bool state_grow(void)
+{
+	unsigned int size;
+	int i;
+
+	size = ess_state.size ? ess_state.size * 2 : STATE_MIN_SIZE;
+
+	STATE_GROW(flags, ess_state.size, size);
+	STATE_GROW(condition, ess_state.size, size);
+	STATE_GROW(trigger, ess_state.size, size);
+	STATE_GROW(deadline, ess_state.size, size);
+	STATE_GROW(interval, ess_state.size, size);
+	STATE_GROW(chr, ess_state.size, size);
+	STATE_GROW(ccc, ess_state.size, size);
+
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		STATE_GROW(value[i], ess_state.size, size);
+		STATE_GROW(threshold[i], ess_state.size, size);
+		STATE_GROW(sample[i], ess_state.size, size);
+	}
+
+	STATE_GROW(due, ess_state.size / 64, size / 64);
+	STATE_GROW(fire, ess_state.size / 64, size / 64);
+
+	ess_mem_charge(ESS_MEM_STATE,
+			state_mem(size) - state_mem(ess_state.size));
+	ess_state.size = size;
+
+	return true;
+}
+
+#endif
+
+/* Give the instance a zeroed slot and set its id */
+
+bool ess_state_add(struct ess_char *chr)
+{
+	unsigned int id;
+	int i;
+
+	if (num_free) {
+		for (id = 0; ess_state.chr[id]; id++)
+			;
+
+		num_free--;
+	} else {
+		if (ess_state.len == ess_state.size && !state_grow())
+			return false;
+
+		id = ess_state.len++;
+	}
+
+	ess_state.flags[id] = 0;
+	ess_state.condition[id] = 0;
+	ess_state.trigger[id] = 0;
+	ess_state.deadline[id] = 0;
+	ess_state.interval[id] = 0;
+	ess_state.chr[id] = chr;
+	ess_state.ccc[id] = 0;
+
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		ess_state.value[i][id] = 0;
+		ess_state.threshold[i][id] = 0;
+		ess_state.sample[i][id] = 0;
+	}
+
+	chr->id = id;
+
+	return true;
+}
+
+void ess_state_remove(struct ess_char *chr)
+{
+	if (chr->id >= ess_state.len || ess_state.chr[chr->id] != chr)
+		return;
+
+	ess_state.chr[chr->id] = NULL;
+	ess_state.flags[chr->id] = 0;
+	ess_state.trigger[chr->id] = 0;
+	ess_state.ccc[chr->id] = 0;
+	num_free++;
+
+	/* the tick does not walk free slots at the end */
+	while (ess_state.len && !ess_state.chr[ess_state.len - 1]) {
+		ess_state.len--;
+		num_free--;
+	}
+}
+
+void ess_state_copy(unsigned int dst, unsigned int src)
+{
+	int i;
+
+	ess_state.flags[dst] = ess_state.flags[src];
+	ess_state.condition[dst] = ess_state.condition[src];
+	ess_state.trigger[dst] = ess_state.trigger[src];
+	ess_state.deadline[dst] = ess_state.deadline[src];
+	ess_state.interval[dst] = ess_state.interval[src];
+	ess_state.ccc[dst] = ess_state.ccc[src];
+
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		ess_state.value[i][dst] = ess_state.value[i][src];
+		ess_state.threshold[i][dst] = ess_state.threshold[i][src];
+		ess_state.sample[i][dst] = ess_state.sample[i][src];
+	}
+}
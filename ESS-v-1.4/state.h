@@ -0,0 +1,88 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Runtime state of every characteristic instance that the tick and the
+ * trigger pass read, one array per field indexed by the id of the
+ * instance. A pass over every instance walks a few contiguous cache lines
+ * and only follows the pointer to the struct ess_char, which holds the
+ * descriptors, source and statistics, for the instances that are due.
+ * Values are split by axis so the batch trigger evaluation loads the same
+ * axis of consecutive instances with one vector load.
+ */
+
+#define ESS_STATE_ENABLE	0x01	/* notifications enabled by any client */
+#define ESS_STATE_TIME		0x02	/* time based trigger */
+#define ESS_STATE_VALUE		0x04	/* value based trigger */
+#define ESS_STATE_INACTIVE	0x08	/* trigger inactive */
+#define ESS_STATE_SPACED	0x10	/* one notification per interval */
+#define ESS_STATE_MULTI		0x20	/* several trigger settings combined */
+#define ESS_STATE_DAMPED	0x40	/* hysteresis or dead band */
+
+struct ess_state {
+	unsigned int len;
+	unsigned int size;
+	uint8_t *flags;
+	uint8_t *condition;
+	uint8_t *trigger;
+	uint32_t *deadline;
+	uint32_t *interval;
+	int32_t *value[ESS_MAX_AXES];
+	int32_t *threshold[ESS_MAX_AXES];
+	int32_t *sample[ESS_MAX_AXES];
+	struct ess_char **chr;
+	/* connections with notifications enabled, bit n for slot n */
+	uint64_t *ccc;
+	/* one bit per instance, scratch of the tick */
+	uint64_t *due;
+	uint64_t *fire;
+};
+
+extern struct ess_state ess_state;
+
+bool ess_state_add(struct ess_char *chr);
+void ess_state_remove(struct ess_char *chr);
+void ess_state_copy(unsigned int dst, unsigned int src);
+size_t ess_state_slot_size(void);
+
+static inline void ess_state_get(int32_t * const *array, unsigned int id,
+							int32_t *value)
+{
+	int i;
+
+	for (i = 0; i < ESS_MAX_AXES; i++)
+		value[i] = array[i][id];
+}
+
+static inline void ess_state_set(int32_t **array, unsigned int id,
+						const int32_t *value)
+{
+	int i;
+
+	for (i = 0; i < ESS_MAX_AXES; i++)
+		array[i][id] = value[i];
+}
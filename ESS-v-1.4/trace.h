@@ -0,0 +1,58 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * USDT probes of the "ess" provider. Every probe carries the value handle
+ * of the characteristic (0 when there is none), the bt_att of the
+ * connection (0 when there is none) and a CLOCK_MONOTONIC timestamp in
+ * ns, some carry a fourth argument:
+ *
+ *   read_entry, write_entry        ATT callback entered
+ *   read_exit, write_exit          ATT callback done, arg3 is the opcode
+ *   trigger                        value trigger evaluated, arg3 fired
+ *   notify                         notification sent, arg3 success, the
+ *                                  timestamp is the tick that produced it
+ *   tick                           1 s tick fired, arg3 is the tick count
+ *   conn_accept, conn_teardown     connection set up or destroyed
+ *
+ * Only values that are at hand anyway are passed, so a disabled probe is
+ * a single NOP. Without <sys/sdt.h> the probes compile to nothing.
+ */
+
+#if !defined(ESS_NO_TRACE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define ESS_HAVE_SDT
+#endif
+#endif
+
+#ifdef ESS_HAVE_SDT
+#include <sys/sdt.h>
+
+#define ess_trace(probe, handle, conn, time) \
+	STAP_PROBE3(ess, probe, handle, conn, time)
+#define ess_trace1(probe, handle, conn, time, arg) \
+	STAP_PROBE4(ess, probe, handle, conn, time, arg)
+#else
+#define ess_trace(probe, handle, conn, time) do { } while (0)
+#define ess_trace1(probe, handle, conn, time, arg) do { } while (0)
+#endif
@@ -0,0 +1,552 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "peripheral/ESS/ESS.h"
+#include "peripheral/ESS/state.h"
+#include "peripheral/ESS/trigger.h"
+
+/* Encode every axis of a value little endian on the width of the characteristic */
+
+uint16_t ess_value_encode(const struct ess_char_type *type,
+					const int32_t *value, uint8_t *pdu)
+{
+	uint16_t len = 0;
+	int i, j;
+
+	for (i = 0; i < type->axes; i++) {
+		uint32_t v = value[i];
+
+		for (j = 0; j < type->len; j++)
+			pdu[len++] = v >> (8 * j);
+	}
+
+	return len;
+}
+
+void ess_value_decode(const struct ess_char_type *type,
+					const uint8_t *pdu, int32_t *value)
+{
+	int i, j;
+
+	for (i = 0; i < type->axes; i++) {
+		uint32_t v = 0;
+
+		for (j = 0; j < type->len; j++)
+			v |= (uint32_t) *pdu++ << (8 * j);
+
+		if (type->len < 4 && type->is_signed &&
+					(v & (1u << (8 * type->len - 1))))
+			v |= ~0u << (8 * type->len);
+		else if (type->len == 4 && !type->is_signed && v > INT32_MAX)
+			v = INT32_MAX;
+
+		value[i] = v;
+	}
+}
+
+/* Relations of the sample to the reference that fire, by condition */
+
+static const uint8_t trigger_relations[] = {
+	[0x02] = ESS_TRIGGER_LT | ESS_TRIGGER_GT | ESS_TRIGGER_CHANGE,
+	[0x03] = ESS_TRIGGER_LT | ESS_TRIGGER_GT | ESS_TRIGGER_CHANGE,
+	[0x04] = ESS_TRIGGER_LT,
+	[0x05] = ESS_TRIGGER_LT | ESS_TRIGGER_EQ,
+	[0x06] = ESS_TRIGGER_GT,
+	[0x07] = ESS_TRIGGER_GT | ESS_TRIGGER_EQ,
+	[0x08] = ESS_TRIGGER_EQ,
+	[0x09] = ESS_TRIGGER_LT | ESS_TRIGGER_GT,
+};
+
+uint8_t ess_trigger_compile(uint8_t condition, uint8_t axes)
+{
+	uint8_t trigger;
+
+	if (condition >= sizeof(trigger_relations))
+		return 0;
+
+	trigger = trigger_relations[condition];
+	if (!trigger)
+		return 0;
+
+	if (axes > 1)
+		trigger |= ESS_TRIGGER_AXIS1;
+
+	if (axes > 2)
+		trigger |= ESS_TRIGGER_AXIS2;
+
+	return trigger;
+}
+
+static inline bool trigger_fire(uint8_t trigger, int32_t sample,
+					int32_t threshold, int32_t value)
+{
+	int32_t ref = trigger & ESS_TRIGGER_CHANGE ? value : threshold;
+	uint8_t rel;
+
+	if (sample < ref)
+		rel = ESS_TRIGGER_LT;
+	else if (sample > ref)
+		rel = ESS_TRIGGER_GT;
+	else
+		rel = ESS_TRIGGER_EQ;
+
+	return trigger & rel;
+}
+
+/*
+*** Check a sample against the value trigger condition, for the magnetic flux ***
+*** characteristics it is enough that one axis satisfies the condition        ***
+*/
+
+bool ess_trigger_check(const struct ess_char *chr, const int32_t *val)
+{
+	unsigned int id = chr->id;
+	uint8_t trigger = ess_state.trigger[id];
+	int i;
+
+	for (i = 0; i < chr->type->axes; i++)
+		if (trigger_fire(trigger, val[i], ess_state.threshold[i][id],
+						ess_state.value[i][id]))
+			return true;
+
+	return false;
+}
+
+static bool trigger_fire_id(unsigned int id)
+{
+	uint8_t trigger = ess_state.trigger[id];
+	int i;
+
+	for (i = 0; i < ESS_MAX_AXES; i++) {
+		if (i == 1 && !(trigger & ESS_TRIGGER_AXIS1))
+			break;
+
+		if (i == 2 && !(trigger & ESS_TRIGGER_AXIS2))
+			break;
+
+		if (trigger_fire(trigger, ess_state.sample[i][id],
+						ess_state.threshold[i][id],
+						ess_state.value[i][id]))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+*** Several trigger settings combined. Every setting that is active gets   ***
+*** one bit, the decision table holds the outcome for each combination of ***
+*** bits, so a sample costs the relations of each setting and one shift.   ***
+*/
+
+uint8_t ess_trigger_table(uint8_t active, bool all)
+{
+	uint8_t table = 0;
+	unsigned int bits;
+
+	if (!active)
+		return 0;
+
+	for (bits = 0; bits < 1 << ESS_MAX_TRIGGERS; bits++) {
+		bool fire = all ? (bits & active) == active : bits & active;
+
+		table |= fire << bits;
+	}
+
+	return table;
+}
+
+uint8_t ess_trigger_combine(struct ess_trigger_combo *combo,
+				const struct ess_trigger_setting *settings,
+				unsigned int num, uint8_t config, uint8_t axes)
+{
+	uint8_t active = 0;
+	unsigned int k;
+	int i;
+
+	combo->timed = 0;
+
+	for (k = 0; k < ESS_MAX_TRIGGERS; k++) {
+		uint8_t condition = k < num ? settings[k].condition : 0x00;
+
+		combo->trigger[k] = ess_trigger_compile(condition, axes);
+		combo->interval[k] = 0;
+
+		if (condition < 0x01 || condition > 0x09)
+			continue;
+
+		active |= 1 << k;
+
+		if (condition == 0x01 || condition == 0x02) {
+			combo->timed |= 1 << k;
+			combo->interval[k] = settings[k].interval;
+		}
+
+		for (i = 0; i < ESS_MAX_AXES; i++)
+			combo->threshold[k][i] = settings[k].threshold[i];
+	}
+
+	combo->table = ess_trigger_table(active, config == ESS_CONFIG_AND);
+
+	return active;
+}
+
+/* Start every interval over, changes count from "value" on */
+
+void ess_trigger_arm(struct ess_trigger_combo *combo, const int32_t *value,
+								uint32_t tick)
+{
+	unsigned int k;
+	int i;
+
+	for (k = 0; k < ESS_MAX_TRIGGERS; k++)
+		combo->due[k] = tick + combo->interval[k];
+
+	for (i = 0; i < ESS_MAX_AXES; i++)
+		combo->sent[i] = value[i];
+}
+
+bool ess_trigger_eval(const struct ess_trigger_combo *combo,
+				const int32_t *sample, uint8_t axes,
+				uint32_t tick)
+{
+	unsigned int k, bits = 0;
+	int i;
+
+	for (k = 0; k < ESS_MAX_TRIGGERS; k++) {
+		uint8_t trigger = combo->trigger[k];
+		unsigned int fire = !trigger, due;
+
+		for (i = 0; i < axes; i++)
+			fire |= trigger_fire(trigger, sample[i],
+						combo->threshold[k][i],
+						combo->sent[i]);
+
+		due = !(combo->timed >> k & 1) |
+				((int32_t) (tick - combo->due[k]) >= 0);
+
+		bits |= (fire & due) << k;
+	}
+
+	return combo->table >> bits & 1;
+}
+
+/*
+*** Damping. A threshold condition with a hysteresis latches once it      ***
+*** notified and stays quiet until every axis went back past the          ***
+*** threshold by more than the hysteresis. A dead band holds back samples ***
+*** that did not move far enough from the value last notified.            ***
+*/
+
+static bool damp_released(uint8_t condition, const int32_t *sample,
+				const int32_t *threshold, uint8_t axes,
+				uint32_t hysteresis)
+{
+	int i;
+
+	for (i = 0; i < axes; i++) {
+		int64_t s = sample[i], t = threshold[i];
+
+		if (condition <= 0x05 ? s <= t + hysteresis :
+							s >= t - hysteresis)
+			return false;
+	}
+
+	return true;
+}
+
+static bool damp_moved(const int32_t *sample, const int32_t *sent,
+				uint8_t axes, uint32_t deadband)
+{
+	int i;
+
+	for (i = 0; i < axes; i++) {
+		int64_t delta = (int64_t) sample[i] - sent[i];
+
+		if (delta > deadband || -delta > deadband)
+			return true;
+	}
+
+	return false;
+}
+
+bool ess_trigger_damp(struct ess_char *chr, const int32_t *sample,
+								bool fire)
+{
+	struct ess_damping *damping = &chr->damping;
+	unsigned int id = chr->id;
+	uint8_t condition = ess_state.condition[id];
+	int32_t threshold[ESS_MAX_AXES];
+	bool latch;
+
+	/* combined settings have no single threshold to come back from */
+	latch = damping->hysteresis && !(ess_state.flags[id] & ESS_STATE_MULTI)
+				&& condition >= 0x04 && condition <= 0x07;
+
+	if (latch && damping->latched && !fire) {
+		ess_state_get(ess_state.threshold, id, threshold);
+
+		if (damp_released(condition, sample, threshold,
+					chr->type->axes, damping->hysteresis))
+			damping->latched = false;
+	}
+
+	if (!fire || (latch && damping->latched))
+		return false;
+
+	if (damping->deadband && !damp_moved(sample, damping->sent,
+					chr->type->axes, damping->deadband))
+		return false;
+
+	/* the sample is notified */
+	damping->latched = latch;
+	ess_trigger_damp_arm(chr, sample);
+
+	return true;
+}
+
+void ess_trigger_damp_arm(struct ess_char *chr, const int32_t *value)
+{
+	int i;
+
+	for (i = 0; i < ESS_MAX_AXES; i++)
+		chr->damping.sent[i] = value[i];
+}
+
+/* Evaluate the instances from "start" on, the words of mask are cleared */
+
+static void batch_tail(unsigned int start, unsigned int len, uint64_t *mask)
+{
+	unsigned int id;
+
+	for (id = start; id < len; id++)
+		if (trigger_fire_id(id))
+			mask[id / 64] |= 1ull << (id % 64);
+}
+
+void ess_trigger_batch_scalar(unsigned int len, uint64_t *mask)
+{
+	memset(mask, 0, (len + 63) / 64 * sizeof(uint64_t));
+
+	batch_tail(0, len, mask);
+}
+
+/*
+*   Vector evaluation, 4 (SSE2) or 8 (AVX2) instances per step: every lane   *
+*   compares the sample of its instance with the reference picked by the    *
+*   CHANGE bit, turns the result into one relation bit and tests it against *
+*   the compiled trigger. The axes beyond the first only count in lanes     *
+*   with the AXIS bits. The arrays of struct ess_state are 64 octet         *
+*   aligned, so every load is aligned; what is left of len after the last   *
+*   whole step goes through batch_tail().                                   *
+*/
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+__attribute__((target("sse2")))
+static __m128i sse2_axis(__m128i trigger, const int32_t *sample,
+				const int32_t *threshold, const int32_t *value)
+{
+	__m128i s = _mm_load_si128((const __m128i *) sample);
+	__m128i t = _mm_load_si128((const __m128i *) threshold);
+	__m128i v = _mm_load_si128((const __m128i *) value);
+	__m128i change = _mm_set1_epi32(ESS_TRIGGER_CHANGE);
+	__m128i ref, rel;
+
+	change = _mm_cmpeq_epi32(_mm_and_si128(trigger, change), change);
+	ref = _mm_or_si128(_mm_and_si128(change, v),
+					_mm_andnot_si128(change, t));
+
+	rel = _mm_and_si128(_mm_cmplt_epi32(s, ref),
+					_mm_set1_epi32(ESS_TRIGGER_LT));
+	rel = _mm_or_si128(rel, _mm_and_si128(_mm_cmpeq_epi32(s, ref),
+					_mm_set1_epi32(ESS_TRIGGER_EQ)));
+	rel = _mm_or_si128(rel, _mm_and_si128(_mm_cmpgt_epi32(s, ref),
+					_mm_set1_epi32(ESS_TRIGGER_GT)));
+
+	return _mm_and_si128(rel, trigger);
+}
+
+__attribute__((target("sse2")))
+static __m128i sse2_lanes(__m128i trigger, int bit)
+{
+	__m128i b = _mm_set1_epi32(bit);
+
+	return _mm_cmpeq_epi32(_mm_and_si128(trigger, b), b);
+}
+
+__attribute__((target("sse2")))
+static void batch_sse2(unsigned int len, uint64_t *mask)
+{
+	__m128i zero = _mm_setzero_si128();
+	unsigned int id, end = len & ~3u;
+
+	memset(mask, 0, (len + 63) / 64 * sizeof(uint64_t));
+
+	for (id = 0; id < end; id += 4) {
+		__m128i trigger, fire, hit;
+		int32_t octets;
+		int i, bits;
+
+		memcpy(&octets, &ess_state.trigger[id], sizeof(octets));
+		trigger = _mm_cvtsi32_si128(octets);
+		trigger = _mm_unpacklo_epi8(trigger, zero);
+		trigger = _mm_unpacklo_epi16(trigger, zero);
+
+		fire = sse2_axis(trigger, &ess_state.sample[0][id],
+						&ess_state.threshold[0][id],
+						&ess_state.value[0][id]);
+
+		for (i = 1; i < ESS_MAX_AXES; i++) {
+			hit = sse2_axis(trigger, &ess_state.sample[i][id],
+						&ess_state.threshold[i][id],
+						&ess_state.value[i][id]);
+			hit = _mm_and_si128(hit, sse2_lanes(trigger,
+					ESS_TRIGGER_AXIS1 << (i - 1)));
+			fire = _mm_or_si128(fire, hit);
+		}
+
+		bits = ~_mm_movemask_ps(_mm_castsi128_ps(
+					_mm_cmpeq_epi32(fire, zero))) & 0xf;
+
+		mask[id / 64] |= (uint64_t) bits << (id % 64);
+	}
+
+	batch_tail(end, len, mask);
+}
+
+__attribute__((target("avx2")))
+static __m256i avx2_axis(__m256i trigger, const int32_t *sample,
+				const int32_t *threshold, const int32_t *value)
+{
+	__m256i s = _mm256_load_si256((const __m256i *) sample);
+	__m256i t = _mm256_load_si256((const __m256i *) threshold);
+	__m256i v = _mm256_load_si256((const __m256i *) value);
+	__m256i change = _mm256_set1_epi32(ESS_TRIGGER_CHANGE);
+	__m256i ref, rel;
+
+	change = _mm256_cmpeq_epi32(_mm256_and_si256(trigger, change),
+								change);
+	ref = _mm256_blendv_epi8(t, v, change);
+
+	rel = _mm256_and_si256(_mm256_cmpgt_epi32(ref, s),
+					_mm256_set1_epi32(ESS_TRIGGER_LT));
+	rel = _mm256_or_si256(rel, _mm256_and_si256(
+					_mm256_cmpeq_epi32(s, ref),
+					_mm256_set1_epi32(ESS_TRIGGER_EQ)));
+	rel = _mm256_or_si256(rel, _mm256_and_si256(
+					_mm256_cmpgt_epi32(s, ref),
+					_mm256_set1_epi32(ESS_TRIGGER_GT)));
+
+	return _mm256_and_si256(rel, trigger);
+}
+
+__attribute__((target("avx2")))
+static __m256i avx2_lanes(__m256i trigger, int bit)
+{
+	__m256i b = _mm256_set1_epi32(bit);
+
+	return _mm256_cmpeq_epi32(_mm256_and_si256(trigger, b), b);
+}
+
+__attribute__((target("avx2")))
+static void batch_avx2(unsigned int len, uint64_t *mask)
+{
+	__m256i zero = _mm256_setzero_si256();
+	unsigned int id, end = len & ~7u;
+
+	memset(mask, 0, (len + 63) / 64 * sizeof(uint64_t));
+
+	for (id = 0; id < end; id += 8) {
+		__m256i trigger, fire, hit;
+		int i, bits;
+
+		trigger = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+				(const __m128i *) &ess_state.trigger[id]));
+
+		fire = avx2_axis(trigger, &ess_state.sample[0][id],
+						&ess_state.threshold[0][id],
+						&ess_state.value[0][id]);
+
+		for (i = 1; i < ESS_MAX_AXES; i++) {
+			hit = avx2_axis(trigger, &ess_state.sample[i][id],
+						&ess_state.threshold[i][id],
+						&ess_state.value[i][id]);
+			hit = _mm256_and_si256(hit, avx2_lanes(trigger,
+					ESS_TRIGGER_AXIS1 << (i - 1)));
+			fire = _mm256_or_si256(fire, hit);
+		}
+
+		bits = ~_mm256_movemask_ps(_mm256_castsi256_ps(
+				_mm256_cmpeq_epi32(fire, zero))) & 0xff;
+
+		mask[id / 64] |= (uint64_t) bits << (id % 64);
+	}
+
+	batch_tail(end, len, mask);
+}
+
+const char *ess_trigger_batch_name(void)
+{
+	if (__builtin_cpu_supports("avx2"))
+		return "avx2";
+
+	if (__builtin_cpu_supports("sse2"))
+		return "sse2";
+
+	return "scalar";
+}
+
+void ess_trigger_batch(unsigned int len, uint64_t *mask)
+{
+	if (__builtin_cpu_supports("avx2"))
+		batch_avx2(len, mask);
+	else if (__builtin_cpu_supports("sse2"))
+		batch_sse2(len, mask);
+	else
+		ess_trigger_batch_scalar(len, mask);
+}
+
+#else
+
+const char *ess_trigger_batch_name(void)
+{
+	return "scalar";
+}
+
+void ess_trigger_batch(unsigned int len, uint64_t *mask)
+{
+	ess_trigger_batch_scalar(len, mask);
+}
+
+#endif
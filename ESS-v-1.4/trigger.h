@@ -0,0 +1,95 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Value codec and trigger evaluation, the per sample hot path. Values are
+ * little endian on the width of the characteristic, one field per axis.
+ */
+
+uint16_t ess_value_encode(const struct ess_char_type *type,
+					const int32_t *value, uint8_t *pdu);
+void ess_value_decode(const struct ess_char_type *type,
+					const uint8_t *pdu, int32_t *value);
+
+/*
+ * A value trigger condition compiled to one octet: the relations of the
+ * sample to the reference that fire, whether the reference is the last
+ * value (0x02, 0x03) instead of the threshold, and which axes beyond the
+ * first the characteristic has. Zero for every other condition.
+ */
+
+#define ESS_TRIGGER_LT		0x01
+#define ESS_TRIGGER_EQ		0x02
+#define ESS_TRIGGER_GT		0x04
+#define ESS_TRIGGER_CHANGE	0x08
+#define ESS_TRIGGER_AXIS1	0x10
+#define ESS_TRIGGER_AXIS2	0x20
+
+uint8_t ess_trigger_compile(uint8_t condition, uint8_t axes);
+bool ess_trigger_check(const struct ess_char *chr, const int32_t *val);
+
+/*
+ * More than one trigger setting: ess_trigger_combine() compiles "num"
+ * settings and the ES Configuration value as written over the air
+ * (ESS_CONFIG_AND or ESS_CONFIG_OR) into combo and returns the mask of
+ * the active ones, ess_trigger_eval() tells whether a sample is notified
+ * and ess_trigger_arm() starts the intervals over once it was. A time
+ * setting (0x01) fires once its interval is over, 0x02 once its interval
+ * is over and the value changed.
+ */
+
+uint8_t ess_trigger_table(uint8_t active, bool all);
+uint8_t ess_trigger_combine(struct ess_trigger_combo *combo,
+				const struct ess_trigger_setting *settings,
+				unsigned int num, uint8_t config, uint8_t axes);
+void ess_trigger_arm(struct ess_trigger_combo *combo, const int32_t *value,
+								uint32_t tick);
+bool ess_trigger_eval(const struct ess_trigger_combo *combo,
+				const int32_t *sample, uint8_t axes,
+				uint32_t tick);
+
+/*
+ * Vendor damping of an instance flagged ESS_STATE_DAMPED: whether a sample
+ * the trigger did ("fire") or did not fire on is notified. Every sample of
+ * the instance goes through it, a hysteresis is only released by those.
+ * The dead band counts from the last sample it let through or from the
+ * value given to ess_trigger_damp_arm().
+ */
+
+bool ess_trigger_damp(struct ess_char *chr, const int32_t *sample,
+								bool fire);
+void ess_trigger_damp_arm(struct ess_char *chr, const int32_t *value);
+
+/*
+ * Evaluate the compiled trigger of the instances 0 to len - 1 against
+ * ess_state.sample, one bit per instance in mask. Bits of instances
+ * without a value trigger are clear. The scalar version is the reference
+ * the vector ones are checked and measured against.
+ */
+
+const char *ess_trigger_batch_name(void);
+void ess_trigger_batch(unsigned int len, uint64_t *mask);
+void ess_trigger_batch_scalar(unsigned int len, uint64_t *mask);